@@ -10,21 +10,33 @@ if( NOT TARGET Cinder-View )
 	ci_log_v( "VIEW_LIB_PATH: ${VIEW_LIB_PATH}" )
 
 	list( APPEND VIEW_SOURCES
+		${VIEW_SOURCE_PATH}/ui/Animator.cpp
 		${VIEW_SOURCE_PATH}/ui/Control.cpp
 		${VIEW_SOURCE_PATH}/ui/Filter.cpp
 		${VIEW_SOURCE_PATH}/ui/GestureTracker.cpp
+		${VIEW_SOURCE_PATH}/ui/GlDevice.cpp
+		${VIEW_SOURCE_PATH}/ui/GlStateCache.cpp
 		${VIEW_SOURCE_PATH}/ui/Graph.cpp
 		${VIEW_SOURCE_PATH}/ui/Image.cpp
+		${VIEW_SOURCE_PATH}/ui/ImageAtlas.cpp
+		${VIEW_SOURCE_PATH}/ui/ImageLoader.cpp
 		${VIEW_SOURCE_PATH}/ui/ImageView.cpp
+		${VIEW_SOURCE_PATH}/ui/InputQueue.cpp
+		${VIEW_SOURCE_PATH}/ui/InputRecording.cpp
 		${VIEW_SOURCE_PATH}/ui/Interface3d.cpp
 		${VIEW_SOURCE_PATH}/ui/Label.cpp
 		${VIEW_SOURCE_PATH}/ui/Layer.cpp
 		${VIEW_SOURCE_PATH}/ui/Layout.cpp
+		${VIEW_SOURCE_PATH}/ui/NullGlDevice.cpp
+		${VIEW_SOURCE_PATH}/ui/RenderCommandList.cpp
 		${VIEW_SOURCE_PATH}/ui/Renderer.cpp
 		${VIEW_SOURCE_PATH}/ui/ScrollView.cpp
+		${VIEW_SOURCE_PATH}/ui/SoftwareRasterizer.cpp
+		${VIEW_SOURCE_PATH}/ui/SpatialIndex.cpp
 		${VIEW_SOURCE_PATH}/ui/Suite.cpp
 		${VIEW_SOURCE_PATH}/ui/TextManager.cpp
 		${VIEW_SOURCE_PATH}/ui/TextField.cpp
+		${VIEW_SOURCE_PATH}/ui/TransformHierarchy.cpp
 		${VIEW_SOURCE_PATH}/ui/View.cpp
 	)
 
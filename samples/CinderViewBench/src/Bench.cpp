@@ -0,0 +1,111 @@
+#include "Bench.h"
+
+#include "cinder/Log.h"
+#include "cinder/Timer.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace ci;
+using namespace std;
+
+bool Bench::isEnabled( const string &scenario, const string &operation ) const
+{
+	return mFilter.empty() || ( scenario + "/" + operation ).find( mFilter ) != string::npos;
+}
+
+void Bench::run( const string &scenario, const string &operation, size_t numViews, size_t opsPerIteration, size_t iterations,
+					const function<void ()> &fn, const function<void ()> &setupFn )
+{
+	if( ! isEnabled( scenario, operation ) )
+		return;
+
+	CI_ASSERT( iterations > 0 );
+
+	// warm up
+	if( setupFn )
+		setupFn();
+	fn();
+
+	Result result;
+	result.mScenario = scenario;
+	result.mOperation = operation;
+	result.mNumViews = numViews;
+	result.mOpsPerIteration = opsPerIteration;
+	result.mIterations = iterations;
+	result.mMinMs = numeric_limits<double>::max();
+	result.mMaxMs = 0;
+
+	double totalMs = 0;
+	for( size_t i = 0; i < iterations; i++ ) {
+		if( setupFn )
+			setupFn();
+
+		Timer timer( true );
+		fn();
+		timer.stop();
+
+		double ms = timer.getSeconds() * 1000.0;
+		totalMs += ms;
+		result.mMinMs = std::min( result.mMinMs, ms );
+		result.mMaxMs = std::max( result.mMaxMs, ms );
+	}
+
+	result.mMeanMs = totalMs / (double)iterations;
+	mResults.push_back( result );
+
+	CI_LOG_I( scenario << "/" << operation << " [" << numViews << " views]: mean " << result.mMeanMs << " ms, min " << result.mMinMs
+				<< " ms, max " << result.mMaxMs << " ms, " << result.getNanosPerOp() << " ns/op" );
+}
+
+void Bench::check( const string &scenario, const string &name, bool passed, const string &detail )
+{
+	mChecks.push_back( { scenario, name, passed, detail } );
+
+	if( passed )
+		CI_LOG_I( scenario << "/" << name << " passed: " << detail );
+	else
+		CI_LOG_E( scenario << "/" << name << " FAILED: " << detail );
+}
+
+size_t Bench::getNumFailedChecks() const
+{
+	return (size_t)count_if( mChecks.begin(), mChecks.end(), []( const Check &check ) { return ! check.mPassed; } );
+}
+
+void Bench::writeJson( ostream &os ) const
+{
+	// names and check details are all plain ascii chosen in this app, so nothing needs escaping
+	os << "{\n";
+	os << "\t\"suite\": \"cinder-view-bench\",\n";
+	os << "\t\"results\": [";
+	for( size_t i = 0; i < mResults.size(); i++ ) {
+		const auto &r = mResults[i];
+		os << ( i == 0 ? "\n" : ",\n" );
+		os << "\t\t{ ";
+		os << "\"scenario\": \"" << r.mScenario << "\", ";
+		os << "\"operation\": \"" << r.mOperation << "\", ";
+		os << "\"views\": " << r.mNumViews << ", ";
+		os << "\"ops_per_iteration\": " << r.mOpsPerIteration << ", ";
+		os << "\"iterations\": " << r.mIterations << ", ";
+		os << "\"min_ms\": " << r.mMinMs << ", ";
+		os << "\"mean_ms\": " << r.mMeanMs << ", ";
+		os << "\"max_ms\": " << r.mMaxMs << ", ";
+		os << "\"ns_per_op\": " << r.getNanosPerOp();
+		os << " }";
+	}
+	os << "\n\t],\n";
+	os << "\t\"checks\": [";
+	for( size_t i = 0; i < mChecks.size(); i++ ) {
+		const auto &c = mChecks[i];
+		os << ( i == 0 ? "\n" : ",\n" );
+		os << "\t\t{ ";
+		os << "\"scenario\": \"" << c.mScenario << "\", ";
+		os << "\"name\": \"" << c.mName << "\", ";
+		os << "\"passed\": " << ( c.mPassed ? "true" : "false" ) << ", ";
+		os << "\"detail\": \"" << c.mDetail << "\"";
+		os << " }";
+	}
+	os << "\n\t]\n";
+	os << "}\n";
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! Collects timings for the cinder-view-bench scenarios and writes them out as JSON.
+class Bench {
+  public:
+	struct Result {
+		std::string	mScenario;		// Which synthetic hierarchy was measured (ex. "flat", "chain")
+		std::string	mOperation;		// What was timed (ex. "addSubview", "update")
+		size_t		mNumViews;		// Total number of Views in the hierarchy
+		size_t		mOpsPerIteration;	// Number of operations one iteration performs, used to derive ns per op
+		size_t		mIterations;
+		double		mMinMs;
+		double		mMeanMs;
+		double		mMaxMs;
+
+		double	getNanosPerOp() const	{ return mOpsPerIteration ? mMeanMs * 1e6 / (double)mOpsPerIteration : 0; }
+	};
+
+	struct Check {
+		std::string	mScenario;
+		std::string	mName;		// What was checked (ex. "program_issued")
+		bool		mPassed;
+		std::string	mDetail;	// The expected and actual values
+	};
+
+	//! Only operations whose "scenario/operation" name contains \a filter are run. Empty runs everything.
+	void	setFilter( const std::string &filter )	{ mFilter = filter; }
+	//! Returns false if the "scenario/operation" is filtered out, in which case it isn't worth building its hierarchy.
+	bool	isEnabled( const std::string &scenario, const std::string &operation ) const;
+
+	//! Times \a iterations calls to \a fn after one warm up call. \a setupFn is called untimed before every call to \a fn, including the warm up.
+	void	run( const std::string &scenario, const std::string &operation, size_t numViews, size_t opsPerIteration, size_t iterations,
+					const std::function<void ()> &fn, const std::function<void ()> &setupFn = nullptr );
+
+	//! Records whether the invariant \a name of \a scenario held, logging an error if it didn't. Checks are written alongside the timings so that regressions show up in release builds.
+	void	check( const std::string &scenario, const std::string &name, bool passed, const std::string &detail );
+
+	const std::vector<Result>&	getResults() const	{ return mResults; }
+	const std::vector<Check>&	getChecks() const	{ return mChecks; }
+	//! Returns the number of checks that didn't pass.
+	size_t	getNumFailedChecks() const;
+
+	//! Writes all results as a JSON object to \a os.
+	void	writeJson( std::ostream &os ) const;
+
+  private:
+	std::vector<Result>	mResults;
+	std::vector<Check>	mChecks;
+	std::string			mFilter;
+};
@@ -0,0 +1,1693 @@
+#include "cinder/app/App.h"
+#include "cinder/app/RendererGl.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Log.h"
+#include "cinder/Rand.h"
+#include "cinder/Timeline.h"
+
+#include "vu/vu.h"
+#include "Bench.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
+
+using namespace ci;
+using namespace std;
+
+// Builds synthetic View hierarchies on a headless vu::Graph and times the core scene graph operations on them, writing the
+// results to a JSON file along with correctness checks, ex. of the gl state changes that reference scenes need. The app window is only needed for the GL context that Labels use to load fonts.
+//
+// Command line arguments:
+//	--output <path>		where to write the JSON results (defaults to cinder-view-bench.json next to the executable)
+//	--max-views <n>		skips scenarios with more than n views (defaults to 1000000)
+//	--filter <str>		only runs operations whose "scenario/operation" name contains str
+
+namespace {
+
+const ivec2 GRAPH_SIZE = { 1920, 1080 };
+const size_t NUM_HIT_TESTS = 64;
+const size_t NUM_TOUCHES = 10;
+const size_t NUM_GESTURE_MOVES = 10;
+const size_t LABEL_GRID_COLUMNS = 4;
+
+const vector<size_t> FLAT_VIEW_COUNTS = { 1000, 10000, 100000, 1000000 };
+const vector<size_t> CHAIN_DEPTHS = { 10, 100, 1000, 5000 };
+const vector<size_t> SCROLL_ROW_COUNTS = { 1000, 10000, 100000 };
+const vector<size_t> LABEL_GRID_ROW_COUNTS = { 10, 100, 1000 };
+const vector<size_t> FRAMEBUFFER_POOL_VIEW_COUNTS = { 100, 500 };
+const vector<size_t> PANEL_CELL_COUNTS = { 100, 1000 };
+const vector<size_t> ICON_GRID_COUNTS = { 100, 1000 };
+const size_t NUM_UNIQUE_ICONS = 64;
+const int ICON_SIZE = 24;
+const vector<size_t> GALLERY_IMAGE_COUNTS = { 16, 64 };
+const int GALLERY_IMAGE_SIZE = 512;
+const size_t GALLERY_ITERATIONS = 5;
+const size_t GL_STATE_PANEL_CELLS = 100;
+const size_t GL_STATE_NUM_LAYERS = 16;
+const ivec2 OPTIMIZE_SCENE_SIZE = { 256, 256 };
+const size_t OPTIMIZE_GRID_CELLS = 48;
+const size_t OPTIMIZE_NUM_IMAGES = 3;
+const size_t TOUCH_DISPATCH_EVENTS = 24;
+const size_t TOUCH_DISPATCH_TOUCHES = 12;
+const size_t TRANSFORM_CHAIN_DEPTH = 64;
+const float TRANSFORM_TOLERANCE = 0.001f;
+const size_t WORLD_POS_CHAIN_DEPTH = 32;
+const size_t WORLD_POS_FRAMES = 40;
+const size_t SLEEP_SETTLE_FRAMES = 3;
+const size_t SLEEP_IDLE_FRAMES = 5;
+
+//! Handles all touches that land on it, so that dispatch ends at the leaves like it would in a real app
+class TouchTarget : public vu::View {
+  public:
+	TouchTarget( const Rectf &bounds = Rectf::zero() )
+		: View( bounds )
+	{}
+
+  protected:
+	bool touchesBegan( app::TouchEvent &event ) override
+	{
+		for( auto &touch : event.getTouches() )
+			touch.setHandled();
+
+		return true;
+	}
+};
+
+//! Appends the touches it receives in touchesBegan() to a shared log. Handles either all of them, or only the ones in its left half so that the rest fall through
+//! to the Views below it. A spawner adds a TouchLogger above itself and one inside of itself each time it is touched, which the following events can land on.
+class TouchLogger : public vu::View {
+  public:
+	TouchLogger( const Rectf &bounds, vector<string> *log, bool handlesAll = true, bool spawns = false )
+		: View( bounds ), mLog( log ), mHandlesAll( handlesAll ), mSpawns( spawns )
+	{}
+
+  protected:
+	bool touchesBegan( app::TouchEvent &event ) override
+	{
+		string entry = getName() + ":";
+		for( auto &touch : event.getTouches() ) {
+			entry += " " + to_string( touch.getId() );
+			if( mHandlesAll || toLocal( touch.getPos() ).x < getWidth() / 2 )
+				touch.setHandled();
+		}
+		mLog->push_back( entry );
+
+		if( mSpawns ) {
+			const string name = getName() + "_" + to_string( mNumSpawned++ );
+			const vec2 offset = vec2( 40 ) * (float)mNumSpawned;
+			spawn( getParent(), name + "_above", Rectf( getPos() + offset, getPos() + offset + getSize() / 2.0f ) );
+			spawn( this, name + "_inside", Rectf( offset, offset + getSize() / 3.0f ) );
+		}
+
+		return true;
+	}
+
+  private:
+	void spawn( vu::View *parent, const string &name, const Rectf &bounds )
+	{
+		auto view = make_shared<TouchLogger>( bounds, mLog, false );
+		view->setHooks( vu::View::detectHooks<TouchLogger>() );
+		view->setLabel( name );
+		parent->addSubview( view );
+	}
+
+	vector<string>	*mLog;
+	bool			mHandlesAll, mSpawns;
+	size_t			mNumSpawned = 0;
+};
+
+//! Calls a function from update(), so checks can run in the middle of Graph::propagateUpdate(), after the Animator has written to the Views it animates.
+class UpdateProbe : public vu::View {
+  public:
+	UpdateProbe( const function<void ()> &callback )
+		: mCallback( callback )
+	{}
+
+  protected:
+	void update() override
+	{
+		mCallback();
+	}
+
+  private:
+	function<void ()>	mCallback;
+};
+
+//! Counts how many times the Graph updates and draws it, so that checks can see which Views culling and update policies skipped. Handles all touches that land on it.
+class CountingView : public vu::RectView {
+  public:
+	CountingView( const Rectf &bounds = Rectf::zero() )
+		: RectView( bounds )
+	{}
+
+	size_t	getNumUpdates() const	{ return mNumUpdates; }
+	size_t	getNumDraws() const		{ return mNumDraws; }
+
+  protected:
+	void update() override
+	{
+		mNumUpdates++;
+	}
+
+	void draw( vu::Renderer *ren ) override
+	{
+		mNumDraws++;
+		RectView::draw( ren );
+	}
+
+	bool touchesBegan( app::TouchEvent &event ) override
+	{
+		for( auto &touch : event.getTouches() )
+			touch.setHandled();
+
+		return true;
+	}
+
+  private:
+	size_t	mNumUpdates = 0;
+	size_t	mNumDraws = 0;
+};
+
+//! Keeps the total amount of Views touched per scenario roughly constant, so the small cases aren't dominated by timer noise
+size_t getNumIterations( size_t numViews )
+{
+	return std::min<size_t>( std::max<size_t>( 200000 / std::max<size_t>( numViews, 1 ), 3 ), 100 );
+}
+
+vu::GraphRef makeGraph()
+{
+	return make_shared<vu::Graph>( GRAPH_SIZE );
+}
+
+//! Returns \a numViews TouchTargets laid out in a square-ish grid that covers \a size
+vector<vu::ViewRef> makeGridViews( size_t numViews, const vec2 &size )
+{
+	const size_t numColumns = (size_t)ceil( sqrt( (double)numViews ) );
+	const vec2 cellSize = size / (float)numColumns;
+
+	vector<vu::ViewRef> result;
+	result.reserve( numViews );
+	for( size_t i = 0; i < numViews; i++ ) {
+		vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+		auto view = make_shared<TouchTarget>( Rectf( pos, pos + cellSize ) );
+		view->setHooks( vu::View::detectHooks<TouchTarget>() );
+		result.push_back( view );
+	}
+
+	return result;
+}
+
+//! Returns a chain of \a depth Views, each one the only subview of the one before it. Every View is offset by one pixel from its parent.
+vu::ViewRef makeChain( size_t depth )
+{
+	auto root = make_shared<TouchTarget>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+	auto parent = root;
+	for( size_t i = 1; i < depth; i++ ) {
+		auto view = make_shared<TouchTarget>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+		view->setPos( vec2( 1 ) );
+		parent->addSubview( view );
+		parent = view;
+	}
+
+	return root;
+}
+
+vector<app::TouchEvent::Touch> makeTouches( Rand &rand, size_t numTouches )
+{
+	vector<app::TouchEvent::Touch> result;
+	for( uint32_t id = 0; id < numTouches; id++ ) {
+		vec2 pos = vec2( rand.nextFloat( 0, GRAPH_SIZE.x ), rand.nextFloat( 0, GRAPH_SIZE.y ) );
+		result.emplace_back( pos, pos, id, 0.0, nullptr );
+	}
+
+	return result;
+}
+
+vector<app::TouchEvent> makeHitTestEvents()
+{
+	Rand rand( 1 );
+	vector<app::TouchEvent> result;
+	for( size_t i = 0; i < NUM_HIT_TESTS; i++ )
+		result.emplace_back( nullptr, makeTouches( rand, 1 ) );
+
+	return result;
+}
+
+//! A recorded multi-touch gesture: began, a number of moves that drag every touch upwards, then ended.
+struct Gesture {
+	Gesture()
+	{
+		Rand rand( 2 );
+		mBegan = makeTouches( rand, NUM_TOUCHES );
+
+		auto prev = mBegan;
+		for( size_t i = 0; i < NUM_GESTURE_MOVES; i++ ) {
+			vector<app::TouchEvent::Touch> touches;
+			for( const auto &touch : prev ) {
+				vec2 pos = touch.getPos() - vec2( 0, 10 );
+				touches.emplace_back( pos, touch.getPos(), touch.getId(), 0.0, nullptr );
+			}
+
+			mMoves.push_back( touches );
+			prev = touches;
+		}
+
+		mEnded = prev;
+	}
+
+	void dispatch( vu::Graph *graph ) const
+	{
+		app::TouchEvent beganEvent( nullptr, mBegan );
+		graph->propagateTouchesBegan( beganEvent );
+
+		for( const auto &touches : mMoves ) {
+			app::TouchEvent movedEvent( nullptr, touches );
+			graph->propagateTouchesMoved( movedEvent );
+		}
+
+		app::TouchEvent endedEvent( nullptr, mEnded );
+		graph->propagateTouchesEnded( endedEvent );
+	}
+
+	vector<app::TouchEvent::Touch>			mBegan, mEnded;
+	vector<vector<app::TouchEvent::Touch>>	mMoves;
+};
+
+//! Returns the transform from \a view's coordinate space to its parent's, built straight from its position, rotation and scale.
+mat3 calcLocalTransform( const vu::View *view )
+{
+	const float c = cos( view->getRotation() );
+	const float s = sin( view->getRotation() );
+	const vec2 &scale = view->getScale();
+	return mat3( vec3( c * scale.x, s * scale.x, 0 ), vec3( - s * scale.y, c * scale.y, 0 ), vec3( view->getPos(), 1 ) );
+}
+
+//! Returns the world transform of \a view multiplied out from the root, without any of the caching that View and TransformHierarchy do.
+mat3 calcWorldTransform( const vu::View *view )
+{
+	if( ! view )
+		return mat3( 1 );
+
+	return calcWorldTransform( view->getParent() ) * calcLocalTransform( view );
+}
+
+//! Returns the axis aligned box around the corners of \a rect transformed by \a transform.
+Rectf transformCorners( const Rectf &rect, const mat3 &transform )
+{
+	Rectf result( vec2( numeric_limits<float>::max() ), vec2( numeric_limits<float>::lowest() ) );
+	for( const vec2 &corner : { rect.getUpperLeft(), rect.getUpperRight(), rect.getLowerLeft(), rect.getLowerRight() } ) {
+		const vec2 pos = vec2( transform * vec3( corner, 1 ) );
+		result.x1 = std::min( result.x1, pos.x );
+		result.y1 = std::min( result.y1, pos.y );
+		result.x2 = std::max( result.x2, pos.x );
+		result.y2 = std::max( result.y2, pos.y );
+	}
+
+	return result;
+}
+
+size_t countViews( const vu::ViewRef &view )
+{
+	size_t result = 0;
+	vu::traverse( view, [&result]( const vu::ViewRef & ) {
+		result++;
+		return true;
+	} );
+
+	return result;
+}
+
+//! Fills \a graph with a grid of numCells cells, each with a background, a border and a bar. Returns the bars, which the panel benchmarks resize every frame.
+vector<vu::RectViewRef> makePanel( const vu::GraphRef &graph, size_t numCells )
+{
+	const size_t numColumns = (size_t)ceil( sqrt( (double)numCells ) );
+	const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)numColumns;
+
+	vector<vu::RectViewRef> bars;
+	for( size_t i = 0; i < numCells; i++ ) {
+		vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+		auto cell = graph->makeSubview<vu::View>( Rectf( pos, pos + cellSize ) );
+		cell->getBackground()->setColor( Color::gray( 0.2f ) );
+
+		auto border = cell->makeSubview<vu::StrokedRectView>( Rectf( vec2( 0 ), cellSize ) );
+		border->setColor( Color::gray( 0.8f ) );
+
+		auto bar = cell->makeSubview<vu::RectView>( Rectf( vec2( 2 ), vec2( cellSize.x - 2, 6 ) ) );
+		bar->setColor( Color( 0, 0.6f, 1 ) );
+		bars.push_back( bar );
+	}
+
+	return bars;
+}
+
+//! Returns a square icon with a colored disc on a transparent background, the color depends on \a index.
+Surface8u makeIcon( size_t index )
+{
+	Surface8u result( ICON_SIZE, ICON_SIZE, true, SurfaceChannelOrder::RGBA );
+	const Color8u color( Color( CM_HSV, (float)index / (float)NUM_UNIQUE_ICONS, 0.7f, 1 ) );
+	const vec2 center = vec2( ICON_SIZE ) / 2.0f;
+	for( int y = 0; y < ICON_SIZE; y++ ) {
+		for( int x = 0; x < ICON_SIZE; x++ ) {
+			uint8_t *pixel = result.getData( ivec2( x, y ) );
+			const bool inside = glm::distance( vec2( x, y ) + vec2( 0.5f ), center ) < ICON_SIZE / 2.0f - 1;
+			pixel[result.getRedOffset()] = color.r;
+			pixel[result.getGreenOffset()] = color.g;
+			pixel[result.getBlueOffset()] = color.b;
+			pixel[result.getAlphaOffset()] = inside ? 255 : 0;
+		}
+	}
+
+	return result;
+}
+
+//! Returns a photo sized image for the gallery benchmark, whose pattern depends on \a index so that every file decodes to different pixels.
+Surface8u makeGalleryImage( size_t index )
+{
+	Surface8u result( GALLERY_IMAGE_SIZE, GALLERY_IMAGE_SIZE, false );
+	for( int y = 0; y < GALLERY_IMAGE_SIZE; y++ ) {
+		for( int x = 0; x < GALLERY_IMAGE_SIZE; x++ ) {
+			uint8_t *pixel = result.getData( ivec2( x, y ) );
+			pixel[result.getRedOffset()] = uint8_t( x + index * 31 );
+			pixel[result.getGreenOffset()] = uint8_t( y ^ ( x * (int)index ) );
+			pixel[result.getBlueOffset()] = uint8_t( ( x * y ) >> 6 );
+		}
+	}
+
+	return result;
+}
+
+//! Accumulates results that would otherwise be unused, so the compiler can't throw away the work being timed
+volatile float sSink = 0;
+
+} // anonymous namespace
+
+class CinderViewBenchApp : public app::App {
+  public:
+	void setup() override;
+	void draw() override;
+
+  private:
+	void parseArgs();
+	void benchFlatCanvas( size_t numViews );
+	void benchDeepChain( size_t depth );
+	void benchScrollList( size_t numRows );
+	void benchLabelGrid( size_t numRows );
+	void benchFrameBufferPool( size_t numViews );
+	void benchLayerCache( size_t numViews );
+	void benchBatching( size_t numCells );
+	void benchSoftwareRasterizer( size_t numCells );
+	void benchGlState();
+	void benchOptimize();
+	void benchTouchDispatch();
+	void benchTransforms();
+	void benchWorldPos();
+	void benchCulling();
+	void benchSleep();
+	void benchImageAtlas( size_t numIcons );
+	void benchGallery( size_t numImages );
+	void writeResults();
+
+	Bench		mBench;
+	fs::path	mOutputPath;
+	size_t		mMaxViews = 1000000;
+};
+
+void CinderViewBenchApp::setup()
+{
+	parseArgs();
+
+	for( size_t numViews : FLAT_VIEW_COUNTS ) {
+		if( numViews <= mMaxViews )
+			benchFlatCanvas( numViews );
+	}
+	for( size_t depth : CHAIN_DEPTHS ) {
+		if( depth <= mMaxViews )
+			benchDeepChain( depth );
+	}
+	for( size_t numRows : SCROLL_ROW_COUNTS ) {
+		if( numRows <= mMaxViews )
+			benchScrollList( numRows );
+	}
+	for( size_t numRows : LABEL_GRID_ROW_COUNTS ) {
+		if( numRows * LABEL_GRID_COLUMNS <= mMaxViews )
+			benchLabelGrid( numRows );
+	}
+	for( size_t numViews : FRAMEBUFFER_POOL_VIEW_COUNTS ) {
+		if( numViews <= mMaxViews )
+			benchFrameBufferPool( numViews );
+	}
+	for( size_t numViews : FRAMEBUFFER_POOL_VIEW_COUNTS ) {
+		if( numViews <= mMaxViews )
+			benchLayerCache( numViews );
+	}
+	for( size_t numCells : PANEL_CELL_COUNTS ) {
+		if( numCells * 3 <= mMaxViews )
+			benchBatching( numCells );
+	}
+	for( size_t numCells : PANEL_CELL_COUNTS ) {
+		if( numCells * 3 <= mMaxViews )
+			benchSoftwareRasterizer( numCells );
+	}
+	benchGlState();
+	benchOptimize();
+	benchTouchDispatch();
+	benchTransforms();
+	benchWorldPos();
+	benchCulling();
+	benchSleep();
+	for( size_t numIcons : ICON_GRID_COUNTS ) {
+		if( numIcons <= mMaxViews )
+			benchImageAtlas( numIcons );
+	}
+	for( size_t numImages : GALLERY_IMAGE_COUNTS ) {
+		if( numImages <= mMaxViews )
+			benchGallery( numImages );
+	}
+
+	writeResults();
+	quit();
+}
+
+void CinderViewBenchApp::parseArgs()
+{
+	mOutputPath = getAppPath() / "cinder-view-bench.json";
+
+	const auto &args = getCommandLineArgs();
+	for( size_t i = 1; i + 1 < args.size(); i++ ) {
+		if( args[i] == "--output" )
+			mOutputPath = args[++i];
+		else if( args[i] == "--max-views" )
+			mMaxViews = (size_t)stoull( args[++i] );
+		else if( args[i] == "--filter" )
+			mBench.setFilter( args[++i] );
+	}
+}
+
+// A single canvas holding numViews leaves, all direct subviews. This is the shape of the big multi-user walls.
+void CinderViewBenchApp::benchFlatCanvas( size_t numViews )
+{
+	const size_t iterations = getNumIterations( numViews );
+	const size_t totalViews = numViews + 2; // Graph + canvas
+
+	vu::GraphRef graph;
+	vu::ViewRef canvas;
+	vector<vu::ViewRef> views;
+
+	mBench.run( "flat", "addSubview", totalViews, numViews, iterations,
+		[&] {
+			for( const auto &view : views )
+				canvas->addSubview( view );
+		},
+		[&] {
+			graph = makeGraph();
+			canvas = graph->makeSubview<vu::View>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+			views = makeGridViews( numViews, vec2( GRAPH_SIZE ) );
+		} );
+
+	// all remaining operations share one populated hierarchy
+	graph = makeGraph();
+	canvas = graph->makeSubview<vu::View>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+	for( const auto &view : makeGridViews( numViews, vec2( GRAPH_SIZE ) ) )
+		canvas->addSubview( view );
+
+	graph->propagateUpdate();
+
+	mBench.run( "flat", "layoutIfNeeded", totalViews, numViews, iterations, [&] {
+		for( const auto &view : canvas->getSubviews() )
+			view->setNeedsLayout();
+
+		graph->layoutIfNeeded();
+	} );
+
+	mBench.run( "flat", "update", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	// same as above, with the leaves' empty update() and layout() hooks called as they would be without hook detection
+	for( const auto &view : canvas->getSubviews() )
+		view->setHooks( vu::View::HOOKS_ALL );
+
+	mBench.run( "flat", "update_all_hooks", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	for( const auto &view : canvas->getSubviews() )
+		view->setHooks( vu::View::detectHooks<TouchTarget>() );
+
+	// same as above, with the canvas allowed to sleep. The first update settles it, after which its subtree is skipped.
+	canvas->setUpdatePolicy( vu::UpdatePolicy::WHEN_DIRTY );
+	graph->propagateUpdate();
+	mBench.run( "flat", "update_asleep", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+	canvas->setUpdatePolicy( vu::UpdatePolicy::ALWAYS );
+
+	// moving the container without reading anything back only pays for invalidating the subviews' world positions
+	bool moved = false;
+	mBench.run( "flat", "move_container", totalViews, 1, iterations, [&] {
+		moved = ! moved;
+		canvas->setPos( moved ? vec2( 1 ) : vec2( 0 ) );
+	} );
+
+	mBench.run( "flat", "getWorldPos_after_root_move", totalViews, numViews, iterations, [&] {
+		moved = ! moved;
+		canvas->setPos( moved ? vec2( 1 ) : vec2( 0 ) );
+
+		float sum = 0;
+		for( const auto &view : canvas->getSubviews() )
+			sum += view->getWorldPos().x;
+
+		sSink = sSink + sum;
+	} );
+
+	// a frame in which the container moves and every leaf is then queried, with world transforms either computed lazily
+	// per View or all at once by the Graph's flattened TransformHierarchy at the end of the update
+	for( bool flattened : { false, true } ) {
+		graph->setFlattenedTransformsEnabled( flattened );
+		mBench.run( "flat", flattened ? "move_update_toWorld_flattened" : "move_update_toWorld", totalViews, numViews, iterations, [&] {
+			moved = ! moved;
+			canvas->setPos( moved ? vec2( 1 ) : vec2( 0 ) );
+			graph->propagateUpdate();
+
+			float sum = 0;
+			for( const auto &view : canvas->getSubviews() )
+				sum += view->toWorld( vec2( 1 ) ).x;
+
+			sSink = sSink + sum;
+		} );
+	}
+	graph->setFlattenedTransformsEnabled( false );
+
+	const auto hitTestEvents = makeHitTestEvents();
+	mBench.run( "flat", "hitTest", totalViews, hitTestEvents.size(), iterations, [&] {
+		for( const auto &event : hitTestEvents ) {
+			if( graph->hitTest( event ) )
+				sSink = sSink + 1;
+		}
+	} );
+
+	const Gesture gesture;
+	mBench.run( "flat", "touchDispatch", totalViews, 1, iterations, [&] {
+		gesture.dispatch( graph.get() );
+	} );
+
+	mBench.run( "flat", "traverse", totalViews, totalViews, iterations, [&] {
+		sSink = sSink + (float)countViews( graph );
+	} );
+
+	// every leaf's position tweening at once, like an intro sequence: ci::Anims stepped by a Timeline vs. the Graph's Animator.
+	// These run last as the tweens leave the leaves displaced.
+	const double tweenDuration = 1000; // long enough that no tween completes while being timed
+	auto timeline = Timeline::create();
+	for( const auto &view : canvas->getSubviews() )
+		timeline->apply( view->animPos(), view->getPos() + vec2( 10 ), (float)tweenDuration );
+
+	float timelineTime = 0;
+	mBench.run( "flat", "tween_timeline", totalViews, numViews, iterations, [&] {
+		timelineTime += 1.0f / 60.0f;
+		timeline->stepTo( timelineTime );
+		graph->propagateUpdate();
+	} );
+
+	timeline->clear();
+	for( const auto &view : canvas->getSubviews() )
+		view->animatePos( view->getPos() + vec2( 10 ), tweenDuration );
+
+	mBench.run( "flat", "tween_animator", totalViews, numViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	graph->getAnimator().cancelAll();
+}
+
+// A single chain of Views, each nested within the last. Worst case for anything that recurses up or down the hierarchy.
+void CinderViewBenchApp::benchDeepChain( size_t depth )
+{
+	const size_t iterations = getNumIterations( depth );
+	const size_t totalViews = depth + 1; // Graph + chain
+
+	vu::GraphRef graph;
+	vu::ViewRef chain;
+
+	mBench.run( "chain", "addSubview", totalViews, depth, iterations,
+		[&] {
+			chain = makeChain( depth );
+			graph->addSubview( chain );
+		},
+		[&] {
+			graph = makeGraph();
+			chain = nullptr;
+		} );
+
+	graph = makeGraph();
+	chain = makeChain( depth );
+	graph->addSubview( chain );
+	graph->propagateUpdate();
+
+	vector<vu::View *> chainViews;
+	for( vu::View *view = chain.get(); view; view = view->getSubviews().empty() ? nullptr : view->getSubviews().front().get() )
+		chainViews.push_back( view );
+
+	vu::View *leaf = chainViews.back();
+
+	mBench.run( "chain", "layoutIfNeeded", totalViews, depth, iterations, [&] {
+		for( auto view : chainViews )
+			view->setNeedsLayout();
+
+		graph->layoutIfNeeded();
+	} );
+
+	mBench.run( "chain", "update", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	// only the leaf is queried, so this measures how far a root move has to reach to invalidate the leaf's cached world position
+	bool moved = false;
+	mBench.run( "chain", "getWorldPos_after_root_move", totalViews, 1, iterations, [&] {
+		moved = ! moved;
+		chain->setPos( moved ? vec2( 1 ) : vec2( 0 ) );
+		sSink = sSink + leaf->getWorldPos().x;
+	} );
+
+	const auto hitTestEvents = makeHitTestEvents();
+	mBench.run( "chain", "hitTest", totalViews, hitTestEvents.size(), iterations, [&] {
+		for( const auto &event : hitTestEvents ) {
+			if( graph->hitTest( event ) )
+				sSink = sSink + 1;
+		}
+	} );
+
+	const Gesture gesture;
+	mBench.run( "chain", "touchDispatch", totalViews, 1, iterations, [&] {
+		gesture.dispatch( graph.get() );
+	} );
+
+	mBench.run( "chain", "traverse", totalViews, totalViews, iterations, [&] {
+		sSink = sSink + (float)countViews( graph );
+	} );
+}
+
+// A full screen ScrollView holding a long vertical list of rows. Touch dispatch is a drag, which the ScrollView intercepts.
+void CinderViewBenchApp::benchScrollList( size_t numRows )
+{
+	const size_t iterations = getNumIterations( numRows );
+	const size_t totalViews = numRows + 3; // Graph + ScrollView + content view
+	const vec2 rowSize = { GRAPH_SIZE.x, 40 };
+
+	auto makeRows = [numRows, rowSize] {
+		vector<vu::ViewRef> rows;
+		rows.reserve( numRows );
+		for( size_t i = 0; i < numRows; i++ ) {
+			vec2 pos = vec2( 0, rowSize.y * (float)i );
+			rows.push_back( make_shared<TouchTarget>( Rectf( pos, pos + rowSize ) ) );
+		}
+
+		return rows;
+	};
+
+	vu::GraphRef graph;
+	vu::ScrollViewRef scrollView;
+	vector<vu::ViewRef> rows;
+
+	mBench.run( "scroll_list", "addSubview", totalViews, numRows, iterations,
+		[&] {
+			scrollView->addContentViews( rows );
+		},
+		[&] {
+			graph = makeGraph();
+			scrollView = graph->makeSubview<vu::ScrollView>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+			rows = makeRows();
+		} );
+
+	graph = makeGraph();
+	scrollView = graph->makeSubview<vu::ScrollView>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+	scrollView->addContentViews( makeRows() );
+	graph->propagateUpdate();
+
+	mBench.run( "scroll_list", "layoutIfNeeded", totalViews, numRows, iterations, [&] {
+		for( const auto &row : scrollView->getContentView()->getSubviews() )
+			row->setNeedsLayout();
+
+		scrollView->setNeedsLayout();
+		graph->layoutIfNeeded();
+	} );
+
+	mBench.run( "scroll_list", "update", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	// moving the content view is what scrolling does every frame
+	bool moved = false;
+	mBench.run( "scroll_list", "getWorldPos_after_root_move", totalViews, numRows, iterations, [&] {
+		moved = ! moved;
+		scrollView->getContentView()->setPos( moved ? vec2( 0, -1 ) : vec2( 0 ) );
+
+		float sum = 0;
+		for( const auto &row : scrollView->getContentView()->getSubviews() )
+			sum += row->getWorldPos().y;
+
+		sSink = sSink + sum;
+	} );
+
+	const auto hitTestEvents = makeHitTestEvents();
+	mBench.run( "scroll_list", "hitTest", totalViews, hitTestEvents.size(), iterations, [&] {
+		for( const auto &event : hitTestEvents ) {
+			if( graph->hitTest( event ) )
+				sSink = sSink + 1;
+		}
+	} );
+
+	const Gesture gesture;
+	mBench.run( "scroll_list", "touchDispatch", totalViews, 1, iterations, [&] {
+		gesture.dispatch( graph.get() );
+	} );
+
+	mBench.run( "scroll_list", "traverse", totalViews, totalViews, iterations, [&] {
+		sSink = sSink + (float)countViews( graph );
+	} );
+}
+
+// A LabelGrid with numRows rows of text, like the info panels used throughout the test suite.
+void CinderViewBenchApp::benchLabelGrid( size_t numRows )
+{
+	const size_t numCells = numRows * LABEL_GRID_COLUMNS;
+	const size_t iterations = getNumIterations( numCells );
+	const size_t totalViews = numCells + 2; // Graph + LabelGrid
+	const float cellHeight = 20;
+
+	vector<vector<string>> rowText( numRows );
+	for( size_t row = 0; row < numRows; row++ ) {
+		for( size_t col = 0; col < LABEL_GRID_COLUMNS; col++ )
+			rowText[row].push_back( "cell " + to_string( col ) + ", " + to_string( row ) );
+	}
+
+	vu::GraphRef graph;
+	vu::LabelGridRef grid;
+
+	auto makeLabelGrid = [&] {
+		graph = makeGraph();
+		grid = graph->makeSubview<vu::LabelGrid>( Rectf( 0, 0, GRAPH_SIZE.x, cellHeight * numRows ) );
+		grid->setCellHeight( cellHeight );
+	};
+
+	mBench.run( "label_grid", "setRow", totalViews, numCells, iterations,
+		[&] {
+			for( size_t row = 0; row < numRows; row++ )
+				grid->setRow( row, rowText[row] );
+		},
+		makeLabelGrid );
+
+	makeLabelGrid();
+	for( size_t row = 0; row < numRows; row++ )
+		grid->setRow( row, rowText[row] );
+
+	graph->propagateUpdate();
+
+	mBench.run( "label_grid", "layoutIfNeeded", totalViews, numCells, iterations, [&] {
+		grid->setNeedsLayout();
+		for( const auto &label : grid->getSubviews() )
+			label->setNeedsLayout();
+
+		graph->layoutIfNeeded();
+	} );
+
+	mBench.run( "label_grid", "update", totalViews, totalViews, iterations, [&] {
+		graph->propagateUpdate();
+	} );
+
+	bool moved = false;
+	mBench.run( "label_grid", "getWorldPos_after_root_move", totalViews, numCells, iterations, [&] {
+		moved = ! moved;
+		grid->setPos( moved ? vec2( 1 ) : vec2( 0 ) );
+
+		float sum = 0;
+		for( const auto &label : grid->getSubviews() )
+			sum += label->getWorldPos().x;
+
+		sSink = sSink + sum;
+	} );
+
+	mBench.run( "label_grid", "traverse", totalViews, totalViews, iterations, [&] {
+		sSink = sSink + (float)countViews( graph );
+	} );
+}
+
+// A grid of RectViews that keep switching between faded and opaque, staggered so that Layers are created and removed every frame, with every
+// fourth View also blurred. This is the only scenario that draws, as it measures the Renderer's FrameBuffer pool.
+void CinderViewBenchApp::benchFrameBufferPool( size_t numViews )
+{
+	if( ! mBench.isEnabled( "framebuffers", "fade_and_filter" ) )
+		return;
+
+	const size_t iterations = getNumIterations( numViews );
+	const size_t totalViews = numViews + 1; // Graph + views
+
+	auto renderer = make_shared<vu::Renderer>();
+	auto graph = make_shared<vu::Graph>( GRAPH_SIZE, nullptr, renderer );
+
+	const size_t numColumns = (size_t)ceil( sqrt( (double)numViews ) );
+	const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)numColumns;
+
+	vector<vu::RectViewRef> views;
+	for( size_t i = 0; i < numViews; i++ ) {
+		vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+		auto view = graph->makeSubview<vu::RectView>( Rectf( pos, pos + cellSize ) );
+		view->setColor( Color( CM_HSV, (float)i / (float)numViews, 1, 1 ) );
+		if( i % 4 == 0 )
+			view->addFilter( make_shared<vu::FilterBlur>() );
+
+		views.push_back( view );
+	}
+
+	size_t frame = 0;
+	mBench.run( "framebuffers", "fade_and_filter", totalViews, numViews, iterations, [&] {
+		frame++;
+		for( size_t i = 0; i < views.size(); i++ )
+			views[i]->setAlpha( ( i + frame ) % 3 == 0 ? 1.0f : 0.5f );
+
+		graph->propagateUpdate();
+		graph->propagateDraw();
+	} );
+
+	CI_LOG_I( numViews << " views, " << iterations + 1 << " frames: " << renderer->getNumFrameBuffersCached() << " FrameBuffers pooled ("
+		<< renderer->getFrameBufferMemoryUsage() / ( 1024 * 1024 ) << " MB), created: " << renderer->getNumFrameBuffersCreated()
+		<< ", resized: " << renderer->getNumFrameBuffersResized() << ", evicted: " << renderer->getNumFrameBuffersEvicted()
+		<< ", hits: " << renderer->getNumFrameBufferHits() << ", misses: " << renderer->getNumFrameBufferMisses() );
+}
+
+// A grid of faded RectViews, every fourth one blurred, that all move every frame. Only their placement changes, so with Layer caching
+// each frame only composites the FrameBuffers rendered in the first frame.
+void CinderViewBenchApp::benchLayerCache( size_t numViews )
+{
+	const size_t iterations = getNumIterations( numViews );
+	const size_t totalViews = numViews + 1; // Graph + views
+
+	for( bool cachingEnabled : { true, false } ) {
+		const char *operation = cachingEnabled ? "move_cached" : "move_uncached";
+		if( ! mBench.isEnabled( "layers", operation ) )
+			continue;
+
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE );
+		graph->setLayerCachingEnabled( cachingEnabled );
+		graph->setFrameStatsEnabled( true, 1 );
+
+		const size_t numColumns = (size_t)ceil( sqrt( (double)numViews ) );
+		const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)numColumns;
+
+		vector<vu::RectViewRef> views;
+		for( size_t i = 0; i < numViews; i++ ) {
+			vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+			auto view = graph->makeSubview<vu::RectView>( Rectf( pos, pos + cellSize ) );
+			view->setColor( Color( CM_HSV, (float)i / (float)numViews, 1, 1 ) );
+			view->setAlpha( 0.5f );
+			if( i % 4 == 0 )
+				view->addFilter( make_shared<vu::FilterBlur>() );
+
+			views.push_back( view );
+		}
+
+		graph->propagateUpdate();
+		graph->propagateDraw();
+
+		bool moved = false;
+		mBench.run( "layers", operation, totalViews, numViews, iterations, [&] {
+			moved = ! moved;
+			const vec2 offset = moved ? vec2( 1 ) : vec2( -1 );
+			for( const auto &view : views )
+				view->setPos( view->getPos() + offset );
+
+			graph->propagateUpdate();
+			graph->propagateDraw();
+		} );
+
+		CI_LOG_I( numViews << " views, " << operation << ": " << graph->getFrameStats() );
+	}
+}
+
+// A panel of cells that each have a background, a border and a value bar, like a screen of controls without text. Every frame the bars change and
+// the whole panel is drawn, once with the Renderer batching quads and once drawing each on its own.
+void CinderViewBenchApp::benchBatching( size_t numCells )
+{
+	const size_t iterations = getNumIterations( numCells );
+	const size_t totalViews = numCells * 3 + 1; // Graph + cells, borders and bars
+
+	// draw_recorded batches the quads of the recorded RenderCommandList when it is submitted
+	for( const string operation : { "draw_batched", "draw_unbatched", "draw_recorded" } ) {
+		if( ! mBench.isEnabled( "panel", operation ) )
+			continue;
+
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE );
+		graph->getRenderer()->setBatchingEnabled( operation != "draw_unbatched" );
+		graph->setDrawRecordingEnabled( operation == "draw_recorded" );
+		graph->setFrameStatsEnabled( true, 1 );
+
+		auto bars = makePanel( graph, numCells );
+
+		size_t frame = 0;
+		mBench.run( "panel", operation, totalViews, totalViews, iterations, [&] {
+			frame++;
+			for( size_t i = 0; i < bars.size(); i++ )
+				bars[i]->setSize( vec2( 2 + (float)( ( i + frame ) % 10 ), 4 ) );
+
+			graph->propagateUpdate();
+			graph->propagateDraw();
+		} );
+
+		CI_LOG_I( numCells << " cells, " << operation << ": " << graph->getFrameStats() );
+	}
+}
+
+// The batching panel drawn by the CPU rasterizer instead of gl, every frame redrawing the whole Graph into a Surface
+void CinderViewBenchApp::benchSoftwareRasterizer( size_t numCells )
+{
+	if( ! mBench.isEnabled( "software", "draw" ) )
+		return;
+
+	const size_t iterations = getNumIterations( numCells );
+	const size_t totalViews = numCells * 3 + 1;
+
+	auto rasterizer = make_shared<vu::SoftwareRasterizer>( GRAPH_SIZE );
+	auto renderer = make_shared<vu::Renderer>();
+	renderer->setBackend( rasterizer );
+	auto graph = make_shared<vu::Graph>( GRAPH_SIZE, nullptr, renderer );
+	auto bars = makePanel( graph, numCells );
+
+	size_t frame = 0;
+	mBench.run( "software", "draw", totalViews, totalViews, iterations,
+		[&] {
+			frame++;
+			for( size_t i = 0; i < bars.size(); i++ )
+				bars[i]->setSize( vec2( 2 + (float)( ( i + frame ) % 10 ), 4 ) );
+
+			graph->propagateUpdate();
+			graph->propagateDraw();
+		},
+		[&] {
+			// so the counters hold a single frame when the run is done
+			rasterizer->resetCounters();
+		} );
+
+	const auto &result = mBench.getResults().back();
+	const double pixelsPerSecond = (double)rasterizer->getNumPixelsFilled() / ( result.mMeanMs / 1000.0 );
+	CI_LOG_I( numCells << " cells, software draw: " << pixelsPerSecond / 1e6 << " Mpixels/s, skipped commands: " << rasterizer->getNumCommandsSkipped() );
+}
+
+// Reference scenes drawn by the Renderer through a NullGlDevice, checking the gl state changes that drawing them with gl would issue and elide. These are checks rather
+// than timings, so that a change which breaks batching or redundant state elision shows up in the results even though the bench runs without drawing with gl.
+void CinderViewBenchApp::benchGlState()
+{
+	const auto checkCount = [this]( const string &name, size_t actual, size_t expected, bool atLeast ) {
+		const bool passed = atLeast ? actual >= expected : actual == expected;
+		mBench.check( "glstate", name, passed, string( "expected " ) + ( atLeast ? "at least " : "" ) + to_string( expected ) + ", got " + to_string( actual ) );
+	};
+
+	typedef vu::GlStateCache::State State;
+
+	// the device should only see the changes that the Renderer's GlStateCache let through
+	const auto checkDevice = [&checkCount]( const string &prefix, const vu::NullGlDeviceRef &device, const vu::RendererRef &renderer ) {
+		const auto &cache = renderer->getStateCache();
+		checkCount( prefix + "_device_program_binds", device->getNumProgramBinds(), cache.getNumIssued( State::PROGRAM ), false );
+		checkCount( prefix + "_device_texture_binds", device->getNumTextureBinds(), cache.getNumIssued( State::TEXTURE ), false );
+	};
+
+	// the batching panel: every quad is solid, so the whole panel is a single batch that binds the GlslProg and texture once
+	if( mBench.isEnabled( "glstate", "panel" ) ) {
+		auto device = make_shared<vu::NullGlDevice>();
+		auto renderer = make_shared<vu::Renderer>();
+		renderer->setGlDevice( device );
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE, nullptr, renderer );
+		makePanel( graph, GL_STATE_PANEL_CELLS );
+
+		graph->propagateUpdate();
+		graph->propagateDraw();
+
+		const auto &cache = renderer->getStateCache();
+		checkCount( "panel_batches", renderer->getNumBatches(), 1, false );
+		checkCount( "panel_device_quad_draws", device->getNumQuadDraws(), 1, false );
+		checkCount( "panel_program_issued", cache.getNumIssued( State::PROGRAM ), 1, false );
+		checkCount( "panel_texture_issued", cache.getNumIssued( State::TEXTURE ), 1, false );
+		checkCount( "panel_framebuffer_issued", cache.getNumIssued( State::FRAMEBUFFER ), 0, false );
+		checkCount( "panel_scissor_issued", cache.getNumIssued( State::SCISSOR ), 0, false );
+		checkDevice( "panel", device, renderer );
+	}
+
+	// translucent views that each render to a FrameBuffer, which is bound and unbound once per Layer. The GlslProg and white texture stay bound throughout.
+	if( mBench.isEnabled( "glstate", "layers" ) ) {
+		auto device = make_shared<vu::NullGlDevice>();
+		auto renderer = make_shared<vu::Renderer>();
+		renderer->setGlDevice( device );
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE, nullptr, renderer );
+		// so that every frame renders the Layers, rather than compositing their last render
+		graph->setLayerCachingEnabled( false );
+
+		const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)GL_STATE_NUM_LAYERS;
+		for( size_t i = 0; i < GL_STATE_NUM_LAYERS; i++ ) {
+			vec2 pos = vec2( (float)i * cellSize.x, 0 );
+			auto view = graph->makeSubview<vu::RectView>( Rectf( pos, pos + cellSize ) );
+			view->setColor( Color( 0, 0.6f, 1 ) );
+			view->setAlpha( 0.5f );
+
+			auto inner = view->makeSubview<vu::RectView>( Rectf( vec2( 2 ), cellSize - vec2( 2 ) ) );
+			inner->setColor( Color::gray( 0.8f ) );
+		}
+
+		// the first frame creates the Layers, the second is the one checked. The Renderer's counts accumulate, so the second frame's are the difference.
+		graph->propagateUpdate();
+		graph->propagateDraw();
+
+		const auto &cache = renderer->getStateCache();
+		const size_t frameBufferIssued = cache.getNumIssued( State::FRAMEBUFFER );
+		const size_t programIssued = cache.getNumIssued( State::PROGRAM );
+		const size_t programElided = cache.getNumElided( State::PROGRAM );
+		const size_t textureIssued = cache.getNumIssued( State::TEXTURE );
+		device->resetCounters();
+
+		graph->propagateUpdate();
+		graph->propagateDraw();
+
+		checkCount( "layers_framebuffer_issued", cache.getNumIssued( State::FRAMEBUFFER ) - frameBufferIssued, GL_STATE_NUM_LAYERS * 2, false );
+		checkCount( "layers_program_issued", cache.getNumIssued( State::PROGRAM ) - programIssued, 1, false );
+		checkCount( "layers_program_elided", cache.getNumElided( State::PROGRAM ) - programElided, GL_STATE_NUM_LAYERS - 1, true );
+		checkCount( "layers_texture_issued", cache.getNumIssued( State::TEXTURE ) - textureIssued, 1, false );
+		checkCount( "layers_device_framebuffer_binds", device->getNumFrameBufferBinds(), GL_STATE_NUM_LAYERS * 2, false );
+		checkCount( "layers_device_framebuffer_draws", device->getNumFrameBufferDraws(), GL_STATE_NUM_LAYERS, false );
+		checkCount( "layers_device_program_binds", device->getNumProgramBinds(), cache.getNumIssued( State::PROGRAM ) - programIssued, false );
+		checkCount( "layers_device_texture_binds", device->getNumTextureBinds(), cache.getNumIssued( State::TEXTURE ) - textureIssued, false );
+	}
+}
+
+// A scene recorded straight through the Renderer and rasterized on the CPU twice, once as recorded and once after RenderCommandList::optimize(), which must not change a pixel.
+// Optimizing moves quads in front of others they don't overlap and drops state changes that nothing is drawn with, so the scene has overlapping translucent quads
+// with several textures, nested clips, clips and blend modes that nothing is drawn with, and a FrameBuffer drawn premultiplied like a Layer.
+void CinderViewBenchApp::benchOptimize()
+{
+	if( ! mBench.isEnabled( "optimize", "pixels" ) )
+		return;
+
+	const ivec2 size = OPTIMIZE_SCENE_SIZE;
+	auto renderer = make_shared<vu::Renderer>();
+	renderer->setBackend( make_shared<vu::SoftwareRasterizer>( size ) );
+
+	vector<vu::ImageRef> images;
+	for( size_t i = 0; i < OPTIMIZE_NUM_IMAGES; i++ )
+		images.push_back( make_shared<vu::Image>( make_shared<Surface8u>( makeIcon( i * NUM_UNIQUE_ICONS / OPTIMIZE_NUM_IMAGES ) ) ) );
+
+	// cells overlap their neighbors, and cycle through the images and solid quads so that there is something to reorder
+	const auto drawGrid = [&]( const vec2 &offset, float alpha ) {
+		for( size_t i = 0; i < OPTIMIZE_GRID_CELLS; i++ ) {
+			const vec2 pos = offset + vec2( float( i % 8 ) * 28, float( i / 8 ) * 20 );
+			const Rectf rect( pos, pos + vec2( 34, 24 ) );
+			const size_t image = ( i * 5 ) % ( OPTIMIZE_NUM_IMAGES + 1 );
+			renderer->setColor( ColorA( Color( CM_HSV, (float)i / (float)OPTIMIZE_GRID_CELLS, 0.8f, 1 ), alpha ) );
+			if( image == OPTIMIZE_NUM_IMAGES )
+				renderer->drawSolidRect( rect );
+			else
+				renderer->draw( images[image], rect );
+		}
+	};
+
+	vu::RenderCommandList recorded;
+	renderer->beginRecording( &recorded, mat4(), glm::ortho( 0.0f, (float)size.x, (float)size.y, 0.0f, -1.0f, 1.0f ) );
+	drawGrid( vec2( 0 ), 0.6f );
+
+	// clips are in gl coordinates, with the origin in the lower left
+	renderer->pushClip( ivec2( 16, 16 ), ivec2( 200, 120 ) );
+	renderer->pushClip( ivec2( 40, 40 ), ivec2( 120, 60 ) );
+	renderer->pushBlendMode( vu::BlendMode::PREMULT_ALPHA );
+	drawGrid( vec2( 8, 120 ), 0.5f );
+	renderer->popBlendMode();
+	renderer->popClip();
+	renderer->pushClip( ivec2( 0 ), ivec2( 10 ) );
+	renderer->popClip();
+	renderer->pushBlendMode( vu::BlendMode::PREMULT_ALPHA );
+	renderer->popBlendMode();
+	drawGrid( vec2( 20, 130 ), 0.8f );
+	renderer->popClip();
+
+	auto frameBuffer = renderer->getFrameBuffer( ivec2( 128 ) );
+	const ivec2 frameBufferSize = frameBuffer->getSize();
+	renderer->pushFrameBuffer( frameBuffer );
+	renderer->pushViewport( ivec2( 0 ), frameBufferSize );
+	renderer->pushMatrices();
+	renderer->setMatricesWindow( frameBufferSize );
+	renderer->clear( ColorA::zero() );
+	drawGrid( vec2( -10 ), 0.7f );
+	renderer->popMatrices();
+	renderer->popViewport();
+	renderer->popFrameBuffer( frameBuffer );
+	renderer->pushBlendMode( vu::BlendMode::PREMULT_ALPHA );
+	renderer->setColor( ColorA::gray( 1, 0.75f ) );
+	renderer->draw( frameBuffer, Rectf( vec2( 100, 60 ), vec2( 100, 60 ) + vec2( frameBufferSize ) ) );
+	renderer->popBlendMode();
+	renderer->endRecording();
+	renderer->releaseFrameBuffer( frameBuffer );
+
+	vu::RenderCommandList optimized = recorded;
+	optimized.optimize();
+
+	vu::SoftwareRasterizer recordedRasterizer( size ), optimizedRasterizer( size );
+	recordedRasterizer.submit( recorded );
+	optimizedRasterizer.submit( optimized );
+
+	const Surface8u &expected = recordedRasterizer.getSurface();
+	const Surface8u &actual = optimizedRasterizer.getSurface();
+	size_t numDiffering = 0;
+	for( int y = 0; y < size.y; y++ ) {
+		for( int x = 0; x < size.x; x++ ) {
+			if( memcmp( expected.getData( ivec2( x, y ) ), actual.getData( ivec2( x, y ) ), 4 ) != 0 )
+				numDiffering++;
+		}
+	}
+
+	mBench.check( "optimize", "pixels", numDiffering == 0, to_string( numDiffering ) + " of " + to_string( size.x * size.y ) + " pixels differ" );
+
+	// make sure the scene gives optimize() something to do, otherwise the comparison above proves nothing
+	const auto getQuadOrder = []( const vu::RenderCommandList &list ) {
+		vector<uint32_t> result;
+		for( const auto &command : list.getCommands() ) {
+			if( command.mType == vu::RenderCommand::Type::QUADS )
+				result.push_back( command.mFirst );
+		}
+		return result;
+	};
+
+	const size_t numDropped = recorded.getCommands().size() - optimized.getCommands().size();
+	const bool reordered = getQuadOrder( recorded ) != getQuadOrder( optimized );
+	mBench.check( "optimize", "changed", numDropped > 0 && reordered, to_string( numDropped ) + " commands dropped, quads " + ( reordered ? "reordered" : "not reordered" ) );
+}
+
+// The same multi-touch events dispatched with batched hit testing and one touch at a time, which must reach the same Views with the same touches. The scene has
+// overlapping siblings that pass touches on to the ones below them, a nested child, a rotated and a non-interactive View, and Views added during touchesBegan().
+void CinderViewBenchApp::benchTouchDispatch()
+{
+	if( ! mBench.isEnabled( "touches", "batched_dispatch" ) )
+		return;
+
+	const auto dispatch = []( bool batched, size_t *numViews ) {
+		vector<string> log;
+		auto graph = makeGraph();
+		graph->setBatchedHitTestingEnabled( batched );
+
+		const auto addLogger = [&log]( vu::View *parent, const string &name, const Rectf &bounds, bool handlesAll, bool spawns ) {
+			auto view = make_shared<TouchLogger>( bounds, &log, handlesAll, spawns );
+			view->setHooks( vu::View::detectHooks<TouchLogger>() );
+			view->setLabel( name );
+			parent->addSubview( view );
+			return view;
+		};
+
+		auto root = graph->makeSubview<vu::View>( Rectf( vec2( 0 ), vec2( GRAPH_SIZE ) ) );
+		addLogger( root.get(), "a", Rectf( 0, 0, 1200, 800 ), true, false );
+		auto b = addLogger( root.get(), "b", Rectf( 400, 200, 1600, 1000 ), false, false );
+		addLogger( b.get(), "b_child", Rectf( 100, 100, 600, 500 ), true, false );
+		auto rotated = addLogger( root.get(), "rotated", Rectf( 900, 300, 1500, 700 ), false, false );
+		rotated->setRotation( 0.5f );
+		addLogger( root.get(), "spawner", Rectf( 800, 0, 1920, 600 ), false, true );
+		auto blocked = addLogger( root.get(), "blocked", Rectf( 0, 0, 1920, 1080 ), true, false );
+		blocked->setInteractive( false );
+
+		Rand rand( 3 );
+		for( size_t i = 0; i < TOUCH_DISPATCH_EVENTS; i++ ) {
+			graph->propagateUpdate();
+			log.push_back( "event " + to_string( i ) );
+
+			const auto touches = makeTouches( rand, TOUCH_DISPATCH_TOUCHES );
+			app::TouchEvent beganEvent( nullptr, touches );
+			graph->propagateTouchesBegan( beganEvent );
+			app::TouchEvent endedEvent( nullptr, touches );
+			graph->propagateTouchesEnded( endedEvent );
+		}
+
+		*numViews = countViews( root );
+		return log;
+	};
+
+	size_t numViewsBatched = 0, numViewsUnbatched = 0;
+	const auto batched = dispatch( true, &numViewsBatched );
+	const auto unbatched = dispatch( false, &numViewsUnbatched );
+
+	string detail = to_string( batched.size() ) + " log entries, " + to_string( numViewsBatched ) + " views";
+	size_t i = 0;
+	while( i < batched.size() && i < unbatched.size() && batched[i] == unbatched[i] )
+		i++;
+	if( i < batched.size() || i < unbatched.size() ) {
+		detail = "first difference at entry " + to_string( i ) + ", batched: '" + ( i < batched.size() ? batched[i] : "" )
+			+ "', unbatched: '" + ( i < unbatched.size() ? unbatched[i] : "" ) + "'";
+	}
+
+	mBench.check( "touches", "batched_dispatch", batched == unbatched && numViewsBatched == numViewsUnbatched, detail );
+}
+
+// A deep chain of scaled and rotated Views, whose world transforms, toWorld(), toLocal(), getBoundsInParent() and getWorldBounds() must match the transforms
+// multiplied out from the root. Checked with and without the Graph's TransformHierarchy, before and after Views in the middle of the chain change.
+void CinderViewBenchApp::benchTransforms()
+{
+	if( ! mBench.isEnabled( "transforms", "chain" ) )
+		return;
+
+	// errors are relative, as the chain's scale and translation compound with depth
+	const auto relativeError = []( float actual, float expected ) {
+		return abs( actual - expected ) / std::max( 1.0f, abs( expected ) );
+	};
+
+	const auto checkChain = [&]( const vector<vu::ViewRef> &views, const string &name ) {
+		float worldError = 0, toWorldError = 0, toLocalError = 0, boundsInParentError = 0, worldBoundsError = 0;
+		const auto includeRect = [&relativeError]( float *error, const Rectf &actual, const Rectf &expected ) {
+			*error = std::max( { *error, relativeError( actual.x1, expected.x1 ), relativeError( actual.y1, expected.y1 ), relativeError( actual.x2, expected.x2 ), relativeError( actual.y2, expected.y2 ) } );
+		};
+
+		for( const auto &view : views ) {
+			const mat3 expected = calcWorldTransform( view.get() );
+			const mat3 &actual = view->getWorldTransform();
+			for( int col = 0; col < 3; col++ ) {
+				for( int row = 0; row < 3; row++ )
+					worldError = std::max( worldError, relativeError( actual[col][row], expected[col][row] ) );
+			}
+
+			for( const vec2 &localPos : { vec2( 0 ), view->getSize(), vec2( 13, 57 ) } ) {
+				const vec2 worldPos = vec2( expected * vec3( localPos, 1 ) );
+				const vec2 toWorld = view->toWorld( localPos );
+				const vec2 toLocal = view->toLocal( worldPos );
+				toWorldError = std::max( { toWorldError, relativeError( toWorld.x, worldPos.x ), relativeError( toWorld.y, worldPos.y ) } );
+				toLocalError = std::max( { toLocalError, relativeError( toLocal.x, localPos.x ), relativeError( toLocal.y, localPos.y ) } );
+			}
+
+			includeRect( &boundsInParentError, view->getBoundsInParent(), transformCorners( view->getBoundsLocal(), calcLocalTransform( view.get() ) ) );
+			includeRect( &worldBoundsError, view->getWorldBounds(), transformCorners( view->getBoundsLocal(), expected ) );
+		}
+
+		const float maxError = std::max( { worldError, toWorldError, toLocalError, boundsInParentError, worldBoundsError } );
+		mBench.check( "transforms", name, maxError <= TRANSFORM_TOLERANCE, "max relative error: world transform " + to_string( worldError ) + ", toWorld " + to_string( toWorldError )
+			+ ", toLocal " + to_string( toLocalError ) + ", bounds in parent " + to_string( boundsInParentError ) + ", world bounds " + to_string( worldBoundsError ) );
+	};
+
+	for( bool flattened : { false, true } ) {
+		const string prefix = flattened ? "flattened_" : "recursive_";
+		auto graph = makeGraph();
+		graph->setFlattenedTransformsEnabled( flattened );
+
+		// every fourth View only translates, so that the chain mixes Views with and without a local transform
+		vector<vu::ViewRef> views;
+		vu::View *parent = graph.get();
+		for( size_t i = 0; i < TRANSFORM_CHAIN_DEPTH; i++ ) {
+			auto view = make_shared<vu::View>( Rectf( 0, 0, 200, 100 ) );
+			view->setPos( vec2( 30 + float( i % 5 ), 10 - float( i % 3 ) ) );
+			if( i % 4 != 3 ) {
+				view->setScale( vec2( i % 2 ? 1.1f : 0.92f, i % 3 ? 0.95f : 1.08f ) );
+				view->setRotation( 0.1f + 0.05f * float( i % 7 ) );
+			}
+			parent->addSubview( view );
+			views.push_back( view );
+			parent = view.get();
+		}
+
+		graph->propagateUpdate();
+		checkChain( views, prefix + "initial" );
+
+		// changes in the middle of the chain must reach every View below them, before the next update and after it
+		views[TRANSFORM_CHAIN_DEPTH / 3]->setRotation( -0.4f );
+		views[TRANSFORM_CHAIN_DEPTH / 2]->setPos( vec2( -25, 40 ) );
+		views[TRANSFORM_CHAIN_DEPTH / 2 + 1]->setScale( vec2( 1.3f, 0.7f ) );
+		checkChain( views, prefix + "changed" );
+
+		graph->propagateUpdate();
+		checkChain( views, prefix + "updated" );
+	}
+}
+
+// A chain of Views whose ancestors are moved with setPos() and animated with the Graph's Animator, which writes to their positions directly. The lazily
+// calculated View::getWorldPos() must match the position multiplied out from the root whenever it is read: between frames, right after a setPos() and
+// from the update() of a View that the Graph updates before the chain, which runs after the Animator but before the moved Views have been updated.
+void CinderViewBenchApp::benchWorldPos()
+{
+	if( ! mBench.isEnabled( "world_pos", "animated" ) )
+		return;
+
+	for( bool flattened : { false, true } ) {
+		double time = 0;
+		auto graph = makeGraph();
+		graph->setFlattenedTransformsEnabled( flattened );
+		graph->setTimeSource( [&time] { return time; } );
+
+		vector<vu::ViewRef> views;
+		size_t numReads = 0;
+		float maxError = 0;
+		const auto checkViews = [&views, &numReads, &maxError] {
+			for( const auto &view : views ) {
+				const vec2 expected = vec2( calcWorldTransform( view.get() )[2] );
+				const float scale = std::max( 1.0f, glm::length( expected ) );
+				maxError = std::max( { maxError, glm::distance( view->getWorldPos(), expected ) / scale, glm::distance( view->toWorld( vec2( 0 ) ), expected ) / scale } );
+				numReads++;
+			}
+		};
+
+		graph->makeSubview<UpdateProbe>( checkViews );
+
+		vu::View *parent = graph.get();
+		for( size_t i = 0; i < WORLD_POS_CHAIN_DEPTH; i++ ) {
+			auto view = make_shared<vu::View>( Rectf( 0, 0, 100, 100 ) );
+			view->setPos( vec2( 10 + float( i % 3 ), 5 ) );
+			if( i % 5 == 2 )
+				view->setScale( vec2( 0.95f ) );
+			parent->addSubview( view );
+			views.push_back( view );
+			parent = view.get();
+		}
+
+		const vec2 animatedPos = vec2( 300, 200 );
+		for( size_t frame = 0; frame < WORLD_POS_FRAMES; frame++ ) {
+			if( frame == 1 ) {
+				views[2]->animatePos( animatedPos, 0.5 );
+				views[WORLD_POS_CHAIN_DEPTH / 2]->animatePos( vec2( -50, 80 ), 0.5, 0.25, vu::Ease::IN_OUT_QUAD );
+			}
+			else if( frame == 10 || frame == 30 ) {
+				views[5]->setPos( views[5]->getPos() + vec2( 7, -3 ) );
+				checkViews();
+			}
+
+			time += 1.0 / 30.0;
+			graph->propagateUpdate();
+			checkViews();
+		}
+
+		const bool animated = glm::distance( views[2]->getPos(), animatedPos ) < TRANSFORM_TOLERANCE;
+		mBench.check( "world_pos", flattened ? "flattened" : "recursive", maxError <= TRANSFORM_TOLERANCE && animated,
+			to_string( numReads ) + " reads, max relative error " + to_string( maxError ) + ( animated ? "" : ", animation didn't finish" ) );
+	}
+}
+
+// Views on and off screen, drawn through a NullGlDevice with draw culling enabled. Every View whose subtree reaches the screen must be drawn, including a rotated
+// View that only pokes in at a corner and an off-screen parent of an on-screen subview, while the ones entirely off screen or outside of a clipping parent are skipped.
+// Views then move across the edge of the screen, which must change which of them are drawn on the next frame.
+void CinderViewBenchApp::benchCulling()
+{
+	if( ! mBench.isEnabled( "culling", "draw" ) )
+		return;
+
+	auto device = make_shared<vu::NullGlDevice>();
+	auto renderer = make_shared<vu::Renderer>();
+	renderer->setGlDevice( device );
+	auto graph = make_shared<vu::Graph>( GRAPH_SIZE, nullptr, renderer );
+
+	vector<pair<shared_ptr<CountingView>, string>> views;
+	const auto addView = [&views]( vu::View *parent, const string &name, const Rectf &bounds ) {
+		auto view = make_shared<CountingView>( bounds );
+		view->setHooks( vu::View::detectHooks<CountingView>() );
+		view->setLabel( name );
+		parent->addSubview( view );
+		views.emplace_back( view, name );
+		return view;
+	};
+
+	const vec2 screen = vec2( GRAPH_SIZE );
+	addView( graph.get(), "onscreen", Rectf( 100, 100, 300, 200 ) );
+	addView( graph.get(), "offscreen_right", Rectf( screen.x + 10, 100, screen.x + 200, 200 ) );
+	addView( graph.get(), "offscreen_above", Rectf( 100, -300, 300, -10 ) );
+	auto rotated = addView( graph.get(), "rotated_corner", Rectf( -100, -100, 50, 50 ) );
+	rotated->setRotation( 0.7f );
+	auto offscreenParent = addView( graph.get(), "offscreen_parent", Rectf( -500, 400, -400, 500 ) );
+	addView( offscreenParent.get(), "onscreen_child", Rectf( 600, 0, 700, 100 ) );
+	auto onscreenParent = addView( graph.get(), "onscreen_parent", Rectf( 500, 500, 700, 700 ) );
+	addView( onscreenParent.get(), "offscreen_child", Rectf( screen.x, 0, screen.x + 100, 100 ) );
+	auto clipping = addView( graph.get(), "clipping", Rectf( 800, 100, 1000, 300 ) );
+	clipping->setClipEnabled();
+	addView( clipping.get(), "clipped_inside", Rectf( 20, 20, 120, 120 ) );
+	addView( clipping.get(), "clipped_outside", Rectf( 300, 20, 400, 120 ) );
+	auto moving = addView( graph.get(), "moving", Rectf( screen.x + 50, 800, screen.x + 150, 900 ) );
+
+	const auto drawFrame = [&]( const set<string> &expectedDrawn, const string &name ) {
+		vector<size_t> drawsBefore;
+		for( const auto &view : views )
+			drawsBefore.push_back( view.first->getNumDraws() );
+
+		graph->propagateUpdate();
+		graph->propagateDraw();
+
+		string wrong;
+		for( size_t i = 0; i < views.size(); i++ ) {
+			const bool drawn = views[i].first->getNumDraws() != drawsBefore[i];
+			if( drawn != ( expectedDrawn.count( views[i].second ) != 0 ) )
+				wrong += ( wrong.empty() ? "" : ", " ) + views[i].second + ( drawn ? " drawn" : " culled" );
+		}
+
+		mBench.check( "culling", name, wrong.empty(), wrong.empty() ? to_string( expectedDrawn.size() ) + " of " + to_string( views.size() ) + " views drawn" : wrong );
+	};
+
+	set<string> drawn = { "onscreen", "rotated_corner", "offscreen_parent", "onscreen_child", "onscreen_parent", "clipping", "clipped_inside" };
+	drawFrame( drawn, "initial" );
+
+	// moving onto the screen and off of it, and a parent moving its subview out of the clip
+	moving->setPos( vec2( screen.x - 150, 800 ) );
+	offscreenParent->setPos( vec2( -800, 400 ) );
+	drawn.insert( "moving" );
+	drawn.erase( "offscreen_parent" );
+	drawn.erase( "onscreen_child" );
+	drawFrame( drawn, "moved" );
+}
+
+// A subtree with UpdatePolicy::WHEN_DIRTY must stop being updated once nothing changes, and wake up for the next frame when one of its Views is touched, resized
+// or animated, or has a subview removed. An animation keeps it awake until the animation has finished. A subtree with UpdatePolicy::WHEN_VISIBLE must only be
+// updated while it is on screen.
+void CinderViewBenchApp::benchSleep()
+{
+	if( ! mBench.isEnabled( "sleep", "wake" ) )
+		return;
+
+	double time = 0;
+	auto graph = makeGraph();
+	graph->setTimeSource( [&time] { return time; } );
+
+	const auto makeCountingView = []( vu::View *parent, const Rectf &bounds ) {
+		auto view = make_shared<CountingView>( bounds );
+		view->setHooks( vu::View::detectHooks<CountingView>() );
+		parent->addSubview( view );
+		return view;
+	};
+
+	auto sleeper = makeCountingView( graph.get(), Rectf( 100, 100, 500, 500 ) );
+	sleeper->setUpdatePolicy( vu::UpdatePolicy::WHEN_DIRTY );
+	auto child = makeCountingView( sleeper.get(), Rectf( 50, 50, 250, 250 ) );
+	auto leaf = makeCountingView( child.get(), Rectf( 20, 20, 120, 120 ) );
+
+	auto visible = makeCountingView( graph.get(), Rectf( vec2( GRAPH_SIZE ) + vec2( 10 ), vec2( GRAPH_SIZE ) + vec2( 110 ) ) );
+	visible->setUpdatePolicy( vu::UpdatePolicy::WHEN_VISIBLE );
+
+	// returns how many times the leaf was updated over numFrames frames
+	const auto runFrames = [&]( size_t numFrames ) {
+		const size_t updatesBefore = leaf->getNumUpdates();
+		for( size_t i = 0; i < numFrames; i++ ) {
+			time += 1.0 / 30.0;
+			graph->propagateUpdate();
+		}
+		return leaf->getNumUpdates() - updatesBefore;
+	};
+
+	// wakes the subtree with \a wake, which must update it on the next frame. After it settles, it must go back to sleep.
+	const auto checkWake = [&]( const string &name, const function<void ()> &wake ) {
+		wake();
+		const size_t updatesWoken = runFrames( 1 );
+		runFrames( SLEEP_SETTLE_FRAMES );
+		const size_t updatesIdle = runFrames( SLEEP_IDLE_FRAMES );
+		mBench.check( "sleep", "wake_on_" + name, updatesWoken == 1 && updatesIdle == 0,
+			to_string( updatesWoken ) + " updates on the next frame, " + to_string( updatesIdle ) + " over " + to_string( SLEEP_IDLE_FRAMES ) + " idle frames" );
+	};
+
+	runFrames( SLEEP_SETTLE_FRAMES );
+	const size_t updatesIdle = runFrames( SLEEP_IDLE_FRAMES );
+	mBench.check( "sleep", "asleep", updatesIdle == 0, to_string( updatesIdle ) + " updates over " + to_string( SLEEP_IDLE_FRAMES ) + " idle frames" );
+
+	checkWake( "touch", [&] {
+		const vector<app::TouchEvent::Touch> touches = { app::TouchEvent::Touch( leaf->toWorld( leaf->getCenterLocal() ), vec2( 0 ), 0, 0.0, nullptr ) };
+		app::TouchEvent beganEvent( nullptr, touches );
+		graph->propagateTouchesBegan( beganEvent );
+		app::TouchEvent endedEvent( nullptr, touches );
+		graph->propagateTouchesEnded( endedEvent );
+	} );
+	checkWake( "resize", [&] { leaf->setSize( leaf->getSize() + vec2( 10 ) ); } );
+	checkWake( "remove_subview", [&] {
+		auto removed = makeCountingView( child.get(), Rectf( 0, 0, 10, 10 ) );
+		runFrames( SLEEP_SETTLE_FRAMES );
+		child->removeSubview( removed );
+	} );
+
+	// the animation must be evaluated and reach the leaf on every frame it runs for, then the subtree sleeps again
+	const size_t animationFrames = 6;
+	const vec2 animatedPos = leaf->getPos() + vec2( 60, 30 );
+	leaf->animatePos( animatedPos, animationFrames / 30.0 );
+	const size_t updatesAnimating = runFrames( animationFrames );
+	runFrames( SLEEP_SETTLE_FRAMES );
+	const bool finished = glm::distance( leaf->getPos(), animatedPos ) < 0.001f;
+	const size_t updatesAfterAnimation = runFrames( SLEEP_IDLE_FRAMES );
+	mBench.check( "sleep", "wake_on_animation", updatesAnimating == animationFrames && finished && updatesAfterAnimation == 0,
+		to_string( updatesAnimating ) + " updates over " + to_string( animationFrames ) + " animated frames, " + ( finished ? "finished" : "didn't finish" )
+		+ ", " + to_string( updatesAfterAnimation ) + " updates after" );
+
+	// skipped while off screen, updated every frame once moved on
+	const size_t visibleUpdatesOffscreen = visible->getNumUpdates();
+	visible->setPos( vec2( 10 ) );
+	runFrames( SLEEP_IDLE_FRAMES );
+	const size_t visibleUpdatesOnscreen = visible->getNumUpdates() - visibleUpdatesOffscreen;
+	mBench.check( "sleep", "when_visible", visibleUpdatesOffscreen == 0 && visibleUpdatesOnscreen == SLEEP_IDLE_FRAMES,
+		to_string( visibleUpdatesOffscreen ) + " updates off screen, " + to_string( visibleUpdatesOnscreen ) + " over " + to_string( SLEEP_IDLE_FRAMES ) + " frames on screen" );
+}
+
+// A grid of icons, like a toolbar or file browser, drawn once with every Image owning its texture and once with all of them packed into an ImageAtlas.
+// With the atlas the icons share a texture and batch together, which shows up as fewer texture binds per frame.
+void CinderViewBenchApp::benchImageAtlas( size_t numIcons )
+{
+	const size_t iterations = getNumIterations( numIcons );
+	const size_t totalViews = numIcons + 1;
+
+	vector<Surface8u> icons;
+	for( size_t i = 0; i < NUM_UNIQUE_ICONS; i++ )
+		icons.push_back( makeIcon( i ) );
+
+	for( const string operation : { "draw_separate", "draw_atlased" } ) {
+		if( ! mBench.isEnabled( "icons", operation ) )
+			continue;
+
+		vu::ImageAtlas atlas;
+		vector<vu::ImageRef> images;
+		for( const auto &icon : icons ) {
+			if( operation == "draw_atlased" )
+				images.push_back( atlas.insert( icon ) );
+			else
+				images.push_back( make_shared<vu::Image>( gl::Texture::create( icon ) ) );
+		}
+
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE );
+		graph->setFrameStatsEnabled( true, 1 );
+
+		const size_t numColumns = (size_t)ceil( sqrt( (double)numIcons ) );
+		const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)numColumns;
+		vector<vu::ImageViewRef> imageViews;
+		for( size_t i = 0; i < numIcons; i++ ) {
+			vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+			auto imageView = graph->makeSubview<vu::ImageView>( Rectf( pos, pos + cellSize ) );
+			imageView->setScaleMode( vu::ImageScaleMode::CENTER );
+			imageView->setImage( images[i % images.size()] );
+			imageViews.push_back( imageView );
+		}
+
+		size_t frame = 0;
+		mBench.run( "icons", operation, totalViews, totalViews, iterations, [&] {
+			// swapping the icons keeps every frame redrawn
+			frame++;
+			for( size_t i = 0; i < imageViews.size(); i++ )
+				imageViews[i]->setImage( images[( i + frame ) % images.size()] );
+
+			graph->propagateUpdate();
+			graph->propagateDraw();
+		} );
+
+		CI_LOG_I( numIcons << " icons, " << operation << ": texture binds: " << graph->getFrameStats().mNumTextureBinds << ", " << graph->getFrameStats() );
+		if( operation == "draw_atlased" )
+			CI_LOG_I( "atlas occupancy: " << atlas.getOccupancy() * 100 << "%, pages:\n" << atlas.printOccupancyToString() );
+	}
+}
+
+// Opening a gallery of photos: the frame that creates an ImageView per photo, once decoding and uploading every image on the UI thread and once
+// handing the files to an ImageLoader, which decodes them on worker threads and uploads a few per frame. The timed frame is the hitch a user would see.
+// Closing the gallery between iterations destroys the ImageViews, which cancels the loads that haven't finished.
+void CinderViewBenchApp::benchGallery( size_t numImages )
+{
+	const fs::path directory = fs::temp_directory_path() / "cinder-view-bench-gallery";
+	fs::create_directories( directory );
+
+	vector<fs::path> paths;
+	for( size_t i = 0; i < numImages; i++ ) {
+		paths.push_back( directory / ( "image_" + to_string( i ) + ".png" ) );
+		if( ! fs::exists( paths.back() ) )
+			writeImage( paths.back(), makeGalleryImage( i ) );
+	}
+
+	const size_t numColumns = (size_t)ceil( sqrt( (double)numImages ) );
+	const vec2 cellSize = vec2( GRAPH_SIZE ) / (float)numColumns;
+
+	for( const string operation : { "open_sync", "open_async" } ) {
+		if( ! mBench.isEnabled( "gallery", operation ) )
+			continue;
+
+		auto loader = make_shared<vu::ImageLoader>();
+		auto graph = make_shared<vu::Graph>( GRAPH_SIZE );
+		graph->setImageLoader( loader );
+		graph->setFrameStatsEnabled( true, 1 );
+
+		vector<vu::ImageViewRef> imageViews;
+		auto openGallery = [&] {
+			for( size_t i = 0; i < numImages; i++ ) {
+				vec2 pos = vec2( i % numColumns, i / numColumns ) * cellSize;
+				auto imageView = graph->makeSubview<vu::ImageView>( Rectf( pos, pos + cellSize ) );
+				if( operation == "open_async" )
+					imageView->setImageLoad( loader->load( paths[i] ) );
+				else
+					imageView->setImage( make_shared<vu::Image>( loadImage( loadFile( paths[i] ) ) ) );
+
+				imageViews.push_back( imageView );
+			}
+
+			graph->propagateUpdate();
+			graph->propagateDraw();
+		};
+
+		auto closeGallery = [&] {
+			imageViews.clear();
+			graph->removeAllSubviews();
+
+			// canceled loads that were already decoding finish untimed, so they don't overlap the next iteration
+			while( loader->getNumQueued() + loader->getNumDecoded() > 0 ) {
+				loader->update();
+				this_thread::sleep_for( chrono::milliseconds( 1 ) );
+			}
+		};
+
+		mBench.run( "gallery", operation, numImages + 1, numImages, GALLERY_ITERATIONS, openGallery, closeGallery );
+		CI_LOG_I( numImages << " images, " << operation << ": " << graph->getFrameStats() );
+
+		if( operation == "open_async" ) {
+			// untimed, counts the frames it takes until every ImageView shows its image
+			closeGallery();
+			openGallery();
+			size_t numFrames = 1;
+			while( any_of( imageViews.begin(), imageViews.end(), []( const vu::ImageViewRef &imageView ) { return imageView->isLoading(); } ) ) {
+				this_thread::sleep_for( chrono::milliseconds( 16 ) );
+				graph->propagateUpdate();
+				graph->propagateDraw();
+				numFrames++;
+			}
+
+			CI_LOG_I( numImages << " images, " << operation << ": all loaded after " << numFrames << " frames, loaded: " << loader->getNumLoaded() << ", canceled: " << loader->getNumCanceled()
+						<< ", failed: " << loader->getNumFailed() << ", MB uploaded: " << loader->getNumBytesUploaded() / ( 1024.0 * 1024.0 ) );
+		}
+	}
+}
+
+void CinderViewBenchApp::writeResults()
+{
+	if( mBench.getNumFailedChecks() )
+		CI_LOG_E( mBench.getNumFailedChecks() << " of " << mBench.getChecks().size() << " checks failed" );
+
+	ofstream stream( mOutputPath.string() );
+	if( ! stream.is_open() ) {
+		CI_LOG_E( "failed to open " << mOutputPath << " for writing, printing results to the console instead." );
+		mBench.writeJson( cout );
+		return;
+	}
+
+	mBench.writeJson( stream );
+	CI_LOG_I( "wrote " << mBench.getResults().size() << " results to " << mOutputPath );
+
+}
+
+void CinderViewBenchApp::draw()
+{
+	gl::clear( Color( 0, 0, 0 ) );
+}
+
+CINDER_APP( CinderViewBenchApp, app::RendererGl, []( app::App::Settings *settings ) {
+	settings->setWindowSize( 640, 480 );
+	settings->setTitle( "cinder-view-bench" );
+} )
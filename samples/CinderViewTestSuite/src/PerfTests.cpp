@@ -0,0 +1,400 @@
+#include "PerfTests.h"
+#include "mason/Format.h"
+#include "vu/InputQueue.h"
+
+#include "cinder/app/App.h"
+#include "cinder/Log.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace std;
+using namespace ci;
+
+namespace {
+
+// Heap allocations are counted per thread while enabled, so that the drag benchmark can check that dispatch doesn't allocate.
+thread_local bool	sAllocationCountEnabled = false;
+thread_local size_t	sAllocationCount = 0;
+
+} // anonymous namespace
+
+void* operator new( size_t size )
+{
+	if( sAllocationCountEnabled )
+		sAllocationCount++;
+
+	void *result = malloc( size != 0 ? size : 1 );
+	if( ! result )
+		throw bad_alloc();
+
+	return result;
+}
+
+void operator delete( void *ptr ) noexcept
+{
+	free( ptr );
+}
+
+const float PADDING = 40.0f;
+
+const size_t TOUCH_NUM_EVENTS				= 200;
+const size_t HIT_TEST_NUM_TOUCHES			= 10;
+const vector<size_t> HIT_TEST_SIBLING_COUNTS	= { 100, 1000, 5000, 10000, 20000 };
+const vec2 HIT_TEST_VIEW_SIZE				= vec2( 40 );
+const vector<size_t> BATCH_TOUCH_COUNTS		= { 10, 40, 100 };
+const size_t BATCH_NUM_GROUPS				= 100;
+const size_t BATCH_VIEWS_PER_GROUP			= 50;
+const vec2 BATCH_GROUP_SIZE					= vec2( 200 );
+const vector<size_t> DRAG_COUNTS			= { 10, 40, 100, 200 };
+const vector<size_t> QUEUE_PRODUCER_COUNTS	= { 1, 2, 4, 8 };
+const size_t QUEUE_RECORDS_PER_PRODUCER		= 100000;
+const size_t QUEUE_CAPACITY					= 1024;
+
+namespace {
+
+//! Handles all touches that begin inside of it, so that they are routed back to it in touches moved and ended.
+class DragTarget : public vu::View {
+  public:
+	DragTarget( const Rectf &bounds )
+		: View( bounds )
+	{}
+
+  protected:
+	bool touchesBegan( app::TouchEvent &event ) override
+	{
+		for( auto &touch : event.getTouches() )
+			touch.setHandled();
+
+		return true;
+	}
+};
+
+} // anonymous namespace
+
+PerfTests::PerfTests()
+	: SuiteView()
+{
+	mContainer = make_shared<vu::View>();
+	mContainer->setLabel( "perf container" );
+
+	mInfoLabel = make_shared<vu::LabelGrid>();
+	mInfoLabel->setTextColor( Color::white() );
+	mInfoLabel->getBackground()->setColor( ColorA::gray( 0, 0.3f ) );
+
+	mResultRows.push_back( { "'h': hit test vs. siblings", "" } );
+	mResultRows.push_back( { "'b': batched hit test vs. touches", "" } );
+	mResultRows.push_back( { "'d': touches moved vs. concurrent drags", "" } );
+	mResultRows.push_back( { "'q': input queue with concurrent producers", "" } );
+
+	addSubview( mContainer );
+	addSubview( mInfoLabel );
+}
+
+void PerfTests::layout()
+{
+	mContainer->setBounds( Rectf( PADDING, PADDING, getWidth() - PADDING, getHeight() - PADDING ) );
+}
+
+bool PerfTests::keyDown( app::KeyEvent &event )
+{
+	if( event.isControlDown() )
+		return false;
+
+	bool handled = true;
+	switch( event.getCode() ) {
+		case app::KeyEvent::KEY_h: {
+			runHitTestBenchmark();
+			break;
+		}
+		case app::KeyEvent::KEY_b: {
+			runBatchedHitTestBenchmark();
+			break;
+		}
+		case app::KeyEvent::KEY_d: {
+			runDragBenchmark();
+			break;
+		}
+		case app::KeyEvent::KEY_q: {
+			runInputQueueStressTest();
+			break;
+		}
+		default:
+			handled = false;
+	}
+
+	return handled;
+}
+
+void PerfTests::beginBenchmark( const vector<string> &header )
+{
+	// avoid hitting the test selector with injected touches
+	getSuite()->getSelector()->setInteractive( false );
+
+	mResultRows.clear();
+	mResultRows.push_back( header );
+	mInfoLabel->clearCells();
+}
+
+void PerfTests::endBenchmark()
+{
+	mContainer->removeAllSubviews();
+	getSuite()->getSelector()->setInteractive( true );
+}
+
+void PerfTests::runHitTestBenchmark()
+{
+	beginBenchmark( { "siblings", "linear (ms)", "indexed (ms)" } );
+
+	for( size_t numSiblings : HIT_TEST_SIBLING_COUNTS ) {
+		makeSiblings( numSiblings );
+
+		mContainer->setSubviewIndexEnabled( false );
+		double linearMs = timeTouchDispatch( HIT_TEST_NUM_TOUCHES );
+		mContainer->setSubviewIndexEnabled( true );
+		double indexedMs = timeTouchDispatch( HIT_TEST_NUM_TOUCHES );
+
+		CI_LOG_I( "siblings: " << numSiblings << ", linear: " << linearMs << "ms, indexed: " << indexedMs << "ms" );
+		mResultRows.push_back( { to_string( numSiblings ), fmt::format( "{:.4f}", linearMs ), fmt::format( "{:.4f}", indexedMs ) } );
+	}
+
+	endBenchmark();
+}
+
+void PerfTests::runBatchedHitTestBenchmark()
+{
+	beginBenchmark( { "touches", "per touch (ms)", "batched (ms)" } );
+
+	auto graph = getGraph();
+	const bool batchedWasEnabled = graph->isBatchedHitTestingEnabled();
+	makeGroups( BATCH_NUM_GROUPS, BATCH_VIEWS_PER_GROUP );
+
+	for( size_t numTouches : BATCH_TOUCH_COUNTS ) {
+		graph->setBatchedHitTestingEnabled( false );
+		double perTouchMs = timeTouchDispatch( numTouches );
+		graph->setBatchedHitTestingEnabled( true );
+		double batchedMs = timeTouchDispatch( numTouches );
+
+		CI_LOG_I( "touches: " << numTouches << ", per touch: " << perTouchMs << "ms, batched: " << batchedMs << "ms" );
+		mResultRows.push_back( { to_string( numTouches ), fmt::format( "{:.4f}", perTouchMs ), fmt::format( "{:.4f}", batchedMs ) } );
+	}
+
+	graph->setBatchedHitTestingEnabled( batchedWasEnabled );
+	endBenchmark();
+}
+
+void PerfTests::runDragBenchmark()
+{
+	beginBenchmark( { "drags", "moved (ms)", "allocations", "allocation free" } );
+
+	for( size_t numDrags : DRAG_COUNTS ) {
+		size_t numAllocations = 0;
+		double movedMs = timeDragDispatch( numDrags, &numAllocations );
+
+		// after warming up, dispatching touches moved should reuse all of its buffers.
+		// This is checked here instead of asserted so that it also fails in release builds, where the timings are meaningful.
+		const bool allocationFree = numAllocations == 0;
+		if( ! allocationFree )
+			CI_LOG_E( "touches moved dispatch allocated " << numAllocations << " times in steady state, drags: " << numDrags );
+
+		CI_LOG_I( "drags: " << numDrags << ", moved: " << movedMs << "ms, allocations: " << numAllocations );
+		mResultRows.push_back( { to_string( numDrags ), fmt::format( "{:.4f}", movedMs ), to_string( numAllocations ), allocationFree ? "yes" : "FAILED" } );
+	}
+
+	endBenchmark();
+}
+
+// Each producer thread pushes records numbered in mTimestamp, with its index as the touch id.
+// The consumer (this thread) checks that every record arrives exactly once and in order per producer.
+void PerfTests::runInputQueueStressTest()
+{
+	beginBenchmark( { "producers", "records / ms", "in order" } );
+
+	for( size_t numProducers : QUEUE_PRODUCER_COUNTS ) {
+		vu::InputQueue queue( QUEUE_CAPACITY );
+
+		Timer timer( true );
+		vector<thread> producers;
+		for( size_t p = 0; p < numProducers; p++ ) {
+			producers.emplace_back( [&queue, p] {
+				vu::InputRecord record;
+				record.mType = vu::InputRecord::Type::TOUCHES_MOVED;
+				record.mNumTouches = 1;
+				record.mTouches[0].mId = (uint32_t)p;
+
+				for( size_t i = 0; i < QUEUE_RECORDS_PER_PRODUCER; /* */ ) {
+					record.mTimestamp = (double)i;
+					if( queue.push( record ) )
+						i++;
+					else
+						this_thread::yield(); // full, wait for the consumer
+				}
+			} );
+		}
+
+		bool inOrder = true;
+		vector<size_t> nextRecord( numProducers, 0 );
+		const size_t numRecords = numProducers * QUEUE_RECORDS_PER_PRODUCER;
+		vu::InputRecord record;
+		for( size_t numPopped = 0; numPopped < numRecords; /* */ ) {
+			if( ! queue.pop( &record ) )
+				continue;
+
+			size_t producer = record.mTouches[0].mId;
+			if( producer >= numProducers || record.mTimestamp != (double)nextRecord[producer] )
+				inOrder = false;
+			else
+				nextRecord[producer]++;
+
+			numPopped++;
+		}
+
+		for( auto &producer : producers )
+			producer.join();
+
+		timer.stop();
+		inOrder = inOrder && ! queue.pop( &record );
+
+		double recordsPerMs = (double)numRecords / ( timer.getSeconds() * 1000.0 );
+		CI_LOG_I( "producers: " << numProducers << ", records / ms: " << recordsPerMs << ", in order: " << boolalpha << inOrder );
+		mResultRows.push_back( { to_string( numProducers ), fmt::format( "{:.1f}", recordsPerMs ), inOrder ? "yes" : "no" } );
+
+		CI_ASSERT_MSG( inOrder, "input queue records lost or out of order" );
+	}
+
+	endBenchmark();
+}
+
+void PerfTests::makeSiblings( size_t numSiblings )
+{
+	// use the same seed each time so that runs being compared see the same layout
+	Rand rand( 1 );
+	const vec2 containerSize = mContainer->getSize();
+
+	mContainer->removeAllSubviews();
+	for( size_t i = 0; i < numSiblings; i++ ) {
+		vec2 pos( rand.nextFloat( 0, containerSize.x - HIT_TEST_VIEW_SIZE.x ), rand.nextFloat( 0, containerSize.y - HIT_TEST_VIEW_SIZE.y ) );
+		mContainer->addSubview( make_shared<vu::View>( Rectf( pos, pos + HIT_TEST_VIEW_SIZE ) ) );
+	}
+}
+
+void PerfTests::makeGroups( size_t numGroups, size_t viewsPerGroup )
+{
+	Rand rand( 1 );
+	const vec2 containerSize = mContainer->getSize();
+
+	mContainer->removeAllSubviews();
+	for( size_t i = 0; i < numGroups; i++ ) {
+		vec2 groupPos( rand.nextFloat( 0, containerSize.x - BATCH_GROUP_SIZE.x ), rand.nextFloat( 0, containerSize.y - BATCH_GROUP_SIZE.y ) );
+		auto group = make_shared<vu::View>( Rectf( groupPos, groupPos + BATCH_GROUP_SIZE ) );
+		for( size_t j = 0; j < viewsPerGroup; j++ ) {
+			vec2 pos( rand.nextFloat( 0, BATCH_GROUP_SIZE.x - HIT_TEST_VIEW_SIZE.x ), rand.nextFloat( 0, BATCH_GROUP_SIZE.y - HIT_TEST_VIEW_SIZE.y ) );
+			group->addSubview( make_shared<vu::View>( Rectf( pos, pos + HIT_TEST_VIEW_SIZE ) ) );
+		}
+
+		mContainer->addSubview( group );
+	}
+}
+
+double PerfTests::timeTouchDispatch( size_t numTouches )
+{
+	Rand rand( 2 );
+	const vec2 containerSize = mContainer->getSize();
+
+	vector<vector<app::TouchEvent::Touch>> events( TOUCH_NUM_EVENTS );
+	for( auto &touches : events ) {
+		for( uint32_t id = 0; id < numTouches; id++ ) {
+			vec2 pos = mContainer->toWorld( vec2( rand.nextFloat( 0, containerSize.x ), rand.nextFloat( 0, containerSize.y ) ) );
+			touches.emplace_back( pos, pos, id, 0.0, nullptr );
+		}
+	}
+
+	auto graph = getGraph();
+	auto dispatch = [graph]( const vector<app::TouchEvent::Touch> &touches ) {
+		app::TouchEvent beganEvent( graph->getWindow(), touches );
+		graph->propagateTouchesBegan( beganEvent );
+		app::TouchEvent endedEvent( graph->getWindow(), touches );
+		graph->propagateTouchesEnded( endedEvent );
+	};
+
+	// warm up, which also builds subview indices if enabled
+	dispatch( events.front() );
+
+	Timer timer( true );
+	for( const auto &touches : events )
+		dispatch( touches );
+
+	timer.stop();
+	return timer.getSeconds() * 1000.0 / (double)events.size();
+}
+
+double PerfTests::timeDragDispatch( size_t numDrags, size_t *numAllocations )
+{
+	const size_t numColumns = (size_t)ceil( sqrt( (double)numDrags ) );
+	const vec2 cellSize = mContainer->getSize() / (float)numColumns;
+
+	// one touch per DragTarget, starting at its center
+	mContainer->removeAllSubviews();
+	vector<app::TouchEvent::Touch> touches;
+	for( uint32_t id = 0; id < numDrags; id++ ) {
+		vec2 pos = vec2( id % numColumns, id / numColumns ) * cellSize;
+		mContainer->addSubview( make_shared<DragTarget>( Rectf( pos, pos + cellSize ).inflated( - vec2( 2 ) ) ) );
+
+		vec2 touchPos = mContainer->toWorld( pos + cellSize / 2.0f );
+		touches.emplace_back( touchPos, touchPos, id, 0.0, nullptr );
+	}
+
+	auto graph = getGraph();
+	app::TouchEvent beganEvent( graph->getWindow(), touches );
+	graph->propagateTouchesBegan( beganEvent );
+
+	// events are made up front so that only dispatch is timed and counted, plus one to warm up
+	Rand rand( 2 );
+	vector<app::TouchEvent> events;
+	for( size_t i = 0; i < TOUCH_NUM_EVENTS + 1; i++ ) {
+		vector<app::TouchEvent::Touch> eventTouches;
+		for( const auto &touch : touches ) {
+			vec2 pos = touch.getPos() + rand.nextVec2() * 2.0f;
+			eventTouches.emplace_back( pos, touch.getPos(), touch.getId(), 0.0, nullptr );
+		}
+
+		events.emplace_back( graph->getWindow(), eventTouches );
+	}
+
+	graph->propagateTouchesMoved( events.front() );
+
+	sAllocationCount = 0;
+	sAllocationCountEnabled = true;
+	Timer timer( true );
+	for( size_t i = 1; i < events.size(); i++ )
+		graph->propagateTouchesMoved( events[i] );
+
+	timer.stop();
+	sAllocationCountEnabled = false;
+	*numAllocations = sAllocationCount;
+
+	app::TouchEvent endedEvent( graph->getWindow(), touches );
+	graph->propagateTouchesEnded( endedEvent );
+
+	return timer.getSeconds() * 1000.0 / (double)TOUCH_NUM_EVENTS;
+}
+
+void PerfTests::update()
+{
+	for( size_t row = 0; row < mResultRows.size(); row++ )
+		mInfoLabel->setRow( row, mResultRows[row] );
+
+	//  resize info label
+	{
+		const float padding = 6;
+		const vec2 infoRowSize = vec2( 450, 20 );
+
+		const int numRows = mInfoLabel->getNumRows();
+		vec2 windowSize = vec2( app::getWindow()->getSize() );
+		vec2 labelSize = { infoRowSize.x, infoRowSize.y * numRows };
+		mInfoLabel->setBounds( { padding, windowSize.y - labelSize.y - padding, labelSize.x + padding, windowSize.y - padding } ); // anchor bottom left
+	}
+}
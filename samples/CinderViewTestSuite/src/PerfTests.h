@@ -0,0 +1,39 @@
+#pragma once
+
+#include "vu/Suite.h"
+#include "vu/Label.h"
+
+//! Benchmarks for the costs of event dispatch, update and draw as the number of Views grows. Results are logged and shown in the info label.
+class PerfTests : public vu::SuiteView {
+  public:
+	PerfTests();
+
+  protected:
+	void layout() override;
+	void update() override;
+	bool keyDown( ci::app::KeyEvent &event ) override;
+
+  private:
+	void	runHitTestBenchmark();
+	void	runBatchedHitTestBenchmark();
+	void	runDragBenchmark();
+	void	runInputQueueStressTest();
+
+	//! Fills mContainer with \a numSiblings randomly placed Views.
+	void	makeSiblings( size_t numSiblings );
+	//! Fills mContainer with \a numGroups randomly placed Views, each containing \a viewsPerGroup randomly placed Views.
+	void	makeGroups( size_t numGroups, size_t viewsPerGroup );
+	//! Returns the average milliseconds spent dispatching one touches began + ended event pair with \a numTouches touches, inside of mContainer.
+	double	timeTouchDispatch( size_t numTouches );
+	//! Fills mContainer with a grid of \a numDrags Views that handle touches, drags each with its own touch and returns the average milliseconds spent dispatching one touches moved event.
+	//! \a numAllocations is set to the number of heap allocations made while dispatching, after one warm up event.
+	double	timeDragDispatch( size_t numDrags, size_t *numAllocations );
+
+	void	beginBenchmark( const std::vector<std::string> &header );
+	void	endBenchmark();
+
+	vu::ViewRef			mContainer;
+	vu::LabelGridRef	mInfoLabel;
+
+	std::vector<std::vector<std::string>>	mResultRows;
+};
@@ -69,6 +69,9 @@ protected:
 		gl::drawSolidCircle( mLocalTouchPos, 10.0f );
 	}
 
+	// draws with ci::gl, so it can't be batched like other RectViews
+	bool drawsOnlyThroughRenderer() const override	{ return false; }
+
 	vec2 mLocalTouchPos;
 	Color mLocalTouchColor = Color::gray( 0.3f );
 };
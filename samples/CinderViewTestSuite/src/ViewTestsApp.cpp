@@ -12,6 +12,7 @@
 #include "FilterTest.h"
 #include "LayoutTests.h"
 #include "MultiTouchTest.h"
+#include "PerfTests.h"
 #include "ScrollTests.h"
 
 #include "glm/gtc/epsilon.hpp"
@@ -25,6 +26,7 @@ const bool USE_SECONDARY_SCREEN = 0;
 const int DEFAULT_TEST			= 0;
 const vec2 WINDOW_SIZE			= vec2( 1220, 720 );
 const vec2 INFO_ROW_SIZE		= vec2( 250, 20 );
+const fs::path INPUT_RECORDING_FILENAME	= "input_recording.bin";
 
 
 #define LIVEPP_ENABLED 0
@@ -50,9 +52,14 @@ class ViewTestsApp : public App {
 	void drawViewBorders();
 	void drawLayerBorders();
 	void drawTouches();
+	void toggleInputRecording();
+	void playInputRecording();
 
 	vu::SuiteRef		mTestSuite;
 	vu::LabelGridRef    mInfoLabel;
+	vu::InputRecorderRef	mInputRecorder;
+	vu::InputPlayerRef		mInputPlayer;
+	double					mInputPlaybackStartTime = 0;
 
 	bool	mDrawViewBorders = false;
 	bool    mDrawLayerBorders = false;
@@ -67,6 +74,7 @@ void ViewTestsApp::setup()
 		eventOptions.mouse( false );
 	}
 	mTestSuite = make_shared<vu::Suite>( eventOptions );
+	mTestSuite->getGraph()->setFrameStatsEnabled();
 
 	mTestSuite->registerSuiteView<BasicViewTests>( "basic" );
 	mTestSuite->registerSuiteView<CompositingTest>( "compositing" );
@@ -75,6 +83,7 @@ void ViewTestsApp::setup()
 	mTestSuite->registerSuiteView<MultiTouchTest>( "multitouch" );
 	mTestSuite->registerSuiteView<ScrollTests>( "scroll" );
 	mTestSuite->registerSuiteView<FilterTest>( "filters" );
+	mTestSuite->registerSuiteView<PerfTests>( "perf" );
 
 	// TODO: this doesn't cover the case of calling Suite::select() directly - should probably add new signal that ties to both Selector and that
 	mTestSuite->getSelector()->getSignalValueChanged().connect( [this] {
@@ -117,6 +126,12 @@ void ViewTestsApp::keyDown( app::KeyEvent event )
 				mDrawTouches = ! mDrawTouches;
 				CI_LOG_I( "draw touches: " << mDrawTouches );
 			break;
+			case app::KeyEvent::KEY_i:
+				toggleInputRecording();
+			break;
+			case app::KeyEvent::KEY_p:
+				playInputRecording();
+			break;
 		}
 	}
 
@@ -129,10 +144,55 @@ void ViewTestsApp::resize()
 
 void ViewTestsApp::update()
 {
+	if( mInputPlayer ) {
+		mInputPlayer->update( mTestSuite->getGraph().get(), getElapsedSeconds() - mInputPlaybackStartTime );
+		if( mInputPlayer->isFinished() ) {
+			CI_LOG_I( "input playback finished" );
+			mInputPlayer = nullptr;
+		}
+	}
+
 	mTestSuite->update();
 	updateUI();
 }
 
+void ViewTestsApp::toggleInputRecording()
+{
+	auto graph = mTestSuite->getGraph();
+	if( ! mInputRecorder ) {
+		mInputRecorder = make_shared<vu::InputRecorder>();
+		graph->setInputRecorder( mInputRecorder );
+		CI_LOG_I( "input recording started" );
+		return;
+	}
+
+	graph->setInputRecorder( nullptr );
+	auto filePath = getAppPath() / INPUT_RECORDING_FILENAME;
+	try {
+		mInputRecorder->write( filePath );
+		CI_LOG_I( "input recording stopped, wrote " << mInputRecorder->getNumRecords() << " records to: " << filePath );
+	}
+	catch( exception &exc ) {
+		CI_LOG_EXCEPTION( "failed to write input recording", exc );
+	}
+
+	mInputRecorder = nullptr;
+}
+
+// Replays the last input recording at its recorded timing
+void ViewTestsApp::playInputRecording()
+{
+	auto filePath = getAppPath() / INPUT_RECORDING_FILENAME;
+	try {
+		mInputPlayer = vu::InputPlayer::load( filePath );
+		mInputPlaybackStartTime = getElapsedSeconds();
+		CI_LOG_I( "playing " << mInputPlayer->getNumRecords() << " records, duration: " << mInputPlayer->getDuration() << "s" );
+	}
+	catch( exception &exc ) {
+		CI_LOG_EXCEPTION( "failed to load input recording", exc );
+	}
+}
+
 void ViewTestsApp::updateUI()
 {
 	mInfoLabel->setRow( 0, { "fps:",  fmt::format( "{:.2f}", getAverageFps() ) } );
@@ -140,6 +200,11 @@ void ViewTestsApp::updateUI()
 	size_t numFrameBuffers = mTestSuite->getGraph()->getRenderer()->getNumFrameBuffersCached();
 	mInfoLabel->setRow( 1, { "FrameBuffers: ", to_string( numFrameBuffers ) } );
 
+	const auto &stats = mTestSuite->getGraph()->getFrameStats();
+	mInfoLabel->setRow( 2, { "views updated / drawn / culled:", fmt::format( "{} / {} / {}", stats.mNumViewsUpdated, stats.mNumViewsDrawn, stats.mNumViewsCulled ) } );
+	mInfoLabel->setRow( 3, { "draw calls:", to_string( stats.mNumDrawCalls ) } );
+	mInfoLabel->setRow( 4, { "update / draw ms:", fmt::format( "{:.2f} / {:.2f}", stats.mUpdateSeconds * 1000.0, stats.mDrawSeconds * 1000.0 ) } );
+
 	if( ! glm::epsilonEqual( INFO_ROW_SIZE.y * mInfoLabel->getNumRows(), mInfoLabel->getHeight(), 0.01f ) )
 		resizeInfoLabel();
 }
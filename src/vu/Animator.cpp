@@ -0,0 +1,237 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "vu/Animator.h"
+#include "vu/View.h"
+
+#include "cinder/CinderAssert.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+//! Durations are clamped to at least this, so that zero length tweens complete on the update after they start
+const double MIN_DURATION = 0.000001;
+
+inline float applyEase( Ease ease, float t )
+{
+	switch( ease ) {
+		case Ease::LINEAR:			return t;
+		case Ease::IN_QUAD:			return t * t;
+		case Ease::OUT_QUAD:		return t * ( 2 - t );
+		case Ease::IN_OUT_QUAD:		return t < 0.5f ? 2 * t * t : -1 + ( 4 - 2 * t ) * t;
+		case Ease::IN_CUBIC:		return t * t * t;
+		case Ease::OUT_CUBIC:		{ float u = t - 1; return u * u * u + 1; }
+		case Ease::IN_OUT_CUBIC:	{ float u = 2 * t - 2; return t < 0.5f ? 4 * t * t * t : ( t - 1 ) * u * u + 1; }
+		default:					CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return t;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// Animator::Track
+// ----------------------------------------------------------------------------------------------------
+
+template<typename T>
+void Animator::Track<T>::add( View *view, T *target, const T &end, double startTime, double duration, Ease ease )
+{
+	CI_ASSERT( view && target );
+
+	// a new tween on a target replaces the one running on it
+	remove( target );
+
+	mIndexForTarget[target] = mTargets.size();
+	mTargets.push_back( target );
+	mStartValues.push_back( *target );
+	mEndValues.push_back( end );
+	mStartTimes.push_back( startTime );
+	mInvDurations.push_back( float( 1.0 / std::max( duration, MIN_DURATION ) ) );
+	mEases.push_back( ease );
+	mViews.push_back( view->shared_from_this() );
+	mStarted.push_back( 0 );
+
+	view->mNumTweens++;
+}
+
+template<typename T>
+bool Animator::Track<T>::remove( const void *target )
+{
+	auto it = mIndexForTarget.find( target );
+	if( it == mIndexForTarget.end() )
+		return false;
+
+	removeAt( it->second );
+	return true;
+}
+
+// Swaps the last tween into \a index, so removal is constant time
+template<typename T>
+void Animator::Track<T>::removeAt( size_t index )
+{
+	const size_t last = mTargets.size() - 1;
+
+	mIndexForTarget.erase( mTargets[index] );
+	mViews[index]->mNumTweens--;
+
+	if( index != last ) {
+		mTargets[index] = mTargets[last];
+		mStartValues[index] = mStartValues[last];
+		mEndValues[index] = mEndValues[last];
+		mStartTimes[index] = mStartTimes[last];
+		mInvDurations[index] = mInvDurations[last];
+		mEases[index] = mEases[last];
+		mViews[index] = move( mViews[last] );
+		mStarted[index] = mStarted[last];
+		mIndexForTarget[mTargets[index]] = index;
+	}
+
+	mTargets.pop_back();
+	mStartValues.pop_back();
+	mEndValues.pop_back();
+	mStartTimes.pop_back();
+	mInvDurations.pop_back();
+	mEases.pop_back();
+	mViews.pop_back();
+	mStarted.pop_back();
+}
+
+template<typename T>
+void Animator::Track<T>::removeView( const View *view )
+{
+	for( size_t i = mTargets.size(); i-- > 0; ) {
+		if( mViews[i].get() == view )
+			removeAt( i );
+	}
+}
+
+template<typename T>
+void Animator::Track<T>::clear()
+{
+	for( size_t i = mTargets.size(); i-- > 0; )
+		removeAt( i );
+}
+
+template<typename T>
+void Animator::Track<T>::update( double currentTime )
+{
+	const size_t numTweens = mTargets.size();
+	if( numTweens == 0 )
+		return;
+
+	// progress for all tweens first, in a branch free loop over the time arrays
+	mProgress.resize( numTweens );
+	const double *startTimes = mStartTimes.data();
+	const float *invDurations = mInvDurations.data();
+	float *progress = mProgress.data();
+	for( size_t i = 0; i < numTweens; i++ )
+		progress[i] = float( ( currentTime - startTimes[i] ) * invDurations[i] );
+
+	for( size_t i = 0; i < numTweens; i++ ) {
+		if( progress[i] < 0 )
+			continue; // not started yet
+
+		if( ! mStarted[i] ) {
+			// tween from the value at the end of the delay, so that changes made while waiting aren't undone
+			mStartValues[i] = *mTargets[i];
+			mStarted[i] = 1;
+		}
+
+		const float t = applyEase( mEases[i], std::min( progress[i], 1.0f ) );
+		*mTargets[i] = mStartValues[i] + ( mEndValues[i] - mStartValues[i] ) * t;
+		mViews[i]->animatedPropertyChanged( mTargets[i] );
+	}
+
+	// remove completed tweens back to front, so that the swapped in tweens have already been visited
+	for( size_t i = numTweens; i-- > 0; ) {
+		if( progress[i] >= 1 )
+			removeAt( i );
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Animator
+// ----------------------------------------------------------------------------------------------------
+
+void Animator::animate( View *view, float *target, float end, double startTime, double duration, Ease ease )
+{
+	mFloatTrack.add( view, target, end, startTime, duration, ease );
+}
+
+void Animator::animate( View *view, vec2 *target, const vec2 &end, double startTime, double duration, Ease ease )
+{
+	mVec2Track.add( view, target, end, startTime, duration, ease );
+}
+
+void Animator::animate( View *view, Color *target, const Color &end, double startTime, double duration, Ease ease )
+{
+	mColorTrack.add( view, target, end, startTime, duration, ease );
+}
+
+void Animator::animate( View *view, ColorA *target, const ColorA &end, double startTime, double duration, Ease ease )
+{
+	mColorATrack.add( view, target, end, startTime, duration, ease );
+}
+
+void Animator::cancel( const void *target )
+{
+	mFloatTrack.remove( target ) || mVec2Track.remove( target ) || mColorTrack.remove( target ) || mColorATrack.remove( target );
+}
+
+void Animator::cancel( const View *view )
+{
+	if( view->mNumTweens == 0 )
+		return;
+
+	mFloatTrack.removeView( view );
+	mVec2Track.removeView( view );
+	mColorTrack.removeView( view );
+	mColorATrack.removeView( view );
+}
+
+void Animator::cancelAll()
+{
+	mFloatTrack.clear();
+	mVec2Track.clear();
+	mColorTrack.clear();
+	mColorATrack.clear();
+}
+
+void Animator::update( double currentTime )
+{
+	mFloatTrack.update( currentTime );
+	mVec2Track.update( currentTime );
+	mColorTrack.update( currentTime );
+	mColorATrack.update( currentTime );
+}
+
+size_t Animator::getNumTweens() const
+{
+	return mFloatTrack.getSize() + mVec2Track.getSize() + mColorTrack.getSize() + mColorATrack.getSize();
+}
+
+} // namespace vu
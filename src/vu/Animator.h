@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/Color.h"
+#include "cinder/Vector.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace vu {
+
+typedef std::shared_ptr<class View>	ViewRef;
+
+//! Easing curves understood by the Animator. These are evaluated inline for every tween in a pass, rather than through a function object per tween.
+enum class Ease : uint8_t {
+	LINEAR,
+	IN_QUAD,
+	OUT_QUAD,
+	IN_OUT_QUAD,
+	IN_CUBIC,
+	OUT_CUBIC,
+	IN_OUT_CUBIC
+};
+
+//! Tweens View properties in bulk. Owned by the Graph, which evaluates every active tween in one pass at the start of propagateUpdate(), then wakes the animated Views so that
+//! update() notices the new values. Tweens are stored in contiguous arrays segregated by value type, rather than as individual objects on a timeline like ci::Anim.
+//! The animated View is kept alive until its tweens complete or are cancelled. Usually used through View::animatePos() and friends.
+class CI_UI_API Animator {
+  public:
+	//! Tweens \a target, a property of \a view, to \a end. Starts at \a startTime, in the same time base as Graph::getCurrentTime(), and runs for \a duration seconds.
+	//! Replaces any tween already running on \a target. Before the tween starts, \a target is left untouched, and the value it has when the tween starts is the one tweened from.
+	void	animate( View *view, float *target, float end, double startTime, double duration, Ease ease = Ease::LINEAR );
+	void	animate( View *view, ci::vec2 *target, const ci::vec2 &end, double startTime, double duration, Ease ease = Ease::LINEAR );
+	void	animate( View *view, ci::Color *target, const ci::Color &end, double startTime, double duration, Ease ease = Ease::LINEAR );
+	void	animate( View *view, ci::ColorA *target, const ci::ColorA &end, double startTime, double duration, Ease ease = Ease::LINEAR );
+
+	//! Stops the tween running on \a target, if there is one. \a target keeps its current value.
+	void	cancel( const void *target );
+	//! Stops all tweens running on properties of \a view.
+	void	cancel( const View *view );
+	//! Stops all tweens.
+	void	cancelAll();
+
+	//! Evaluates all tweens at \a currentTime, writing the results to their targets. Tweens that have reached their end value are removed.
+	void	update( double currentTime );
+
+	//! Returns whether any tweens are running.
+	bool	isAnimating() const		{ return getNumTweens() != 0; }
+	//! Returns the number of tweens running.
+	size_t	getNumTweens() const;
+
+  private:
+	//! Arrays for all tweens of one value type, indexed together
+	template<typename T>
+	struct Track {
+		void	add( View *view, T *target, const T &end, double startTime, double duration, Ease ease );
+		bool	remove( const void *target );
+		void	removeAt( size_t index );
+		void	removeView( const View *view );
+		void	clear();
+		void	update( double currentTime );
+		size_t	getSize() const		{ return mTargets.size(); }
+
+		std::vector<T *>		mTargets;
+		std::vector<T>			mStartValues;
+		std::vector<T>			mEndValues;
+		std::vector<double>		mStartTimes;
+		std::vector<float>		mInvDurations;
+		std::vector<Ease>		mEases;
+		std::vector<ViewRef>	mViews;
+		std::vector<uint8_t>	mStarted; // whether the start value has been captured, which happens once the start time is reached
+		std::vector<float>		mProgress; // scratch for update()
+		std::unordered_map<const void *, size_t>	mIndexForTarget;
+	};
+
+	Track<float>		mFloatTrack;
+	Track<ci::vec2>		mVec2Track;
+	Track<ci::Color>	mColorTrack;
+	Track<ci::ColorA>	mColorATrack;
+};
+
+} // namespace vu
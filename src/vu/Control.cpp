@@ -150,7 +150,8 @@ void Button::update()
 			int blarg = 2;
 		}
 
-		if( mTitleLabel->isBackgroundEnabled() ) {
+		// only set the color when it changes, as this runs every frame and setColor() requests a redraw
+		if( mTitleLabel->isBackgroundEnabled() && mTitleLabel->getBackground()->getColor() != getColor() ) {
 			mTitleLabel->getBackground()->setColor( getColor() );
 		}
 	}
@@ -166,6 +167,7 @@ void Button::setEnabled( bool enabled )
 	mState = state;
 
 	updateTitle();
+	setNeedsRedraw();
 	getSignalValueChanged().emit();
 }
 
@@ -203,21 +205,25 @@ void Button::setTitleColor( const ci::ColorA &color, State state )
 void Button::setColor( const ci::ColorA &color, State state )
 {
 	switch( state ) {
-		case State::NORMAL:		mColorNormal = color; return;
-		case State::ENABLED:	mColorEnabled = color; return;
-		case State::PRESSED:	mColorPressed = color; return;
+		case State::NORMAL:		mColorNormal = color; break;
+		case State::ENABLED:	mColorEnabled = color; break;
+		case State::PRESSED:	mColorPressed = color; break;
 		default: CI_ASSERT_NOT_REACHABLE();
 	}
+
+	setNeedsRedraw();
 }
 
 void Button::setImage( const vu::ImageRef &image, State state )
 {
 	switch( state ) {
-		case State::NORMAL:		mImageNormal = image; return;
-		case State::ENABLED:	mImageEnabled = image; return;
-		case State::PRESSED:	mImagePressed = image; return;
+		case State::NORMAL:		mImageNormal = image; break;
+		case State::ENABLED:	mImageEnabled = image; break;
+		case State::PRESSED:	mImagePressed = image; break;
 		default: CI_ASSERT_NOT_REACHABLE();
 	}
+
+	setNeedsRedraw();
 }
 
 ImageRef Button::getImage() const
@@ -353,13 +359,20 @@ void CheckBox::draw( Renderer *ren )
 	const float offsetY = 4;
 	mTitleLabel->setHidden( true );
 	ren->setColor( getTitleColor() );
-	mTextTitle->drawString( getTitle(), vec2( r + padding * 2, getCenterLocal().y + mTextTitle->getDescent() + offsetY ) );
+	ren->drawString( mTextTitle, getTitle(), vec2( r + padding * 2, getCenterLocal().y + mTextTitle->getDescent() + offsetY ) );
 }
 
 // ----------------------------------------------------------------------------------------------------
 // TextField
 // ----------------------------------------------------------------------------------------------------
 
+namespace {
+
+//! Seconds that the TextField cursor is shown for, then hidden for
+const double CURSOR_BLINK_SECONDS = 0.5;
+
+} // anonymous namespace
+
 TextField::TextField( const ci::Rectf &bounds )
 	: Control( bounds )
 {
@@ -372,21 +385,25 @@ TextField::TextField( const ci::Rectf &bounds )
 void TextField::setBorderColor( const ci::ColorA &color, State state )
 {
 	switch( state ) {
-		case State::NORMAL:		mBorderColorNormal = color; return;
-		case State::SELECTED:	mBorderColorSelected = color; return;
+		case State::NORMAL:		mBorderColorNormal = color; break;
+		case State::SELECTED:	mBorderColorSelected = color; break;
 			//case State::PRESSED:	mColorPressed = color; return;
 		default: CI_ASSERT_NOT_REACHABLE();
 	}
+
+	setNeedsRedraw();
 }
 
 void TextField::setTextColor( const ci::ColorA &color, State state )
 {
 	switch( state ) {
-		case State::NORMAL:		mTextColorNormal = color; return;
-		case State::SELECTED:	mTextColorSelected = color; return;
+		case State::NORMAL:		mTextColorNormal = color; break;
+		case State::SELECTED:	mTextColorSelected = color; break;
 			//case State::PRESSED:	mColorPressed = color; return;
 		default: CI_ASSERT_NOT_REACHABLE();
 	}
+
+	setNeedsRedraw();
 }
 
 void TextField::setPlaceholderText( const std::string &text )
@@ -394,6 +411,26 @@ void TextField::setPlaceholderText( const std::string &text )
 	mPlaceholderString = text;
 	if( getLabel().empty() )
 		setLabel( "TextField ('" + text + "')" );
+
+	setNeedsRedraw();
+}
+
+// The cursor blinks rather than fading, so that a focused TextField only needs a frame each time the cursor is shown or hidden
+void TextField::update()
+{
+	if( ! isFirstResponder() )
+		return;
+
+	const double currentTime = getGraph()->getCurrentTime();
+	const double elapsed = std::max( 0.0, currentTime - mCursorBlinkStartTime );
+	const double phase = fmod( elapsed, CURSOR_BLINK_SECONDS * 2 );
+	const bool visible = phase < CURSOR_BLINK_SECONDS;
+	if( mCursorVisible != visible ) {
+		mCursorVisible = visible;
+		setNeedsRedraw();
+	}
+
+	setNeedsRedraw( currentTime + CURSOR_BLINK_SECONDS - fmod( phase, CURSOR_BLINK_SECONDS ) );
 }
 
 void TextField::draw( Renderer *ren )
@@ -404,16 +441,16 @@ void TextField::draw( Renderer *ren )
 	if( ! mInputString.empty() ) {
 		auto color = isFirstResponder() ? mTextColorSelected : mTextColorNormal;
 		ren->setColor( color );
-		mText->drawString( mInputString, vec2( padding, getCenterLocal().y + mText->getDescent() ) );
+		ren->drawString( mText, mInputString, vec2( padding, getCenterLocal().y + mText->getDescent() ) );
 	}
 	else if( ! isFirstResponder() && ! mPlaceholderString.empty() ) {
 		auto color = Color::gray( 0.5f ); // TODO: make color a property
 		ren->setColor( color );
-		mText->drawString( mPlaceholderString, vec2( padding, getCenterLocal().y + mText->getDescent() ) );
+		ren->drawString( mText, mPlaceholderString, vec2( padding, getCenterLocal().y + mText->getDescent() ) );
 	}
 
 	// draw cursor bar
-	if( isFirstResponder() ) {
+	if( isFirstResponder() && mCursorVisible ) {
 		const float cursorThickness = 1;
 		const float nextCharOffset = 6;
 		vec2 cursorLoc = { 0, 0 };
@@ -423,12 +460,9 @@ void TextField::draw( Renderer *ren )
 		cursorLoc.x += nextCharOffset;
 		Rectf cursorRect = { cursorLoc.x - cursorThickness / 2, 0, cursorLoc.x + cursorThickness / 2, getHeight() };
 
-		ColorA cursorColor = mBorderColorSelected;
-		cursorColor.a *= (float)( 1.0 - glm::pow( cos( getGraph()->getCurrentTime() * 2 ), 4 ) );
-
 		// TODO: does this need more care to be correctly composited?
 		ren->pushBlendMode( vu::BlendMode::PREMULT_ALPHA );
-		ren->setColor( cursorColor );
+		ren->setColor( mBorderColorSelected );
 		ren->drawSolidRect( cursorRect );
 		ren->popBlendMode();
 	}
@@ -456,6 +490,8 @@ bool TextField::willBecomeFirstResponder()
 
 	// store the input string, in case input is canceled and we need to revert.
 	mInputStringBeforeInput = mInputString;
+
+	showCursor();
 	return true;
 }
 
@@ -472,6 +508,8 @@ bool TextField::keyDown( ci::app::KeyEvent &event )
 	//	<< ", shift down: " << event.isShiftDown() << ", alt down: " << event.isAltDown() << ", ctrl down: " << event.isControlDown()
 	//	<< ", meta down: " << event.isMetaDown() << ", accel down: " << event.isAccelDown() << ", native code: " << event.getNativeKeyCode() );
 
+	showCursor();
+
 	bool handled = true;
 	if( event.getCode() == app::KeyEvent::KEY_RETURN ) {
 		// text completed
@@ -538,6 +576,13 @@ bool TextField::keyDown( ci::app::KeyEvent &event )
 	return handled;
 }
 
+void TextField::showCursor()
+{
+	mCursorBlinkStartTime = getGraph() ? getGraph()->getCurrentTime() : 0;
+	mCursorVisible = true;
+	setNeedsRedraw();
+}
+
 bool TextField::checkCharIsValid( char c ) const
 {
 	if( mInputMode == InputMode::NUMERIC ) {
@@ -596,6 +641,7 @@ void SliderBase::setValue( float value, bool emitChanged )
 		mValue = roundf( mValue );
 
 	updateSliderPos();
+	setNeedsRedraw();
 
 	if( emitChanged )
 		getSignalValueChanged().emit();
@@ -611,7 +657,7 @@ void SliderBase::draw( Renderer *ren )
 	ren->drawSolidRect( valRect );
 
 	ren->setColor( mTitleColor );
-	mTextLabel->drawString( getTitleLabel(), vec2( padding, getCenterLocal().y + mTextLabel->getDescent() ) );
+	ren->drawString( mTextLabel, getTitleLabel(), vec2( padding, getCenterLocal().y + mTextLabel->getDescent() ) );
 }
 
 std::string	SliderBase::getTitleLabel() const
@@ -755,7 +801,7 @@ void SelectorBase::draw( Renderer *ren )
 	for( size_t i = 0; i < mSegments.size(); i++ ) {
 		if( i != mSelectedIndex ) {
 			ren->drawStrokedRect( section );
-			mTextLabel->drawString( mSegments[i], vec2( section.x1 + padding, section.getCenter().y + mTextLabel->getDescent() ) );
+			ren->drawString( mTextLabel, mSegments[i], vec2( section.x1 + padding, section.getCenter().y + mTextLabel->getDescent() ) );
 		}
 		section += vec2( 0.0f, sectionHeight );
 	}
@@ -767,12 +813,12 @@ void SelectorBase::draw( Renderer *ren )
 	ren->drawStrokedRect( section );
 
 	if( ! mSegments.empty() ) {
-		mTextLabel->drawString( mSegments[mSelectedIndex], vec2( section.x1 + padding, section.getCenter().y + mTextLabel->getDescent() ) );
+		ren->drawString( mTextLabel, mSegments[mSelectedIndex], vec2( section.x1 + padding, section.getCenter().y + mTextLabel->getDescent() ) );
 	}
 
 	if( ! mTitle.empty() ) {
 		ren->setColor( mTitleColor );
-		mTextLabel->drawString( mTitle, vec2( padding, - mTextLabel->getDescent() ) );
+		ren->drawString( mTextLabel, mTitle, vec2( padding, - mTextLabel->getDescent() ) );
 	}
 }
 
@@ -840,6 +886,7 @@ void SelectorBase::select( size_t index )
 
 	if( mSelectedIndex != index ) {
 		mSelectedIndex = index;
+		setNeedsRedraw();
 		getSignalValueChanged().emit();
 	}
 }
@@ -908,6 +955,8 @@ void NumberBox::setValue( float value, bool emitChanged )
 	if( mSnapToInt )
 		mValue = roundf( mValue );
 
+	setNeedsRedraw();
+
 	if( emitChanged )
 		getSignalValueChanged().emit();
 }
@@ -941,7 +990,7 @@ void NumberBox::draw( Renderer *ren )
 {
 	// TODO: add option to draw to right, like CheckBox
 	ren->setColor( mTitleColor );
-	mTextLabel->drawString( getTitleLabel(), vec2( mPadding, getCenterLocal().y + mTextLabel->getDescent() ) );
+	ren->drawString( mTextLabel, getTitleLabel(), vec2( mPadding, getCenterLocal().y + mTextLabel->getDescent() ) );
 
 	ren->setColor( mBorderColor );
 	ren->drawStrokedRect( getBoundsLocal(), 2 );
@@ -969,6 +1018,7 @@ void NumberBox::setNumDigits( size_t numDigits )
 {
 	mNumDigits = numDigits;
 	mFormatStr = "{0:." + to_string( numDigits ) + "f}";
+	setNeedsRedraw();
 }
 
 void NumberBox::updateValueFromTextField()
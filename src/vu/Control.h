@@ -56,6 +56,8 @@ class CI_UI_API Control : public View {
 
   protected:
 	bool hitTestInsideCancelPadding( const ci::vec2 &localPos ) const;
+	//! Controls draw their text with Renderer::drawString(), so they are batched with other Views unless a subclass returns false.
+	bool drawsOnlyThroughRenderer() const override	{ return true; }
 
   private:
 	ci::Rectf	mCancelPadding = ci::Rectf( 40, 40, 40, 40 );
@@ -165,14 +167,14 @@ class CI_UI_API TextField : public Control {
 	void setBorderColor( const ci::ColorA &color, State state = State::NORMAL );
 	void setTextColor( const ci::ColorA &color, State state = State::NORMAL );
 
-	void				setText( const std::string &text )				{ mInputString = text; }
+	void				setText( const std::string &text )				{ mInputString = text; setNeedsRedraw(); }
 	const std::string&	getText() const									{ return mInputString; }
 	void				setPlaceholderText( const std::string &text );
 	const std::string&	getPlaceholderText() const						{ return mPlaceholderString; }
 
-	void		setInputMode( InputMode mode )		{ mInputMode = mode; }
+	void		setInputMode( InputMode mode )		{ mInputMode = mode; setNeedsRedraw(); }
 	InputMode	getInputMode() const				{ return mInputMode; }
-	void		setBorderMode( BorderMode mode )	{ mBorderMode = mode; }
+	void		setBorderMode( BorderMode mode )	{ mBorderMode = mode; setNeedsRedraw(); }
 	BorderMode	getBorderMode() const				{ return mBorderMode; }
 
 	ci::signals::Signal<void ()>&	getSignalmSignalTextInputBegin()	{ return mSignalTextInputBegin; }
@@ -180,6 +182,7 @@ class CI_UI_API TextField : public Control {
 	ci::signals::Signal<void ()>&	getSignalTextInputCanceled()	{ return mSignalTextInputCanceled; }
 
   private:
+	void	update()				override;
 	void	draw( Renderer *ren )	override;
 
 	bool	willBecomeFirstResponder() override;
@@ -187,11 +190,15 @@ class CI_UI_API TextField : public Control {
 
 	bool	keyDown( ci::app::KeyEvent &event ) override;
 	bool	checkCharIsValid( char c ) const;
+	//! Shows the cursor and restarts its blink, called when input begins and for every key.
+	void	showCursor();
 
 	TextRef		mText;
 	std::string mInputString, mInputStringBeforeInput;
 	std::string mPlaceholderString;
 	int			mCursorPos = -1; // position of next character input. -1 indicates it's never been set and will be at the end of the text once we're first responder
+	double		mCursorBlinkStartTime = 0; // Graph time that the cursor was last shown from, reset by input so that it stays visible while typing
+	bool		mCursorVisible = false;
 
 	InputMode	mInputMode = InputMode::TEXT;
 	BorderMode  mBorderMode = BorderMode::LINE;
@@ -213,15 +220,15 @@ class CI_UI_API SliderBase : public Control {
 	float getMin() const	{ return mMin; }
 	float getMax() const	{ return mMax; }
 
-	void				setTitle( const std::string &title )	{ mTitle = title; }
+	void				setTitle( const std::string &title )	{ mTitle = title; setNeedsRedraw(); }
 	const std::string&	getTitle() const						{ return mTitle; }
 
 	float getValue() const	{ return mValue; }
 
 	void setValue( float value, bool emitChanged = true );
 
-	void setValueColor( const ci::ColorA &color )	{ mValueColor = color; }
-	void setTitleColor( const ci::ColorA &color )	{ mTitleColor = color; }
+	void setValueColor( const ci::ColorA &color )	{ mValueColor = color; setNeedsRedraw(); }
+	void setTitleColor( const ci::ColorA &color )	{ mTitleColor = color; setNeedsRedraw(); }
 
 	void setSnapToIntEnabled( bool enable )	{ mSnapToInt = enable; }
 	bool isSnapToIntEnabled() const			{ return mSnapToInt; }
@@ -281,19 +288,19 @@ class CI_UI_API SelectorBase : public Control {
 	const std::vector<std::string>&	getSegmentLabels() const			{ return mSegments; }
 	std::vector<std::string>&		getSegmentLabels()					{ return mSegments; }
 
-	void	setSegmentLabels( const std::vector<std::string> &segments )	{ mSegments = segments; }
+	void	setSegmentLabels( const std::vector<std::string> &segments )	{ mSegments = segments; setNeedsRedraw(); }
 
 	size_t				getSelectedIndex() const	{ return mSelectedIndex; }
 	const std::string&	getSelectedLabel() const;
 
 	const std::string&	getTitle() const						{ return mTitle; }
-	void				setTitle( const std::string &title )	{ mTitle = title; }
+	void				setTitle( const std::string &title )	{ mTitle = title; setNeedsRedraw(); }
 
-	void				setSelectedColor( const ci::ColorA &color )		{ mSelectedColor = color; }
+	void				setSelectedColor( const ci::ColorA &color )		{ mSelectedColor = color; setNeedsRedraw(); }
 	const ci::ColorA&	getSelectedColor() const						{ return mSelectedColor; }
-	void				setUnselectedColor( const ci::ColorA &color )	{ mUnselectedColor = color; }
+	void				setUnselectedColor( const ci::ColorA &color )	{ mUnselectedColor = color; setNeedsRedraw(); }
 	const ci::ColorA&	getUnselectedColor() const						{ return mUnselectedColor; }
-	void				setTitleColor( const ci::ColorA &color )		{ mTitleColor = color; }
+	void				setTitleColor( const ci::ColorA &color )		{ mTitleColor = color; setNeedsRedraw(); }
 	const ci::ColorA&	getTitleColor() const							{ return mTitleColor; }
 
 	//! Causes value changed signal to be fired if the selection changes.
@@ -350,8 +357,8 @@ class CI_UI_API NumberBox : public Control {
 
 	void setValue( float value, bool emitChanged = true );
 
-	void setBorderColor( const ci::ColorA &color )	{ mBorderColor = color; }
-	void setTitleColor( const ci::ColorA &color )	{ mTitleColor = color; }
+	void setBorderColor( const ci::ColorA &color )	{ mBorderColor = color; setNeedsRedraw(); }
+	void setTitleColor( const ci::ColorA &color )	{ mTitleColor = color; setNeedsRedraw(); }
 
 	void setSnapToIntEnabled( bool enable )	{ mSnapToInt = enable; }
 	bool isSnapToIntEnabled() const			{ return mSnapToInt; }
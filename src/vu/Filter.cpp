@@ -20,6 +20,7 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "vu/Filter.h"
+#include "vu/View.h"
 #include "cinder/CinderAssert.h"
 
 #include "cinder/gl/scoped.h"
@@ -174,6 +175,13 @@ Filter::~Filter()
 {
 }
 
+void Filter::setNeedsProcess()
+{
+	mVersion++;
+	if( mView )
+		mView->setNeedsRedraw();
+}
+
 void Filter::configure( const ivec2 &size, PassInfo *info )
 {
 	info->mSizes.resize( 1, size );
@@ -259,6 +267,7 @@ void FilterDropShadow::configure( const ci::ivec2 &size, vu::Filter::PassInfo *i
 void FilterDropShadow::setDownsampleFactor( float factor )
 {
 	mDownsampleFactor = glm::max( 1.0f, factor );
+	setNeedsProcess();
 	// TODO: need to mark the filter as needing to be re-configured
 }
 
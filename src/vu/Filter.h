@@ -31,6 +31,8 @@ typedef std::shared_ptr<class GlslProg> GlslProgRef;
 
 namespace vu {
 
+class View;
+
 typedef std::shared_ptr<class Filter>				FilterRef;
 typedef std::shared_ptr<class FilterBlur>			FilterBlurRef;
 typedef std::shared_ptr<class FilterDropShadow>		FilterDropShadowRef;
@@ -90,11 +92,18 @@ class CI_UI_API Filter {
 	ci::gl::TextureRef getRenderColorTexture() const;
 	ci::gl::TextureRef getPassColorTexture( size_t passIndex ) const;
 
+	//! Call when a parameter that affects process() changes, so that a Layer with a cached FrameBuffer processes this Filter again
+	//! and the View it was added to is redrawn, see View::setNeedsRedraw().
+	void	setNeedsProcess();
+
   private:
 	std::vector<Pass>	mPasses;
 	FrameBufferRef		mRenderFrameBuffer;
+	uint64_t			mVersion = 0;
+	View*				mView = nullptr; // the View this Filter was last added to, set by View::addFilter()
 
 	friend class Layer;
+	friend class View;
 };
 
 class CI_UI_API FilterBlur : public vu::Filter {
@@ -105,9 +114,9 @@ public:
 	void process( vu::Renderer *ren, const vu::Filter::Pass &frame ) override;
 
 	const ci::vec2&	getBlurPixels() const { return mBlurPixels; }
-	void			setBlurPixels( const ci::vec2 &pixels ) { mBlurPixels = pixels; }
+	void			setBlurPixels( const ci::vec2 &pixels ) { mBlurPixels = pixels; setNeedsProcess(); }
 
-	void	setGlslProg( const ci::gl::GlslProgRef &glsl )	{ mGlsl = glsl; }
+	void	setGlslProg( const ci::gl::GlslProgRef &glsl )	{ mGlsl = glsl; setNeedsProcess(); }
 
 private:
 	ci::gl::GlslProgRef	mGlsl;
@@ -122,16 +131,16 @@ public:
 	void configure( const ci::ivec2 &size, vu::Filter::PassInfo *info ) override;
 	void process( vu::Renderer *ren, const vu::Filter::Pass &frame ) override;
 
-	void			setBlurPixels( const ci::vec2 &pixels ) { mBlurPixels = pixels; }
+	void			setBlurPixels( const ci::vec2 &pixels ) { mBlurPixels = pixels; setNeedsProcess(); }
 	const ci::vec2&	getBlurPixels() const { return mBlurPixels; }
 
-	void			setShadowOffset( const ci::vec2 &pixels ) { mShadowOffset = pixels; }
+	void			setShadowOffset( const ci::vec2 &pixels ) { mShadowOffset = pixels; setNeedsProcess(); }
 	const ci::vec2&	getShadowOffset() const { return mShadowOffset; }
 
 	void			setDownsampleFactor( float factor );
 	float			getDownsampleFactor() const { return mDownsampleFactor; }
 
-	void	setGlslProg( const ci::gl::GlslProgRef &glsl ) { mGlsl = glsl; }
+	void	setGlslProg( const ci::gl::GlslProgRef &glsl ) { mGlsl = glsl; setNeedsProcess(); }
 
 private:
 	ci::gl::GlslProgRef	mGlsl;
@@ -0,0 +1,338 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/GlDevice.h"
+#include "vu/Renderer.h"
+#include "vu/TextManager.h"
+
+#include "cinder/gl/Batch.h"
+#include "cinder/gl/Context.h"
+#include "cinder/gl/wrapper.h"
+#include "cinder/gl/draw.h"
+#include "cinder/gl/scoped.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/VboMesh.h"
+#include "cinder/Log.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+const string FRAMEBUFFER_VERT = R"(
+#version 400
+
+uniform mat4 ciModelViewProjection;
+
+uniform vec2 uPositionOffset, uPositionScale;
+uniform vec2 uTexCoordOffset, uTexCoordScale;
+
+in vec4 ciPosition;
+in vec2 ciTexCoord0;
+in vec4 ciColor;
+
+out highp vec2 vTexCoord;
+out lowp vec4 vColor;
+
+void main()
+{
+//	gl_Position = ciModelViewProjection * ( vec4( uPositionOffset, 0, 0 ) + vec4( uPositionScale, 1, 1 ) * ciPosition );
+//	vTexCoord = uTexCoordOffset + uTexCoordScale * ciTexCoord0;
+
+	gl_Position = ciModelViewProjection * ciPosition;
+	vTexCoord = ciTexCoord0;
+	vColor = ciColor;
+}
+)";
+
+const string FRAMEBUFFER_FRAG = R"(
+#version 400
+
+uniform sampler2D uTex0;
+
+in vec2	vTexCoord;
+in vec4 vColor;
+
+out vec4 oFragColor;
+
+void main()
+{
+	oFragColor = texture( uTex0, vTexCoord.st ) * vColor;
+}
+)";
+
+} // anonymous namespace
+
+void CinderGlDevice::setColor( const ColorA &color )
+{
+	gl::color( color );
+}
+
+ColorA CinderGlDevice::getColor() const
+{
+	return gl::context()->getCurrentColor();
+}
+
+void CinderGlDevice::setBlendMode( BlendMode mode )
+{
+#if 0
+	switch( mode ) {
+		case BlendMode::ALPHA:
+			gl::enableAlphaBlending();
+		break;
+		case BlendMode::PREMULT_ALPHA:
+			gl::enableAlphaBlendingPremult();
+		break;
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+#else
+	auto ctx = gl::context();
+	ctx->enable( GL_BLEND );
+	switch( mode ) {
+		case BlendMode::ALPHA:
+			ctx->blendFuncSeparate( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+		break;
+		case BlendMode::PREMULT_ALPHA:
+			ctx->blendFuncSeparate( GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+		break;
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+#endif
+}
+
+void CinderGlDevice::pushScissor( const ivec2 &lowerLeft, const ivec2 &size )
+{
+	auto ctx = gl::context();
+	ctx->pushBoolState( GL_SCISSOR_TEST, GL_TRUE );
+	ctx->pushScissor( { lowerLeft, size } );
+}
+
+void CinderGlDevice::setScissor( const ivec2 &lowerLeft, const ivec2 &size )
+{
+	gl::context()->setScissor( { lowerLeft, size } );
+}
+
+void CinderGlDevice::popScissor()
+{
+	auto ctx = gl::context();
+	ctx->popBoolState( GL_SCISSOR_TEST );
+	ctx->popScissor();
+}
+
+void CinderGlDevice::pushViewport( const ivec2 &lowerLeft, const ivec2 &size )
+{
+	gl::pushViewport( lowerLeft, size );
+}
+
+void CinderGlDevice::popViewport()
+{
+	gl::popViewport();
+}
+
+void CinderGlDevice::pushDrawState( const RenderCommandList::DrawState &state )
+{
+	gl::pushModelMatrix();
+	gl::pushViewMatrix();
+	gl::pushProjectionMatrix();
+	gl::setModelMatrix( state.mModelMatrix );
+	gl::setViewMatrix( mat4() );
+	gl::setProjectionMatrix( state.mProjectionMatrix );
+
+	auto ctx = gl::context();
+	mDrawStateColorStack.push_back( ctx->getCurrentColor() );
+	ctx->setCurrentColor( state.mColor );
+}
+
+void CinderGlDevice::popDrawState()
+{
+	CI_ASSERT_MSG( ! mDrawStateColorStack.empty(), "DrawState stack underflow" );
+
+	gl::popModelMatrix();
+	gl::popViewMatrix();
+	gl::popProjectionMatrix();
+	gl::context()->setCurrentColor( mDrawStateColorStack.back() );
+	mDrawStateColorStack.pop_back();
+}
+
+uint32_t CinderGlDevice::getFrameBufferId( const FrameBuffer &frameBuffer )
+{
+	return frameBuffer.mFbo->getId();
+}
+
+uint32_t CinderGlDevice::getBoundFrameBufferId() const
+{
+	return gl::context()->getFramebuffer();
+}
+
+void CinderGlDevice::pushFrameBuffer( const FrameBuffer &frameBuffer )
+{
+	gl::context()->pushFramebuffer( frameBuffer.mFbo );
+}
+
+void CinderGlDevice::popFrameBuffer()
+{
+	gl::context()->popFramebuffer();
+}
+
+uint32_t CinderGlDevice::getProgramId( Program program )
+{
+	return getGlslProg( program )->getHandle();
+}
+
+void CinderGlDevice::bindProgram( Program program )
+{
+	gl::context()->bindGlslProg( getGlslProg( program ) );
+}
+
+uint32_t CinderGlDevice::getTextureId( const RenderCommandList::QuadTexture &texture )
+{
+	return getTexture( texture )->getId();
+}
+
+void CinderGlDevice::bindTexture( const RenderCommandList::QuadTexture &texture )
+{
+	gl::context()->bindTexture( GL_TEXTURE_2D, getTexture( texture )->getId(), 0 );
+}
+
+const gl::GlslProgRef& CinderGlDevice::getGlslProg( Program program )
+{
+	if( program == Program::QUADS ) {
+		if( ! mQuadBatch )
+			initQuadBatch();
+
+		return mQuadBatch->getGlslProg();
+	}
+
+	if( ! mGlslFrameBuffer ) {
+		try {
+			// TODO: add support for drawing partial textures
+//			mGlslFrameBuffer = gl::GlslProg::create( FRAMEBUFFER_VERT, FRAMEBUFFER_FRAG );
+			mGlslFrameBuffer = gl::getStockShader( gl::ShaderDef().texture().color() );
+			CI_LOG_I( "loaded mGlslFrameBuffer" );
+		}
+		catch( Exception &exc ) {
+			CI_LOG_EXCEPTION( "failed to load mGlslFrameBuffer", exc );
+		}
+	}
+
+	return mGlslFrameBuffer;
+}
+
+const gl::TextureRef& CinderGlDevice::getTexture( const RenderCommandList::QuadTexture &texture )
+{
+	if( texture.mTexture )
+		return texture.mTexture;
+
+	if( ! mQuadBatch )
+		initQuadBatch();
+
+	return mWhiteTexture;
+}
+
+void CinderGlDevice::initQuadBatch()
+{
+	const size_t maxQuads = Renderer::MAX_QUADS_PER_BATCH;
+
+	// The indices never change, each quad is two triangles
+	vector<uint16_t> indices;
+	indices.reserve( maxQuads * 6 );
+	for( size_t i = 0; i < maxQuads * 4; i += 4 ) {
+		const uint16_t index = (uint16_t)i;
+		indices.insert( indices.end(), { index, uint16_t( index + 1 ), uint16_t( index + 2 ), index, uint16_t( index + 2 ), uint16_t( index + 3 ) } );
+	}
+
+	auto indexVbo = gl::Vbo::create( GL_ELEMENT_ARRAY_BUFFER, indices, GL_STATIC_DRAW );
+	mQuadVbo = gl::Vbo::create( GL_ARRAY_BUFFER, maxQuads * 4 * sizeof( QuadVertex ), nullptr, GL_STREAM_DRAW );
+
+	geom::BufferLayout layout;
+	layout.append( geom::Attrib::POSITION, 4, sizeof( QuadVertex ), offsetof( QuadVertex, mPosition ) );
+	layout.append( geom::Attrib::TEX_COORD_0, 2, sizeof( QuadVertex ), offsetof( QuadVertex, mTexCoord ) );
+	layout.append( geom::Attrib::COLOR, 4, sizeof( QuadVertex ), offsetof( QuadVertex, mColor ) );
+
+	auto mesh = gl::VboMesh::create( uint32_t( maxQuads * 4 ), GL_TRIANGLES, { { layout, mQuadVbo } }, uint32_t( maxQuads * 6 ), GL_UNSIGNED_SHORT, indexVbo );
+	mQuadBatch = gl::Batch::create( mesh, gl::getStockShader( gl::ShaderDef().color().texture() ) );
+
+	// solid quads sample a white texel, so that they share the shader with images and batch with each other
+	const uint8_t white[] = { 255, 255, 255, 255 };
+	mWhiteTexture = gl::Texture2d::create( white, GL_RGBA, 1, 1 );
+}
+
+void CinderGlDevice::drawQuads( const QuadVertex *vertices, size_t numQuads )
+{
+	CI_ASSERT( numQuads <= Renderer::MAX_QUADS_PER_BATCH );
+
+	if( ! mQuadBatch )
+		initQuadBatch();
+
+	// orphan the previous contents first, so that the driver doesn't wait for the last batch to finish drawing
+	mQuadVbo->bufferData( mQuadVbo->getSize(), nullptr, GL_STREAM_DRAW );
+	mQuadVbo->bufferSubData( 0, numQuads * 4 * sizeof( QuadVertex ), vertices );
+
+	// the vertices are already in clip space
+	gl::ScopedModelMatrix modelScope;
+	gl::ScopedViewMatrix viewScope;
+	gl::ScopedProjectionMatrix projectionScope;
+	gl::setModelMatrix( mat4() );
+	gl::setViewMatrix( mat4() );
+	gl::setProjectionMatrix( mat4() );
+
+	mQuadBatch->draw( 0, GLsizei( numQuads * 6 ) );
+}
+
+void CinderGlDevice::drawFrameBuffer( const FrameBuffer &frameBuffer, const Rectf &destRect )
+{
+	gl::ScopedTextureBind texScope( frameBuffer.getColorTexture() );
+	gl::drawSolidRect( destRect );
+}
+
+void CinderGlDevice::drawFrameBufferArea( const FrameBuffer &frameBuffer, const Area &sourceArea, const Rectf &destRect )
+{
+	gl::draw( frameBuffer.getColorTexture(), sourceArea, destRect );
+}
+
+void CinderGlDevice::drawString( const TextRef &text, const string &str, const vec2 &baseline )
+{
+	text->drawString( str, baseline );
+}
+
+void CinderGlDevice::drawStringWrapped( const TextRef &text, const string &str, const Rectf &fitRect )
+{
+	text->drawStringWrapped( str, fitRect );
+}
+
+void CinderGlDevice::drawCallback( const function<void ()> &fn )
+{
+	fn();
+}
+
+void CinderGlDevice::clear( const ColorA &color )
+{
+	gl::clear( color );
+}
+
+} // namespace vu
@@ -0,0 +1,156 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/Export.h"
+#include "vu/RenderCommandList.h"
+
+#include "cinder/Area.h"
+#include "cinder/Color.h"
+#include "cinder/Rect.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class Batch>		BatchRef;
+typedef std::shared_ptr<class GlslProg>     GlslProgRef;
+typedef std::shared_ptr<class Vbo>			VboRef;
+
+} } // namespace cinder::gl
+
+namespace vu {
+
+typedef std::shared_ptr<class GlDevice>	GlDeviceRef;
+
+class FrameBuffer;
+
+//! Issues the gl calls that the Renderer decides on when drawing, see Renderer::setGlDevice(). The Renderer batches quads and checks every state change
+//! against its GlStateCache first, a GlDevice only carries out what is left. Ids identify the gl objects to the GlStateCache, they are the gl names in CinderGlDevice.
+class CI_UI_API GlDevice {
+  public:
+	//! The GlslProgs that the Renderer binds.
+	enum class Program {
+		QUADS,			//! draws batched quads, which are in clip space and sample the bound texture
+		FRAMEBUFFER		//! draws a whole FrameBuffer's color texture
+	};
+
+	virtual ~GlDevice()	{}
+
+	//! Returns whether this device draws with gl. If not, Graphs record their drawing and submit it, and new FrameBuffers have no gl::Fbo.
+	virtual bool	usesGl() const	{ return true; }
+
+	virtual void		setColor( const ci::ColorA &color ) = 0;
+	//! Returns the current color, used when the Renderer's GlStateCache doesn't know it.
+	virtual ci::ColorA	getColor() const = 0;
+	virtual void		setBlendMode( BlendMode mode ) = 0;
+
+	//! Enables the scissor test with the box \a lowerLeft, \a size, storing the previous scissor state for popScissor().
+	virtual void	pushScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) = 0;
+	//! Changes the scissor box that the last pushScissor() set.
+	virtual void	setScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) = 0;
+	//! Restores the scissor state from before the last pushScissor().
+	virtual void	popScissor() = 0;
+	virtual void	pushViewport( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) = 0;
+	virtual void	popViewport() = 0;
+	//! Makes the matrices and color of \a state current, storing the previous ones for popDrawState().
+	virtual void	pushDrawState( const RenderCommandList::DrawState &state ) = 0;
+	virtual void	popDrawState() = 0;
+
+	//! Returns the id of the framebuffer that \a frameBuffer renders to.
+	virtual uint32_t	getFrameBufferId( const FrameBuffer &frameBuffer ) = 0;
+	//! Returns the id of the framebuffer that is bound, the window's if no FrameBuffer is.
+	virtual uint32_t	getBoundFrameBufferId() const = 0;
+	virtual void		pushFrameBuffer( const FrameBuffer &frameBuffer ) = 0;
+	virtual void		popFrameBuffer() = 0;
+
+	virtual uint32_t	getProgramId( Program program ) = 0;
+	virtual void		bindProgram( Program program ) = 0;
+	//! Returns the id of the texture that quads with \a texture sample, a white texture if it is empty.
+	virtual uint32_t	getTextureId( const RenderCommandList::QuadTexture &texture ) = 0;
+	//! Binds the texture that quads with \a texture sample to the first texture unit, a white texture if it is empty.
+	virtual void		bindTexture( const RenderCommandList::QuadTexture &texture ) = 0;
+
+	//! Draws \a numQuads quads, four vertices each, with the bound GlslProg and texture.
+	virtual void	drawQuads( const QuadVertex *vertices, size_t numQuads ) = 0;
+	//! Draws the whole of \a frameBuffer into \a destRect with the bound GlslProg, which is Program::FRAMEBUFFER.
+	virtual void	drawFrameBuffer( const FrameBuffer &frameBuffer, const ci::Rectf &destRect ) = 0;
+	//! Draws \a sourceArea of \a frameBuffer into \a destRect with a GlslProg of its own, leaving the bound one as it was.
+	virtual void	drawFrameBufferArea( const FrameBuffer &frameBuffer, const ci::Area &sourceArea, const ci::Rectf &destRect ) = 0;
+	virtual void	drawString( const TextRef &text, const std::string &str, const ci::vec2 &baseline ) = 0;
+	virtual void	drawStringWrapped( const TextRef &text, const std::string &str, const ci::Rectf &fitRect ) = 0;
+	//! Calls \a fn, which draws with ci::gl directly.
+	virtual void	drawCallback( const std::function<void ()> &fn ) = 0;
+	virtual void	clear( const ci::ColorA &color ) = 0;
+};
+
+//! The GlDevice that Renderers draw with by default, which issues everything with ci::gl.
+class CI_UI_API CinderGlDevice : public GlDevice {
+  public:
+	void		setColor( const ci::ColorA &color ) override;
+	ci::ColorA	getColor() const override;
+	void		setBlendMode( BlendMode mode ) override;
+
+	void	pushScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override;
+	void	setScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override;
+	void	popScissor() override;
+	void	pushViewport( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override;
+	void	popViewport() override;
+	void	pushDrawState( const RenderCommandList::DrawState &state ) override;
+	void	popDrawState() override;
+
+	uint32_t	getFrameBufferId( const FrameBuffer &frameBuffer ) override;
+	uint32_t	getBoundFrameBufferId() const override;
+	void		pushFrameBuffer( const FrameBuffer &frameBuffer ) override;
+	void		popFrameBuffer() override;
+
+	uint32_t	getProgramId( Program program ) override;
+	void		bindProgram( Program program ) override;
+	uint32_t	getTextureId( const RenderCommandList::QuadTexture &texture ) override;
+	void		bindTexture( const RenderCommandList::QuadTexture &texture ) override;
+
+	void	drawQuads( const QuadVertex *vertices, size_t numQuads ) override;
+	void	drawFrameBuffer( const FrameBuffer &frameBuffer, const ci::Rectf &destRect ) override;
+	void	drawFrameBufferArea( const FrameBuffer &frameBuffer, const ci::Area &sourceArea, const ci::Rectf &destRect ) override;
+	void	drawString( const TextRef &text, const std::string &str, const ci::vec2 &baseline ) override;
+	void	drawStringWrapped( const TextRef &text, const std::string &str, const ci::Rectf &fitRect ) override;
+	void	drawCallback( const std::function<void ()> &fn ) override;
+	void	clear( const ci::ColorA &color ) override;
+
+  private:
+	void						initQuadBatch();
+	const ci::gl::GlslProgRef&	getGlslProg( Program program );
+	const ci::gl::TextureRef&	getTexture( const RenderCommandList::QuadTexture &texture );
+
+	ci::gl::GlslProgRef		mGlslFrameBuffer;
+	ci::gl::TextureRef		mWhiteTexture;
+	ci::gl::VboRef			mQuadVbo;
+	ci::gl::BatchRef		mQuadBatch;
+	std::vector<ci::ColorA>	mDrawStateColorStack; // colors from before each pushDrawState()
+};
+
+} // namespace vu
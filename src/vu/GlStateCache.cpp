@@ -0,0 +1,153 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/GlStateCache.h"
+#include "vu/Renderer.h"
+
+#include "cinder/CinderAssert.h"
+
+#include <numeric>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+GlStateCache::GlStateCache()
+	: mBlendMode( BlendMode::ALPHA )
+{
+	invalidate();
+	resetCounters();
+}
+
+bool GlStateCache::change( State state, bool differs )
+{
+	const size_t index = size_t( state );
+	if( mKnown[index] && ! differs ) {
+		mNumElided[index]++;
+		return false;
+	}
+
+	mKnown[index] = true;
+	mNumIssued[index]++;
+	return true;
+}
+
+bool GlStateCache::setBlendMode( BlendMode mode )
+{
+	const bool issue = change( State::BLEND, mode != mBlendMode );
+	mBlendMode = mode;
+	return issue;
+}
+
+bool GlStateCache::setColor( const ColorA &color )
+{
+	const bool issue = change( State::COLOR, color != mColor );
+	mColor = color;
+	return issue;
+}
+
+bool GlStateCache::setScissor( bool enabled, const ivec2 &lowerLeft, const ivec2 &size )
+{
+	// the box doesn't matter while the scissor test is disabled
+	const bool differs = enabled != mScissorEnabled || ( enabled && ( lowerLeft != mScissorLowerLeft || size != mScissorSize ) );
+	const bool issue = change( State::SCISSOR, differs );
+	mScissorEnabled = enabled;
+	mScissorLowerLeft = enabled ? lowerLeft : ivec2();
+	mScissorSize = enabled ? size : ivec2();
+	return issue;
+}
+
+bool GlStateCache::setFrameBuffer( uint32_t id )
+{
+	const bool issue = change( State::FRAMEBUFFER, id != mFrameBufferId );
+	mFrameBufferId = id;
+	return issue;
+}
+
+bool GlStateCache::setProgram( uint32_t id )
+{
+	const bool issue = change( State::PROGRAM, id != mProgramId );
+	mProgramId = id;
+	return issue;
+}
+
+bool GlStateCache::setTexture( uint32_t id )
+{
+	const bool issue = change( State::TEXTURE, id != mTextureId );
+	mTextureId = id;
+	return issue;
+}
+
+void GlStateCache::invalidate()
+{
+	mKnown.fill( false );
+}
+
+size_t GlStateCache::getNumIssued() const
+{
+	return accumulate( mNumIssued.begin(), mNumIssued.end(), size_t( 0 ) );
+}
+
+size_t GlStateCache::getNumElided() const
+{
+	return accumulate( mNumElided.begin(), mNumElided.end(), size_t( 0 ) );
+}
+
+void GlStateCache::resetCounters()
+{
+	mNumIssued.fill( 0 );
+	mNumElided.fill( 0 );
+}
+
+string GlStateCache::printCountersToString() const
+{
+	stringstream s;
+	for( size_t i = 0; i < size_t( State::NUM_STATES ); i++ ) {
+		if( i > 0 )
+			s << ", ";
+
+		s << getStateName( State( i ) ) << ": " << mNumIssued[i] << " issued, " << mNumElided[i] << " elided";
+	}
+
+	return s.str();
+}
+
+// static
+const char* GlStateCache::getStateName( State state )
+{
+	switch( state ) {
+		case State::BLEND:			return "BLEND";
+		case State::COLOR:			return "COLOR";
+		case State::SCISSOR:		return "SCISSOR";
+		case State::FRAMEBUFFER:	return "FRAMEBUFFER";
+		case State::PROGRAM:		return "PROGRAM";
+		case State::TEXTURE:		return "TEXTURE";
+		default:					CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return "";
+}
+
+} // namespace vu
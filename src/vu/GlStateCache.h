@@ -0,0 +1,111 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/Color.h"
+#include "cinder/Vector.h"
+
+#include <array>
+#include <string>
+
+namespace vu {
+
+enum class BlendMode;
+
+//! Shadows the gl state that the Renderer controls, so that changes to the value that is already current can be skipped. It doesn't use gl itself,
+//! each set method returns whether the change needs to be issued and then holds the new value. Issued and elided changes are counted per kind of state.
+class CI_UI_API GlStateCache {
+  public:
+	enum class State : uint8_t {
+		BLEND,			//! GL_BLEND and the blend function, as a BlendMode
+		COLOR,			//! the current color
+		SCISSOR,		//! GL_SCISSOR_TEST and the scissor box
+		FRAMEBUFFER,	//! the bound draw framebuffer
+		PROGRAM,		//! the bound GlslProg
+		TEXTURE,		//! the texture bound to the first texture unit
+		NUM_STATES
+	};
+
+	GlStateCache();
+
+	//! Returns whether \a mode differs from the current BlendMode and needs to be issued.
+	bool setBlendMode( BlendMode mode );
+	//! Returns whether \a color differs from the current color and needs to be issued.
+	bool setColor( const ci::ColorA &color );
+	//! Returns whether the scissor test or box differ and need to be issued. The box is ignored when \a enabled is false.
+	bool setScissor( bool enabled, const ci::ivec2 &lowerLeft = ci::ivec2(), const ci::ivec2 &size = ci::ivec2() );
+	//! Returns whether the framebuffer with \a id isn't bound yet.
+	bool setFrameBuffer( uint32_t id );
+	//! Returns whether the GlslProg with \a id isn't bound yet.
+	bool setProgram( uint32_t id );
+	//! Returns whether the texture with \a id isn't bound yet.
+	bool setTexture( uint32_t id );
+
+	//! Returns whether the current value of \a state is known, which is false until it is set after construction or invalidate().
+	bool			isKnown( State state ) const		{ return mKnown[size_t( state )]; }
+	//! Returns the current color, only meaningful if isKnown( State::COLOR ).
+	const ci::ColorA&	getColor() const				{ return mColor; }
+
+	//! Forgets all current values, so that the next change to each is issued. Needed after gl has been used without going through the cache.
+	void invalidate();
+	//! Forgets the current value of \a state.
+	void invalidate( State state )						{ mKnown[size_t( state )] = false; }
+
+	//! Returns the number of changes to \a state that needed to be issued.
+	size_t	getNumIssued( State state ) const			{ return mNumIssued[size_t( state )]; }
+	//! Returns the number of changes to \a state that were skipped because the value was already current.
+	size_t	getNumElided( State state ) const			{ return mNumElided[size_t( state )]; }
+	//! Returns the number of issued changes to all states.
+	size_t	getNumIssued() const;
+	//! Returns the number of elided changes to all states.
+	size_t	getNumElided() const;
+	//! Sets all issued and elided counts to zero.
+	void	resetCounters();
+
+	//! Returns the issued and elided counts of each state, ex. for logging.
+	std::string printCountersToString() const;
+
+	//! Returns the name of \a state, ex. "BLEND".
+	static const char*	getStateName( State state );
+
+  private:
+	//! Counts the change and updates the known flag, returns whether it needs to be issued.
+	bool	change( State state, bool differs );
+
+	std::array<bool, size_t( State::NUM_STATES )>	mKnown;
+	std::array<size_t, size_t( State::NUM_STATES )>	mNumIssued;
+	std::array<size_t, size_t( State::NUM_STATES )>	mNumElided;
+
+	BlendMode	mBlendMode;
+	ci::ColorA	mColor;
+	bool		mScissorEnabled = false;
+	ci::ivec2	mScissorLowerLeft, mScissorSize;
+	uint32_t	mFrameBufferId = 0;
+	uint32_t	mProgramId = 0;
+	uint32_t	mTextureId = 0;
+};
+
+} // namespace vu
@@ -24,13 +24,56 @@
 #include "vu/Graph.h"
 
 #include "cinder/app/AppBase.h"
+#include "cinder/gl/gl.h"
 #include "vu/Debug.h"
 
+#include <chrono>
+#include <limits>
+
 using namespace ci;
 using namespace std;
 
 namespace vu {
 
+namespace {
+
+// Subview bounds are expanded by this much when batch testing touches, so that rounding differences never reject a touch that View::isPointInside() would accept.
+const float BATCH_BOUNDS_EPSILON = 0.001f;
+
+//! Adds the wall time of its scope to \a seconds. Does nothing if \a seconds is null or another phase is already being timed (tracked by \a timing).
+class ScopedFrameStatsTimer {
+  public:
+	ScopedFrameStatsTimer( double *seconds, bool *timing )
+		: mSeconds( seconds && ! *timing ? seconds : nullptr ), mTiming( timing )
+	{
+		if( mSeconds ) {
+			*mTiming = true;
+			mStart = chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedFrameStatsTimer()
+	{
+		if( mSeconds ) {
+			*mSeconds += chrono::duration<double>( chrono::steady_clock::now() - mStart ).count();
+			*mTiming = false;
+		}
+	}
+
+  private:
+	double*		mSeconds;
+	bool*		mTiming;
+	chrono::steady_clock::time_point	mStart;
+};
+
+//! Returns a copy of \a touch without its native pointer, which is only valid while the Window's signal is being emitted.
+app::TouchEvent::Touch copyTouch( const app::TouchEvent::Touch &touch )
+{
+	return app::TouchEvent::Touch( touch.getPos(), touch.getPrevPos(), touch.getId(), touch.getTime(), nullptr );
+}
+
+} // anonymous namespace
+
 Graph::Graph( const ci::app::WindowRef &window )
 	: mWindow( window )
 {
@@ -53,6 +96,18 @@ Graph::Graph( const ci::app::WindowRef &window )
 	mRenderer = make_shared<vu::Renderer>();
 }
 
+Graph::Graph( const ivec2 &size, const function<double ()> &timeSource, const RendererRef &renderer )
+	: mRenderer( renderer ), mTimeSource( timeSource ), mHeadlessTimer( true )
+{
+	mGraph = this;
+
+	// The Graph always gets a Layer because it is root.
+	mLayer = makeLayer( this );
+
+	setBounds( Rectf( vec2( 0 ), vec2( size ) ) );
+	setClippingSize( size );
+}
+
 Graph::~Graph()
 {
 }
@@ -88,26 +143,50 @@ void Graph::setClippingSize( const ci::ivec2 &size )
 //! Returns the size used for clipping operations in pixel coordinates. Defaults to the size of the window
 ci::ivec2 Graph::getClippingSize() const
 {
-	return ( mClippingSizeSet ? mClippingSize : mWindow->toPixels( mWindow->getSize() ) );
+	return ( mClippingSizeSet || ! mWindow ? mClippingSize : mWindow->toPixels( mWindow->getSize() ) );
 }
 
 void Graph::layout()
 {
-	if( isFillParentEnabled() ) {
+	if( isFillParentEnabled() && mWindow ) {
 		setSize( mWindow->toPixels( mWindow->getSize() ) );
 	}
 }
 
 void Graph::propagateUpdate()
 {
+	// if the last frame wasn't drawn (ex. running headless), it ends here instead
+	if( mFrameStats && mFrameStatsUpdated )
+		finishFrameStats();
+
+	ScopedFrameStatsTimer statsTimer( mFrameStats ? &mFrameStats->mUpdateSeconds : nullptr, &mFrameStatsTiming );
+
 	// TODO: see note in Time section on allowing this to be customized.
-	mCurrentTime = app::getElapsedSeconds();
-	mCurrentFrame = app::getElapsedFrames();
+	mCurrentTime = sampleTime();
+	mCurrentFrame = mWindow ? app::getElapsedFrames() : mCurrentFrame + 1;
+
+	if( mFrameStats ) {
+		mFrameStats->mFrame = mCurrentFrame;
+		mFrameStatsUpdated = true;
+	}
+
+	mAnimator.update( mCurrentTime );
+
+	dispatchInjectedInput();
+	dispatchQueuedTouchEvents();
+
+	// completed loads set their Images on Views before they are updated
+	if( mImageLoader ) {
+		const size_t numImagesUploaded = mImageLoader->update();
+		if( mFrameStats )
+			mFrameStats->mNumImagesUploaded += numImagesUploaded;
+	}
 
 	// Check if views should release their intercepting touches
 	// - if yes, will allow subviews a chance at touchesBegan()
 	for( auto viewIt = mViewsWithTouches.begin(); viewIt != mViewsWithTouches.end(); /* */ ) {
 		const auto &view = *viewIt;
+		view->wake(); // touched Views are kept awake even if their touches aren't moving
 		if( ! view->mInterceptedTouchEvent.getTouches().empty() ) {
 			UI_LOG_TOUCHES( view->getName() << " | updating intercepted touch" );
 			if( handleInterceptingTouches( view, false ) ) {
@@ -116,6 +195,7 @@ void Graph::propagateUpdate()
 				view->mInterceptedTouchEvent = {};
 				view->mActiveTouches.clear(); // TODO (intercept): only clear touches that have been marked as handled (either by this view or the next one in line)
 				viewIt = mViewsWithTouches.erase( viewIt ); // TODO (intercept): consider marking for removal and erasing later
+				mTouchRoutesDirty = true;
 				continue;
 			}
 		}
@@ -126,6 +206,9 @@ void Graph::propagateUpdate()
 	// Update the Layer tree, starting with the root
 	mLayer->update();
 
+	if( mTransformHierarchy )
+		mTransformHierarchy->update( this );
+
 	// Remove Layers marked for removal
 	for( auto layerIt = mLayers.begin(); layerIt != mLayers.end(); /* */ ) {
 		auto &layer = *layerIt;
@@ -140,19 +223,185 @@ void Graph::propagateUpdate()
 	}
 
 	// Remove Views marked for removal
-	mViewsWithTouches.erase(
-			remove_if( mViewsWithTouches.begin(), mViewsWithTouches.end(),
-			           []( const ViewRef &view ) {
-				           return view->mMarkedForRemoval || view->mActiveTouches.empty();
-			           } ),
-			mViewsWithTouches.end() );
+	auto removedIt = remove_if( mViewsWithTouches.begin(), mViewsWithTouches.end(),
+	                            []( const ViewRef &view ) {
+		                            return view->mMarkedForRemoval || view->mActiveTouches.empty();
+	                            } );
+	if( removedIt != mViewsWithTouches.end() ) {
+		mViewsWithTouches.erase( removedIt, mViewsWithTouches.end() );
+		mTouchRoutesDirty = true;
+	}
 }
 
 void Graph::propagateDraw()
 {
 	CI_ASSERT( getLayer() );
 
-	mLayer->draw( mRenderer.get() );
+	// the last recorded frame can only be submitted again if nothing has asked for a redraw since
+	const bool reuseAllowed = ! needsRedraw();
+
+	// this frame satisfies all redraw requests made so far, including a timed request that has been reached
+	mNeedsRedraw = false;
+	if( mCurrentTime >= mRedrawTime )
+		mRedrawTime = numeric_limits<double>::infinity();
+
+	if( ! mRenderer ) {
+		if( mFrameStats )
+			finishFrameStats();
+
+		return;
+	}
+
+	// Views are culled against the clipping size, which is the area of the window that the Graph draws to
+	const Rectf cullBounds = Rectf( vec2( 0 ), vec2( getClippingSize() ) );
+
+	if( ! mFrameStats ) {
+		drawFrame( cullBounds, reuseAllowed );
+		return;
+	}
+
+	const size_t numFrameBuffersCreated = mRenderer->getNumFrameBuffersCreated();
+	const size_t numFrameBuffersResized = mRenderer->getNumFrameBuffersResized();
+	const size_t numFrameBuffersReused = mRenderer->getNumFrameBuffersReused();
+	const size_t numFrameBuffersEvicted = mRenderer->getNumFrameBuffersEvicted();
+	const size_t numDrawCalls = mRenderer->getNumDrawCalls();
+	const size_t numBatches = mRenderer->getNumBatches();
+	const size_t numQuadsBatched = mRenderer->getNumQuadsBatched();
+	const size_t numStateChangesIssued = mRenderer->getStateCache().getNumIssued();
+	const size_t numStateChangesElided = mRenderer->getStateCache().getNumElided();
+	const size_t numTextureBinds = mRenderer->getStateCache().getNumIssued( GlStateCache::State::TEXTURE );
+
+	{
+		ScopedFrameStatsTimer statsTimer( &mFrameStats->mDrawSeconds, &mFrameStatsTiming );
+		drawFrame( cullBounds, reuseAllowed );
+	}
+
+	mFrameStats->mNumFrameBuffersCreated += mRenderer->getNumFrameBuffersCreated() - numFrameBuffersCreated;
+	mFrameStats->mNumFrameBuffersResized += mRenderer->getNumFrameBuffersResized() - numFrameBuffersResized;
+	mFrameStats->mNumFrameBuffersReused += mRenderer->getNumFrameBuffersReused() - numFrameBuffersReused;
+	mFrameStats->mNumFrameBuffersEvicted += mRenderer->getNumFrameBuffersEvicted() - numFrameBuffersEvicted;
+	mFrameStats->mNumDrawCalls += mRenderer->getNumDrawCalls() - numDrawCalls;
+	mFrameStats->mNumBatches += mRenderer->getNumBatches() - numBatches;
+	mFrameStats->mNumQuadsBatched += mRenderer->getNumQuadsBatched() - numQuadsBatched;
+	mFrameStats->mNumStateChangesIssued += mRenderer->getStateCache().getNumIssued() - numStateChangesIssued;
+	mFrameStats->mNumStateChangesElided += mRenderer->getStateCache().getNumElided() - numStateChangesElided;
+	mFrameStats->mNumTextureBinds += mRenderer->getStateCache().getNumIssued( GlStateCache::State::TEXTURE ) - numTextureBinds;
+	if( mDrawRecordingEnabled ) {
+		mFrameStats->mNumRenderCommands += mRenderCommands.getCommands().size();
+		if( mRenderCommandsReused )
+			mFrameStats->mNumRenderCommandsReused += mRenderCommands.getCommands().size();
+	}
+
+	finishFrameStats();
+}
+
+void Graph::drawFrame( const Rectf &cullBounds, bool reuseAllowed )
+{
+	// the app may have used gl since the last frame
+	mRenderer->invalidateState();
+
+	// a RenderBackend, or a GlDevice that doesn't use gl, can only draw what has been recorded
+	const bool useGl = mRenderer->isDrawingWithGl();
+	if( ! mDrawRecordingEnabled && useGl ) {
+		mRenderer->beginFrame();
+		mLayer->draw( mRenderer.get(), cullBounds );
+		mRenderer->flush();
+		return;
+	}
+
+	// without gl, the Graph draws to the backend's output with window matrices
+	const ivec2 clippingSize = getClippingSize();
+	const mat4 modelMatrix = useGl ? gl::getModelMatrix() : mat4();
+	const mat4 projectionMatrix = useGl ? gl::getProjectionMatrix() * gl::getViewMatrix() : glm::ortho( 0.0f, (float)clippingSize.x, (float)clippingSize.y, 0.0f, -1.0f, 1.0f );
+
+	mRenderCommandsReused = reuseAllowed && ! mRenderCommands.empty() && cullBounds == mRecordedCullBounds
+		&& modelMatrix == mRecordedModelMatrix && projectionMatrix == mRecordedProjectionMatrix;
+
+	// submitting the same commands again doesn't start a frame, as their FrameBuffers must stay valid
+	if( ! mRenderCommandsReused ) {
+		mRenderer->beginFrame();
+		mRenderer->beginRecording( &mRenderCommands, modelMatrix, projectionMatrix );
+		mLayer->draw( mRenderer.get(), cullBounds );
+		mRenderer->endRecording();
+		mRenderCommands.optimize();
+
+		mRecordedCullBounds = cullBounds;
+		mRecordedModelMatrix = modelMatrix;
+		mRecordedProjectionMatrix = projectionMatrix;
+	}
+
+	mRenderer->submit( mRenderCommands );
+}
+
+void Graph::setDrawRecordingEnabled( bool enable )
+{
+	mDrawRecordingEnabled = enable;
+	mRenderCommands.clear();
+	mRenderCommandsReused = false;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Frame Stats
+// ----------------------------------------------------------------------------------------------------
+
+void Graph::setFrameStatsEnabled( bool enable, size_t historySize )
+{
+	if( ! enable ) {
+		mFrameStats = nullptr;
+		mFrameStatsHistory.clear();
+		mFrameStatsHistoryNext = 0;
+		mNumFrameStats = 0;
+		mFrameStatsUpdated = false;
+		return;
+	}
+
+	CI_ASSERT( historySize > 0 );
+
+	if( ! mFrameStats ) {
+		mCurrentFrameStats = FrameStats();
+		mFrameStats = &mCurrentFrameStats;
+	}
+
+	if( mFrameStatsHistory.size() != historySize ) {
+		mFrameStatsHistory.assign( historySize, FrameStats() );
+		mFrameStatsHistoryNext = 0;
+		mNumFrameStats = 0;
+	}
+}
+
+const Graph::FrameStats& Graph::getFrameStats( size_t framesAgo ) const
+{
+	static const FrameStats sEmpty;
+	if( framesAgo >= mNumFrameStats )
+		return sEmpty;
+
+	const size_t historySize = mFrameStatsHistory.size();
+	return mFrameStatsHistory[( mFrameStatsHistoryNext + historySize - 1 - framesAgo ) % historySize];
+}
+
+void Graph::finishFrameStats()
+{
+	CI_ASSERT( mFrameStats && ! mFrameStatsHistory.empty() );
+
+	mFrameStatsHistory[mFrameStatsHistoryNext] = *mFrameStats;
+	mFrameStatsHistoryNext = ( mFrameStatsHistoryNext + 1 ) % mFrameStatsHistory.size();
+	mNumFrameStats = std::min( mNumFrameStats + 1, mFrameStatsHistory.size() );
+
+	*mFrameStats = FrameStats();
+	mFrameStatsUpdated = false;
+}
+
+ostream& operator<<( ostream &os, const Graph::FrameStats &rhs )
+{
+	os << "frame: " << rhs.mFrame << ", views updated: " << rhs.mNumViewsUpdated << ", views drawn: " << rhs.mNumViewsDrawn << ", views culled: " << rhs.mNumViewsCulled << ", views asleep: " << rhs.mNumViewsAsleep << ", layouts: " << rhs.mNumLayouts
+		<< ", layers composited: " << rhs.mNumLayersComposited << ", layer cache hits: " << rhs.mNumLayerCacheHits << ", layer cache mismatches: " << rhs.mNumLayerCacheMismatches << ", FrameBuffers created: " << rhs.mNumFrameBuffersCreated << ", resized: " << rhs.mNumFrameBuffersResized
+		<< ", reused: " << rhs.mNumFrameBuffersReused << ", evicted: " << rhs.mNumFrameBuffersEvicted << ", filter passes: " << rhs.mNumFilterPasses << ", draw calls: " << rhs.mNumDrawCalls << ", batches: " << rhs.mNumBatches << ", quads batched: " << rhs.mNumQuadsBatched
+		<< ", render commands: " << rhs.mNumRenderCommands << ", reused: " << rhs.mNumRenderCommandsReused
+		<< ", state changes issued: " << rhs.mNumStateChangesIssued << ", elided: " << rhs.mNumStateChangesElided << ", texture binds: " << rhs.mNumTextureBinds
+		<< ", touch events: " << rhs.mNumTouchEvents << ", images uploaded: " << rhs.mNumImagesUploaded << ", input ms: " << rhs.mInputSeconds * 1000.0 << ", update ms: " << rhs.mUpdateSeconds * 1000.0
+		<< ", draw ms: " << rhs.mDrawSeconds * 1000.0;
+
+	return os;
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -164,7 +413,7 @@ void Graph::propagateDraw()
 
 double Graph::getTargetFrameRate() const
 {
-	return app::getFrameRate();
+	return mWindow ? app::getFrameRate() : mTargetFrameRate;
 }
 
 size_t Graph::getCurrentFrame() const
@@ -177,30 +426,49 @@ double Graph::getCurrentTime() const
 	return mCurrentTime;
 }
 
+bool Graph::needsRedraw() const
+{
+	return mNeedsRedraw || mAnimator.isAnimating() || mCurrentTime >= mRedrawTime;
+}
+
+double Graph::sampleTime() const
+{
+	if( mTimeSource )
+		return mTimeSource();
+
+	return app::AppBase::get() ? app::getElapsedSeconds() : mHeadlessTimer.getSeconds();
+}
+
 // ----------------------------------------------------------------------------------------------------
 // Events
 // ----------------------------------------------------------------------------------------------------
 
 void Graph::connectEvents( const EventOptions &options )
 {
+	if( ! mWindow )
+		throw GraphExc( "No app::Window to connect events to, Graph was created headless" );
+
 	mEventSlotPriority = options.mPriority;
 	mEventConnections.clear();
 
 	if( options.mMouse ) {
 		mEventConnections += mWindow->getSignalMouseDown().connect( mEventSlotPriority, [&]( app::MouseEvent &event ) {
-			app::TouchEvent touchEvent( event.getWindow(), vector<app::TouchEvent::Touch>( 1, app::TouchEvent::Touch( event.getPos(), vec2( 0 ), 0, 0, &event ) ) );
+			auto &touchEvent = makeMouseTouchEvent( event, vec2( 0 ) );
+			recordTouches( InputRecord::Type::TOUCHES_BEGAN, touchEvent );
 			propagateTouchesBegan( touchEvent );
 			event.setHandled( touchEvent.isHandled() );
 			mPrevMousePos = event.getPos();
 		} );
 		mEventConnections += mWindow->getSignalMouseDrag().connect( mEventSlotPriority, [&]( app::MouseEvent &event ) {
-			app::TouchEvent touchEvent( event.getWindow(), vector<app::TouchEvent::Touch>( 1, app::TouchEvent::Touch( event.getPos(), mPrevMousePos, 0, 0, &event ) ) );
+			auto &touchEvent = makeMouseTouchEvent( event, mPrevMousePos );
+			recordTouches( InputRecord::Type::TOUCHES_MOVED, touchEvent );
 			propagateTouchesMoved( touchEvent );
 			event.setHandled( touchEvent.isHandled() );
 			mPrevMousePos = event.getPos();
 		} );
 		mEventConnections += mWindow->getSignalMouseUp().connect( mEventSlotPriority, [&]( app::MouseEvent &event ) {
-			app::TouchEvent touchEvent( event.getWindow(), vector<app::TouchEvent::Touch>( 1, app::TouchEvent::Touch( event.getPos(), mPrevMousePos, 0, 0, &event ) ) );
+			auto &touchEvent = makeMouseTouchEvent( event, mPrevMousePos );
+			recordTouches( InputRecord::Type::TOUCHES_ENDED, touchEvent );
 			propagateTouchesEnded( touchEvent );
 			event.setHandled( touchEvent.isHandled() );
 			mPrevMousePos = event.getPos();
@@ -209,21 +477,35 @@ void Graph::connectEvents( const EventOptions &options )
 
 	if( options.mTouches ) {
 		mEventConnections += mWindow->getSignalTouchesBegan().connect( mEventSlotPriority, [&]( app::TouchEvent &event ) {
-			propagateTouchesBegan( event );
+			recordTouches( InputRecord::Type::TOUCHES_BEGAN, event );
+			if( mTouchCoalescingEnabled )
+				queueTouchEvent( QueuedTouchEvent::Type::BEGAN, event );
+			else
+				propagateTouchesBegan( event );
 		} );
 		mEventConnections += mWindow->getSignalTouchesMoved().connect( mEventSlotPriority, [&]( app::TouchEvent &event ) {
-			propagateTouchesMoved( event );
+			recordTouches( InputRecord::Type::TOUCHES_MOVED, event );
+			if( mTouchCoalescingEnabled )
+				queueTouchEvent( QueuedTouchEvent::Type::MOVED, event );
+			else
+				propagateTouchesMoved( event );
 		} );
 		mEventConnections += mWindow->getSignalTouchesEnded().connect( mEventSlotPriority, [&]( app::TouchEvent &event ) {
-			propagateTouchesEnded( event );
+			recordTouches( InputRecord::Type::TOUCHES_ENDED, event );
+			if( mTouchCoalescingEnabled )
+				queueTouchEvent( QueuedTouchEvent::Type::ENDED, event );
+			else
+				propagateTouchesEnded( event );
 		} );
 	}
 
 	if( options.mKeyboard ) {
 		mEventConnections += mWindow->getSignalKeyDown().connect( mEventSlotPriority, [&]( app::KeyEvent &event ) {
+			recordKey( InputRecord::Type::KEY_DOWN, event );
 			propagateKeyDown( event );
 		} );
 		mEventConnections += mWindow->getSignalKeyUp().connect( mEventSlotPriority, [&]( app::KeyEvent &event ) {
+			recordKey( InputRecord::Type::KEY_UP, event );
 			propagateKeyUp( event );
 		} );
 	}
@@ -234,8 +516,206 @@ void Graph::disconnectEvents()
 	mEventConnections.clear();
 }
 
+void Graph::setFlattenedTransformsEnabled( bool enable )
+{
+	if( enable && ! mTransformHierarchy ) {
+		mTransformHierarchy.reset( new TransformHierarchy );
+		mTransformHierarchy->update( this );
+	}
+	else if( ! enable )
+		mTransformHierarchy.reset();
+}
+
+void Graph::setTouchCoalescingEnabled( bool enable )
+{
+	if( mTouchCoalescingEnabled == enable )
+		return;
+
+	mTouchCoalescingEnabled = enable;
+	if( ! enable )
+		dispatchQueuedTouchEvents();
+}
+
+void Graph::queueTouchEvent( QueuedTouchEvent::Type type, app::TouchEvent &event )
+{
+	// the touches are taken by the Graph now, they reach Views when the queue is dispatched
+	event.setHandled();
+
+	// merge into the previous event if both are touches moved
+	if( type == QueuedTouchEvent::Type::MOVED && mNumQueuedTouchEvents != 0 ) {
+		auto &prev = mQueuedTouchEvents[mNumQueuedTouchEvents - 1];
+		if( prev.mType == QueuedTouchEvent::Type::MOVED ) {
+			auto &prevTouches = prev.mEvent.getTouches();
+			if( prev.mSamples.empty() )
+				prev.mSamples = prevTouches;
+
+			for( const auto &touch : event.getTouches() ) {
+				prev.mSamples.push_back( copyTouch( touch ) );
+
+				auto it = find_if( prevTouches.begin(), prevTouches.end(), [&touch]( const app::TouchEvent::Touch &t ) { return t.getId() == touch.getId(); } );
+				if( it != prevTouches.end() ) {
+					// keep the previous position from the first sample, so the merged touch spans all of them
+					*it = app::TouchEvent::Touch( touch.getPos(), it->getPrevPos(), touch.getId(), touch.getTime(), nullptr );
+				}
+				else {
+					prevTouches.push_back( copyTouch( touch ) );
+				}
+			}
+
+			mNumTouchEventsCoalesced++;
+			if( mFrameStats )
+				mFrameStats->mNumTouchEventsCoalesced++;
+
+			return;
+		}
+	}
+
+	// queued events are assigned in place so that their storage is reused
+	if( mNumQueuedTouchEvents == mQueuedTouchEvents.size() )
+		mQueuedTouchEvents.emplace_back();
+
+	auto &queued = mQueuedTouchEvents[mNumQueuedTouchEvents++];
+	queued.mType = type;
+	queued.mEvent = event;
+	queued.mEvent.setHandled( false );
+	for( auto &touch : queued.mEvent.getTouches() )
+		touch = copyTouch( touch );
+
+	queued.mSamples.clear();
+}
+
+void Graph::dispatchQueuedTouchEvents()
+{
+	for( size_t i = 0; i < mNumQueuedTouchEvents; i++ ) {
+		auto &queued = mQueuedTouchEvents[i];
+		switch( queued.mType ) {
+			case QueuedTouchEvent::Type::BEGAN:
+				propagateTouchesBegan( queued.mEvent );
+				break;
+			case QueuedTouchEvent::Type::MOVED:
+				mCoalescedTouches = queued.mSamples.empty() ? nullptr : &queued.mSamples;
+				propagateTouchesMoved( queued.mEvent );
+				mCoalescedTouches = nullptr;
+				break;
+			case QueuedTouchEvent::Type::ENDED:
+				propagateTouchesEnded( queued.mEvent );
+				break;
+		}
+	}
+
+	mNumQueuedTouchEvents = 0;
+}
+
+void Graph::dispatchInjectedInput()
+{
+	InputRecord record;
+	for( size_t i = 0; i < mInputQueue.getCapacity() && mInputQueue.pop( &record ); i++ ) {
+		if( mInputRecorder ) {
+			InputRecord recorded = record;
+			recorded.mTimestamp = sampleTime();
+			mInputRecorder->record( recorded );
+		}
+
+		if( record.isTouches() ) {
+			if( mInjectedTouchEvent.getWindow() != mWindow )
+				mInjectedTouchEvent = app::TouchEvent( mWindow, {} );
+
+			mInjectedTouchEvent.setHandled( false );
+			auto &touches = mInjectedTouchEvent.getTouches();
+			touches.clear();
+			for( size_t t = 0; t < record.mNumTouches; t++ ) {
+				const auto &touch = record.mTouches[t];
+				touches.emplace_back( touch.mPos, touch.mPrevPos, touch.mId, record.mTimestamp, nullptr );
+			}
+
+			// injected touches go through the same path as those from the Window's signals
+			QueuedTouchEvent::Type type = record.mType == InputRecord::Type::TOUCHES_BEGAN ? QueuedTouchEvent::Type::BEGAN
+				: record.mType == InputRecord::Type::TOUCHES_MOVED ? QueuedTouchEvent::Type::MOVED : QueuedTouchEvent::Type::ENDED;
+
+			if( mTouchCoalescingEnabled ) {
+				queueTouchEvent( type, mInjectedTouchEvent );
+			}
+			else if( type == QueuedTouchEvent::Type::BEGAN ) {
+				propagateTouchesBegan( mInjectedTouchEvent );
+			}
+			else if( type == QueuedTouchEvent::Type::MOVED ) {
+				propagateTouchesMoved( mInjectedTouchEvent );
+			}
+			else {
+				propagateTouchesEnded( mInjectedTouchEvent );
+			}
+		}
+		else {
+			// keep key events ordered after any touches that were pushed before them
+			dispatchQueuedTouchEvents();
+
+			app::KeyEvent event( mWindow, record.mKeyCode, record.mKeyChar32, record.mKeyChar, record.mKeyModifiers, record.mNativeKeyCode );
+			if( record.mType == InputRecord::Type::KEY_DOWN )
+				propagateKeyDown( event );
+			else
+				propagateKeyUp( event );
+		}
+	}
+}
+
+void Graph::setInputRecorder( const InputRecorderRef &recorder )
+{
+	mInputRecorder = recorder;
+	if( mInputRecorder )
+		mInputRecorder->setStartTime( sampleTime() );
+}
+
+void Graph::recordTouches( InputRecord::Type type, const app::TouchEvent &event )
+{
+	if( ! mInputRecorder )
+		return;
+
+	// events with more than InputRecord::MAX_TOUCHES touches are recorded as several records, so that no touches are lost
+	const auto &touches = event.getTouches();
+	const double timestamp = sampleTime();
+	const size_t numRecords = InputRecord::getNumTouchesRecords( touches.size() );
+	for( size_t i = 0; i < numRecords; i++ )
+		mInputRecorder->record( InputRecord::touches( type, touches, timestamp, i * InputRecord::MAX_TOUCHES ) );
+}
+
+void Graph::recordKey( InputRecord::Type type, const app::KeyEvent &event )
+{
+	if( mInputRecorder )
+		mInputRecorder->record( InputRecord::key( type, event, sampleTime() ) );
+}
+
+void Graph::getCoalescedTouches( uint32_t touchId, vector<app::TouchEvent::Touch> *result ) const
+{
+	result->clear();
+
+	const auto &samples = mCoalescedTouches ? *mCoalescedTouches : mCurrentTouchEvent.getTouches();
+	for( const auto &touch : samples ) {
+		if( touch.getId() == touchId )
+			result->push_back( touch );
+	}
+}
+
+app::TouchEvent& Graph::makeMouseTouchEvent( app::MouseEvent &event, const vec2 &prevPos )
+{
+	// the same event and touches are reused so that converting mouse events doesn't allocate
+	if( mMouseTouchEvent.getWindow() != event.getWindow() )
+		mMouseTouchEvent = app::TouchEvent( event.getWindow(), {} );
+
+	mMouseTouchEvent.setHandled( false );
+	auto &touches = mMouseTouchEvent.getTouches();
+	touches.clear();
+	touches.emplace_back( event.getPos(), prevPos, 0, 0, &event );
+	return mMouseTouchEvent;
+}
+
 void Graph::propagateTouchesBegan( app::TouchEvent &event )
 {
+	ScopedFrameStatsTimer statsTimer( mFrameStats ? &mFrameStats->mInputSeconds : nullptr, &mFrameStatsTiming );
+	if( mFrameStats )
+		mFrameStats->mNumTouchEvents++;
+
+	setNeedsRedraw();
+
 	mCurrentTouchEvent = event;
 	for( const auto &touch : event.getTouches() )
 		mActiveTouches[touch.getId()] = touch;
@@ -257,17 +737,23 @@ void Graph::propagateTouchesBegan( app::TouchEvent &event )
 	}
 }
 
-void Graph::propagateTouchesBegan( const ViewRef &view, app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder )
+void Graph::propagateTouchesBegan( const ViewRef &view, app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder, const TouchBatch *batch, size_t batchIndex )
 {
 	if( view->isHidden() || ! view->isInteractive() )
 		return;
 
 	UI_LOG_TOUCHES( view->getName() << " | num touches A: " << event.getTouches().size() );
 
-	vector<app::TouchEvent::Touch> touchesInside;
-	touchesInside.reserve( event.getTouches().size() );
+	// mTouchesInside is consumed before recursing into subviews, so one buffer serves every level
+	auto &touchesInside = mTouchesInside;
+	touchesInside.clear();
 
+	size_t batchTouchIndex = 0;
 	for( const auto &touch : event.getTouches() ) {
+		// skip touches that the parent's batched test already found to be outside of this view's bounds
+		if( batch && ! batch->mayContain( batchIndex, touch.getId(), &batchTouchIndex ) )
+			continue;
+
 		vec2 pos = view->toLocal( touch.getPos() );
 		if( view->isPointInside( pos ) ) {
 			touchesInside.push_back( touch );
@@ -292,27 +778,25 @@ void Graph::propagateTouchesBegan( const ViewRef &view, app::TouchEvent &event,
 		// TODO (intercept): might want to erase individual touches depending on if they were marked as handled
 		view->mInterceptedTouchEvent = event;
 		intercepting = true;
+		mTouchRoutesDirty = true;
 	}
 
 	// Allow children views to handle non-intercepted event before the current view
 	if( ! intercepting ) {
-		// TODO (optimization): this copy is currently necessary to prevent bad iterators if a view is added during the subview touchesBegan()
-		// - Might defer adding but need to think through how the ordering will be handled
-		auto subviews = view->mSubviews;
-		for( auto rIt = subviews.rbegin(); rIt != subviews.rend(); ++rIt ) {
-			propagateTouchesBegan( *rIt, event, numTouchesHandled, firstResponder );
-			if( event.isHandled() )
-				return;
-		}
+		if( propagateTouchesBeganToSubviews( view, event, numTouchesHandled, firstResponder ) )
+			return;
 	}
 
+	view->wake();
 	if( view->touchesBegan( event ) ) {
+		view->setNeedsRedraw(); // handling a touch usually changes what a View draws, ex. a pressed Button
 		// Only allow this View to handle this touch in other UI events.
 		auto &touches = event.getTouches();
 		size_t numTouchesHandledThisView = 0;
 		for( auto &touch : touches ) {
 			if( touch.isHandled() ) {
 				view->mActiveTouches[touch.getId()] = touch;
+				mTouchRoutesDirty = true;
 				numTouchesHandled++;
 				numTouchesHandledThisView++;
 				UI_LOG_TOUCHES( view->getName() << " | handled touch with id: " << touch.getId() << ", total handled: " << numTouchesHandled << ", in this view: " << numTouchesHandledThisView );
@@ -337,65 +821,191 @@ void Graph::propagateTouchesBegan( const ViewRef &view, app::TouchEvent &event,
 	}
 }
 
+bool Graph::propagateTouchesBeganToSubviews( const ViewRef &view, app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder )
+{
+	// TODO (optimization): this copy is currently necessary to prevent bad iterators if a view is added during the subview touchesBegan()
+	// - Might defer adding but need to think through how the ordering will be handled
+	// The copy lives in a batch that is stored per recursion depth, so its storage is reused for every event.
+	if( mTouchBatchDepth == mTouchBatches.size() )
+		mTouchBatches.emplace_back( new TouchBatch );
+
+	TouchBatch *batch = mTouchBatches[mTouchBatchDepth++].get();
+	view->getSubviewsForTouches( event.getTouches(), &batch->mSubviews );
+
+	// Subviews that can't contain any of the touches are skipped here, as they would return early anyway. Views that disable their subview index
+	// may have subviews that accept touches outside of their bounds, so those are always hit tested one by one.
+	const bool classified = mBatchedHitTestingEnabled && view->isSubviewIndexEnabled();
+	if( classified )
+		classifyTouches( view.get(), event.getTouches(), batch );
+
+	const auto &subviews = batch->mSubviews;
+	bool handled = false;
+	for( size_t i = subviews.size(); i-- > 0; ) {
+		if( classified && ! batch->mayContainAny( i ) )
+			continue;
+
+		propagateTouchesBegan( subviews[i], event, numTouchesHandled, firstResponder, classified ? batch : nullptr, i );
+		if( event.isHandled() ) {
+			handled = true;
+			break;
+		}
+	}
+
+	batch->mSubviews.clear(); // don't hold references to subviews between events
+	mTouchBatchDepth--;
+
+	return handled;
+}
+
+// Tests all touches against all subviews in one pass, recording a bit per touch for each subview that may contain it.
+// The inner loop runs over contiguous arrays without branches so that the compiler can vectorize it.
+void Graph::classifyTouches( const View *view, const vector<app::TouchEvent::Touch> &touches, TouchBatch *batch )
+{
+	const size_t numTouches = touches.size();
+	const size_t numSubviews = batch->mSubviews.size();
+
+	batch->mTouchIds.resize( numTouches );
+	batch->mTouchX.resize( numTouches );
+	batch->mTouchY.resize( numTouches );
+	for( size_t i = 0; i < numTouches; i++ ) {
+		vec2 pos = view->toLocal( touches[i].getPos() );
+		batch->mTouchIds[i] = touches[i].getId();
+		batch->mTouchX[i] = pos.x;
+		batch->mTouchY[i] = pos.y;
+	}
+
+	batch->mX1.resize( numSubviews );
+	batch->mY1.resize( numSubviews );
+	batch->mX2.resize( numSubviews );
+	batch->mY2.resize( numSubviews );
+	for( size_t i = 0; i < numSubviews; i++ ) {
+		const auto &subview = batch->mSubviews[i];
+		if( subview->isHidden() || ! subview->isInteractive() ) {
+			// inverted bounds never contain a point
+			batch->mX1[i] = batch->mY1[i] = numeric_limits<float>::max();
+			batch->mX2[i] = batch->mY2[i] = numeric_limits<float>::lowest();
+			continue;
+		}
+
+		Rectf bounds = subview->getBoundsInParent();
+		batch->mX1[i] = bounds.x1 - BATCH_BOUNDS_EPSILON;
+		batch->mY1[i] = bounds.y1 - BATCH_BOUNDS_EPSILON;
+		batch->mX2[i] = bounds.x2 + BATCH_BOUNDS_EPSILON;
+		batch->mY2[i] = bounds.y2 + BATCH_BOUNDS_EPSILON;
+	}
+
+	batch->mNumWords = ( numTouches + 63 ) / 64;
+	batch->mMasks.assign( batch->mNumWords * numSubviews, 0 );
+
+	const float *x1 = batch->mX1.data();
+	const float *y1 = batch->mY1.data();
+	const float *x2 = batch->mX2.data();
+	const float *y2 = batch->mY2.data();
+	for( size_t t = 0; t < numTouches; t++ ) {
+		const float x = batch->mTouchX[t];
+		const float y = batch->mTouchY[t];
+		const uint64_t bit = uint64_t( 1 ) << ( t % 64 );
+		uint64_t *masks = batch->mMasks.data() + ( t / 64 ) * numSubviews;
+		for( size_t s = 0; s < numSubviews; s++ ) {
+			uint64_t inside = uint64_t( ( x >= x1[s] ) & ( x <= x2[s] ) & ( y >= y1[s] ) & ( y <= y2[s] ) );
+			masks[s] |= bit & ( 0 - inside );
+		}
+	}
+}
+
+bool Graph::TouchBatch::mayContainAny( size_t subviewIndex ) const
+{
+	for( size_t word = 0; word < mNumWords; word++ ) {
+		if( mMasks[word * mSubviews.size() + subviewIndex] != 0 )
+			return true;
+	}
+
+	return false;
+}
+
+bool Graph::TouchBatch::mayContain( size_t subviewIndex, uint32_t touchId, size_t *touchIndex ) const
+{
+	// The event's touches are always an ordered subset of the batched touches (views only ever filter them),
+	// so the lookup continues from where the previous touch was found.
+	size_t &i = *touchIndex;
+	while( i < mTouchIds.size() && mTouchIds[i] != touchId )
+		i++;
+
+	// not one of the batched touches, let the caller test it
+	if( i == mTouchIds.size() )
+		return true;
+
+	bool result = ( mMasks[( i / 64 ) * mSubviews.size() + subviewIndex] & ( uint64_t( 1 ) << ( i % 64 ) ) ) != 0;
+	i++;
+	return result;
+}
+
 void Graph::propagateTouchesMoved( app::TouchEvent &event )
 {
+	ScopedFrameStatsTimer statsTimer( mFrameStats ? &mFrameStats->mInputSeconds : nullptr, &mFrameStatsTiming );
+	if( mFrameStats )
+		mFrameStats->mNumTouchEvents++;
+
+	setNeedsRedraw();
+
 	mCurrentTouchEvent = event;
 	for( const auto &touch : event.getTouches() )
 		mActiveTouches[touch.getId()] = touch;
 
 	size_t numTouchesHandled = 0;
 
-	for( auto &view : mViewsWithTouches ) {
+	auto scratch = pushTouchDispatchScratch();
+	auto &routes = scratch->mRoutes;
+	routeTouches( mCurrentTouchEvent.getTouches(), &routes );
+
+	const auto &currentTouches = mCurrentTouchEvent.getTouches();
+	auto &touchesContinued = scratch->mViewTouches;
+	for( size_t i = 0; i < routes.size(); /* */ ) {
+		const size_t viewOrder = routes[i].first.mViewOrder;
+		View *view = routes[i].first.mView;
 		UI_LOG_TOUCHES( view->getName() << " | num touches A: " << event.getTouches().size() );
 
-		// update intercepted touches
-		if( ! view->mInterceptedTouchEvent.getTouches().empty() ) {
-			for( auto &touch : view->mInterceptedTouchEvent.getTouches() ) {
-				auto it = find_if( mCurrentTouchEvent.getTouches().begin(), mCurrentTouchEvent.getTouches().end(),
-					[&touch]( const auto &t ) { return touch.getId() == t.getId(); }
-				);
-
-				if( it != mCurrentTouchEvent.getTouches().end() ) {
-					touch = *it;
-					UI_LOG_TOUCHES( view->getName() << " | intercepted touch updated with id: " << touch.getId() << ", pos: " << touch.getPos() );
+		touchesContinued.clear();
+		for( ; i < routes.size() && routes[i].first.mViewOrder == viewOrder; i++ ) {
+			const auto &touch = currentTouches[routes[i].second];
+			if( routes[i].first.mIntercepting ) {
+				// update intercepted touches
+				for( auto &interceptedTouch : view->mInterceptedTouchEvent.getTouches() ) {
+					if( interceptedTouch.getId() == touch.getId() ) {
+						interceptedTouch = touch;
+						UI_LOG_TOUCHES( view->getName() << " | intercepted touch updated with id: " << touch.getId() << ", pos: " << touch.getPos() );
+					}
 				}
 			}
-
-			// call touchesMoved() on view intercepting the event
-			auto interceptEvent = event;
-			interceptEvent.getTouches() = view->mInterceptedTouchEvent.getTouches();
-			//view->touchesMoved( interceptEvent );
-		}
-
-		// Update active touches
-		if( ! view->mActiveTouches.empty() ) {
-			vector<app::TouchEvent::Touch> touchesContinued;
-			for( const auto &touch : mCurrentTouchEvent.getTouches() ) {
-				auto it = view->mActiveTouches.find( touch.getId() );
-				if( it == view->mActiveTouches.end() )
-					continue;
-
+			else {
+				// Update active touches
 				view->mActiveTouches[touch.getId()] = touch;
 				touchesContinued.push_back( touch );
 			}
+		}
 
-			//UI_LOG_TOUCHES( view->getName() << " | num touchesContinued: " << touchesContinued.size() );
+		// TODO: call touchesMoved() on view intercepting the event
 
-			if( ! touchesContinued.empty() ) {
-				event.getTouches() = touchesContinued;
-				view->touchesMoved( event );
+		//UI_LOG_TOUCHES( view->getName() << " | num touchesContinued: " << touchesContinued.size() );
 
-				// for now always updating the active touch in touch map
-				//for( auto &touch : event.getTouches() ) {
-				//	if( touch.isHandled() ) {
-				//		numTouchesHandled++;
-				//		view->mActiveTouches.at( touch.getId() ) = touch;
-				//	}
-				//}
-			}
+		if( ! touchesContinued.empty() ) {
+			event.getTouches() = touchesContinued;
+			view->wake();
+			view->setNeedsRedraw();
+			view->touchesMoved( event );
+
+			// for now always updating the active touch in touch map
+			//for( auto &touch : event.getTouches() ) {
+			//	if( touch.isHandled() ) {
+			//		numTouchesHandled++;
+			//		view->mActiveTouches.at( touch.getId() ) = touch;
+			//	}
+			//}
 		}
 	}
 
+	popTouchDispatchScratch();
+
 	// Allow other app signal connections to respond to the event with remaining touches if not all were handled
 	// TODO: probably need above commented out for loop to be enabled for this to work
 	//		 - and to also account for intercepted touches
@@ -406,59 +1016,80 @@ void Graph::propagateTouchesMoved( app::TouchEvent &event )
 
 void Graph::propagateTouchesEnded( app::TouchEvent &event, const vu::ViewRef &interceptingView )
 {
+	ScopedFrameStatsTimer statsTimer( mFrameStats ? &mFrameStats->mInputSeconds : nullptr, &mFrameStatsTiming );
+	if( mFrameStats )
+		mFrameStats->mNumTouchEvents++;
+
+	setNeedsRedraw();
+
 	mCurrentTouchEvent = event; // TODO (intercept): may want to only set this if it isn't an intercepting event
 //	size_t numTouchesHandled = 0;
 
-	for(const auto &view : mViewsWithTouches ) {
+	auto scratch = pushTouchDispatchScratch();
+
+	// copy the touches, as handleInterceptingTouches() may replace mCurrentTouchEvent while they are being dispatched
+	auto &currentTouches = scratch->mEventTouches;
+	currentTouches = mCurrentTouchEvent.getTouches();
+	auto &routes = scratch->mRoutes;
+	routeTouches( currentTouches, &routes );
+
+	auto &touchesEnded = scratch->mViewTouches;
+	for( size_t i = 0; i < routes.size(); /* */ ) {
+		// A nested propagateTouchesEnded() from handleInterceptingTouches() clears mCurrentTouchEvent, which ends dispatch of this event
+		if( mCurrentTouchEvent.getTouches().empty() )
+			break;
+
+		const size_t viewOrder = routes[i].first.mViewOrder;
+		View *view = routes[i].first.mView;
 		UI_LOG_TOUCHES( view->getName() << " | num active touches: " << view->mActiveTouches.size() << ", intercepting touches: " << view->mInterceptedTouchEvent.getTouches().size() );
 
-		// Update touches on view's mInterceptedTouchEvent
 		bool intercepting = false;
-		if( ! view->mInterceptedTouchEvent.getTouches().empty() ) {
-			for( auto &touch : view->mInterceptedTouchEvent.getTouches() ) {
-				auto it = find_if( mCurrentTouchEvent.getTouches().begin(), mCurrentTouchEvent.getTouches().end(),
-					[&touch]( const auto &t ) { return touch.getId() == t.getId(); }
-				);
-
-				if( it != mCurrentTouchEvent.getTouches().end() ) {
-					intercepting = true;
-					touch = *it;
-					UI_LOG_TOUCHES( view->getName() << " | intercepted touch updated with id: " << touch.getId() << ", pos: " << touch.getPos() );
+		touchesEnded.clear();
+		for( ; i < routes.size() && routes[i].first.mViewOrder == viewOrder; i++ ) {
+			const auto &touch = currentTouches[routes[i].second];
+			if( routes[i].first.mIntercepting ) {
+				// Update touches on view's mInterceptedTouchEvent
+				for( auto &interceptedTouch : view->mInterceptedTouchEvent.getTouches() ) {
+					if( interceptedTouch.getId() == touch.getId() ) {
+						intercepting = true;
+						interceptedTouch = touch;
+						UI_LOG_TOUCHES( view->getName() << " | intercepted touch updated with id: " << touch.getId() << ", pos: " << touch.getPos() );
+					}
 				}
 			}
-		}
-
-		// Update active touches
-		if( ! view->mActiveTouches.empty() ) {
-			vector<app::TouchEvent::Touch> touchesEnded;
-			for( const auto &touch : mCurrentTouchEvent.getTouches() ) {
-				auto touchIt = view->mActiveTouches.find( touch.getId() );
-				if( touchIt == view->mActiveTouches.end() )
-					continue;
-
+			else {
+				// Update active touches
 				view->mActiveTouches[touch.getId()] = touch;
 				touchesEnded.push_back( touch );
 			}
+		}
 
-			UI_LOG_TOUCHES( view->getName() << " | num touchesEnded: " << touchesEnded.size() );
+		if( view->mActiveTouches.empty() )
+			continue;
 
-			if( ! touchesEnded.empty() ) {
-				event.getTouches() = touchesEnded;
-				view->touchesEnded( event );
+		UI_LOG_TOUCHES( view->getName() << " | num touchesEnded: " << touchesEnded.size() );
 
-				for( const auto &touch : touchesEnded ) {
-					view->mActiveTouches.erase( touch.getId() );
-				}
-			}
+		if( ! touchesEnded.empty() ) {
+			event.getTouches() = touchesEnded;
+			view->wake();
+			view->setNeedsRedraw();
+			view->touchesEnded( event );
 
-			// - if the view is intercepting a touch, then updateViewsInterceptingTouches() will clear it later
-			if( intercepting ) {
-				handleInterceptingTouches( view, true );
-				//view->mInterceptedTouchEvent = {};
+			for( const auto &touch : touchesEnded ) {
+				view->mActiveTouches.erase( touch.getId() );
 			}
+			mTouchRoutesDirty = true;
+		}
+
+		// - if the view is intercepting a touch, then updateViewsInterceptingTouches() will clear it later
+		if( intercepting ) {
+			handleInterceptingTouches( view->shared_from_this(), true );
+			//view->mInterceptedTouchEvent = {};
 		}
 	}
 
+	popTouchDispatchScratch();
+
 	for( const auto &touch : mCurrentTouchEvent.getTouches() ) {
 		size_t numRemoved = mActiveTouches.erase( touch.getId() );
 		//CI_VERIFY( numRemoved != 0 );
@@ -471,6 +1102,58 @@ void Graph::propagateTouchesEnded( app::TouchEvent &event, const vu::ViewRef &in
 	mCurrentTouchEvent.getTouches().clear();
 }
 
+void Graph::rebuildTouchRoutes()
+{
+	mTouchRoutes.clear();
+
+	size_t viewOrder = 0;
+	for( const auto &view : mViewsWithTouches ) {
+		for( const auto &touch : view->mInterceptedTouchEvent.getTouches() )
+			mTouchRoutes.push_back( { touch.getId(), viewOrder, view.get(), true } );
+		for( const auto &activeTouch : view->mActiveTouches )
+			mTouchRoutes.push_back( { activeTouch.first, viewOrder, view.get(), false } );
+
+		viewOrder++;
+	}
+
+	// routeTouches() puts the entries for each event in a total order, so the order of equal ids doesn't matter here
+	sort( mTouchRoutes.begin(), mTouchRoutes.end(), []( const TouchRoute &a, const TouchRoute &b ) { return a.mTouchId < b.mTouchId; } );
+	mTouchRoutesDirty = false;
+}
+
+void Graph::routeTouches( const vector<app::TouchEvent::Touch> &touches, vector<pair<TouchRoute, size_t>> *routes )
+{
+	if( mTouchRoutesDirty )
+		rebuildTouchRoutes();
+
+	routes->clear();
+	for( size_t i = 0; i < touches.size(); i++ ) {
+		const uint32_t id = touches[i].getId();
+		auto it = lower_bound( mTouchRoutes.begin(), mTouchRoutes.end(), id, []( const TouchRoute &route, uint32_t id ) { return route.mTouchId < id; } );
+		for( ; it != mTouchRoutes.end() && it->mTouchId == id; ++it )
+			routes->push_back( { *it, i } );
+	}
+
+	// group by View in the order of mViewsWithTouches, keeping touches within each group in event order.
+	// This is a total order, so sort() gives the same result as stable_sort() without its temporary buffer.
+	sort( routes->begin(), routes->end(), []( const pair<TouchRoute, size_t> &a, const pair<TouchRoute, size_t> &b ) {
+		if( a.first.mViewOrder != b.first.mViewOrder )
+			return a.first.mViewOrder < b.first.mViewOrder;
+		if( a.second != b.second )
+			return a.second < b.second;
+
+		return a.first.mIntercepting && ! b.first.mIntercepting;
+	} );
+}
+
+Graph::TouchDispatchScratch* Graph::pushTouchDispatchScratch()
+{
+	if( mTouchDispatchDepth == mTouchDispatchScratch.size() )
+		mTouchDispatchScratch.emplace_back( new TouchDispatchScratch );
+
+	return mTouchDispatchScratch[mTouchDispatchDepth++].get();
+}
+
 // If eventEnding is true, will call propagateTouchesEnded(). Otherwise, released touches will allow subviews a chance at touchesBegan
 // Returns true if view should be erased from mViewsWithTouches and the intercepted event was released.
 // TODO (intercept): call this from touchesMoved() too
@@ -513,19 +1196,14 @@ bool Graph::handleInterceptingTouches( const ViewRef &view, bool eventEnding )
 			// give subview hierarchy a chance at the touches
 			size_t numTouchesHandled = 0;
 			ViewRef firstResponder;
-			auto subviews = view->mSubviews;
-			for( auto rIt = subviews.rbegin(); rIt != subviews.rend(); ++rIt ) {
-				propagateTouchesBegan( *rIt, beganEvent, numTouchesHandled, firstResponder );
-				if( beganEvent.isHandled() )
-					break;
-			}
+			propagateTouchesBeganToSubviews( view, beganEvent, numTouchesHandled, firstResponder );
 
 		}
 
 		// Handle event ending with original intercepted touches. TODO (intercept): use those handled in touches began only?
-		// TODO (intercept): only make copy if eventEnding is true
-		auto endedEvent = view->mInterceptedTouchEvent;
+		auto endedEvent = move( view->mInterceptedTouchEvent );
 		view->mInterceptedTouchEvent = {}; // clear intercepted event for the view
+		mTouchRoutesDirty = true;
 
 		// If the intercept event was claimed by a child, call touches ended on it here.
 		// TODO (intercept): should do this for any touches right below propagateTouchesBegan() above
@@ -555,6 +1233,8 @@ void Graph::propagateKeyDown( ci::app::KeyEvent &event )
 			}
 		}
 		else {
+			mFirstResponder->wake();
+			mFirstResponder->setNeedsRedraw();
 			if( mFirstResponder->keyDown( event ) )
 				event.setHandled();
 		}
@@ -566,6 +1246,8 @@ void Graph::propagateKeyDown( ci::app::KeyEvent &event )
 void Graph::propagateKeyUp( ci::app::KeyEvent &event )
 {
 	if( mFirstResponder ) {
+		mFirstResponder->wake();
+		mFirstResponder->setNeedsRedraw();
 		if( mFirstResponder->keyUp( event ) )
 			event.setHandled();
 	}
@@ -586,6 +1268,11 @@ void Graph::setFirstResponder( const ViewRef &view )
 		auto previousFirstResponder = mFirstResponder;
 		mFirstResponder = view;
 		mPreviousFirstResponder = previousFirstResponder;
+
+		// responders usually draw differently while they have focus, ex. a TextField's cursor
+		view->setNeedsRedraw();
+		if( previousFirstResponder )
+			previousFirstResponder->setNeedsRedraw();
 	}
 	else {
 		// if view declines to become first responder, try the next in the chain.
@@ -645,6 +1332,7 @@ void Graph::resignFirstResponder()
 		mPreviousFirstResponder = mFirstResponder;
 	}
 	mFirstResponder->willResignFirstResponder();
+	mFirstResponder->setNeedsRedraw();
 	mFirstResponder = nullptr;
 }
 
@@ -21,13 +21,18 @@
 
 #pragma once
 
+#include "vu/Animator.h"
 #include "vu/Renderer.h"
+#include "vu/ImageLoader.h"
+#include "vu/InputQueue.h"
+#include "vu/InputRecording.h"
 #include "vu/Layer.h"
 #include "vu/View.h"
 
 #include "cinder/Cinder.h"
 #include "cinder/Exception.h"
 #include "cinder/Signals.h"
+#include "cinder/Timer.h"
 
 namespace cinder { namespace app {
 
@@ -44,6 +49,9 @@ typedef std::shared_ptr<class View>		ViewRef;
 class CI_UI_API Graph : public View {
   public:
 	Graph( const ci::app::WindowRef &window = nullptr );
+	//! Creates a Graph that isn't connected to an app::Window and doesn't need an App, for running headless (ex. in benchmarks).
+	//! \a size is used for the bounds and clipping size. Time comes from \a timeSource, or seconds since construction if null. If \a renderer is null, propagateDraw() does nothing.
+	Graph( const ci::ivec2 &size, const std::function<double ()> &timeSource = nullptr, const RendererRef &renderer = nullptr );
 	~Graph();
 
 	RendererRef getRenderer()       { return mRenderer; }
@@ -100,23 +108,150 @@ class CI_UI_API Graph : public View {
 	void disconnectEvents();
 
 	//! Returns a map of all current touches in the window (key = touch id).
-	const std::map<uint32_t, ci::app::TouchEvent::Touch>&  getAllTouchesInWindow() const   { return mActiveTouches; }
+	const TouchMap&  getAllTouchesInWindow() const   { return mActiveTouches; }
 	//! Returns the current TouchEvent, if one is currently being processed.
 	const ci::app::TouchEvent&  getCurrentTouchEvent() const    { return mCurrentTouchEvent; }
 	//! Returns all Views that currently have active touches.
 	const std::list<ViewRef>&	    getViewsWithTouches() const { return mViewsWithTouches; }
 
+	//! Enables or disables testing all touches of an event against a View's subviews in one pass, so subviews whose bounds can't contain any touch are skipped.
+	//! Views with View::setSubviewIndexEnabled( false ) opt their subviews out, which is needed if a subview's isPointInside() accepts points outside of its bounds. \default true.
+	void	setBatchedHitTestingEnabled( bool enable = true )	{ mBatchedHitTestingEnabled = enable; }
+	//! Returns whether all touches of an event are tested against a View's subviews in one pass.
+	bool	isBatchedHitTestingEnabled() const					{ return mBatchedHitTestingEnabled; }
+
+	//! Enables or disables buffering the events from the Window's touch signals and dispatching them once per frame at the start of propagateUpdate().
+	//! Consecutive touches moved events are merged per touch id, touches began and ended are dispatched in the order they arrived. Disabling dispatches any buffered events. \default false.
+	void	setTouchCoalescingEnabled( bool enable = true );
+	//! Returns whether events from the Window's touch signals are buffered and dispatched once per frame.
+	bool	isTouchCoalescingEnabled() const				{ return mTouchCoalescingEnabled; }
+	//! Returns the number of touches moved events that have been merged into a previous event since the Graph was created.
+	size_t	getNumTouchEventsCoalesced() const				{ return mNumTouchEventsCoalesced; }
+	//! Pushes \a record to be dispatched at the start of the next propagateUpdate(), in the order records were pushed. Safe to call from any thread.
+	//! Returns false if the input queue is full, in which case the record is dropped.
+	bool	injectInput( const InputRecord &record )			{ return mInputQueue.push( record ); }
+	//! Returns the queue that injectInput() pushes to.
+	const InputQueue&	getInputQueue() const				{ return mInputQueue; }
+	//! Fills \a result with every sample of the touch with \a touchId that was merged into the touches moved event currently being dispatched, oldest first.
+	//! If the touch wasn't coalesced, \a result only contains the touch as it was dispatched. Useful for velocity tracking.
+	void	getCoalescedTouches( uint32_t touchId, std::vector<ci::app::TouchEvent::Touch> *result ) const;
+
+	//! Enables or disables skipping the drawing of View subtrees that are entirely outside of the clipping size or a clipping View, based on View::getSubtreeBounds(). \default true.
+	void	setDrawCullingEnabled( bool enable = true )		{ mDrawCullingEnabled = enable; }
+	//! Returns whether View subtrees outside of the current clip are skipped when drawing.
+	bool	isDrawCullingEnabled() const					{ return mDrawCullingEnabled; }
+	//! Enables or disables Layers keeping their rendered (and filtered) FrameBuffer while nothing in their subtree changes, so that only compositing is redone
+	//! when just the Layer's alpha, position or transform is changing. Each cached Layer reserves a FrameBuffer from the Renderer. See View::setNeedsRedraw(). \default true.
+	void	setLayerCachingEnabled( bool enable = true )	{ mLayerCachingEnabled = enable; }
+	//! Returns whether Layers composite their cached FrameBuffer while their subtree is unchanged.
+	bool	isLayerCachingEnabled() const					{ return mLayerCachingEnabled; }
+	//! Enables or disables re-rendering Layers even when their cache is valid, logging a warning for each one whose cached FrameBuffer differs from the fresh render.
+	//! This reads back FrameBuffers from the GPU and is only meant for finding Views that change what they draw without calling View::setNeedsRedraw(). \default false.
+	void	setLayerCacheVerificationEnabled( bool enable = true )	{ mLayerCacheVerificationEnabled = enable; }
+	//! Returns whether valid Layer caches are verified against a fresh render.
+	bool	isLayerCacheVerificationEnabled() const			{ return mLayerCacheVerificationEnabled; }
+	//! Enables or disables recording each frame into a RenderCommandList that is optimized and then submitted to the Renderer, instead of drawing Views immediately.
+	//! Frames are always recorded if the Renderer doesn't draw with gl, see Renderer::isDrawingWithGl().
+	//! While nothing needs a redraw and the gl matrices and clipping size are unchanged, the last list is submitted again without visiting any Views.
+	//! FrameBuffers are still acquired while recording, so the Renderer shouldn't be shared with another Graph while this is enabled. \default false.
+	void	setDrawRecordingEnabled( bool enable = true );
+	//! Returns whether frames are recorded into a RenderCommandList before they are submitted.
+	bool	isDrawRecordingEnabled() const					{ return mDrawRecordingEnabled; }
+	//! Returns the RenderCommandList of the last recorded frame, which is empty unless setDrawRecordingEnabled() is on.
+	const RenderCommandList&	getRenderCommands() const	{ return mRenderCommands; }
+
+	//! Returns whether the next propagateDraw() may differ from the last one: a View property or layout changed, touches are active, an animation or scroll is running,
+	//! or a redraw time requested with setNeedsRedraw( double ) has been reached. Check after propagateUpdate() to skip or throttle frames while the Graph is idle.
+	bool	needsRedraw() const;
+	//! Marks the next frame as needing to be drawn, see needsRedraw(). Views usually call View::setNeedsRedraw() instead.
+	void	setNeedsRedraw()					{ mNeedsRedraw = true; }
+	//! Requests that a frame is drawn once getCurrentTime() reaches \a time. Only the earliest pending request is kept.
+	void	setNeedsRedraw( double time )		{ mRedrawTime = std::min( mRedrawTime, time ); }
+	//! Returns the time of the earliest pending redraw request, or infinity if there isn't one. An idle app can sleep until then.
+	double	getRedrawTime() const				{ return mRedrawTime; }
+
+	//! Returns the Animator that tweens View properties, evaluated at the start of propagateUpdate().
+	Animator&		getAnimator()			{ return mAnimator; }
+	//! Returns the Animator that tweens View properties, evaluated at the start of propagateUpdate().
+	const Animator&	getAnimator() const		{ return mAnimator; }
+
+	//! Sets the ImageLoader that propagateUpdate() uploads decoded images from, before Views are updated. Pass nullptr to stop updating it. \default nullptr.
+	void	setImageLoader( const ImageLoaderRef &loader )	{ mImageLoader = loader; }
+	//! Returns the ImageLoader set with setImageLoader(), or nullptr.
+	const ImageLoaderRef&	getImageLoader() const		{ return mImageLoader; }
+
+	//! Enables or disables keeping a flattened TransformHierarchy of this Graph's Views, whose world transforms are all brought up to date in one pass at the end of
+	//! propagateUpdate(). While it is current, View::getWorldTransform(), getWorldBounds(), toWorld() and toLocal() read from it instead of recursing up the hierarchy. \default false.
+	void	setFlattenedTransformsEnabled( bool enable = true );
+	//! Returns whether a flattened TransformHierarchy is kept for this Graph's Views.
+	bool	isFlattenedTransformsEnabled() const			{ return (bool)mTransformHierarchy; }
+	//! Returns the flattened TransformHierarchy, or nullptr if it isn't enabled.
+	const TransformHierarchy*	getTransformHierarchy() const	{ return mTransformHierarchy.get(); }
+
 	//! Sets the size used for clipping operations.
 	void setClippingSize( const ci::ivec2 &size );
 	//! Returns the size used for clipping operations. Defaults to the size of the window
 	ci::ivec2 getClippingSize() const;
 
-	//!
+	//! Returns the App's frame rate, or the rate set with setTargetFrameRate() when not connected to a Window.
 	double	getTargetFrameRate() const;
+	//! Sets the frame rate returned by getTargetFrameRate() when the Graph isn't connected to a Window. \default 60.
+	void	setTargetFrameRate( double frameRate )	{ mTargetFrameRate = frameRate; }
 	//!
 	size_t	getCurrentFrame() const;
 	//!
 	double	getCurrentTime() const;
+	//! Sets the function that propagateUpdate() samples for the current time in seconds. Pass nullptr to use app::getElapsedSeconds(), or seconds since construction when there is no App. Allows driving the Graph with a virtual clock.
+	void	setTimeSource( const std::function<double ()> &timeSource )	{ mTimeSource = timeSource; }
+	//! Returns the function set with setTimeSource(), or nullptr if the app's elapsed seconds are used.
+	const std::function<double ()>&	getTimeSource() const			{ return mTimeSource; }
+
+	//! Records all touch and key input the Graph receives into \a recorder, with timestamps relative to now. Pass nullptr to stop recording.
+	void	setInputRecorder( const InputRecorderRef &recorder );
+	//! Returns the InputRecorder set with setInputRecorder(), or nullptr if input isn't being recorded.
+	const InputRecorderRef&	getInputRecorder() const	{ return mInputRecorder; }
+
+	//! Counters and wall times for a single frame, collected while frame stats are enabled.
+	//! A frame ends with propagateDraw(), so touches dispatched before propagateUpdate() count towards the frame that follows them.
+	struct FrameStats {
+		uint64_t	mFrame = 0;						// getCurrentFrame() during the frame
+		size_t		mNumViewsUpdated = 0;
+		size_t		mNumViewsDrawn = 0;
+		size_t		mNumViewsCulled = 0;			// Views skipped because their subtree was outside of the current clip
+		size_t		mNumViewsAsleep = 0;			// Views skipped by update because of their subtree's UpdatePolicy
+		size_t		mNumLayouts = 0;				// calls to View::layout()
+		size_t		mNumLayersComposited = 0;		// Layers rendered to a FrameBuffer and then drawn
+		size_t		mNumLayerCacheHits = 0;			// composited Layers whose subtree was unchanged, so their cached FrameBuffer was drawn without rendering
+		size_t		mNumLayerCacheMismatches = 0;	// verified Layer caches that differed from a fresh render, see setLayerCacheVerificationEnabled()
+		size_t		mNumFrameBuffersCreated = 0;	// FrameBuffer counters are only taken from the Renderer's, around propagateDraw(), so each is counted once
+		size_t		mNumFrameBuffersResized = 0;
+		size_t		mNumFrameBuffersReused = 0;		// FrameBuffers handed back as is by Renderer::getFrameBuffer() or Renderer::acquireFrameBuffer()
+		size_t		mNumFrameBuffersEvicted = 0;		// pooled FrameBuffers freed to stay within the Renderer's memory budget
+		size_t		mNumFilterPasses = 0;
+		size_t		mNumDrawCalls = 0;				// draws issued through the Renderer
+		size_t		mNumBatches = 0;				// draw calls that drew batched quads, see Renderer::setBatchingEnabled()
+		size_t		mNumQuadsBatched = 0;			// solid rects, stroked rect sides and images drawn in batches
+		size_t		mNumRenderCommands = 0;			// commands submitted from the RenderCommandList, see setDrawRecordingEnabled()
+		size_t		mNumRenderCommandsReused = 0;	// submitted commands that came from the previous frame's recording
+		size_t		mNumStateChangesIssued = 0;		// blend, color, scissor, framebuffer, GlslProg and texture changes made by the Renderer, see GlStateCache
+		size_t		mNumStateChangesElided = 0;		// state changes skipped because the value was already current
+		size_t		mNumTextureBinds = 0;			// textures bound for batches, Images from the same ImageAtlas page share one
+		size_t		mNumTouchEvents = 0;			// calls to propagateTouchesBegan(), propagateTouchesMoved() and propagateTouchesEnded()
+		size_t		mNumTouchEventsCoalesced = 0;	// touches moved events merged into a previous event, see setTouchCoalescingEnabled()
+		size_t		mNumImagesUploaded = 0;			// Images finished by the ImageLoader, see setImageLoader()
+		double		mInputSeconds = 0;				// touches dispatched outside of propagateUpdate()
+		double		mUpdateSeconds = 0;
+		double		mDrawSeconds = 0;
+	};
+
+	//! Enables or disables collecting FrameStats for every frame, keeping the last \a historySize frames. When disabled, nothing is collected. \default false.
+	void	setFrameStatsEnabled( bool enable = true, size_t historySize = 120 );
+	//! Returns whether FrameStats are being collected.
+	bool	isFrameStatsEnabled() const				{ return mFrameStats != nullptr; }
+	//! Returns the FrameStats of a completed frame, where \a framesAgo = 0 is the most recent. Returns empty FrameStats if \a framesAgo >= getNumFrameStats().
+	const FrameStats&	getFrameStats( size_t framesAgo = 0 ) const;
+	//! Returns the number of completed frames in the FrameStats history.
+	size_t	getNumFrameStats() const				{ return mNumFrameStats; }
 
   protected:
 	void layout() override;
@@ -124,10 +259,77 @@ class CI_UI_API Graph : public View {
   private:
 	LayerRef makeLayer( View *rootView );
 
-	void propagateTouchesBegan( const ViewRef &view, ci::app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder );
+	//! Per-subview results of testing all touches of an event against a View's subviews at once, in the View's coordinate space.
+	struct TouchBatch {
+		//! Returns whether any of the batched touches may be inside the subview at \a subviewIndex.
+		bool	mayContainAny( size_t subviewIndex ) const;
+		//! Returns whether the touch with \a touchId may be inside the subview at \a subviewIndex. \a touchIndex is advanced past the touch, as touches are looked up in order.
+		bool	mayContain( size_t subviewIndex, uint32_t touchId, size_t *touchIndex ) const;
+
+		std::vector<ViewRef>	mSubviews;
+		std::vector<uint32_t>	mTouchIds;
+		std::vector<float>		mTouchX, mTouchY;
+		std::vector<float>		mX1, mY1, mX2, mY2;
+		std::vector<uint64_t>	mMasks; // bit per touch, laid out as [word][subview]
+		size_t					mNumWords = 0;
+	};
+
+	void propagateTouchesBegan( const ViewRef &view, ci::app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder, const TouchBatch *batch = nullptr, size_t batchIndex = 0 );
+	//! Propagates touches began to the subviews of \a view, front to back. Returns true if the loop was stopped because the event was handled.
+	bool propagateTouchesBeganToSubviews( const ViewRef &view, ci::app::TouchEvent &event, size_t &numTouchesHandled, ViewRef &firstResponder );
+	void classifyTouches( const View *view, const std::vector<ci::app::TouchEvent::Touch> &touches, TouchBatch *batch );
 	
 	//! Returns true if view should be erased from mViewsWithTouches and the intercepted event was released.
 	bool handleInterceptingTouches( const ViewRef &view, bool eventEnding );
+	//! Touch event buffered from the Window's signals while touch coalescing is enabled.
+	struct QueuedTouchEvent {
+		enum class Type { BEGAN, MOVED, ENDED };
+
+		Type					mType;
+		ci::app::TouchEvent		mEvent;
+		std::vector<ci::app::TouchEvent::Touch>	mSamples; // every touch merged into mEvent in the order they arrived, empty if nothing was merged
+	};
+
+	//! Buffers a copy of \a event without the touches' native pointers, and marks \a event as handled.
+	void queueTouchEvent( QueuedTouchEvent::Type type, ci::app::TouchEvent &event );
+	void dispatchQueuedTouchEvents();
+	//! Pops and dispatches records pushed with injectInput(), at most the capacity of the queue so that producers can't stall the frame.
+	void dispatchInjectedInput();
+	void recordTouches( InputRecord::Type type, const ci::app::TouchEvent &event );
+	void recordKey( InputRecord::Type type, const ci::app::KeyEvent &event );
+	//! Returns the current time from mTimeSource, or the app's elapsed seconds if there isn't one.
+	double sampleTime() const;
+
+	//! Moves the FrameStats being collected into the history and starts collecting the next frame.
+	void finishFrameStats();
+	//! Draws the Layer tree, recording it first or submitting the last recording again when draw recording is enabled.
+	void drawFrame( const ci::Rectf &cullBounds, bool reuseAllowed );
+
+	//! Returns mMouseTouchEvent, updated with a single touch for \a event.
+	ci::app::TouchEvent& makeMouseTouchEvent( ci::app::MouseEvent &event, const ci::vec2 &prevPos );
+
+	//! Entry in the table used to route touches moved and ended to the Views that own or intercept them.
+	struct TouchRoute {
+		uint32_t	mTouchId;
+		size_t		mViewOrder; // position of mView in mViewsWithTouches, so Views are dispatched to in the same order
+		View*		mView;
+		bool		mIntercepting;
+	};
+
+	//! Buffers used while dispatching touches moved or ended, stored per level of recursion so that steady state dispatch doesn't allocate.
+	struct TouchDispatchScratch {
+		std::vector<std::pair<TouchRoute, size_t>>	mRoutes;
+		std::vector<ci::app::TouchEvent::Touch>		mEventTouches;
+		std::vector<ci::app::TouchEvent::Touch>		mViewTouches;
+	};
+
+	TouchDispatchScratch*	pushTouchDispatchScratch();
+	void					popTouchDispatchScratch()	{ mTouchDispatchDepth--; }
+
+	//! Rebuilds mTouchRoutes from the active and intercepted touches of mViewsWithTouches.
+	void rebuildTouchRoutes();
+	//! Fills \a routes with the entries of mTouchRoutes for each touch in \a touches, grouped by View in dispatch order. The second member is the index of the touch in \a touches.
+	void routeTouches( const std::vector<ci::app::TouchEvent::Touch> &touches, std::vector<std::pair<TouchRoute, size_t>> *routes );
 
 #if 0
 	void propagateKeyDown( ViewRef &view, ci::app::KeyEvent &event );
@@ -141,21 +343,65 @@ class CI_UI_API Graph : public View {
 	int					mEventSlotPriority = 1;
 	ci::ivec2			mClippingSize;
 	bool				mClippingSizeSet = false;
-	double				mCurrentTime;
-	uint64_t			mCurrentFrame;
-	
+	double				mCurrentTime = 0;
+	bool				mNeedsRedraw = true;
+	double				mRedrawTime = std::numeric_limits<double>::infinity();
+	uint64_t			mCurrentFrame = 0;
+	double				mTargetFrameRate = 60;
+	std::function<double ()>	mTimeSource;
+	ci::Timer			mHeadlessTimer; // fallback time source when there is no App
+	InputRecorderRef	mInputRecorder;
+
+	FrameStats					mCurrentFrameStats;
+	FrameStats*					mFrameStats = nullptr; // points to mCurrentFrameStats while frame stats are enabled
+	std::vector<FrameStats>		mFrameStatsHistory; // ring buffer of completed frames
+	size_t						mFrameStatsHistoryNext = 0;
+	size_t						mNumFrameStats = 0;
+	bool						mFrameStatsUpdated = false; // propagateUpdate() has been collected for the current frame
+	bool						mFrameStatsTiming = false; // a phase is being timed, so nested phases aren't counted twice
 
 	ci::signals::ConnectionList				mEventConnections;
 	ci::vec2								mPrevMousePos;
+	ci::app::TouchEvent						mMouseTouchEvent; // reused when converting mouse events to touches
 
 	std::list<LayerRef>	    mLayers;
 	std::list<ViewRef>	    mViewsWithTouches;
+	bool					mBatchedHitTestingEnabled = true;
+	bool					mDrawCullingEnabled = true;
+	bool					mLayerCachingEnabled = true;
+	bool					mLayerCacheVerificationEnabled = false;
+	bool					mDrawRecordingEnabled = false;
+	RenderCommandList		mRenderCommands;
+	bool					mRenderCommandsReused = false;
+	ci::Rectf				mRecordedCullBounds; // these three must match for mRenderCommands to be submitted again
+	ci::mat4				mRecordedModelMatrix;
+	ci::mat4				mRecordedProjectionMatrix;
+	std::unique_ptr<TransformHierarchy>	mTransformHierarchy;
+	Animator				mAnimator;
+	ImageLoaderRef			mImageLoader;
+	std::vector<std::unique_ptr<TouchBatch>>	mTouchBatches; // one per level of touches began recursion, reused between events
+	size_t					mTouchBatchDepth = 0;
+	std::vector<TouchRoute>	mTouchRoutes; // sorted by touch id
+	bool					mTouchRoutesDirty = true;
+	std::vector<std::unique_ptr<TouchDispatchScratch>>	mTouchDispatchScratch;
+	size_t					mTouchDispatchDepth = 0;
+	std::vector<ci::app::TouchEvent::Touch>	mTouchesInside; // reused by touches began for each View
+	bool					mTouchCoalescingEnabled = false;
+	std::vector<QueuedTouchEvent>	mQueuedTouchEvents; // storage is reused between frames, only the first mNumQueuedTouchEvents are valid
+	size_t					mNumQueuedTouchEvents = 0;
+	size_t					mNumTouchEventsCoalesced = 0;
+	const std::vector<ci::app::TouchEvent::Touch>*	mCoalescedTouches = nullptr; // samples of the queued event being dispatched
+	InputQueue				mInputQueue;
+	ci::app::TouchEvent		mInjectedTouchEvent; // reused for each touches record popped from mInputQueue
 	ViewRef					mFirstResponder;
 	std::weak_ptr<View>		mPreviousFirstResponder; //! Only store a weak reference to the previous responder so we don't retain it (mFirstResponder will get unset when it is removed from the view hierarchy)
 
 	friend class Layer;
+	friend class View;
 };
 
+CI_UI_API std::ostream& operator<<( std::ostream &os, const Graph::FrameStats &rhs );
+
 class CI_UI_API GraphExc : public ci::Exception {
   public:
 	GraphExc( const std::string &description )
@@ -22,6 +22,7 @@
  */
 
 #include "vu/Image.h"
+#include "vu/ImageAtlas.h"
 
 #include "cinder/gl/Texture.h"
 
@@ -38,6 +39,33 @@ Image::Image( const ci::gl::TextureRef &texture )
 	: mTexture( texture )
 {
 	mSize = mTexture->getSize();
+	mArea = Area( ivec2( 0 ), mSize );
+}
+
+Image::Image( const ci::Surface8uRef &surface )
+	: mSurface( surface )
+{
+	mSize = mSurface->getSize();
+	mArea = Area( ivec2( 0 ), mSize );
+}
+
+Image::Image( const std::shared_ptr<ci::gl::TextureRef> &texture, const ci::Surface8uRef &surface, const ci::Area &area )
+	: mTexture( *texture ), mAtlasTexture( texture ), mSurface( surface ), mSize( area.getSize() ), mArea( area ), mAtlased( true )
+{
+}
+
+void Image::createTexture()
+{
+	if( ! mAtlased ) {
+		mTexture = gl::Texture::create( *mSurface );
+		return;
+	}
+
+	// the first Image of a page that is drawn creates the page's texture for all of them, the ImageAtlas keeps it up to date from then on
+	if( ! *mAtlasTexture )
+		*mAtlasTexture = ImageAtlas::createPageTexture( *mSurface );
+
+	mTexture = *mAtlasTexture;
 }
 
 } // namespace vu
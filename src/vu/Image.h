@@ -26,6 +26,7 @@
 #include "vu/Export.h"
 #include "cinder/Cinder.h"
 #include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
 
 #include <memory>
 
@@ -46,17 +47,37 @@ class CI_UI_API Image {
 	Image( const ci::ImageSourceRef &imageSource );
 	//! \note this is public although in the long run, we will want a way to load textures without being tied to gl, so this will likely change.
 	Image( const ci::gl::TextureRef &texture );
+	//! Creates an Image that keeps \a surface on the CPU, which is what a RenderBackend that doesn't use gl draws from. A Renderer that uses gl creates the texture when it is first drawn.
+	Image( const ci::Surface8uRef &surface );
 
 	const ci::ivec2&    getSize() const     { return mSize; }
 	ci::Area            getBounds() const   { return ci::Area( 0, 0, mSize.x, mSize.y ); }
 
 	const ci::gl::TextureRef&	getTexture() const	{ return mTexture; }
+	//! Returns the Surface this Image was created with, or null if it was created from an ImageSource or texture.
+	const ci::Surface8uRef&		getSurface() const	{ return mSurface; }
+
+	//! Returns the area of getTexture() and getSurface() that this Image covers, which is all of it unless the Image is a part of an ImageAtlas page.
+	const ci::Area&		getArea() const		{ return mArea; }
+	//! Returns whether this Image was inserted into an ImageAtlas, in which case its texture and surface are shared with the other Images on the same page.
+	bool				isAtlased() const	{ return mAtlased; }
 
   private:
+	//! Used by ImageAtlas, \a area is the part of the page's \a texture and \a surface that this Image covers. \a texture is shared by all Images of the page and may hold null.
+	Image( const std::shared_ptr<ci::gl::TextureRef> &texture, const ci::Surface8uRef &surface, const ci::Area &area );
+
+	//! Used by the Renderer to create the texture before the first time this Image is drawn with gl. Atlased Images share their page's texture, which is only created once.
+	void	createTexture();
+
 	ci::gl::TextureRef	mTexture;
+	std::shared_ptr<ci::gl::TextureRef>	mAtlasTexture; // the texture of the ImageAtlas page, shared by all of its Images
+	ci::Surface8uRef	mSurface;
 	ci::ivec2           mSize;
+	ci::Area			mArea;
+	bool				mAtlased = false;
 
 	friend class Renderer;
+	friend class ImageAtlas;
 };
 
 } // namespace vu
\ No newline at end of file
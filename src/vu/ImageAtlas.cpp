@@ -0,0 +1,378 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/ImageAtlas.h"
+
+#include "cinder/gl/Context.h"
+#include "cinder/gl/scoped.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+//! Fills the part of \a paddedArea outside of \a area by repeating the edge pixels of \a area.
+void extrudeEdges( Surface8u *surface, const Area &area, const Area &paddedArea )
+{
+	const uint8_t pixelInc = surface->getPixelInc();
+	for( int y = paddedArea.y1; y < paddedArea.y2; y++ ) {
+		const int sourceY = glm::clamp( y, area.y1, area.y2 - 1 );
+		const bool insideRow = y == sourceY;
+		for( int x = paddedArea.x1; x < paddedArea.x2; x++ ) {
+			// rows of the image itself only need their left and right padding
+			if( insideRow && x == area.x1 ) {
+				x = area.x2 - 1;
+				continue;
+			}
+
+			const int sourceX = glm::clamp( x, area.x1, area.x2 - 1 );
+			memcpy( surface->getData( ivec2( x, y ) ), surface->getData( ivec2( sourceX, sourceY ) ), pixelInc );
+		}
+	}
+}
+
+//! Sets the alpha of every pixel within \a area to opaque.
+void fillAlpha( Surface8u *surface, const Area &area )
+{
+	const uint8_t pixelInc = surface->getPixelInc();
+	const uint8_t alphaOffset = surface->getAlphaOffset();
+	for( int y = area.y1; y < area.y2; y++ ) {
+		uint8_t *alpha = surface->getData( ivec2( area.x1, y ) ) + alphaOffset;
+		for( int x = area.x1; x < area.x2; x++, alpha += pixelInc )
+			*alpha = 255;
+	}
+}
+
+} // anonymous namespace
+
+ImageAtlas::ImageAtlas()
+	: ImageAtlas( Format() )
+{
+}
+
+ImageAtlas::ImageAtlas( const Format &format )
+	: mFormat( format )
+{
+	CI_ASSERT( mFormat.mPageSize.x > 0 && mFormat.mPageSize.y > 0 );
+	CI_ASSERT( mFormat.mPadding >= 0 );
+}
+
+ImageRef ImageAtlas::insert( const ImageSourceRef &imageSource )
+{
+	return insert( Surface8u( imageSource ) );
+}
+
+ImageRef ImageAtlas::insert( const Surface8u &surface )
+{
+	const ivec2 paddedSize = surface.getSize() + ivec2( mFormat.mPadding * 2 );
+	if( paddedSize.x > mFormat.mPageSize.x || paddedSize.y > mFormat.mPageSize.y ) {
+		CI_LOG_W( "image of size " << surface.getSize() << " doesn't fit in a page of size " << mFormat.mPageSize );
+		return nullptr;
+	}
+
+	Area paddedArea;
+	size_t pageIndex = 0;
+	while( pageIndex < mPages.size() && ! allocate( &mPages[pageIndex], paddedSize, &paddedArea ) )
+		pageIndex++;
+
+	if( pageIndex == mPages.size() ) {
+		if( mPages.size() >= mFormat.mMaxPages ) {
+			CI_LOG_W( "all " << mPages.size() << " pages are full, image of size " << surface.getSize() << " not inserted" );
+			return nullptr;
+		}
+
+		addPage();
+		const bool allocated = allocate( &mPages.back(), paddedSize, &paddedArea );
+		CI_ASSERT( allocated );
+		(void)allocated;
+	}
+
+	Page &page = mPages[pageIndex];
+	const Area area( paddedArea.x1 + mFormat.mPadding, paddedArea.y1 + mFormat.mPadding, paddedArea.x2 - mFormat.mPadding, paddedArea.y2 - mFormat.mPadding );
+	page.mSurface->copyFrom( surface, surface.getBounds(), area.getUL() );
+	// copying from a surface without alpha leaves the page's alpha as it was, which is transparent for a new page
+	if( ! surface.hasAlpha() )
+		fillAlpha( page.mSurface.get(), area );
+
+	extrudeEdges( page.mSurface.get(), area, paddedArea );
+	if( *page.mTexture )
+		upload( page, paddedArea );
+
+	// Image's constructor for atlases is private
+	ImageRef image( new Image( page.mTexture, page.mSurface, area ) );
+	page.mEntries.push_back( { image, paddedArea } );
+	page.mNumPixelsUsed += paddedArea.calcArea();
+
+	return image;
+}
+
+void ImageAtlas::evict( const ImageRef &image )
+{
+	for( auto &page : mPages ) {
+		for( size_t i = 0; i < page.mEntries.size(); i++ ) {
+			if( page.mEntries[i].mImage.lock() == image ) {
+				release( &page, i );
+				return;
+			}
+		}
+	}
+
+	CI_LOG_W( "image isn't in this atlas" );
+}
+
+size_t ImageAtlas::evictUnused()
+{
+	size_t numEvicted = 0;
+	for( auto &page : mPages ) {
+		for( size_t i = 0; i < page.mEntries.size(); ) {
+			if( page.mEntries[i].mImage.expired() ) {
+				release( &page, i );
+				numEvicted++;
+			}
+			else
+				i++;
+		}
+	}
+
+	return numEvicted;
+}
+
+size_t ImageAtlas::getNumImages() const
+{
+	size_t result = 0;
+	for( const auto &page : mPages )
+		result += page.mEntries.size();
+
+	return result;
+}
+
+float ImageAtlas::getOccupancy( size_t page ) const
+{
+	return float( mPages.at( page ).mNumPixelsUsed ) / float( mFormat.mPageSize.x * mFormat.mPageSize.y );
+}
+
+float ImageAtlas::getOccupancy() const
+{
+	if( mPages.empty() )
+		return 0;
+
+	size_t numPixelsUsed = 0;
+	for( const auto &page : mPages )
+		numPixelsUsed += page.mNumPixelsUsed;
+
+	return float( numPixelsUsed ) / float( mPages.size() * mFormat.mPageSize.x * mFormat.mPageSize.y );
+}
+
+string ImageAtlas::printOccupancyToString() const
+{
+	stringstream s;
+	s << fixed << setprecision( 1 );
+
+	for( size_t i = 0; i < mPages.size(); i++ ) {
+		s << "[" << i << "] images: " << mPages[i].mEntries.size() << ", occupancy: " << getOccupancy( i ) * 100 << "%";
+
+		if( i < mPages.size() - 1 )
+			s << endl;
+	}
+
+	return s.str();
+}
+
+void ImageAtlas::addPage()
+{
+	mPages.push_back( Page() );
+	Page &page = mPages.back();
+
+	page.mSurface = make_shared<Surface8u>( mFormat.mPageSize.x, mFormat.mPageSize.y, true, SurfaceChannelOrder::RGBA );
+	memset( page.mSurface->getData(), 0, page.mSurface->getRowBytes() * mFormat.mPageSize.y );
+
+	page.mTexture = make_shared<gl::TextureRef>();
+	if( gl::context() )
+		*page.mTexture = createPageTexture( *page.mSurface );
+
+	resetPage( &page );
+}
+
+void ImageAtlas::resetPage( Page *page )
+{
+	CI_ASSERT( page->mEntries.empty() );
+
+	page->mSkyline.assign( 1, { 0, 0, mFormat.mPageSize.x } );
+	page->mFreeAreas.clear();
+	page->mNumPixelsUsed = 0;
+}
+
+bool ImageAtlas::allocate( Page *page, const ivec2 &size, Area *area )
+{
+	return allocateFromFreeAreas( page, size, area ) || allocateFromSkyline( page, size, area );
+}
+
+bool ImageAtlas::allocateFromFreeAreas( Page *page, const ivec2 &size, Area *area )
+{
+	// best fit, so that large free areas stay available for large images
+	auto &freeAreas = page->mFreeAreas;
+	auto best = freeAreas.end();
+	for( auto it = freeAreas.begin(); it != freeAreas.end(); ++it ) {
+		if( it->getWidth() >= size.x && it->getHeight() >= size.y && ( best == freeAreas.end() || it->calcArea() < best->calcArea() ) )
+			best = it;
+	}
+
+	if( best == freeAreas.end() )
+		return false;
+
+	const Area freeArea = *best;
+	freeAreas.erase( best );
+	*area = Area( freeArea.x1, freeArea.y1, freeArea.x1 + size.x, freeArea.y1 + size.y );
+
+	// the rest of the free area is split into the part to the right of the allocated area and the part below it
+	const Area right( area->x2, freeArea.y1, freeArea.x2, area->y2 );
+	const Area below( freeArea.x1, area->y2, freeArea.x2, freeArea.y2 );
+	if( right.calcArea() > 0 )
+		freeAreas.push_back( right );
+	if( below.calcArea() > 0 )
+		freeAreas.push_back( below );
+
+	return true;
+}
+
+bool ImageAtlas::allocateFromSkyline( Page *page, const ivec2 &size, Area *area )
+{
+	auto &skyline = page->mSkyline;
+
+	// bottom-left rule: the position where the rect ends closest to the top, ties go to the narrowest node
+	size_t bestIndex = skyline.size();
+	int bestY2 = INT_MAX;
+	int bestWidth = INT_MAX;
+	for( size_t i = 0; i < skyline.size(); i++ ) {
+		const int y = fitSkyline( *page, i, size );
+		if( y < 0 )
+			continue;
+
+		const int y2 = y + size.y;
+		if( y2 < bestY2 || ( y2 == bestY2 && skyline[i].mWidth < bestWidth ) ) {
+			bestIndex = i;
+			bestY2 = y2;
+			bestWidth = skyline[i].mWidth;
+		}
+	}
+
+	if( bestIndex == skyline.size() )
+		return false;
+
+	const int x = skyline[bestIndex].mX;
+	*area = Area( x, bestY2 - size.y, x + size.x, bestY2 );
+
+	// the new node covers the start of the nodes that follow it, which are shortened or removed
+	skyline.insert( skyline.begin() + bestIndex, { x, bestY2, size.x } );
+	for( size_t i = bestIndex + 1; i < skyline.size(); ) {
+		const int coveredTo = skyline[i - 1].mX + skyline[i - 1].mWidth;
+		auto &node = skyline[i];
+		if( node.mX >= coveredTo )
+			break;
+
+		const int shrink = coveredTo - node.mX;
+		node.mX += shrink;
+		node.mWidth -= shrink;
+		if( node.mWidth > 0 )
+			break;
+
+		skyline.erase( skyline.begin() + i );
+	}
+
+	// merge neighboring nodes at the same height
+	for( size_t i = 0; i + 1 < skyline.size(); ) {
+		if( skyline[i].mY == skyline[i + 1].mY ) {
+			skyline[i].mWidth += skyline[i + 1].mWidth;
+			skyline.erase( skyline.begin() + i + 1 );
+		}
+		else
+			i++;
+	}
+
+	return true;
+}
+
+int ImageAtlas::fitSkyline( const Page &page, size_t index, const ivec2 &size ) const
+{
+	const auto &skyline = page.mSkyline;
+	if( skyline[index].mX + size.x > mFormat.mPageSize.x )
+		return -1;
+
+	// the rect rests on the highest node it spans
+	int y = 0;
+	int widthLeft = size.x;
+	while( widthLeft > 0 ) {
+		CI_ASSERT( index < skyline.size() );
+
+		y = max( y, skyline[index].mY );
+		if( y + size.y > mFormat.mPageSize.y )
+			return -1;
+
+		widthLeft -= skyline[index].mWidth;
+		index++;
+	}
+
+	return y;
+}
+
+void ImageAtlas::release( Page *page, size_t entryIndex )
+{
+	const Area area = page->mEntries[entryIndex].mArea;
+	page->mEntries.erase( page->mEntries.begin() + entryIndex );
+
+	if( page->mEntries.empty() ) {
+		resetPage( page );
+		return;
+	}
+
+	page->mFreeAreas.push_back( area );
+	page->mNumPixelsUsed -= area.calcArea();
+}
+
+void ImageAtlas::upload( const Page &page, const Area &area )
+{
+	// the rows of the area are as long as the page's rows in the surface
+	gl::ScopedTextureBind texScope( *page.mTexture );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, GLint( page.mSurface->getRowBytes() / page.mSurface->getPixelInc() ) );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, area.x1, area.y1, area.getWidth(), area.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, page.mSurface->getData( area.getUL() ) );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+}
+
+// static
+gl::TextureRef ImageAtlas::createPageTexture( const Surface8u &surface )
+{
+	// loaded top-down so that areas of the surface and texture match, which lets upload() copy rows as they are
+	return gl::Texture2d::create( surface, gl::Texture2d::Format().loadTopDown().minFilter( GL_LINEAR ).magFilter( GL_LINEAR ) );
+}
+
+} // namespace vu
@@ -0,0 +1,141 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/Image.h"
+
+#include "cinder/Area.h"
+
+#include <string>
+#include <vector>
+
+namespace vu {
+
+typedef std::shared_ptr<class ImageAtlas>	ImageAtlasRef;
+
+//! Packs many small images into a few shared pages, so that drawing them binds one texture per page instead of one per Image and they batch with each other (see Renderer::setBatchingEnabled()).
+//! Each page keeps a Surface8u and a texture that is updated as images are inserted. The texture is created with the page if a gl context is current,
+//! otherwise when the first of the page's Images is drawn with gl, after which all of them share it.
+//! Pages are packed with a skyline packer, the areas of evicted images are reused by later insertions that fit in them and a page that becomes empty starts over.
+class CI_UI_API ImageAtlas {
+  public:
+	struct Format {
+		//! Sets the size of each page in pixels. \default 1024 x 1024.
+		Format &pageSize( const ci::ivec2 &size )
+		{
+			mPageSize = size;
+			return *this;
+		}
+
+		//! Sets how many pixels each image is extended by on every side, by repeating its edge pixels so that filtering doesn't sample its neighbors. \default 1.
+		Format &padding( int padding )
+		{
+			mPadding = padding;
+			return *this;
+		}
+
+		//! Sets the maximum number of pages, insert() fails once all of them are full. \default 4.
+		Format &maxPages( size_t maxPages )
+		{
+			mMaxPages = maxPages;
+			return *this;
+		}
+
+		ci::ivec2	mPageSize = ci::ivec2( 1024 );
+		int			mPadding = 1;
+		size_t		mMaxPages = 4;
+	};
+
+	ImageAtlas();
+	ImageAtlas( const Format &format );
+
+	//! Copies \a imageSource into a page and returns an Image that covers it. Returns null if it is larger than a page or all pages are full.
+	ImageRef	insert( const ci::ImageSourceRef &imageSource );
+	//! Copies \a surface into a page and returns an Image that covers it. Returns null if it is larger than a page or all pages are full.
+	ImageRef	insert( const ci::Surface8u &surface );
+	//! Frees the area of \a image so that later insertions can reuse it. \a image must not be drawn afterwards.
+	void		evict( const ImageRef &image );
+	//! Frees the areas of Images that are no longer referenced outside of the atlas, returns how many were evicted.
+	size_t		evictUnused();
+
+	const Format&	getFormat() const		{ return mFormat; }
+	size_t			getNumPages() const		{ return mPages.size(); }
+	//! Returns the number of Images that haven't been evicted.
+	size_t			getNumImages() const;
+	//! Returns the fraction of the pixels of \a page that are covered by images and their padding.
+	float			getOccupancy( size_t page ) const;
+	//! Returns the fraction of the pixels of all pages that are covered by images and their padding.
+	float			getOccupancy() const;
+
+	const ci::Surface8uRef&		getPageSurface( size_t page ) const		{ return mPages.at( page ).mSurface; }
+	//! Returns the texture of \a page, which is null until one of its Images is drawn if no gl context was current when the page was created.
+	const ci::gl::TextureRef&	getPageTexture( size_t page ) const		{ return *mPages.at( page ).mTexture; }
+
+	//! Returns the number of images and the occupancy of each page, ex. for logging.
+	std::string printOccupancyToString() const;
+
+  private:
+	//! A segment of a page's skyline, the packed images end at mY from mX to mX + mWidth.
+	struct SkylineNode {
+		int		mX, mY, mWidth;
+	};
+
+	struct Entry {
+		std::weak_ptr<Image>	mImage;
+		ci::Area				mArea;	// including padding
+	};
+
+	struct Page {
+		ci::Surface8uRef			mSurface;
+		std::shared_ptr<ci::gl::TextureRef>	mTexture;	// shared with the page's Images, so that the first one drawn can create it
+		std::vector<SkylineNode>	mSkyline;
+		std::vector<ci::Area>		mFreeAreas;	// areas of evicted images, tried before the skyline
+		std::vector<Entry>			mEntries;
+		size_t						mNumPixelsUsed = 0;
+	};
+
+	void	addPage();
+	//! Resets the skyline and free areas of \a page, which must have no entries.
+	void	resetPage( Page *page );
+	//! Finds an unused area of \a size in \a page, returns false if there is none.
+	bool	allocate( Page *page, const ci::ivec2 &size, ci::Area *area );
+	bool	allocateFromFreeAreas( Page *page, const ci::ivec2 &size, ci::Area *area );
+	bool	allocateFromSkyline( Page *page, const ci::ivec2 &size, ci::Area *area );
+	//! Returns the y that a rect of \a size placed at the skyline node \a index would start at, or -1 if it doesn't fit there.
+	int		fitSkyline( const Page &page, size_t index, const ci::ivec2 &size ) const;
+	//! Removes the entry at \a entryIndex from \a page and frees its area.
+	void	release( Page *page, size_t entryIndex );
+	//! Uploads \a area of the page's surface to its texture.
+	void	upload( const Page &page, const ci::Area &area );
+
+	//! Returns a texture holding \a surface, which is a page's surface.
+	static ci::gl::TextureRef	createPageTexture( const ci::Surface8u &surface );
+
+	Format				mFormat;
+	std::vector<Page>	mPages;
+
+	friend class Image;
+};
+
+} // namespace vu
@@ -0,0 +1,254 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/ImageLoader.h"
+
+#include "cinder/gl/Context.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Log.h"
+#include "cinder/Thread.h"
+
+#include <chrono>
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+// ----------------------------------------------------------------------------------------------------
+// ImageLoad
+// ----------------------------------------------------------------------------------------------------
+
+ImageLoad::ImageLoad( const DataSourceRef &source )
+	: mState( State::QUEUED ), mSource( source )
+{
+}
+
+bool ImageLoad::isDone() const
+{
+	const State state = mState;
+	return state == State::LOADED || state == State::FAILED || state == State::CANCELED;
+}
+
+void ImageLoad::cancel()
+{
+	// a worker may be moving the load to the next state at the same time, whichever change happens first wins
+	State state = mState;
+	while( state != State::LOADED && state != State::FAILED && state != State::CANCELED ) {
+		if( mState.compare_exchange_weak( state, State::CANCELED ) )
+			break;
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// ImageLoader
+// ----------------------------------------------------------------------------------------------------
+
+ImageLoader::ImageLoader()
+	: ImageLoader( Format() )
+{
+}
+
+ImageLoader::ImageLoader( const Format &format )
+	: mFormat( format ), mNumCanceled( 0 )
+{
+	CI_ASSERT( mFormat.mNumThreads > 0 );
+
+	for( size_t i = 0; i < mFormat.mNumThreads; i++ )
+		mThreads.emplace_back( &ImageLoader::workerLoop, this );
+}
+
+ImageLoader::~ImageLoader()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQuit = true;
+		for( const auto &weakLoad : mQueued ) {
+			auto load = weakLoad.lock();
+			if( load )
+				load->cancel();
+		}
+		mQueued.clear();
+	}
+
+	mQueuedCondition.notify_all();
+	for( auto &thread : mThreads )
+		thread.join();
+
+	// decoded loads will never be uploaded
+	for( const auto &load : mDecoded )
+		load->cancel();
+}
+
+ImageLoadRef ImageLoader::load( const DataSourceRef &source )
+{
+	// ImageLoad's constructor is private
+	ImageLoadRef result( new ImageLoad( source ) );
+
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQueued.push_back( result );
+	}
+
+	mQueuedCondition.notify_one();
+	return result;
+}
+
+ImageLoadRef ImageLoader::load( const fs::path &path )
+{
+	return load( loadFile( path ) );
+}
+
+ImageLoadRef ImageLoader::load( const BufferRef &buffer )
+{
+	return load( DataSourceBuffer::create( buffer ) );
+}
+
+size_t ImageLoader::getNumQueued() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mQueued.size() + mNumDecoding;
+}
+
+size_t ImageLoader::getNumDecoded() const
+{
+	lock_guard<mutex> lock( mMutex );
+	return mDecoded.size();
+}
+
+ImageLoadRef ImageLoader::popQueued()
+{
+	unique_lock<mutex> lock( mMutex );
+	while( true ) {
+		mQueuedCondition.wait( lock, [this] { return mQuit || ! mQueued.empty(); } );
+		if( mQuit )
+			return nullptr;
+
+		auto load = mQueued.front().lock();
+		mQueued.pop_front();
+
+		// loads that were released or canceled while queued are never decoded
+		auto state = ImageLoad::State::QUEUED;
+		if( ! load || ! load->mState.compare_exchange_strong( state, ImageLoad::State::DECODING ) ) {
+			mNumCanceled++;
+			continue;
+		}
+
+		mNumDecoding++;
+		return load;
+	}
+}
+
+void ImageLoader::workerLoop()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		auto load = popQueued();
+		if( ! load )
+			return;
+
+		auto nextState = ImageLoad::State::DECODED;
+		try {
+			load->mSurface = make_shared<Surface8u>( loadImage( load->mSource ) );
+		}
+		catch( std::exception &exc ) {
+			CI_LOG_EXCEPTION( "failed to decode image", exc );
+			nextState = ImageLoad::State::FAILED;
+		}
+
+		// the source isn't needed anymore, and can be large when it is a buffer
+		load->mSource.reset();
+
+		lock_guard<mutex> lock( mMutex );
+		mNumDecoding--;
+
+		auto state = ImageLoad::State::DECODING;
+		if( load->mState.compare_exchange_strong( state, nextState ) )
+			mDecoded.push_back( load );
+		else
+			mNumCanceled++;
+	}
+}
+
+size_t ImageLoader::update()
+{
+	const auto start = chrono::steady_clock::now();
+	size_t numUploaded = 0;
+	size_t numBytes = 0;
+
+	while( true ) {
+		// the budget is checked after each upload, so that at least one image is uploaded per update
+		if( numUploaded > 0 ) {
+			const double seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+			if( seconds >= mFormat.mUploadSecondsPerUpdate || numBytes >= mFormat.mUploadBytesPerUpdate )
+				break;
+		}
+
+		ImageLoadRef load;
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( mDecoded.empty() )
+				break;
+
+			load = mDecoded.front();
+			mDecoded.pop_front();
+		}
+
+		if( load->mState == ImageLoad::State::FAILED ) {
+			mNumFailed++;
+			load->mSignalCompleted.emit( nullptr );
+			continue;
+		}
+
+		// nobody is waiting for a load that was released after decoding, so it isn't uploaded
+		if( load.use_count() == 1 )
+			load->cancel();
+
+		auto surface = move( load->mSurface );
+		if( load->mState == ImageLoad::State::CANCELED ) {
+			mNumCanceled++;
+			continue;
+		}
+
+		// without a gl context the Image keeps the surface, for a RenderBackend
+		if( gl::context() )
+			load->mImage = make_shared<Image>( gl::Texture::create( *surface ) );
+		else
+			load->mImage = make_shared<Image>( surface );
+
+		load->mState = ImageLoad::State::LOADED;
+		numUploaded++;
+		numBytes += surface->getRowBytes() * surface->getHeight();
+		mNumLoaded++;
+		mNumBytesUploaded += surface->getRowBytes() * surface->getHeight();
+
+		load->mSignalCompleted.emit( load->mImage );
+	}
+
+	return numUploaded;
+}
+
+} // namespace vu
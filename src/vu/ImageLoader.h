@@ -0,0 +1,161 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/Image.h"
+
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Signals.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vu {
+
+typedef std::shared_ptr<class ImageLoader>	ImageLoaderRef;
+typedef std::shared_ptr<class ImageLoad>	ImageLoadRef;
+
+//! An image being loaded by an ImageLoader. The load is dropped if it is canceled or all references to it are released before it has finished.
+class CI_UI_API ImageLoad {
+  public:
+	enum class State {
+		QUEUED,		//! waiting for a worker thread
+		DECODING,	//! being decoded on a worker thread
+		DECODED,	//! decoded, waiting to be uploaded by ImageLoader::update()
+		LOADED,		//! getImage() is ready
+		FAILED,		//! the source couldn't be decoded
+		CANCELED
+	};
+
+	State	getState() const	{ return mState; }
+	//! Returns whether the load has ended, because it is LOADED, FAILED or CANCELED.
+	bool	isDone() const;
+	//! Returns the loaded Image, which is null until the state is LOADED.
+	const ImageRef&	getImage() const	{ return mImage; }
+	//! Cancels the load unless it is already done. getSignalCompleted() won't be emitted.
+	void	cancel();
+
+	//! Emitted on the thread that calls ImageLoader::update() once the load is LOADED or FAILED, with the loaded Image or null.
+	ci::signals::Signal<void ( const ImageRef & )>&	getSignalCompleted()	{ return mSignalCompleted; }
+
+  private:
+	ImageLoad( const ci::DataSourceRef &source );
+
+	std::atomic<State>	mState;
+	ci::DataSourceRef	mSource;
+	ci::Surface8uRef	mSurface; // written by the worker thread before the state becomes DECODED
+	ImageRef			mImage;
+
+	ci::signals::Signal<void ( const ImageRef & )>	mSignalCompleted;
+
+	friend class ImageLoader;
+};
+
+//! Decodes images on a pool of worker threads and uploads them on the main thread, a few per frame, so that loading many images doesn't stall drawing.
+//! Call update() once per frame, which a Graph does from propagateUpdate() when the ImageLoader is set with Graph::setImageLoader().
+class CI_UI_API ImageLoader {
+  public:
+	struct Format {
+		//! Sets the number of worker threads that decode images. \default 2.
+		Format &numThreads( size_t numThreads )
+		{
+			mNumThreads = numThreads;
+			return *this;
+		}
+
+		//! Sets how many seconds update() may spend uploading decoded images. At least one image is uploaded per update(). \default 0.004.
+		Format &uploadSecondsPerUpdate( double seconds )
+		{
+			mUploadSecondsPerUpdate = seconds;
+			return *this;
+		}
+
+		//! Sets how many bytes of decoded pixels update() may upload. At least one image is uploaded per update(). \default 16 MB.
+		Format &uploadBytesPerUpdate( size_t numBytes )
+		{
+			mUploadBytesPerUpdate = numBytes;
+			return *this;
+		}
+
+		size_t	mNumThreads = 2;
+		double	mUploadSecondsPerUpdate = 0.004;
+		size_t	mUploadBytesPerUpdate = 16 * 1024 * 1024;
+	};
+
+	ImageLoader();
+	ImageLoader( const Format &format );
+	//! Joins the worker threads and cancels all loads that haven't been uploaded yet.
+	~ImageLoader();
+
+	//! Queues \a source to be decoded on a worker thread.
+	ImageLoadRef	load( const ci::DataSourceRef &source );
+	//! Queues the file at \a path to be decoded on a worker thread.
+	ImageLoadRef	load( const ci::fs::path &path );
+	//! Queues the encoded image in \a buffer to be decoded on a worker thread. \a buffer must not be modified until the load is done.
+	ImageLoadRef	load( const ci::BufferRef &buffer );
+
+	//! Turns decoded images into Images, creating their textures if a gl context is current, until the Format's time or byte budget is spent.
+	//! Emits ImageLoad::getSignalCompleted() for each finished load. Call from the main thread. Returns the number of Images uploaded.
+	size_t	update();
+
+	const Format&	getFormat() const	{ return mFormat; }
+	//! Returns the number of loads waiting for or being decoded.
+	size_t	getNumQueued() const;
+	//! Returns the number of decoded loads waiting for update().
+	size_t	getNumDecoded() const;
+	//! Returns the number of Images uploaded by update() since construction.
+	size_t	getNumLoaded() const	{ return mNumLoaded; }
+	//! Returns the number of loads that failed to decode since construction.
+	size_t	getNumFailed() const	{ return mNumFailed; }
+	//! Returns the number of loads dropped because they were canceled or released since construction.
+	size_t	getNumCanceled() const	{ return mNumCanceled; }
+	//! Returns the number of bytes of decoded pixels uploaded since construction.
+	size_t	getNumBytesUploaded() const	{ return mNumBytesUploaded; }
+
+  private:
+	void	workerLoop();
+	//! Pops the next queued load that is still wanted and marks it DECODING, or returns null when the ImageLoader is being destroyed.
+	ImageLoadRef	popQueued();
+
+	Format							mFormat;
+	std::vector<std::thread>		mThreads;
+	mutable std::mutex				mMutex;
+	std::condition_variable			mQueuedCondition;
+	std::deque<std::weak_ptr<ImageLoad>>	mQueued;	// guarded by mMutex, loads that are released before decoding are skipped
+	std::deque<ImageLoadRef>		mDecoded;	// guarded by mMutex, decoded or failed loads waiting for update()
+	size_t							mNumDecoding = 0;	// guarded by mMutex
+	bool							mQuit = false;		// guarded by mMutex
+
+	size_t	mNumLoaded = 0;
+	size_t	mNumFailed = 0;
+	std::atomic<size_t>	mNumCanceled;
+	size_t	mNumBytesUploaded = 0;
+};
+
+} // namespace vu
@@ -22,6 +22,7 @@
 */
 
 #include "ImageView.h"
+#include "vu/Graph.h"
 #include "cinder/gl/Batch.h"
 
 using namespace ci;
@@ -35,9 +36,88 @@ ImageView::ImageView( const ci::Rectf &bounds )
 	setInteractive( false );
 }
 
+ImageView::~ImageView()
+{
+	cancelImageLoad();
+}
+
+void ImageView::animateColor( const ci::Color &color, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( getGraph(), "View must be in a Graph to use its Animator" );
+	getGraph()->getAnimator().animate( this, mColor.ptr(), color, getGraph()->getCurrentTime() + delay, duration, ease );
+}
+
 void ImageView::setImage( const ImageRef &image )
 {
+	cancelImageLoad();
+	mImageLoad.reset();
+
+	if( mImage == image )
+		return;
+
+	mImage = image;
+	setNeedsRedraw();
+}
+
+void ImageView::setImageLoad( const ImageLoadRef &load )
+{
+	if( mImageLoad == load )
+		return;
+
+	cancelImageLoad();
+	mImageLoad = load;
+	mImage.reset();
+	setNeedsRedraw();
+
+	if( ! mImageLoad )
+		return;
+
+	if( ! mImageLoad->isDone() )
+		mImageLoadConnection = mImageLoad->getSignalCompleted().connect( [this]( const ImageRef &image ) { imageLoadCompleted( image ); } );
+	else if( mImageLoad->getState() != ImageLoad::State::CANCELED )
+		imageLoadCompleted( mImageLoad->getImage() );
+}
+
+bool ImageView::isLoading() const
+{
+	return mImageLoad && ! mImageLoad->isDone();
+}
+
+void ImageView::cancelImageLoad()
+{
+	mImageLoadConnection.disconnect();
+	if( ! isLoading() )
+		return;
+
+	// canceling a shared load would also cancel it for its other holders
+	if( mImageLoad.use_count() == 1 )
+		mImageLoad->cancel();
+	else
+		mImageLoad.reset();
+}
+
+void ImageView::removedFromParent()
+{
+	// a removed ImageView that is kept around, ex. for reuse, shouldn't keep loading an image that isn't shown
+	cancelImageLoad();
+}
+
+void ImageView::setPlaceholderImage( const ImageRef &image )
+{
+	if( mPlaceholderImage == image )
+		return;
+
+	mPlaceholderImage = image;
+	if( ! mImage )
+		setNeedsRedraw();
+}
+
+void ImageView::imageLoadCompleted( const ImageRef &image )
+{
+	mImageLoadConnection.disconnect();
 	mImage = image;
+	setNeedsRedraw();
+	mSignalImageLoaded.emit();
 }
 
 void ImageView::setShader( const ci::gl::GlslProgRef &glsl )
@@ -47,7 +127,10 @@ void ImageView::setShader( const ci::gl::GlslProgRef &glsl )
 	}
 	else {
 		mBatch = gl::Batch::create( geom::Rect( Rectf( 0, 0, 1, 1 ) ),  glsl );
+		mBatchTexCoords = Rectf::zero();
 	}
+
+	setNeedsRedraw();
 }
 
 ci::gl::GlslProgRef	ImageView::getShader() const
@@ -61,9 +144,13 @@ ci::gl::GlslProgRef	ImageView::getShader() const
 
 void ImageView::draw( Renderer *ren )
 {
-	if( ! mImage )
+	const ImageRef &image = getDisplayedImage();
+	if( ! image )
 		return;
 
+	if( ! mColor.isComplete() )
+		setNeedsRedraw();
+
 	// TODO: this should be handled at the Renderer level
 	if( isRenderTransparencyToFrameBufferEnabled() )
 		ren->setColor( getColor() );
@@ -74,20 +161,36 @@ void ImageView::draw( Renderer *ren )
 	}
 
 	if( mBatch ) {
-		ren->draw( mImage, getDestRectLocal(), mBatch );
+		// the batch's rect samples the whole texture, so it is rebuilt to sample only an atlased Image's area of the page
+		const Rectf texCoords = image->isAtlased() && image->getTexture() ? image->getTexture()->getAreaTexCoords( image->getArea() ) : Rectf::zero();
+		if( texCoords != mBatchTexCoords )
+			updateBatchTexCoords( texCoords );
+
+		ren->draw( image, getDestRectLocal(), mBatch );
 	}
 	else {
-		ren->draw( mImage, getDestRectLocal() );
+		ren->draw( image, getDestRectLocal() );
 	}
 }
 
+void ImageView::updateBatchTexCoords( const Rectf &texCoords )
+{
+	auto rect = geom::Rect( Rectf( 0, 0, 1, 1 ) );
+	if( texCoords != Rectf::zero() )
+		rect.texCoords( texCoords.getUpperLeft(), texCoords.getUpperRight(), texCoords.getLowerRight(), texCoords.getLowerLeft() );
+
+	mBatch = gl::Batch::create( rect, mBatch->getGlslProg() );
+	mBatchTexCoords = texCoords;
+}
+
 Rectf ImageView::getDestRectLocal() const
 {
-	if( ! mImage ) {
+	const ImageRef &image = getDisplayedImage();
+	if( ! image ) {
 		return Rectf::zero();
 	}
 
-	Rectf texBounds = mImage->getBounds();
+	Rectf texBounds = image->getBounds();
 	auto bounds = getBoundsLocal();
 
 	switch( mScaleMode ) {
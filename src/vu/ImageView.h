@@ -25,6 +25,7 @@
 
 #include "vu/View.h"
 #include "vu/Image.h"
+#include "vu/ImageLoader.h"
 
 namespace cinder {
 
@@ -55,31 +56,66 @@ class CI_UI_API ImageView : public View {
   public:
 
 	ImageView( const ci::Rectf &bounds = ci::Rectf::zero() );
+	//! Cancels the image load in progress, if any, see cancelImageLoad().
+	~ImageView();
 
+	//! Sets the Image to draw, canceling the image load in progress if any, see cancelImageLoad().
 	void			setImage( const ImageRef &image );
+	//! Draws the Image of \a load once it has loaded, and the placeholder Image until then. Setting another image, removing this ImageView from its parent
+	//! or destroying it cancels \a load if it hasn't finished, see cancelImageLoad().
+	void			setImageLoad( const ImageLoadRef &load );
 	ImageRef		getImage() const	{ return mImage; }
-
-	void			setScaleMode( ImageScaleMode mode )	{ mScaleMode = mode; }
+	//! Returns the load set with setImageLoad(), which is kept after it completes, or null if the Image was set directly.
+	const ImageLoadRef&	getImageLoad() const	{ return mImageLoad; }
+	//! Returns whether the load set with setImageLoad() hasn't finished yet.
+	bool			isLoading() const;
+	//! Cancels the image load in progress, if any. A load that is also held elsewhere (ex. by another ImageView showing the same image) isn't canceled,
+	//! this ImageView only stops waiting for it and releases it.
+	void			cancelImageLoad();
+
+	//! Sets the Image drawn while an image load is in progress or after it failed. \default nullptr.
+	void			setPlaceholderImage( const ImageRef &image );
+	const ImageRef&	getPlaceholderImage() const		{ return mPlaceholderImage; }
+
+	//! Signal emitted when a load set with setImageLoad() completes. getImage() is null if it failed.
+	ci::signals::Signal<void ()>&	getSignalImageLoaded()	{ return mSignalImageLoaded; }
+
+	void			setScaleMode( ImageScaleMode mode )	{ mScaleMode = mode; setNeedsRedraw(); }
 	ImageScaleMode	getScaleMode() const				{ return mScaleMode; }
 
-	//! Returns the destination Rect in this ImageView's coordinate system.
+	//! Returns the destination Rect in this ImageView's coordinate system, for the placeholder Image while loading. Images from an ImageAtlas are fit by the size of their area of the page.
 	ci::Rectf		getDestRectLocal() const;
 
-	void					setColor( const ci::Color &color )	{ mColor = color; }
+	void					setColor( const ci::Color &color )	{ mColor = color; setNeedsRedraw(); }
 	const ci::Color&		getColor() const					{ return mColor; }
-	ci::Anim<ci::Color>*	getColorAnim()						{ return &mColor; }
+	ci::Anim<ci::Color>*	getColorAnim()						{ setNeedsRedraw(); return &mColor; }
+	//! Animates the color to \a color with the Graph's Animator, see View::animatePos().
+	void					animateColor( const ci::Color &color, double duration, double delay = 0, Ease ease = Ease::LINEAR );
 
 	void setShader( const ci::gl::GlslProgRef &glsl );
 	ci::gl::GlslProgRef	getShader() const;
 
   protected:
 	void draw( Renderer *ren ) override;
+	bool drawsOnlyThroughRenderer() const override	{ return true; }
+	void removedFromParent() override;
 
   private:
+	//! Returns the Image that is drawn, which is the placeholder Image while there is no Image.
+	const ImageRef&	getDisplayedImage() const	{ return mImage ? mImage : mPlaceholderImage; }
+	void			imageLoadCompleted( const ImageRef &image );
+	//! Recreates mBatch with \a texCoords, or with the rect's default texture coordinates if \a texCoords is zero.
+	void updateBatchTexCoords( const ci::Rectf &texCoords );
+
 	ImageRef				mImage;
+	ImageRef				mPlaceholderImage;
+	ImageLoadRef			mImageLoad;
+	ci::signals::Connection	mImageLoadConnection;
+	ci::signals::Signal<void ()>	mSignalImageLoaded;
 	ImageScaleMode			mScaleMode = ImageScaleMode::FIT;
 	ci::Anim<ci::Color>		mColor = ci::Color::white();
 	ci::gl::BatchRef		mBatch;
+	ci::Rectf				mBatchTexCoords = ci::Rectf::zero(); // zero while mBatch uses the default texture coordinates
 };
 
 
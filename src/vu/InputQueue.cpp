@@ -0,0 +1,136 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "vu/InputQueue.h"
+
+#include "cinder/CinderAssert.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+// ----------------------------------------------------------------------------------------------------
+// InputRecord
+// ----------------------------------------------------------------------------------------------------
+
+const size_t InputRecord::MAX_TOUCHES;
+
+// static
+InputRecord InputRecord::touches( Type type, const vector<app::TouchEvent::Touch> &touches, double timestamp, size_t first )
+{
+	CI_ASSERT( first == 0 || first < touches.size() );
+
+	InputRecord result;
+	result.mType = type;
+	result.mTimestamp = timestamp;
+	result.mNumTouches = min( touches.size() - min( first, touches.size() ), MAX_TOUCHES );
+	for( size_t i = 0; i < result.mNumTouches; i++ ) {
+		const auto &touch = touches[first + i];
+		result.mTouches[i].mId = touch.getId();
+		result.mTouches[i].mPos = touch.getPos();
+		result.mTouches[i].mPrevPos = touch.getPrevPos();
+	}
+
+	return result;
+}
+
+// static
+InputRecord InputRecord::key( Type type, const app::KeyEvent &event, double timestamp )
+{
+	InputRecord result;
+	result.mType = type;
+	result.mTimestamp = timestamp;
+	result.mKeyCode = event.getCode();
+	result.mKeyChar32 = event.getCharUtf32();
+	result.mKeyChar = event.getChar();
+	result.mKeyModifiers = ( event.isShiftDown() ? app::KeyEvent::SHIFT_DOWN : 0 ) | ( event.isAltDown() ? app::KeyEvent::ALT_DOWN : 0 )
+		| ( event.isControlDown() ? app::KeyEvent::CTRL_DOWN : 0 ) | ( event.isMetaDown() ? app::KeyEvent::META_DOWN : 0 );
+	result.mNativeKeyCode = event.getNativeKeyCode();
+
+	return result;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// InputQueue
+// ----------------------------------------------------------------------------------------------------
+
+// Each slot's sequence number says whose turn it is: equal to the position when it is free to be pushed to,
+// position + 1 when it holds a record ready to be popped. This is D. Vyukov's bounded queue, with a single consumer.
+InputQueue::InputQueue( size_t capacity )
+	: mPushPos( 0 ), mPopPos( 0 )
+{
+	size_t size = 2;
+	while( size < capacity )
+		size *= 2;
+
+	mSlots.reset( new Slot[size] );
+	mMask = size - 1;
+	for( size_t i = 0; i < size; i++ )
+		mSlots[i].mSequence.store( i, memory_order_relaxed );
+}
+
+bool InputQueue::push( const InputRecord &record )
+{
+	Slot *slot;
+	size_t pos = mPushPos.load( memory_order_relaxed );
+	while( true ) {
+		slot = &mSlots[pos & mMask];
+		size_t sequence = slot->mSequence.load( memory_order_acquire );
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if( diff == 0 ) {
+			// slot is free, try to claim it
+			if( mPushPos.compare_exchange_weak( pos, pos + 1, memory_order_relaxed ) )
+				break;
+		}
+		else if( diff < 0 ) {
+			// slot still holds a record from the previous lap, so the queue is full
+			return false;
+		}
+		else {
+			// another producer claimed this slot first
+			pos = mPushPos.load( memory_order_relaxed );
+		}
+	}
+
+	slot->mRecord = record;
+	slot->mSequence.store( pos + 1, memory_order_release );
+	return true;
+}
+
+bool InputQueue::pop( InputRecord *record )
+{
+	CI_ASSERT( record );
+
+	Slot &slot = mSlots[mPopPos & mMask];
+	size_t sequence = slot.mSequence.load( memory_order_acquire );
+	if( (intptr_t)sequence - (intptr_t)( mPopPos + 1 ) < 0 ) {
+		// empty, or the producer that claimed this slot hasn't finished writing to it
+		return false;
+	}
+
+	*record = slot.mRecord;
+	slot.mSequence.store( mPopPos + mMask + 1, memory_order_release );
+	mPopPos++;
+	return true;
+}
+
+} // namespace vu
@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/app/KeyEvent.h"
+#include "cinder/app/TouchEvent.h"
+
+#include <atomic>
+#include <memory>
+
+namespace vu {
+
+//! Touch or key event that can be pushed to an InputQueue from any thread. Fixed size and self contained, so it can be copied in and out of the queue without allocating.
+struct CI_UI_API InputRecord {
+	enum class Type : uint8_t { TOUCHES_BEGAN, TOUCHES_MOVED, TOUCHES_ENDED, KEY_DOWN, KEY_UP };
+
+	//! The most touches a single record holds. Events with more touches are split into several records of the same type and timestamp, see getNumTouchesRecords().
+	static const size_t MAX_TOUCHES = 10;
+
+	struct Touch {
+		uint32_t	mId = 0;
+		ci::vec2	mPos;
+		ci::vec2	mPrevPos;
+	};
+
+	//! Returns a record for a touches event of \a type, holding up to MAX_TOUCHES of \a touches starting at index \a first.
+	static InputRecord	touches( Type type, const std::vector<ci::app::TouchEvent::Touch> &touches, double timestamp, size_t first = 0 );
+	//! Returns the number of records needed to hold \a numTouches touches, where record \a i is made with touches( type, touches, timestamp, i * MAX_TOUCHES ).
+	static size_t		getNumTouchesRecords( size_t numTouches )	{ return numTouches <= MAX_TOUCHES ? 1 : ( numTouches + MAX_TOUCHES - 1 ) / MAX_TOUCHES; }
+	//! Returns a record for a key event of \a type.
+	static InputRecord	key( Type type, const ci::app::KeyEvent &event, double timestamp );
+
+	//! Returns whether this is a touches began, moved or ended record.
+	bool	isTouches() const	{ return mType == Type::TOUCHES_BEGAN || mType == Type::TOUCHES_MOVED || mType == Type::TOUCHES_ENDED; }
+
+	Type			mType = Type::TOUCHES_BEGAN;
+	double			mTimestamp = 0; //! In seconds, used as the time of each touch.
+
+	size_t			mNumTouches = 0;
+	Touch			mTouches[MAX_TOUCHES];
+
+	int				mKeyCode = 0;
+	uint32_t		mKeyChar32 = 0;
+	char			mKeyChar = 0;
+	unsigned int	mKeyModifiers = 0;
+	unsigned int	mNativeKeyCode = 0;
+};
+
+//! Bounded lock-free queue of InputRecords with any number of producer threads and a single consumer thread.
+//! Records are popped in the order their push claimed a slot, so records pushed from one thread stay in order.
+class CI_UI_API InputQueue {
+  public:
+	//! Creates a queue that holds \a capacity records, rounded up to a power of two.
+	explicit InputQueue( size_t capacity = 1024 );
+
+	InputQueue( const InputQueue & ) = delete;
+	InputQueue& operator=( const InputQueue & ) = delete;
+
+	//! Pushes \a record from any thread. Returns false without blocking if the queue is full.
+	bool	push( const InputRecord &record );
+	//! Pops the oldest record into \a record. Only call from the consumer thread. Returns false if there is nothing ready to pop.
+	bool	pop( InputRecord *record );
+
+	//! Returns the maximum number of records the queue can hold.
+	size_t	getCapacity() const	{ return mMask + 1; }
+
+  private:
+	struct Slot {
+		std::atomic<size_t>	mSequence;
+		InputRecord			mRecord;
+	};
+
+	std::unique_ptr<Slot[]>	mSlots;
+	size_t					mMask;
+
+	// Kept on separate cache lines so producers and the consumer don't contend. Padded rather than declared alignas( 64 ),
+	// which would make the queue and classes that hold it, like Graph, over-aligned for operator new before C++17.
+	static const size_t CACHE_LINE_SIZE = 64;
+
+	char					mPushPad[CACHE_LINE_SIZE];
+	std::atomic<size_t>		mPushPos;
+	char					mPopPad[CACHE_LINE_SIZE - sizeof( std::atomic<size_t> )];
+	size_t					mPopPos;
+};
+
+} // namespace vu
@@ -0,0 +1,247 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "vu/InputRecording.h"
+#include "vu/Graph.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+const char		FORMAT_MAGIC[4]	= { 'V', 'U', 'I', 'N' };
+const uint32_t	FORMAT_VERSION	= 1;
+const size_t	HEADER_SIZE		= sizeof( FORMAT_MAGIC ) + sizeof( FORMAT_VERSION );
+
+template <typename T>
+void writeValue( const T &value, vector<uint8_t> *data )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>( &value );
+	data->insert( data->end(), bytes, bytes + sizeof( T ) );
+}
+
+template <typename T>
+bool readValue( const vector<uint8_t> &data, size_t *pos, T *value )
+{
+	if( *pos + sizeof( T ) > data.size() )
+		return false;
+
+	memcpy( value, data.data() + *pos, sizeof( T ) );
+	*pos += sizeof( T );
+	return true;
+}
+
+void writeHeader( vector<uint8_t> *data )
+{
+	data->insert( data->end(), begin( FORMAT_MAGIC ), end( FORMAT_MAGIC ) );
+	writeValue( FORMAT_VERSION, data );
+}
+
+// Touches records only store their touches and key records only their key fields, so most records are a few dozen bytes.
+void writeRecord( const InputRecord &record, vector<uint8_t> *data )
+{
+	writeValue( static_cast<uint8_t>( record.mType ), data );
+	writeValue( record.mTimestamp, data );
+
+	if( record.isTouches() ) {
+		writeValue( static_cast<uint8_t>( record.mNumTouches ), data );
+		for( size_t i = 0; i < record.mNumTouches; i++ ) {
+			const auto &touch = record.mTouches[i];
+			writeValue( touch.mId, data );
+			writeValue( touch.mPos.x, data );
+			writeValue( touch.mPos.y, data );
+			writeValue( touch.mPrevPos.x, data );
+			writeValue( touch.mPrevPos.y, data );
+		}
+	}
+	else {
+		writeValue( static_cast<int32_t>( record.mKeyCode ), data );
+		writeValue( record.mKeyChar32, data );
+		writeValue( record.mKeyChar, data );
+		writeValue( static_cast<uint32_t>( record.mKeyModifiers ), data );
+		writeValue( static_cast<uint32_t>( record.mNativeKeyCode ), data );
+	}
+}
+
+// Returns false if the data ends before the record does or the record is malformed.
+bool readRecord( const vector<uint8_t> &data, size_t *pos, InputRecord *record )
+{
+	uint8_t type;
+	if( ! readValue( data, pos, &type ) || type > static_cast<uint8_t>( InputRecord::Type::KEY_UP ) )
+		return false;
+
+	record->mType = static_cast<InputRecord::Type>( type );
+	if( ! readValue( data, pos, &record->mTimestamp ) )
+		return false;
+
+	if( record->isTouches() ) {
+		uint8_t numTouches;
+		if( ! readValue( data, pos, &numTouches ) || numTouches > InputRecord::MAX_TOUCHES )
+			return false;
+
+		record->mNumTouches = numTouches;
+		for( size_t i = 0; i < record->mNumTouches; i++ ) {
+			auto &touch = record->mTouches[i];
+			if( ! readValue( data, pos, &touch.mId ) || ! readValue( data, pos, &touch.mPos.x ) || ! readValue( data, pos, &touch.mPos.y )
+				|| ! readValue( data, pos, &touch.mPrevPos.x ) || ! readValue( data, pos, &touch.mPrevPos.y ) )
+				return false;
+		}
+	}
+	else {
+		int32_t keyCode;
+		uint32_t modifiers, nativeKeyCode;
+		if( ! readValue( data, pos, &keyCode ) || ! readValue( data, pos, &record->mKeyChar32 ) || ! readValue( data, pos, &record->mKeyChar )
+			|| ! readValue( data, pos, &modifiers ) || ! readValue( data, pos, &nativeKeyCode ) )
+			return false;
+
+		record->mKeyCode = keyCode;
+		record->mKeyModifiers = modifiers;
+		record->mNativeKeyCode = nativeKeyCode;
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// InputRecorder
+// ----------------------------------------------------------------------------------------------------
+
+InputRecorder::InputRecorder()
+{
+	writeHeader( &mData );
+}
+
+void InputRecorder::record( const InputRecord &record )
+{
+	InputRecord relative = record;
+	relative.mTimestamp -= mStartTime;
+	writeRecord( relative, &mData );
+	mNumRecords++;
+}
+
+void InputRecorder::clear()
+{
+	mData.clear();
+	writeHeader( &mData );
+	mNumRecords = 0;
+}
+
+void InputRecorder::write( const fs::path &filePath ) const
+{
+	ofstream stream( filePath.string(), ios::binary );
+	stream.write( reinterpret_cast<const char *>( mData.data() ), mData.size() );
+	if( ! stream )
+		throw InputRecordingExc( "failed to write input recording to: " + filePath.string() );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// InputPlayer
+// ----------------------------------------------------------------------------------------------------
+
+InputPlayer::InputPlayer( vector<uint8_t> data )
+	: mData( move( data ) )
+{
+	if( mData.size() < HEADER_SIZE || memcmp( mData.data(), FORMAT_MAGIC, sizeof( FORMAT_MAGIC ) ) != 0 )
+		throw InputRecordingExc( "not an input recording" );
+
+	size_t pos = sizeof( FORMAT_MAGIC );
+	uint32_t version;
+	readValue( mData, &pos, &version );
+	if( version != FORMAT_VERSION )
+		throw InputRecordingExc( "unsupported input recording version: " + to_string( version ) );
+
+	// validate everything up front so that playback can't fail part way through
+	InputRecord record;
+	while( pos < mData.size() ) {
+		if( ! readRecord( mData, &pos, &record ) )
+			throw InputRecordingExc( "malformed input recording at record " + to_string( mNumRecords ) );
+
+		mDuration = record.mTimestamp;
+		mNumRecords++;
+	}
+
+	rewind();
+}
+
+// static
+InputPlayerRef InputPlayer::load( const fs::path &filePath )
+{
+	ifstream stream( filePath.string(), ios::binary );
+	if( ! stream )
+		throw InputRecordingExc( "failed to open input recording: " + filePath.string() );
+
+	vector<uint8_t> data( ( istreambuf_iterator<char>( stream ) ), istreambuf_iterator<char>() );
+	return make_shared<InputPlayer>( move( data ) );
+}
+
+void InputPlayer::rewind()
+{
+	mReadPos = HEADER_SIZE;
+	readNextRecord();
+}
+
+void InputPlayer::readNextRecord()
+{
+	mHasNextRecord = mReadPos < mData.size() && readRecord( mData, &mReadPos, &mNextRecord );
+}
+
+void InputPlayer::update( Graph *graph, double time )
+{
+	while( mHasNextRecord && mNextRecord.mTimestamp <= time ) {
+		if( ! graph->injectInput( mNextRecord ) )
+			break; // queue is full, try again next frame
+
+		readNextRecord();
+	}
+}
+
+size_t InputPlayer::playAll( Graph *graph, double frameDuration, const function<void ()> &frameFn )
+{
+	CI_ASSERT( frameDuration > 0 );
+
+	auto prevTimeSource = graph->getTimeSource();
+	mVirtualTime = 0;
+	graph->setTimeSource( [this] { return mVirtualTime; } );
+
+	size_t numFrames = 0;
+	while( ! isFinished() ) {
+		update( graph, mVirtualTime );
+		graph->propagateUpdate();
+		if( frameFn )
+			frameFn();
+
+		mVirtualTime += frameDuration;
+		numFrames++;
+	}
+
+	graph->setTimeSource( prevTimeSource );
+	return numFrames;
+}
+
+} // namespace vu
@@ -0,0 +1,115 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "vu/Export.h"
+#include "vu/InputQueue.h"
+
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace vu {
+
+class Graph;
+
+typedef std::shared_ptr<class InputRecorder>	InputRecorderRef;
+typedef std::shared_ptr<class InputPlayer>		InputPlayerRef;
+
+//! Records input into a compact binary format that InputPlayer can replay. Attach to a Graph with Graph::setInputRecorder() to record everything the Graph receives.
+//! Data is stored in native byte order (little endian on all supported platforms): a 4 byte magic and uint32 version, followed by records until the end of the data.
+//! Touches events with more than InputRecord::MAX_TOUCHES touches are recorded as consecutive records with the same timestamp, which are replayed as separate events.
+class CI_UI_API InputRecorder {
+  public:
+	InputRecorder();
+
+	//! Sets the time in seconds that recorded timestamps are relative to.
+	void	setStartTime( double time )		{ mStartTime = time; }
+	//! Returns the time in seconds that recorded timestamps are relative to.
+	double	getStartTime() const			{ return mStartTime; }
+
+	//! Appends \a record, with its timestamp made relative to the start time.
+	void	record( const InputRecord &record );
+	//! Removes all recorded input.
+	void	clear();
+
+	//! Returns the number of records recorded.
+	size_t	getNumRecords() const				{ return mNumRecords; }
+	//! Returns the recorded input, in the same format as written by write().
+	const std::vector<uint8_t>&	getData() const	{ return mData; }
+	//! Writes the recorded input to \a filePath. Throws InputRecordingExc on failure.
+	void	write( const ci::fs::path &filePath ) const;
+
+  private:
+	std::vector<uint8_t>	mData;
+	size_t					mNumRecords = 0;
+	double					mStartTime = 0;
+};
+
+//! Replays input recorded by InputRecorder into a Graph, either at the recorded timing or as fast as possible with a virtual clock.
+class CI_UI_API InputPlayer {
+  public:
+	//! Creates a player for \a data, in the format recorded by InputRecorder. Throws InputRecordingExc if \a data isn't valid.
+	explicit InputPlayer( std::vector<uint8_t> data );
+
+	//! Loads a file written by InputRecorder::write(). Throws InputRecordingExc on failure.
+	static InputPlayerRef	load( const ci::fs::path &filePath );
+
+	//! Injects all records with a timestamp at or before \a time (seconds since the start of the recording) into \a graph, with Graph::injectInput().
+	//! They are dispatched on the next Graph::propagateUpdate(). Records that don't fit in the Graph's input queue are injected on a later call.
+	void	update( Graph *graph, double time );
+	//! Plays the whole recording into \a graph as fast as possible, calling Graph::propagateUpdate() then \a frameFn (if set) once per frame.
+	//! The Graph's time source is replaced by a virtual clock that starts at zero and advances \a frameDuration each frame, and restored afterwards. Returns the number of frames.
+	size_t	playAll( Graph *graph, double frameDuration = 1.0 / 60.0, const std::function<void ()> &frameFn = nullptr );
+	//! Starts playback over from the first record.
+	void	rewind();
+
+	//! Returns true when all records have been injected.
+	bool	isFinished() const		{ return ! mHasNextRecord; }
+	//! Returns the number of records in the recording.
+	size_t	getNumRecords() const	{ return mNumRecords; }
+	//! Returns the timestamp of the last record, in seconds.
+	double	getDuration() const		{ return mDuration; }
+
+  private:
+	void	readNextRecord();
+
+	std::vector<uint8_t>	mData;
+	size_t					mReadPos = 0;
+	InputRecord				mNextRecord;
+	bool					mHasNextRecord = false;
+	size_t					mNumRecords = 0;
+	double					mDuration = 0;
+	double					mVirtualTime = 0;
+};
+
+class CI_UI_API InputRecordingExc : public ci::Exception {
+  public:
+	InputRecordingExc( const std::string &description )
+		: Exception( description )
+	{}
+};
+
+} // namespace vu
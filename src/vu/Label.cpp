@@ -23,6 +23,7 @@
 
 
 #include "vu/Label.h"
+#include "vu/Graph.h"
 
 #include "cinder/Log.h"
 #include "cinder/CinderAssert.h"
@@ -64,6 +65,12 @@ void Label::setFontFile( const ci::fs::path &filePath, float fontSize )
 	markTextLayoutDirty();
 }
 
+void Label::animateTextColor( const ColorA &color, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( getGraph(), "View must be in a Graph to use its Animator" );
+	getGraph()->getAnimator().animate( this, mTextColor.ptr(), color, getGraph()->getCurrentTime() + delay, duration, ease );
+}
+
 void Label::setText( const std::string &text )
 {
 	if( mTextStr == text )
@@ -71,6 +78,7 @@ void Label::setText( const std::string &text )
 
 	mTextStr = text;
 	markTextLayoutDirty();
+	setNeedsRedraw(); // markTextLayoutDirty() does nothing when the text was cleared
 }
 
 void Label::setSize( const ci::vec2 &size )
@@ -127,6 +135,9 @@ void Label::draw( Renderer *ren )
 	if( mTextStr.empty() )
 		return;
 
+	if( ! mTextColor.isComplete() )
+		setNeedsRedraw();
+
 	ren->setColor( mTextColor );
 
 	auto baseline = getBaseLine();
@@ -136,10 +147,10 @@ void Label::draw( Renderer *ren )
 		fitRect.y1 += mPadding.y1 + baseline.y; // TODO: figure out how wrap and baseline should work together
 		fitRect.x2 -= mPadding.x2;
 		fitRect.y2 -= mPadding.y2;
-		mText->drawStringWrapped( mTextStr, fitRect );
+		ren->drawStringWrapped( mText, mTextStr, fitRect );
 	}
 	else {
-		mText->drawString( mTextStr, baseline );
+		ren->drawString( mText, mTextStr, baseline );
 	}
 }
 
@@ -241,6 +252,15 @@ void LabelGrid::setRow( size_t yloc, const std::vector<std::string> &textColumns
 		setCell( ivec2( i, yloc ), textColumns[i] );
 }
 
+void LabelGrid::setTextColor( const ColorA &color )
+{
+	mTextColor = color;
+	for( const auto &cell : mCells )
+		cell.mLabel->setTextColor( color );
+
+	setNeedsRedraw();
+}
+
 LabelRef LabelGrid::makeOrFindCell( const ci::ivec2 &location )
 {
 	CI_ASSERT( location.x >= 0 && location.y >= 0 );
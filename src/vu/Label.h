@@ -37,9 +37,11 @@ public:
 	void				setText( const std::string &text );
 	const std::string&	getText() const						{ return mTextStr; }
 
-	void					setTextColor( const ci::ColorA &color )	{ mTextColor = color; }
+	void					setTextColor( const ci::ColorA &color )	{ mTextColor = color; setNeedsRedraw(); }
 	const ci::ColorA&		getTextColor() const					{ return mTextColor; }
-	ci::Anim<ci::ColorA>*	animTextColor() { return &mTextColor; }
+	ci::Anim<ci::ColorA>*	animTextColor() { setNeedsRedraw(); return &mTextColor; }
+	//! Animates the text color to \a color with the Graph's Animator, see View::animatePos().
+	void					animateTextColor( const ci::ColorA &color, double duration, double delay = 0, Ease ease = Ease::LINEAR );
 
 	void                setFont( const std::string &systemName, float fontSize );
 	void                setFontFile( const ci::fs::path &filePath, float fontSize = -1 ); // TODO: probably need three methods here too, or use default size in implementation if < 0
@@ -67,6 +69,7 @@ public:
 protected:
 	void layout() override;
 	void draw( Renderer *ren ) override;
+	bool drawsOnlyThroughRenderer() const override	{ return true; }
 
 private:
 	ci::vec2	getBaseLine() const;
@@ -98,9 +101,9 @@ public:
 
 	void setRow( size_t yloc, const std::vector<std::string> &textColumns );
 
-	void setCellHeight( float height )	            { mCellHeight = height; }
+	void setCellHeight( float height )	            { mCellHeight = height; setNeedsLayout(); }
 	//! Sets the default color for all cells
-	void setTextColor( const ci::ColorA &color )	{ mTextColor = color; }
+	void setTextColor( const ci::ColorA &color );
 	//! Returns the number of rows currently set.
 	int getNumRows() const;
 	//! Removes all cells.
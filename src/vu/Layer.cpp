@@ -24,6 +24,7 @@
 #include "vu/View.h"
 
 #include "cinder/Log.h"
+#include "cinder/Surface.h"
 #include "cinder/gl/gl.h"
 #include "cinder/app/Window.h"
 
@@ -42,6 +43,12 @@ Rectf ceil( const Rectf &r )
 	return Rectf( ceilf( r.x1 ), ceilf( r.y1 ), ceilf( r.x2 ), ceilf( r.y2 ) );
 }
 
+//! Expands a 2D affine transform to a model matrix
+mat4 toModelMatrix( const mat3 &m )
+{
+	return mat4( vec4( m[0][0], m[0][1], 0, 0 ), vec4( m[1][0], m[1][1], 0, 0 ), vec4( 0, 0, 1, 0 ), vec4( m[2][0], m[2][1], 0, 1 ) );
+}
+
 } // anonymous namespace
 
 namespace vu {
@@ -56,6 +63,10 @@ Layer::Layer( View *view )
 Layer::~Layer()
 {
 	LOG_LAYER( hex << this << dec );
+
+	// return the cached FrameBuffer to the Renderer's pool
+	if( mCachedFrameBuffer )
+		mCachedFrameBuffer->setInUse( false );
 }
 
 float Layer::getAlpha() const
@@ -101,11 +112,48 @@ void Layer::init()
 
 void Layer::update()
 {
-	updateView( mRootView );
+	updateView( mRootView, false );
 }
 
-void Layer::updateView( View *view )
+bool Layer::shouldUpdateView( View *view ) const
 {
+	switch( view->mUpdatePolicy ) {
+		case UpdatePolicy::ALWAYS:
+			return true;
+		case UpdatePolicy::WHEN_VISIBLE: {
+			if( view->isHidden() )
+				return false;
+			if( view->isUserInteracting() || view->isAnimating() )
+				return true;
+
+			const Rectf viewport = Rectf( vec2( 0 ), vec2( mGraph->getClippingSize() ) );
+			return view->getSubtreeBounds().transformed( view->getWorldTransform() ).intersects( viewport );
+		}
+		case UpdatePolicy::WHEN_DIRTY:
+			return view->mWakeRequested || view->mNeedsLayout || view->isUserInteracting() || view->isAnimating();
+		default:
+			CI_ASSERT_NOT_REACHABLE();
+	}
+
+	return true;
+}
+
+void Layer::updateView( View *view, bool canSleep )
+{
+	if( view->mUpdatePolicy != UpdatePolicy::ALWAYS ) {
+		if( ! shouldUpdateView( view ) ) {
+			if( mGraph->mFrameStats ) {
+				view->getSubtreeBounds(); // brings mSubtreeSize up to date
+				mGraph->mFrameStats->mNumViewsAsleep += view->mSubtreeSize;
+			}
+			return;
+		}
+
+		canSleep = true;
+	}
+
+	view->mWakeRequested = false;
+
 	// update parents before children
 	const bool willLayout = view->needsLayout();
 	if( willLayout && ! mRootView->mFilters.empty() ) {
@@ -114,6 +162,9 @@ void Layer::updateView( View *view )
 
 	view->updateImpl();
 
+	if( mGraph->mFrameStats )
+		mGraph->mFrameStats->mNumViewsUpdated++;
+
 	view->mIsIteratingSubviews = true;
 	for( auto &subview : view->getSubviews() ) {
 		if( subview->mMarkedForRemoval )
@@ -122,11 +173,15 @@ void Layer::updateView( View *view )
 		if( ! subview->mGraph )
 			subview->mGraph = mGraph;
 
-		updateView( subview.get() );
+		updateView( subview.get(), canSleep );
 	}
 	view->mIsIteratingSubviews = false;
 	view->clearViewsMarkedForRemoval();
 
+	// Anims change position, size and alpha without going through their setters, so keep sleeping subtrees awake until they finish
+	if( canSleep && view->isAnimating() )
+		view->wake();
+
 	if( view->mLayer && view->mLayer.get() != this && ! view->mMarkedForRemoval ) {
 		view->mLayer->update();
 	}
@@ -136,125 +191,249 @@ void Layer::updateView( View *view )
 		Rectf frameBufferBounds = view->getBoundsForFrameBuffer();
 		if( mRenderBounds.getWidth() < frameBufferBounds.getWidth() || mRenderBounds.getHeight() < frameBufferBounds.getHeight() ) {
 			mRenderBounds = ceil( frameBufferBounds );
+			mRootView->setSubtreeBoundsDirty();
 			LOG_LAYER( "mRenderBounds: " << mRenderBounds );
 		}
 	}
 }
 
-// rules for when we need a new main RenderBuffer:
-// 1. We don't have one already
-// 2. The one we have is currently in use (being rendered to)
-// 3. The one we have isn't large enough (a View was resized)
-void Layer::draw( Renderer *ren )
+void Layer::draw( Renderer *ren, const Rectf &cullBounds )
 {
-	if( mRootView->mRendersToFrameBuffer ) {
-		ivec2 renderSize = ivec2( mRenderBounds.getSize() );
-		if( renderSize.x == 0 || renderSize.y == 0 )
-			return; // don't try to draw to a FrameBuffer if we don't have a valid bounds
-
-		if( ! mFrameBuffer || mFrameBuffer->isInUse() || mFrameBuffer->getSize().x < renderSize.x || mFrameBuffer->getSize().y < renderSize.y ) {
-			// acquire necessary FrameBuffers. TODO: setup Filter framebuffers here too?
-			mFrameBuffer = ren->getFrameBuffer( renderSize );
-			LOG_LAYER( "acquired main FrameBuffer for view '" << mRootView->getName() << "', size: " << mFrameBuffer->getSize()
-			           << "', mRenderBounds: " << mRenderBounds << ", view bounds:" << mRootView->getBounds() );
-
-			mFrameBuffer->setInUse( true ); // note: only so that the following LOG_LAYER prints correctly, this will be marked in use during the pushFrameBuffer()
-			LOG_LAYER( "current frame buffers:\n" << ren->printCurrentFrameBuffersToString() );
+	if( ! mRootView->mRendersToFrameBuffer ) {
+		// draw the subtree of Views that this Layer is responsible for directly to the current target
+		drawView( mRootView, ren, cullBounds );
+		return;
+	}
+
+	ivec2 renderSize = ivec2( mRenderBounds.getSize() );
+	if( renderSize.x == 0 || renderSize.y == 0 )
+		return; // don't try to draw to a FrameBuffer if we don't have a valid bounds
+
+	// The FrameBuffer is composited as a whole, so it is culled by where it lands. Views within it are only culled by the
+	// FrameBuffer's own area, as Filters may sample content that is outside of the current clip.
+	Rectf viewCullBounds = cullBounds;
+	const Rectf frameBufferWorldBounds = mRenderBounds.transformed( mRootView->getWorldTransform() );
+	if( mGraph->mDrawCullingEnabled ) {
+		// a culled Layer doesn't retain its cache, so after a frame the Renderer's pool may evict it when over budget
+		if( ! frameBufferWorldBounds.intersects( cullBounds ) ) {
+			if( mGraph->mFrameStats && ! mRootView->isHidden() ) {
+				mRootView->getSubtreeBounds(); // brings mSubtreeSize up to date
+				mGraph->mFrameStats->mNumViewsCulled += mRootView->mSubtreeSize;
+			}
+			return;
 		}
 
-		ren->pushFrameBuffer( mFrameBuffer );
-		gl::pushViewport( 0, mFrameBuffer->getHeight() - renderSize.y, renderSize.x, renderSize.y );
+		viewCullBounds = frameBufferWorldBounds;
+	}
 
-		// if scissor stack not empty, adjust and push another for the current viewport
-		if( ! ren->mScissorStack.empty() ) {
-			auto currentScissor = ren->mScissorStack.back();
+	// The FrameBuffer holds the subtree in the root View's own coordinate space, its position, transform and alpha are only applied when compositing.
+	// So while nothing drawn within the subtree changes, the last render can be composited again.
+	const bool cacheValid = isCacheValid();
+	if( mCachedFrameBuffer && ! cacheValid ) {
+		// give it back to the Renderer, acquiring FrameBuffers for rendering below will usually hand it right back
+		ren->releaseFrameBuffer( mCachedFrameBuffer );
+		mCachedFrameBuffer.reset();
+	}
 
-			// convert mRenderBounds to world
-			Rectf viewWorldBounds = mRootView->getWorldBounds();
-			ivec2 clipLowerLeft = ivec2( viewWorldBounds.getLowerLeft() );
+	FrameBufferRef frameBuffer;
+	const bool rendering = ! cacheValid || mGraph->mLayerCacheVerificationEnabled;
+	if( ! rendering ) {
+		frameBuffer = mCachedFrameBuffer;
+	}
+	else {
+		// recorded before rendering, as Views with running Anims mark themselves as changed while drawing
+		const uint64_t contentVersion = mRootView->mContentVersion;
+		frameBuffer = render( ren, renderSize, viewCullBounds );
+
+		if( cacheValid ) {
+			// compared once the FrameBuffers have been drawn to, which is later if the Renderer is recording
+			ren->drawCallback( [this, cached = mCachedFrameBuffer, frameBuffer, size = ivec2( mCachedRenderBounds.getSize() )] {
+				verifyCache( cached, frameBuffer, size );
+			} );
+			ren->releaseFrameBuffer( mCachedFrameBuffer );
+			mCachedFrameBuffer.reset();
+		}
 
-			// figure out current clip coordinates in our view space
-			// rendering to window, flip y relative to Graph's bottom left using its clipping size
-			ivec2 clippingSize = mRootView->getGraph()->getClippingSize();
-			clipLowerLeft.y = clippingSize.y - clipLowerLeft.y;
+		if( mGraph->mLayerCachingEnabled ) {
+			mCachedFrameBuffer = frameBuffer;
+			mCachedContentVersion = contentVersion;
+			mCachedFilterVersion = getFilterVersion();
+			mCachedRenderBounds = mRenderBounds;
+		}
+	}
 
-			ivec2 translatedScissorLowerLeft = currentScissor.first - clipLowerLeft;
-			translatedScissorLowerLeft = glm::max( ivec2( 0 ), translatedScissorLowerLeft ); // clamp to >= zero
-			ivec2 clipSize = mRenderBounds.getSize(); // TODO: clamp to <= currentScissor
+	// retained for each frame it is drawn in, while this Layer isn't drawn (culled, hidden or asleep offscreen) the pool may evict it and the cache is then rebuilt
+	if( mCachedFrameBuffer )
+		ren->retainFrameBufferAsCache( mCachedFrameBuffer );
 
-			ren->pushClip( translatedScissorLowerLeft, clipSize );
-		}
+	composite( ren, frameBuffer );
 
-		gl::pushMatrices();
-		gl::setMatricesWindow( renderSize );
-		gl::translate( - mRenderBounds.getUpperLeft() );
+	// FrameBuffers stay in use until after compositing, so nested Layers and Filter Passes never share one. A cached FrameBuffer stays in use until it is invalid or evicted.
+	// Nothing was acquired on a cache hit, and the FrameBuffers left over from the last render may have been acquired by someone else since, so they aren't touched.
+	if( rendering )
+		releaseFrameBuffers( ren );
 
-		gl::clear( ColorA::zero() );
+	if( mGraph->mFrameStats ) {
+		mGraph->mFrameStats->mNumLayersComposited++;
+		if( cacheValid )
+			mGraph->mFrameStats->mNumLayerCacheHits++;
 	}
+}
 
-	// draw the subtree of Views that this Layer is responsible for
-	drawView( mRootView, ren );
+bool Layer::isCacheValid() const
+{
+	return mCachedFrameBuffer && ! mCachedFrameBuffer->isEvicted() && mGraph->mLayerCachingEnabled && ! mFiltersNeedConfiguration
+		&& mCachedContentVersion == mRootView->mContentVersion
+		&& mCachedFilterVersion == getFilterVersion()
+		&& mCachedRenderBounds == mRenderBounds;
+}
 
-	// Do any necessary Filter processing and compositing
-	if( mRootView->mRendersToFrameBuffer ) {
-		gl::popMatrices();
+uint64_t Layer::getFilterVersion() const
+{
+	// Filter versions only increase, so their sum changes whenever any of them does. Adding or removing a Filter marks the root View as changed.
+	uint64_t result = 0;
+	for( const auto &filter : mRootView->mFilters )
+		result += filter->mVersion;
 
-		if( ren->mScissorStack.size() > 1 ) {
-			// we pushed our own clip on the stack so pop that off
-			ren->popClip();
-		}
+	return result;
+}
+
+// rules for when we need a new main RenderBuffer (see Renderer::acquireFrameBuffer()):
+// 1. We don't have one already
+// 2. The one we have is currently in use (being rendered to by an ancestor Layer, or reserved as another Layer's cache)
+// 3. The one we have isn't large enough (a View was resized)
+FrameBufferRef Layer::render( Renderer *ren, const ivec2 &renderSize, const Rectf &cullBounds )
+{
+	ren->acquireFrameBuffer( &mFrameBuffer, renderSize );
+	LOG_LAYER( "acquired main FrameBuffer for view '" << mRootView->getName() << "', size: " << mFrameBuffer->getSize()
+	           << "', mRenderBounds: " << mRenderBounds << ", view bounds:" << mRootView->getBounds() );
+	LOG_LAYER( "current frame buffers:\n" << ren->printCurrentFrameBuffersToString() );
 
-		gl::popViewport();
-		ren->popFrameBuffer( mFrameBuffer );
+	ren->pushFrameBuffer( mFrameBuffer );
+	ren->pushViewport( ivec2( 0, mFrameBuffer->getHeight() - renderSize.y ), renderSize );
 
-		FrameBufferRef frameBuffer;
-		if( ! mRootView->mFilters.empty() ) {
-			processFilters( ren, mFrameBuffer );
-			// set the FrameBuffer that should be drawn as texture to the last Pass of the last Filter
-			frameBuffer = mRootView->mFilters.back()->mPasses.back().mFrameBuffer;
-		}
-		else {
-			frameBuffer = mFrameBuffer;
-		}
+	// An ancestor's clip is in window coordinates, so replace it with one that covers the whole render area. Compositing is still clipped by the
+	// ancestor, and this keeps the FrameBuffer's contents independent of where the Layer is, so that it can be cached.
+	const bool pushedClip = ! ren->mScissorStack.empty();
+	if( pushedClip )
+		ren->pushClip( ivec2( 0, mFrameBuffer->getHeight() - renderSize.y ), renderSize );
+
+	ren->pushMatrices();
+	ren->setMatricesWindow( renderSize );
+	ren->translate( - mRenderBounds.getUpperLeft() );
+
+	ren->clear( ColorA::zero() );
+
+	drawView( mRootView, ren, cullBounds );
+
+	ren->popMatrices();
+	if( pushedClip )
+		ren->popClip();
+
+	ren->popViewport();
+	ren->popFrameBuffer( mFrameBuffer );
 
-		ren->pushBlendMode( BlendMode::PREMULT_ALPHA );
-		ren->pushColor( ColorA::gray( 1, getAlpha() ) );
+	if( mRootView->mFilters.empty() )
+		return mFrameBuffer;
+
+	processFilters( ren, mFrameBuffer );
+	// the FrameBuffer that should be drawn as texture is the last Pass of the last Filter
+	return mRootView->mFilters.back()->mPasses.back().mFrameBuffer;
+}
+
+void Layer::composite( Renderer *ren, const FrameBufferRef &frameBuffer )
+{
+	ren->pushBlendMode( BlendMode::PREMULT_ALPHA );
+	ren->pushColor( ColorA::gray( 1, getAlpha() ) );
+
+	auto sourceArea = Area( ivec2( 0 ), ivec2( mRenderBounds.getSize() ) );
+	if( mRootView->hasLocalTransform() ) {
+		// the FrameBuffer holds the root View unscaled and unrotated, so its transform is applied when compositing
+		ren->pushModelMatrix();
+		ren->multModelMatrix( toModelMatrix( mRootView->getLocalTransform() ) );
+		ren->draw( frameBuffer, sourceArea, mRenderBounds );
+		ren->popModelMatrix();
+	}
+	else {
+		ren->draw( frameBuffer, sourceArea, mRenderBounds + mRootView->getPos() );
+	}
+	ren->popColor();
+	ren->popBlendMode();
+}
+
+void Layer::verifyCache( const FrameBufferRef &cachedFrameBuffer, const FrameBufferRef &rendered, const ivec2 &renderSize )
+{
+	// Both were rendered with the viewport in the top left of the FrameBuffer, which may be larger than the render area
+	const Surface8u cached( cachedFrameBuffer->createImageSource() );
+	const Surface8u fresh( rendered->createImageSource() );
+	const ivec2 size = glm::min( renderSize, glm::min( cached.getSize(), fresh.getSize() ) );
+
+	const int tolerance = 2;
+	size_t numPixelsDifferent = 0;
+	for( int y = 0; y < size.y; y++ ) {
+		for( int x = 0; x < size.x; x++ ) {
+			const ColorA8u a = cached.getPixel( ivec2( x, y ) );
+			const ColorA8u b = fresh.getPixel( ivec2( x, y ) );
+			if( abs( a.r - b.r ) > tolerance || abs( a.g - b.g ) > tolerance || abs( a.b - b.b ) > tolerance || abs( a.a - b.a ) > tolerance )
+				numPixelsDifferent++;
+		}
+	}
 
-		auto sourceArea = Area( ivec2( 0 ), ivec2( mRenderBounds.getSize() ) );
-		auto destRect = mRenderBounds + mRootView->getPos();
-		ren->draw( frameBuffer, sourceArea, destRect );
-		ren->popColor();
-		ren->popBlendMode();
+	if( numPixelsDifferent ) {
+		CI_LOG_W( "cached FrameBuffer of View '" << mRootView->getName() << "' differs from a fresh render in " << numPixelsDifferent << " pixels, something it draws changed without View::setNeedsRedraw()" );
+		if( mGraph->mFrameStats )
+			mGraph->mFrameStats->mNumLayerCacheMismatches++;
 	}
 }
 
-void Layer::drawView( View *view, Renderer *ren )
+void Layer::drawView( View *view, Renderer *ren, const Rectf &cullBounds )
 {
 	if( view->isHidden() )
 		return;
 
+	Rectf subviewCullBounds = cullBounds;
+	if( mGraph->mDrawCullingEnabled ) {
+		if( ! view->getSubtreeBounds().transformed( view->getWorldTransform() ).intersects( cullBounds ) ) {
+			if( mGraph->mFrameStats )
+				mGraph->mFrameStats->mNumViewsCulled += view->mSubtreeSize;
+			return;
+		}
+
+		if( view->isClipEnabled() )
+			subviewCullBounds = cullBounds.getClipBy( view->getClipWorldBounds() );
+	}
+
 	if( view->isClipEnabled() ) {
 		//CI_LOG_I( "beginClip: " << view->getName() );
 		pushClip( view, ren );
 	}
 
-	gl::ScopedModelMatrix modelScope;
+	ren->pushModelMatrix();
 
-	if( view != mRootView || ! mRootView->mRendersToFrameBuffer )
-		gl::translate( view->getPos() );
+	if( view != mRootView || ! mRootView->mRendersToFrameBuffer ) {
+		if( view->hasLocalTransform() )
+			ren->multModelMatrix( toModelMatrix( view->getLocalTransform() ) );
+		else
+			ren->translate( view->getPos() );
+	}
 
 	view->drawImpl( ren );
 
+	if( mGraph->mFrameStats )
+		mGraph->mFrameStats->mNumViewsDrawn++;
+
 	for( auto &subview : view->getSubviews() ) {
 		auto subviewLayer = subview->getLayer();
 		if( subviewLayer ) {
-			subviewLayer->draw( ren );
+			subviewLayer->draw( ren, subviewCullBounds );
 		}
 		else {
-			drawView( subview.get(), ren );
+			drawView( subview.get(), ren, subviewCullBounds );
 		}
 	}
 
+	ren->popModelMatrix();
+
 	if( view->isClipEnabled() ) {
 		//CI_LOG_I( "endClip: " << view->getName() );
 		ren->popClip();
@@ -263,9 +442,6 @@ void Layer::drawView( View *view, Renderer *ren )
 
 void Layer::processFilters( Renderer *ren, const FrameBufferRef &renderFrameBuffer )
 {
-	// mark the main FrameBuffer as in use while processing Filters, so it doesn't seem available when configuring
-	renderFrameBuffer->setInUse( true );
-
 	// call configure() for any Filters, updating its Pass information
 	for( auto &filter : mRootView->mFilters ) {
 		if( mFiltersNeedConfiguration ) {
@@ -278,42 +454,55 @@ void Layer::processFilters( Renderer *ren, const FrameBufferRef &renderFrameBuff
 				auto &pass = filter->mPasses.back();
 				pass.setIndex( i );
 
-				ivec2 requiredSize = info.getSize( i );
-				pass.mFrameBuffer = ren->getFrameBuffer( requiredSize );
-				pass.mSize = requiredSize;
-
-				LOG_LAYER( "\t- acquired FrameBuffer for pass: " << i << ", size: " << pass.mFrameBuffer->getSize() << ", required size: " << requiredSize );
-
-				// this marks the Pass's FrameBuffer as in use until after it is processed (end of for loop below)
-				pass.mFrameBuffer->setInUse( true );
-
-				LOG_LAYER( "\t- current frame buffers:\n" << ren->printCurrentFrameBuffersToString() );
-				int blarg = 2;
+				pass.mSize = info.getSize( i );
 			}
 		}
 
 		filter->mRenderFrameBuffer = renderFrameBuffer;
 
 		for( auto &pass : filter->mPasses ) {
-			ren->pushFrameBuffer( pass.mFrameBuffer );
+			// Passes keep their FrameBuffers in use until the Layer is composited, as later passes and compositing read from earlier ones
+			ren->acquireFrameBuffer( &pass.mFrameBuffer, pass.getSize() );
+			LOG_LAYER( "\t- acquired FrameBuffer for pass: " << pass.getIndex() << ", size: " << pass.mFrameBuffer->getSize() << ", required size: " << pass.getSize() );
 
-			gl::ScopedViewport viewport( 0, pass.mFrameBuffer->getHeight() - pass.getSize().y, pass.getSize().x, pass.getSize().y );
-			gl::ScopedMatrices matScope;
-			gl::setMatricesWindow( pass.getSize() );
+			ren->pushFrameBuffer( pass.mFrameBuffer );
+			ren->pushViewport( ivec2( 0, pass.mFrameBuffer->getHeight() - pass.getSize().y ), pass.getSize() );
+			ren->pushMatrices();
+			ren->setMatricesWindow( pass.getSize() );
 			
 			// TODO: For each pass, need to specify how much padding is necessary
 			// - things like blur need to go larger than mRenderBounds
 			//gl::translate( - mRenderBounds.getUpperLeft() );
 
-			filter->process( ren, pass );
+			// Filters draw with ci::gl directly
+			const size_t passIndex = pass.getIndex();
+			ren->drawCallback( [ren, filter, passIndex] {
+				filter->process( ren, filter->mPasses[passIndex] );
+			} );
 
+			ren->popMatrices();
+			ren->popViewport();
 			ren->popFrameBuffer( pass.mFrameBuffer );
+
+			if( mGraph->mFrameStats )
+				mGraph->mFrameStats->mNumFilterPasses++;
 		}
 	}
 
 	mFiltersNeedConfiguration = false;
+}
+
+void Layer::releaseFrameBuffers( Renderer *ren )
+{
+	if( mFrameBuffer != mCachedFrameBuffer )
+		ren->releaseFrameBuffer( mFrameBuffer );
 
-	renderFrameBuffer->setInUse( false );
+	for( const auto &filter : mRootView->mFilters ) {
+		for( const auto &pass : filter->mPasses ) {
+			if( pass.mFrameBuffer && pass.mFrameBuffer != mCachedFrameBuffer )
+				ren->releaseFrameBuffer( pass.mFrameBuffer );
+		}
+	}
 }
 
 void Layer::pushClip( View *view, Renderer *ren )
@@ -323,7 +512,7 @@ void Layer::pushClip( View *view, Renderer *ren )
 	vec2 clipSize = viewWorldBounds.getSize();
 	if( mRootView->mRendersToFrameBuffer ) {
 		// get bounds of view relative to framebuffer. // TODO: need a method like convertPointToView( view, point );
- 		Rectf viewBoundsInFrameBuffer = viewWorldBounds - mRootView->getWorldPos();
+ 		Rectf viewBoundsInFrameBuffer = mRootView->toLocal( viewWorldBounds );
 
 		// Take lower left relative to FrameBuffer, which might actually be larger than mRenderBounds
 		clipLowerLeft = viewBoundsInFrameBuffer.getLowerLeft();
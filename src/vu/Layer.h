@@ -49,19 +49,34 @@ class CI_UI_API Layer : public std::enable_shared_from_this<Layer> {
 	bool getShouldRemove() const         { return mShouldRemove; }
 
 	ci::Rectf   getBoundsWorld() const;
+	//! Returns the area of the root View's coordinate space that is rendered to the FrameBuffer.
+	const ci::Rectf&	getRenderBounds() const	{ return mRenderBounds; }
 
 	void setFiltersNeedConfiguration()	{ mFiltersNeedConfiguration = true; }
 
   private:
 
 	void update();
-	void draw( Renderer *ren );
+	//! Draws the Layer's Views, skipping any subtrees that are entirely outside of \a cullBounds (in world coordinates).
+	void draw( Renderer *ren, const ci::Rectf &cullBounds );
 
 	void markForRemoval()               { mShouldRemove = true; }
 	void init();
-	void updateView( View *view );
-	void drawView( View *view, Renderer *ren );
+	//! Updates \a view and its subviews, unless the View's UpdatePolicy says its subtree can be skipped. \a canSleep is true within a subtree that has a policy other than UpdatePolicy::ALWAYS.
+	void updateView( View *view, bool canSleep );
+	bool shouldUpdateView( View *view ) const;
+	void drawView( View *view, Renderer *ren, const ci::Rectf &cullBounds );
+	//! Renders the subtree to the main FrameBuffer and processes any Filters, returning the FrameBuffer to composite.
+	FrameBufferRef render( Renderer *ren, const ci::ivec2 &renderSize, const ci::Rectf &cullBounds );
+	void composite( Renderer *ren, const FrameBufferRef &frameBuffer );
 	void processFilters( Renderer *ren, const FrameBufferRef &renderFrameBuffer );
+	//! Returns the main FrameBuffer and those of all Filter Passes to the Renderer once they've been composited, except for the cached one.
+	void releaseFrameBuffers( Renderer *ren );
+	//! Returns whether mCachedFrameBuffer holds what render() would produce now.
+	bool isCacheValid() const;
+	uint64_t getFilterVersion() const;
+	//! Compares the area of \a renderSize in \a cachedFrameBuffer and \a rendered, logging when they differ. Used when Graph::setLayerCacheVerificationEnabled() is on.
+	void verifyCache( const FrameBufferRef &cachedFrameBuffer, const FrameBufferRef &rendered, const ci::ivec2 &renderSize );
 	void pushClip( View *view, Renderer *ren );
 
 	View*           mRootView;
@@ -69,6 +84,11 @@ class CI_UI_API Layer : public std::enable_shared_from_this<Layer> {
 	FrameBufferRef	mFrameBuffer;
 	ci::Rectf       mRenderBounds = ci::Rectf::zero();
 
+	FrameBufferRef	mCachedFrameBuffer; // result of the last render(), retained by the Renderer each frame it is drawn, see Renderer::retainFrameBufferAsCache()
+	uint64_t		mCachedContentVersion = 0;
+	uint64_t		mCachedFilterVersion = 0;
+	ci::Rectf		mCachedRenderBounds = ci::Rectf::zero();
+
 	bool			mFiltersNeedConfiguration = false;
 	bool            mShouldRemove = false;
 
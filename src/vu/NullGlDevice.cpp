@@ -0,0 +1,120 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/NullGlDevice.h"
+#include "vu/Renderer.h"
+
+#include "cinder/CinderAssert.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+// Solid quads sample the white texture, other ids are handed out from here on
+const uint32_t WHITE_TEXTURE_ID = 1;
+
+} // anonymous namespace
+
+void NullGlDevice::pushScissor( const ivec2 &lowerLeft, const ivec2 &size )
+{
+	mScissorDepth++;
+	mNumScissorChanges++;
+}
+
+void NullGlDevice::popScissor()
+{
+	CI_ASSERT_MSG( mScissorDepth > 0, "scissor stack underflow" );
+
+	mScissorDepth--;
+	mNumScissorChanges++;
+}
+
+void NullGlDevice::pushDrawState( const RenderCommandList::DrawState &state )
+{
+	mDrawStateDepth++;
+}
+
+void NullGlDevice::popDrawState()
+{
+	CI_ASSERT_MSG( mDrawStateDepth > 0, "DrawState stack underflow" );
+
+	mDrawStateDepth--;
+}
+
+uint32_t NullGlDevice::getFrameBufferId( const FrameBuffer &frameBuffer )
+{
+	// the window's framebuffer is 0 and the white texture has its own id, so FrameBuffers and textures start after that
+	auto it = mIds.emplace( &frameBuffer, uint32_t( WHITE_TEXTURE_ID + 1 + mIds.size() ) ).first;
+	return it->second;
+}
+
+void NullGlDevice::pushFrameBuffer( const FrameBuffer &frameBuffer )
+{
+	mFrameBufferStack.push_back( getFrameBufferId( frameBuffer ) );
+	mNumFrameBufferBinds++;
+}
+
+void NullGlDevice::popFrameBuffer()
+{
+	CI_ASSERT_MSG( ! mFrameBufferStack.empty(), "FrameBuffer stack underflow" );
+
+	mFrameBufferStack.pop_back();
+	mNumFrameBufferBinds++;
+}
+
+uint32_t NullGlDevice::getTextureId( const RenderCommandList::QuadTexture &texture )
+{
+	const void *resource = texture.mTexture ? (const void *)texture.mTexture.get() : (const void *)texture.mSurface.get();
+	if( ! resource )
+		return WHITE_TEXTURE_ID;
+
+	auto it = mIds.emplace( resource, uint32_t( WHITE_TEXTURE_ID + 1 + mIds.size() ) ).first;
+	return it->second;
+}
+
+void NullGlDevice::drawQuads( const QuadVertex *vertices, size_t numQuads )
+{
+	CI_ASSERT( numQuads <= Renderer::MAX_QUADS_PER_BATCH );
+
+	mNumQuadDraws++;
+	mNumQuadsDrawn += numQuads;
+}
+
+void NullGlDevice::resetCounters()
+{
+	mNumQuadDraws = 0;
+	mNumQuadsDrawn = 0;
+	mNumFrameBufferDraws = 0;
+	mNumStringDraws = 0;
+	mNumCallbacksSkipped = 0;
+	mNumProgramBinds = 0;
+	mNumTextureBinds = 0;
+	mNumFrameBufferBinds = 0;
+	mNumBlendModeChanges = 0;
+	mNumScissorChanges = 0;
+}
+
+} // namespace vu
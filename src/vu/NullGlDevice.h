@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/GlDevice.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace vu {
+
+typedef std::shared_ptr<class NullGlDevice>	NullGlDeviceRef;
+
+//! A GlDevice that doesn't use gl, it only counts the calls that the Renderer makes. Drawing through it runs the Renderer's own batching and GlStateCache,
+//! so the state change counts of a scene can be checked without a gl context, ex. to catch changes that break batching or redundant state elision.
+//! Both Programs are the stock color and texture GlslProg, same as in CinderGlDevice. Callbacks aren't called, as they draw with ci::gl directly.
+class CI_UI_API NullGlDevice : public GlDevice {
+  public:
+	bool	usesGl() const override		{ return false; }
+
+	void		setColor( const ci::ColorA &color ) override	{ mColor = color; }
+	ci::ColorA	getColor() const override						{ return mColor; }
+	void		setBlendMode( BlendMode mode ) override			{ mNumBlendModeChanges++; }
+
+	void	pushScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override;
+	void	setScissor( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override	{ mNumScissorChanges++; }
+	void	popScissor() override;
+	void	pushViewport( const ci::ivec2 &lowerLeft, const ci::ivec2 &size ) override	{}
+	void	popViewport() override			{}
+	void	pushDrawState( const RenderCommandList::DrawState &state ) override;
+	void	popDrawState() override;
+
+	uint32_t	getFrameBufferId( const FrameBuffer &frameBuffer ) override;
+	uint32_t	getBoundFrameBufferId() const override	{ return mFrameBufferStack.empty() ? 0 : mFrameBufferStack.back(); }
+	void		pushFrameBuffer( const FrameBuffer &frameBuffer ) override;
+	void		popFrameBuffer() override;
+
+	uint32_t	getProgramId( Program program ) override	{ return 1; }
+	void		bindProgram( Program program ) override		{ mNumProgramBinds++; }
+	uint32_t	getTextureId( const RenderCommandList::QuadTexture &texture ) override;
+	void		bindTexture( const RenderCommandList::QuadTexture &texture ) override	{ mNumTextureBinds++; }
+
+	void	drawQuads( const QuadVertex *vertices, size_t numQuads ) override;
+	void	drawFrameBuffer( const FrameBuffer &frameBuffer, const ci::Rectf &destRect ) override					{ mNumFrameBufferDraws++; }
+	void	drawFrameBufferArea( const FrameBuffer &frameBuffer, const ci::Area &sourceArea, const ci::Rectf &destRect ) override	{ mNumFrameBufferDraws++; }
+	void	drawString( const TextRef &text, const std::string &str, const ci::vec2 &baseline ) override			{ mNumStringDraws++; }
+	void	drawStringWrapped( const TextRef &text, const std::string &str, const ci::Rectf &fitRect ) override	{ mNumStringDraws++; }
+	void	drawCallback( const std::function<void ()> &fn ) override	{ mNumCallbacksSkipped++; }
+	void	clear( const ci::ColorA &color ) override					{}
+
+	//! Returns the number of drawQuads() calls, which is one per batch.
+	size_t	getNumQuadDraws() const			{ return mNumQuadDraws; }
+	//! Returns the number of quads in all drawQuads() calls.
+	size_t	getNumQuadsDrawn() const		{ return mNumQuadsDrawn; }
+	size_t	getNumFrameBufferDraws() const	{ return mNumFrameBufferDraws; }
+	size_t	getNumStringDraws() const		{ return mNumStringDraws; }
+	size_t	getNumCallbacksSkipped() const	{ return mNumCallbacksSkipped; }
+	//! Returns the number of GlslProg binds, which should match the issued GlStateCache::State::PROGRAM changes.
+	size_t	getNumProgramBinds() const		{ return mNumProgramBinds; }
+	//! Returns the number of texture binds, which should match the issued GlStateCache::State::TEXTURE changes.
+	size_t	getNumTextureBinds() const		{ return mNumTextureBinds; }
+	//! Returns the number of pushFrameBuffer() and popFrameBuffer() calls.
+	size_t	getNumFrameBufferBinds() const	{ return mNumFrameBufferBinds; }
+	size_t	getNumBlendModeChanges() const	{ return mNumBlendModeChanges; }
+	//! Returns the number of pushScissor(), setScissor() and popScissor() calls.
+	size_t	getNumScissorChanges() const	{ return mNumScissorChanges; }
+	//! Sets all counts to zero.
+	void	resetCounters();
+
+  private:
+	ci::ColorA				mColor = ci::ColorA::white();
+	std::vector<uint32_t>	mFrameBufferStack; // ids of the pushed FrameBuffers, the window's is 0
+	size_t					mDrawStateDepth = 0;
+	size_t					mScissorDepth = 0;
+	std::unordered_map<const void *, uint32_t>	mIds; // FrameBuffers and textures, by what they sample from or render to
+
+	size_t	mNumQuadDraws = 0;
+	size_t	mNumQuadsDrawn = 0;
+	size_t	mNumFrameBufferDraws = 0;
+	size_t	mNumStringDraws = 0;
+	size_t	mNumCallbacksSkipped = 0;
+	size_t	mNumProgramBinds = 0;
+	size_t	mNumTextureBinds = 0;
+	size_t	mNumFrameBufferBinds = 0;
+	size_t	mNumBlendModeChanges = 0;
+	size_t	mNumScissorChanges = 0;
+};
+
+} // namespace vu
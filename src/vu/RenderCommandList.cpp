@@ -0,0 +1,244 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "vu/RenderCommandList.h"
+#include "vu/Renderer.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+// How many commands a quad is moved in front of at most, when looking for earlier quads with the same texture
+const size_t MAX_QUAD_REORDER_DISTANCE = 32;
+
+RenderCommand::Type getMatchingPush( RenderCommand::Type popType )
+{
+	switch( popType ) {
+		case RenderCommand::Type::POP_CLIP:			return RenderCommand::Type::PUSH_CLIP;
+		case RenderCommand::Type::POP_VIEWPORT:		return RenderCommand::Type::PUSH_VIEWPORT;
+		case RenderCommand::Type::POP_FRAMEBUFFER:	return RenderCommand::Type::PUSH_FRAMEBUFFER;
+		default:									return popType;
+	}
+}
+
+const char* getTypeName( RenderCommand::Type type )
+{
+	switch( type ) {
+		case RenderCommand::Type::QUADS:			return "QUADS";
+		case RenderCommand::Type::TEXT:				return "TEXT";
+		case RenderCommand::Type::DRAW_FRAMEBUFFER:	return "DRAW_FRAMEBUFFER";
+		case RenderCommand::Type::CALLBACK:			return "CALLBACK";
+		case RenderCommand::Type::CLEAR:			return "CLEAR";
+		case RenderCommand::Type::PUSH_CLIP:		return "PUSH_CLIP";
+		case RenderCommand::Type::POP_CLIP:			return "POP_CLIP";
+		case RenderCommand::Type::PUSH_VIEWPORT:	return "PUSH_VIEWPORT";
+		case RenderCommand::Type::POP_VIEWPORT:		return "POP_VIEWPORT";
+		case RenderCommand::Type::PUSH_FRAMEBUFFER:	return "PUSH_FRAMEBUFFER";
+		case RenderCommand::Type::POP_FRAMEBUFFER:	return "POP_FRAMEBUFFER";
+		case RenderCommand::Type::SET_BLEND_MODE:	return "SET_BLEND_MODE";
+		default:									return "unknown";
+	}
+}
+
+} // anonymous namespace
+
+void RenderCommandList::clear()
+{
+	mCommands.clear();
+	mVertices.clear();
+	mDrawStates.clear();
+	mTextRuns.clear();
+	mFrameBufferDraws.clear();
+	mCallbacks.clear();
+	mTextures.clear();
+	mFrameBuffers.clear();
+	mResourceIndices.clear();
+}
+
+void RenderCommandList::addCommand( const RenderCommand &command )
+{
+	mCommands.push_back( command );
+}
+
+void RenderCommandList::addQuad( const QuadVertex *vertices, const gl::TextureRef &texture, const Surface8uRef &surface )
+{
+	uint32_t textureIndex = RenderCommand::NO_INDEX;
+	const void *resource = texture ? (const void *)texture.get() : (const void *)surface.get();
+	if( resource ) {
+		auto indexIt = mResourceIndices.find( resource );
+		if( indexIt == mResourceIndices.end() ) {
+			textureIndex = (uint32_t)mTextures.size();
+			mTextures.push_back( { texture, surface } );
+			mResourceIndices[resource] = textureIndex;
+		}
+		else {
+			textureIndex = indexIt->second;
+		}
+	}
+
+	// bounds in normalized device coordinates, for finding out which quads overlap
+	Rectf bounds( vec2( vertices[0].mPosition ) / vertices[0].mPosition.w, vec2( vertices[0].mPosition ) / vertices[0].mPosition.w );
+	for( size_t i = 1; i < 4; i++ )
+		bounds.include( vec2( vertices[i].mPosition ) / vertices[i].mPosition.w );
+
+	// quads drawn one after another with the same texture share a command
+	const uint32_t firstVertex = (uint32_t)mVertices.size();
+	if( ! mCommands.empty() ) {
+		auto &last = mCommands.back();
+		if( last.mType == RenderCommand::Type::QUADS && last.mIndex == textureIndex && last.mFirst + last.mCount * 4 == firstVertex ) {
+			last.mCount++;
+			last.mRect.include( bounds );
+			mVertices.insert( mVertices.end(), vertices, vertices + 4 );
+			return;
+		}
+	}
+
+	RenderCommand command;
+	command.mType = RenderCommand::Type::QUADS;
+	command.mIndex = textureIndex;
+	command.mFirst = firstVertex;
+	command.mCount = 1;
+	command.mRect = bounds;
+	mCommands.push_back( command );
+	mVertices.insert( mVertices.end(), vertices, vertices + 4 );
+}
+
+uint32_t RenderCommandList::addDrawState( const DrawState &state )
+{
+	// consecutive draws usually share their matrices and color
+	if( ! mDrawStates.empty() ) {
+		const auto &last = mDrawStates.back();
+		if( last.mModelMatrix == state.mModelMatrix && last.mProjectionMatrix == state.mProjectionMatrix && last.mColor == state.mColor )
+			return (uint32_t)mDrawStates.size() - 1;
+	}
+
+	mDrawStates.push_back( state );
+	return (uint32_t)mDrawStates.size() - 1;
+}
+
+uint32_t RenderCommandList::addFrameBuffer( const FrameBufferRef &frameBuffer )
+{
+	auto indexIt = mResourceIndices.find( frameBuffer.get() );
+	if( indexIt != mResourceIndices.end() )
+		return indexIt->second;
+
+	const uint32_t result = (uint32_t)mFrameBuffers.size();
+	mFrameBuffers.push_back( frameBuffer );
+	mResourceIndices[frameBuffer.get()] = result;
+	return result;
+}
+
+void RenderCommandList::optimize()
+{
+	// Drop pushed state that nothing was drawn with, and blend modes that don't change anything
+	vector<RenderCommand> commands;
+	commands.reserve( mCommands.size() );
+	bool hasBlendMode = false;
+	BlendMode blendMode = BlendMode::ALPHA;
+	for( const auto &command : mCommands ) {
+		switch( command.mType ) {
+			case RenderCommand::Type::SET_BLEND_MODE:
+				if( hasBlendMode && command.mBlendMode == blendMode )
+					continue;
+
+				if( ! commands.empty() && commands.back().mType == RenderCommand::Type::SET_BLEND_MODE )
+					commands.pop_back();
+
+				hasBlendMode = true;
+				blendMode = command.mBlendMode;
+			break;
+			case RenderCommand::Type::POP_CLIP:
+			case RenderCommand::Type::POP_VIEWPORT:
+			case RenderCommand::Type::POP_FRAMEBUFFER:
+				if( ! commands.empty() && commands.back().mType == getMatchingPush( command.mType ) ) {
+					commands.pop_back();
+					continue;
+				}
+			break;
+			default:
+			break;
+		}
+
+		commands.push_back( command );
+	}
+
+	// Within each run of quads, move quads right behind earlier ones with the same texture, so that the Renderer draws them in the same batch.
+	// A quad can only move in front of those it doesn't overlap, otherwise what is drawn on top would change.
+	for( size_t begin = 0; begin < commands.size(); ) {
+		if( commands[begin].mType != RenderCommand::Type::QUADS ) {
+			begin++;
+			continue;
+		}
+
+		size_t end = begin + 1;
+		while( end < commands.size() && commands[end].mType == RenderCommand::Type::QUADS )
+			end++;
+
+		for( size_t i = begin + 1; i < end; i++ ) {
+			const auto &quads = commands[i];
+			size_t target = i;
+			for( size_t j = i; j > begin && i - j < MAX_QUAD_REORDER_DISTANCE; j-- ) {
+				const auto &previous = commands[j - 1];
+				if( previous.mIndex == quads.mIndex ) {
+					target = j;
+					break;
+				}
+				if( previous.mRect.intersects( quads.mRect ) )
+					break;
+			}
+
+			if( target != i )
+				rotate( commands.begin() + target, commands.begin() + i, commands.begin() + i + 1 );
+		}
+
+		begin = end;
+	}
+
+	mCommands = move( commands );
+}
+
+string RenderCommandList::printToString() const
+{
+	stringstream s;
+
+	for( size_t i = 0; i < mCommands.size(); i++ ) {
+		const auto &command = mCommands[i];
+		s << "[" << i << "] " << getTypeName( command.mType );
+		if( command.mType == RenderCommand::Type::QUADS )
+			s << ", texture: " << (int)command.mIndex << ", quads: " << command.mCount << ", bounds: " << command.mRect;
+		else if( command.mIndex != RenderCommand::NO_INDEX )
+			s << ", index: " << command.mIndex;
+
+		if( i < mCommands.size() - 1 )
+			s << endl;
+	}
+
+	return s.str();
+}
+
+} // namespace vu
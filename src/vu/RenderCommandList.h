@@ -0,0 +1,161 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/Area.h"
+#include "cinder/Color.h"
+#include "cinder/Matrix.h"
+#include "cinder/Rect.h"
+#include "cinder/Surface.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class Texture2d>		Texture2dRef;
+typedef Texture2dRef							TextureRef;
+
+} } // namespace cinder::gl
+
+namespace vu {
+
+typedef std::shared_ptr<class FrameBuffer>	FrameBufferRef;
+typedef std::shared_ptr<class Text>			TextRef;
+
+enum class BlendMode;
+
+//! A vertex of a quad drawn by the Renderer, in clip space so that quads drawn with different matrices can be drawn together.
+struct QuadVertex {
+	ci::vec4	mPosition;
+	ci::vec2	mTexCoord;
+	ci::ColorA	mColor;
+};
+
+//! A single command recorded by the Renderer. Commands are plain data, anything else they need is referenced by index into the RenderCommandList that holds them.
+struct RenderCommand {
+	enum class Type : uint8_t {
+		QUADS,				//! mIndex: QuadTexture, or NO_INDEX for solid quads. mFirst: first vertex, mCount: number of quads, mRect: their bounds in clip space.
+		TEXT,				//! mIndex: text run, mState: draw state.
+		DRAW_FRAMEBUFFER,	//! mIndex: FrameBuffer draw, mState: draw state.
+		CALLBACK,			//! mIndex: callback, mState: draw state.
+		CLEAR,				//! mColor: clear color.
+		PUSH_CLIP,			//! mRect: lower left and size of the scissor.
+		POP_CLIP,
+		PUSH_VIEWPORT,		//! mRect: lower left and size of the viewport.
+		POP_VIEWPORT,
+		PUSH_FRAMEBUFFER,	//! mIndex: FrameBuffer.
+		POP_FRAMEBUFFER,
+		SET_BLEND_MODE		//! mBlendMode
+	};
+
+	static const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+	Type		mType;
+	BlendMode	mBlendMode;
+	uint32_t	mIndex = NO_INDEX;
+	uint32_t	mState = NO_INDEX;
+	uint32_t	mFirst = 0;
+	uint32_t	mCount = 0;
+	ci::Rectf	mRect = ci::Rectf::zero();
+	ci::ColorA	mColor;
+};
+
+//! Holds what the Renderer draws while recording (see Renderer::beginRecording()), so that it can be inspected, optimized and submitted to gl later, possibly more than once.
+//! Recording doesn't touch gl itself, except for acquiring FrameBuffers. The FrameBuffers, textures and callbacks that commands refer to are kept alive by the list.
+class CI_UI_API RenderCommandList {
+  public:
+	//! The matrices and color that were current when a command that draws with ci::gl was recorded.
+	struct DrawState {
+		ci::mat4	mModelMatrix;
+		ci::mat4	mProjectionMatrix; // includes the view matrix
+		ci::ColorA	mColor;
+	};
+
+	struct TextRun {
+		TextRef		mText;
+		std::string	mString;
+		ci::Rectf	mFitRect; // the upper left is the baseline if not wrapped
+		bool		mWrapped;
+	};
+
+	struct FrameBufferDraw {
+		FrameBufferRef	mFrameBuffer;
+		ci::Area		mSourceArea; // the whole FrameBuffer if empty
+		ci::Rectf		mDestRect;
+	};
+
+	//! What textured quads sample from. The gl Renderer uses mTexture, a RenderBackend that doesn't use gl samples mSurface, with texture coordinates from the upper left.
+	struct QuadTexture {
+		ci::gl::TextureRef	mTexture;
+		ci::Surface8uRef	mSurface;
+	};
+
+	//! Removes all commands and everything they refer to.
+	void	clear();
+	//! Returns whether no commands have been recorded.
+	bool	empty() const								{ return mCommands.empty(); }
+	//! Removes state changes that have no effect and moves quads in front of others that they don't overlap, so that quads sharing a texture are drawn together.
+	//! Called by the Graph after recording.
+	void	optimize();
+
+	const std::vector<RenderCommand>&	getCommands() const		{ return mCommands; }
+	const std::vector<QuadVertex>&		getVertices() const		{ return mVertices; }
+	const std::vector<DrawState>&		getDrawStates() const	{ return mDrawStates; }
+	const std::vector<TextRun>&			getTextRuns() const		{ return mTextRuns; }
+	const std::vector<FrameBufferDraw>&	getFrameBufferDraws() const	{ return mFrameBufferDraws; }
+	const std::vector<QuadTexture>&		getTextures() const		{ return mTextures; }
+	const std::vector<FrameBufferRef>&	getFrameBuffers() const	{ return mFrameBuffers; }
+	//! Returns the number of quads recorded.
+	size_t	getNumQuads() const							{ return mVertices.size() / 4; }
+
+	//! Returns a string representation of the commands (for debugging purposes).
+	std::string	printToString() const;
+
+  private:
+	//! Adds a quad textured with \a texture or \a surface, or a solid quad if both are null.
+	void		addQuad( const QuadVertex *vertices, const ci::gl::TextureRef &texture, const ci::Surface8uRef &surface );
+	void		addCommand( const RenderCommand &command );
+	uint32_t	addDrawState( const DrawState &state );
+	uint32_t	addFrameBuffer( const FrameBufferRef &frameBuffer );
+
+	std::vector<RenderCommand>			mCommands;
+	std::vector<QuadVertex>				mVertices;
+	std::vector<DrawState>				mDrawStates;
+	std::vector<TextRun>				mTextRuns;
+	std::vector<FrameBufferDraw>		mFrameBufferDraws;
+	std::vector<std::function<void ()>>	mCallbacks;
+	std::vector<QuadTexture>			mTextures;
+	std::vector<FrameBufferRef>			mFrameBuffers;
+
+	std::unordered_map<const void *, uint32_t>	mResourceIndices; // textures and FrameBuffers already referenced
+
+	friend class Renderer;
+};
+
+} // namespace vu
@@ -22,9 +22,7 @@
 #include "vu/Renderer.h"
 
 #include "cinder/gl/Batch.h"
-#include "cinder/gl/Context.h"
 #include "cinder/gl/wrapper.h"
-#include "cinder/gl/draw.h"
 #include "cinder/gl/scoped.h"
 #include "cinder/gl/Fbo.h"
 #include "cinder/Log.h"
@@ -37,52 +35,6 @@ using namespace std;
 
 namespace vu {
 
-namespace {
-
-const string FRAMEBUFFER_VERT = R"(
-#version 400
-
-uniform mat4 ciModelViewProjection;
-
-uniform vec2 uPositionOffset, uPositionScale;
-uniform vec2 uTexCoordOffset, uTexCoordScale;
-
-in vec4 ciPosition;
-in vec2 ciTexCoord0;
-in vec4 ciColor;
-
-out highp vec2 vTexCoord;
-out lowp vec4 vColor;
-
-void main()
-{
-//	gl_Position = ciModelViewProjection * ( vec4( uPositionOffset, 0, 0 ) + vec4( uPositionScale, 1, 1 ) * ciPosition );
-//	vTexCoord = uTexCoordOffset + uTexCoordScale * ciTexCoord0;
-
-	gl_Position = ciModelViewProjection * ciPosition;
-	vTexCoord = ciTexCoord0;
-	vColor = ciColor;
-}
-)";
-
-const string FRAMEBUFFER_FRAG = R"(
-#version 400
-
-uniform sampler2D uTex0;
-
-in vec2	vTexCoord;
-in vec4 vColor;
-
-out vec4 oFragColor;
-
-void main()
-{
-	oFragColor = texture( uTex0, vTexCoord.st ) * vColor;
-}
-)";
-
-} // anonymous namespace
-
 // ----------------------------------------------------------------------------------------------------
 // FrameBuffer
 // ----------------------------------------------------------------------------------------------------
@@ -103,18 +55,66 @@ gl::Fbo::Format	getBaseFboFormat()
 
 static int sFrameBufferCount = 0;
 
+// Pooled FrameBuffers are allocated in multiples of this many pixels in each dimension
+const int FRAMEBUFFER_SIZE_GRANULARITY = 64;
+// A pooled FrameBuffer is only handed out for a request if its area is at most this many times the area of the request's size class
+const int FRAMEBUFFER_MAX_AREA_RATIO = 2;
+
+ivec2 getFrameBufferSizeClass( const ivec2 &size )
+{
+	return ( ( size + FRAMEBUFFER_SIZE_GRANULARITY - 1 ) / FRAMEBUFFER_SIZE_GRANULARITY ) * FRAMEBUFFER_SIZE_GRANULARITY;
+}
+
+size_t getFrameBufferNumBytes( const ivec2 &size )
+{
+	return (size_t)size.x * (size_t)size.y * 4; // GL_RGBA
+}
+
+RenderCommand makeCommand( RenderCommand::Type type, const Rectf &rect = Rectf::zero() )
+{
+	RenderCommand result;
+	result.mType = type;
+	result.mRect = rect;
+	return result;
+}
+
+//! Returns what \a texture samples from, which is null for solid quads. A device that uses gl samples the texture, one that doesn't may only have the Surface.
+const void* getTextureResource( const RenderCommandList::QuadTexture &texture )
+{
+	return texture.mTexture ? (const void *)texture.mTexture.get() : (const void *)texture.mSurface.get();
+}
+
+//! Makes the matrices and color of a recorded DrawState current, restoring the previous ones when destroyed.
+struct ScopedDrawState {
+	ScopedDrawState( const RenderCommandList::DrawState &state, GlDevice *device, GlStateCache *stateCache )
+		: mDevice( device ), mStateCache( stateCache )
+	{
+		mDevice->pushDrawState( state );
+		mStateCache->invalidate( GlStateCache::State::COLOR );
+	}
+
+	~ScopedDrawState()
+	{
+		mDevice->popDrawState();
+		mStateCache->invalidate( GlStateCache::State::COLOR );
+	}
+
+	GlDevice*		mDevice;
+	GlStateCache*	mStateCache;
+};
+
 } // anonymous namespace
 
 bool FrameBuffer::Format::operator==(const Format &other) const
 {
-	return mSize == other.mSize;
+	return mSize == other.mSize && mCreateFbo == other.mCreateFbo;
 }
 
 FrameBuffer::FrameBuffer( const Format &format )
 {
 	sFrameBufferCount++;
 
-	mFbo = gl::Fbo::create( format.mSize.x, format.mSize.y, getBaseFboFormat() );
+	updateFormat( format );
 
 	LOG_FRAMEBUFFER( hex << this << dec << ", total count: " << sFrameBufferCount << ", size: " << format.mSize );
 }
@@ -128,28 +128,40 @@ FrameBuffer::~FrameBuffer()
 
 void FrameBuffer::updateFormat( const Format &format )
 {
-	mFbo = gl::Fbo::create( format.mSize.x, format.mSize.y, getBaseFboFormat() );
+	mSize = format.mSize;
+	if( format.mCreateFbo )
+		mFbo = gl::Fbo::create( format.mSize.x, format.mSize.y, getBaseFboFormat() );
+	else
+		mFbo.reset();
 }
 
 ivec2 FrameBuffer::getSize() const
 {
-	return mFbo->getSize();
+	return mSize;
+}
+
+size_t FrameBuffer::getNumBytes() const
+{
+	return getFrameBufferNumBytes( getSize() );
 }
 
 void FrameBuffer::setInUse( bool inUse )
 {
 #if UI_FRAMEBUFFER_CACHING_ENABLED
 	mInUse = inUse;
+	mEvictable = false;
 #endif
 }
 
 ImageSourceRef FrameBuffer::createImageSource() const
 {
+	CI_ASSERT_MSG( mFbo, "FrameBuffer has no gl::Fbo, the Renderer doesn't draw with gl" );
 	return mFbo->getColorTexture()->createSource();
 }
 
 ci::gl::TextureRef FrameBuffer::getColorTexture() const
 {
+	CI_ASSERT_MSG( mFbo, "FrameBuffer has no gl::Fbo, the Renderer doesn't draw with gl" );
 	return mFbo->getColorTexture();
 }
 
@@ -157,24 +169,38 @@ ci::gl::TextureRef FrameBuffer::getColorTexture() const
 // Renderer
 // ----------------------------------------------------------------------------------------------------
 
+const size_t Renderer::MAX_QUADS_PER_BATCH;
+
 Renderer::Renderer()
+	: mDevice( make_shared<CinderGlDevice>() )
 {
 	mBlendModeStack.push_back( BlendMode::ALPHA );
+	mBatchingEnabledStack.push_back( true );
 }
 
 void Renderer::setColor( const ColorA &color )
 {
-	if( mBlendModeStack.back() == BlendMode::PREMULT_ALPHA ) {
-		gl::color( color.r * color.a, color.g * color.a, color.b * color.a, color.a );
-	}
-	else {
-		gl::color( color );
+	if( mRecording ) {
+		mRecordingColor = mBlendModeStack.back() == BlendMode::PREMULT_ALPHA ? ColorA( color.r * color.a, color.g * color.a, color.b * color.a, color.a ) : color;
+		return;
 	}
+
+	const ColorA finalColor = mBlendModeStack.back() == BlendMode::PREMULT_ALPHA ? ColorA( color.r * color.a, color.g * color.a, color.b * color.a, color.a ) : color;
+	if( mStateCache.setColor( finalColor ) )
+		mDevice->setColor( finalColor );
+}
+
+ColorA Renderer::getCurrentColor() const
+{
+	if( mRecording )
+		return mRecordingColor;
+
+	return mStateCache.isKnown( GlStateCache::State::COLOR ) ? mStateCache.getColor() : mDevice->getColor();
 }
 
 void Renderer::pushColor()
 {
-	mColorStack.push_back( gl::context()->getCurrentColor() );
+	mColorStack.push_back( getCurrentColor() );
 }
 
 void Renderer::pushColor( const ci::ColorA &color )
@@ -193,31 +219,22 @@ void Renderer::popColor()
 
 void Renderer::setBlendMode( BlendMode mode )
 {
-#if 0
-	switch( mode ) {
-		case BlendMode::ALPHA:
-			gl::enableAlphaBlending();
-		break;
-		case BlendMode::PREMULT_ALPHA:
-			gl::enableAlphaBlendingPremult();
-		break;
-		default:
-			CI_ASSERT_NOT_REACHABLE();
+	if( mRecording ) {
+		// always recorded, RenderCommandList::optimize() removes those that don't change anything
+		auto command = makeCommand( RenderCommand::Type::SET_BLEND_MODE );
+		command.mBlendMode = mode;
+		mRecording->addCommand( command );
+		return;
 	}
-#else
-	auto ctx = gl::context();
-	ctx->enable( GL_BLEND );
-	switch( mode ) {
-		case BlendMode::ALPHA:
-			ctx->blendFuncSeparate( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
-		break;
-		case BlendMode::PREMULT_ALPHA:
-			ctx->blendFuncSeparate( GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
-		break;
-		default:
-			CI_ASSERT_NOT_REACHABLE();
+
+	// pending quads are drawn with the BlendMode they were added with. Views push their BlendMode while drawing, so most of the time it doesn't change.
+	if( mode != mCurrentBlendMode ) {
+		flush();
+		mCurrentBlendMode = mode;
 	}
-#endif
+
+	if( mStateCache.setBlendMode( mode ) )
+		mDevice->setBlendMode( mode );
 }
 
 void Renderer::pushBlendMode( BlendMode mode )
@@ -239,63 +256,130 @@ FrameBufferRef Renderer::getFrameBuffer( const ci::ivec2 &size )
 	CI_ASSERT( size.x > 0 && size.y > 0 );
 
 #if UI_FRAMEBUFFER_CACHING_ENABLED
-	auto availableIt = mFrameBufferCache.end();
-	for( auto frameBufferIt = mFrameBufferCache.begin(); frameBufferIt < mFrameBufferCache.end(); ++frameBufferIt ) {
-		auto &frameBuffer = *frameBufferIt;
+	const ivec2 sizeClass = getFrameBufferSizeClass( size );
+	const int maxArea = sizeClass.x * sizeClass.y * FRAMEBUFFER_MAX_AREA_RATIO;
+
+	FrameBufferRef result;
+	int resultArea = 0;
+	FrameBufferRef leastRecentlyUsed; // idle, so resizing it can't affect anything drawn or recorded recently
+	for( const auto &frameBuffer : mFrameBufferCache ) {
 		if( frameBuffer->isInUse() )
 			continue;
 
-		// Check for any unbound FrameBuffer large enough for the requested size
-		if( frameBuffer->getSize().x >= size.x && frameBuffer->getSize().y >= size.y ) {
-			LOG_FRAMEBUFFER( "using FrameBuffer: " << hex << frameBuffer.get() << dec << " (not in use), required size: " << size << ", framebuffer size: " << frameBuffer->getSize() );
-			return frameBuffer;
+		// Find the smallest available FrameBuffer that is large enough, without wasting too much of it
+		const ivec2 frameBufferSize = frameBuffer->getSize();
+		const int area = frameBufferSize.x * frameBufferSize.y;
+		if( frameBufferSize.x >= size.x && frameBufferSize.y >= size.y && area <= maxArea ) {
+			if( ! result || area < resultArea ) {
+				result = frameBuffer;
+				resultArea = area;
+			}
 		}
-
-		// store the largest unbound FrameBuffer, will replace this with one large enough if we don't find a suitable one in the cache
-		if( availableIt == mFrameBufferCache.end() ) {
-			availableIt = frameBufferIt;
-			continue;
-		}
-
-		int currLargestArea = (*availableIt)->getSize().x * (*availableIt)->getSize().y;
-		int area = frameBuffer->getSize().x * frameBuffer->getSize().y;
-		if( area > currLargestArea ) {
-			availableIt = frameBufferIt;
+		else if( isFrameBufferIdle( frameBuffer ) && ( ! leastRecentlyUsed || frameBuffer->mLastUsed < leastRecentlyUsed->mLastUsed ) ) {
+			leastRecentlyUsed = frameBuffer;
 		}
 	}
 
-	// If a FrameBuffer is available but not large enough, resize it.
-	// - the size is increased to 1.5x the requested size, in order to prevent things that are animating larger from causing too many reallocations.
-	if( availableIt != mFrameBufferCache.end()  ) {
-		const float resizeFactor = 1.5f;
-		ivec2 nextSize = glm::ceil( vec2( size ) * resizeFactor );
-		LOG_FRAMEBUFFER( "\t- resizing FrameBuffer : " << hex << availableIt->get() << dec << ", from size: " << (*availableIt)->getSize() << " to: " << nextSize << " (requested size: " << size << ")" );
-
-		(*availableIt)->updateFormat( FrameBuffer::Format().size( nextSize ) );
-		return *availableIt;
+	if( result ) {
+		LOG_FRAMEBUFFER( "using FrameBuffer: " << hex << result.get() << dec << " (not in use), required size: " << size << ", framebuffer size: " << result->getSize() );
+		mNumFrameBuffersReused++;
+	}
+	else if( leastRecentlyUsed && mFrameBufferMemoryUsage + getFrameBufferNumBytes( sizeClass ) > mFrameBufferMemoryBudget ) {
+		// Over budget, so rather than growing the pool resize a FrameBuffer nobody has used in a while
+		LOG_FRAMEBUFFER( "\t- resizing FrameBuffer : " << hex << leastRecentlyUsed.get() << dec << ", from size: " << leastRecentlyUsed->getSize() << " to: " << sizeClass << " (requested size: " << size << ")" );
+		result = leastRecentlyUsed;
+		mFrameBufferMemoryUsage -= result->getNumBytes();
+		result->updateFormat( FrameBuffer::Format().size( sizeClass ).fbo( isDrawingWithGl() ) );
+		mFrameBufferMemoryUsage += result->getNumBytes();
+		mNumFrameBuffersResized++;
+	}
+	else {
+		// None were available, make a new one.
+		result = make_shared<FrameBuffer>( FrameBuffer::Format().size( sizeClass ).fbo( isDrawingWithGl() ) );
+		result->mCached = true;
+		mFrameBufferCache.push_back( result );
+		mFrameBufferMemoryUsage += result->getNumBytes();
+		mNumFrameBuffersCreated++;
+		LOG_FRAMEBUFFER( "created FrameBuffer " << hex << result.get() << dec << ", size: " << result->getSize() );
 	}
 
-	// None were available, make a new one.
-	auto result = make_shared<FrameBuffer>( FrameBuffer::Format().size( size ) );
-	mFrameBufferCache.push_back( result );
-	LOG_FRAMEBUFFER( "created FrameBuffer " << hex << result.get() << dec << ", size: " << result->getSize() );
+	result->mInUse = true;
+	result->mLastUsed = ++mFrameBufferUseCounter;
 
+	evictFrameBuffers();
 	return result;
 
 #else
 	// FrameBuffer caching disabled, just create and return a new one.
 	// - FrameBuffer::getInUse() always returns false, meaning it can always be used by the renderer
-	// - this path will be removed once all the kinks have been worked out of framebuffer caching
 	CI_ASSERT( mFrameBufferCache.empty() );
 
-	auto format = FrameBuffer::Format().size( size );
+	auto format = FrameBuffer::Format().size( size ).fbo( isDrawingWithGl() );
 	auto result = make_shared<FrameBuffer>( format );
+	mNumFrameBuffersCreated++;
 	return result;
 #endif
 }
 
+void Renderer::acquireFrameBuffer( FrameBufferRef *frameBuffer, const ci::ivec2 &size )
+{
+	CI_ASSERT( frameBuffer );
+
+	auto &current = *frameBuffer;
+#if UI_FRAMEBUFFER_CACHING_ENABLED
+	const bool available = current && current->mCached && ! current->isInUse();
+#else
+	const bool available = (bool)current; // not shared with anyone else when caching is disabled
+#endif
+
+	if( available && current->getSize().x >= size.x && current->getSize().y >= size.y ) {
+		current->setInUse( true );
+		current->mLastUsed = ++mFrameBufferUseCounter;
+		mNumFrameBuffersReused++;
+	}
+	else {
+		current = getFrameBuffer( size );
+	}
+}
+
+void Renderer::releaseFrameBuffer( const FrameBufferRef &frameBuffer )
+{
+	frameBuffer->setInUse( false );
+}
+
+void Renderer::retainFrameBufferAsCache( const FrameBufferRef &frameBuffer )
+{
+	CI_ASSERT( ! frameBuffer->isEvicted() );
+
+#if UI_FRAMEBUFFER_CACHING_ENABLED
+	frameBuffer->mInUse = true;
+	frameBuffer->mEvictable = true;
+	frameBuffer->mLastUsed = ++mFrameBufferUseCounter;
+#endif
+}
+
+void Renderer::beginFrame()
+{
+	mFrameBufferUseAtPrevFrameStart = mFrameBufferUseAtFrameStart;
+	mFrameBufferUseAtFrameStart = mFrameBufferUseCounter;
+}
+
+// Layers and Filter Passes keep their references between frames, and a recorded RenderCommandList may be submitted again, so whether anyone else
+// references a FrameBuffer doesn't say whether it is still needed. Anything acquired or retained during the last two frames may be drawn again, anything older isn't.
+bool Renderer::isFrameBufferIdle( const FrameBufferRef &frameBuffer ) const
+{
+	return ( ! frameBuffer->isInUse() || frameBuffer->mEvictable ) && frameBuffer->mLastUsed <= mFrameBufferUseAtPrevFrameStart;
+}
+
 void Renderer::clearUnusedFrameBuffers()
 {
+	for( const auto &frameBuffer : mFrameBufferCache ) {
+		if( ! frameBuffer->isInUse() ) {
+			frameBuffer->mCached = false;
+			mFrameBufferMemoryUsage -= frameBuffer->getNumBytes();
+		}
+	}
+
 	mFrameBufferCache.erase( remove_if( mFrameBufferCache.begin(), mFrameBufferCache.end(),
 		[]( const FrameBufferRef &frameBuffer ) {
 			return ! frameBuffer->isInUse();
@@ -303,32 +387,482 @@ void Renderer::clearUnusedFrameBuffers()
 	), mFrameBufferCache.end() );
 }
 
+void Renderer::setFrameBufferMemoryBudget( size_t bytes )
+{
+	mFrameBufferMemoryBudget = bytes;
+	evictFrameBuffers();
+}
+
+void Renderer::evictFrameBuffers()
+{
+	while( mFrameBufferMemoryUsage > mFrameBufferMemoryBudget ) {
+		auto lruIt = mFrameBufferCache.end();
+		for( auto frameBufferIt = mFrameBufferCache.begin(); frameBufferIt != mFrameBufferCache.end(); ++frameBufferIt ) {
+			const auto &frameBuffer = *frameBufferIt;
+			if( ! isFrameBufferIdle( frameBuffer ) )
+				continue;
+
+			if( lruIt == mFrameBufferCache.end() || frameBuffer->mLastUsed < (*lruIt)->mLastUsed )
+				lruIt = frameBufferIt;
+		}
+
+		if( lruIt == mFrameBufferCache.end() )
+			break;
+
+		LOG_FRAMEBUFFER( "evicting FrameBuffer " << hex << lruIt->get() << dec << ", size: " << (*lruIt)->getSize() );
+		mFrameBufferMemoryUsage -= (*lruIt)->getNumBytes();
+		// A holder, like a Layer that is offscreen, may still reference it or even retain it as a cache. Its gl::Fbo is freed now rather than when the holder lets go,
+		// and as it is no longer pooled the holder's next acquireFrameBuffer() replaces it.
+		(*lruIt)->mFbo.reset();
+		(*lruIt)->mEvicted = true;
+		(*lruIt)->mCached = false;
+		mFrameBufferCache.erase( lruIt );
+		mNumFrameBuffersEvicted++;
+	}
+}
+
 void Renderer::pushFrameBuffer( const FrameBufferRef &frameBuffer )
 {
-	frameBuffer->setInUse( true );
-	gl::context()->pushFramebuffer( frameBuffer->mFbo );
+	CI_ASSERT_MSG( frameBuffer->isInUse() || ! UI_FRAMEBUFFER_CACHING_ENABLED, "FrameBuffer must be acquired before rendering to it" );
+
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::PUSH_FRAMEBUFFER );
+		command.mIndex = mRecording->addFrameBuffer( frameBuffer );
+		mRecording->addCommand( command );
+		return;
+	}
+
+	bindFrameBuffer( frameBuffer );
 }
 
 void Renderer::popFrameBuffer( const FrameBufferRef &frameBuffer )
 {
-	frameBuffer->setInUse( false );
-	gl::context()->popFramebuffer();
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::POP_FRAMEBUFFER );
+		command.mIndex = mRecording->addFrameBuffer( frameBuffer );
+		mRecording->addCommand( command );
+		return;
+	}
+
+	CI_ASSERT_MSG( ! mFrameBufferPushedStack.empty(), "FrameBuffer stack underflow" );
+
+	flush();
+	if( mFrameBufferPushedStack.back() )
+		mDevice->popFrameBuffer();
+
+	mFrameBufferPushedStack.pop_back();
+	mStateCache.setFrameBuffer( mDevice->getBoundFrameBufferId() );
 }
 
-void Renderer::pushClip( const ci::ivec2 &lowerLeft, const ci::ivec2 &size )
+void Renderer::bindFrameBuffer( const FrameBufferRef &frameBuffer )
+{
+	// also makes sure that pending quads sampling from this FrameBuffer are drawn before it is rendered to again
+	flush();
+
+	// nothing is pushed if it is already bound, popFrameBuffer() then has nothing to restore
+	const bool push = mStateCache.setFrameBuffer( mDevice->getFrameBufferId( *frameBuffer ) );
+	if( push )
+		mDevice->pushFrameBuffer( *frameBuffer );
+
+	mFrameBufferPushedStack.push_back( push );
+}
+
+void Renderer::bindProgram( GlDevice::Program program )
 {
-	gl::context()->pushBoolState( GL_SCISSOR_TEST, GL_TRUE );	
-	gl::context()->pushScissor( { lowerLeft, size } );
+	// left bound afterwards, ci::gl draws bind their own GlslProg in a scope that restores this one
+	if( mStateCache.setProgram( mDevice->getProgramId( program ) ) )
+		mDevice->bindProgram( program );
+}
 
+void Renderer::bindTexture( const RenderCommandList::QuadTexture &texture )
+{
+	// left bound afterwards like bindProgram(), consecutive batches from the same ImageAtlas page or of solid quads don't rebind
+	if( mStateCache.setTexture( mDevice->getTextureId( texture ) ) )
+		mDevice->bindTexture( texture );
+}
+
+void Renderer::setBackend( const RenderBackendRef &backend )
+{
+	CI_ASSERT_MSG( ! mRecording, "can't change the backend while recording" );
+
+	// pooled FrameBuffers were created for the previous backend
+	flush();
+	clearUnusedFrameBuffers();
+	mBackend = backend;
+}
+
+void Renderer::setGlDevice( const GlDeviceRef &device )
+{
+	CI_ASSERT_MSG( ! mRecording, "can't change the GlDevice while recording" );
+	CI_ASSERT( device );
+
+	// pooled FrameBuffers were created for the previous device, and the shadowed state was set through it
+	flush();
+	clearUnusedFrameBuffers();
+	mDevice = device;
+	invalidateState();
+}
+
+void Renderer::invalidateState()
+{
+	mStateCache.invalidate();
+}
+
+void Renderer::pushClip( const ci::ivec2 &lowerLeft, const ci::ivec2 &size )
+{
 	mScissorStack.push_back( { lowerLeft, size } );
+
+	if( mRecording ) {
+		mRecording->addCommand( makeCommand( RenderCommand::Type::PUSH_CLIP, Rectf( vec2( lowerLeft ), vec2( lowerLeft + size ) ) ) );
+		return;
+	}
+
+	flush();
+	const bool changed = mStateCache.setScissor( true, lowerLeft, size );
+	if( mScissorStack.size() == 1 ) {
+		// the outermost clip stores the scissor state from before, nested clips only change it
+		mDevice->pushScissor( lowerLeft, size );
+	}
+	else if( changed ) {
+		mDevice->setScissor( lowerLeft, size );
+	}
 }
 
 void Renderer::popClip()
 {
-	gl::context()->popBoolState( GL_SCISSOR_TEST );
-	gl::context()->popScissor();
-
 	mScissorStack.pop_back();
+
+	if( mRecording ) {
+		mRecording->addCommand( makeCommand( RenderCommand::Type::POP_CLIP ) );
+		return;
+	}
+
+	flush();
+	if( mScissorStack.empty() ) {
+		mDevice->popScissor();
+		// back to whatever it was before the outermost clip
+		mStateCache.invalidate( GlStateCache::State::SCISSOR );
+	}
+	else {
+		const auto &scissor = mScissorStack.back();
+		if( mStateCache.setScissor( true, scissor.first, scissor.second ) )
+			mDevice->setScissor( scissor.first, scissor.second );
+	}
+}
+
+void Renderer::pushViewport( const ci::ivec2 &lowerLeft, const ci::ivec2 &size )
+{
+	if( mRecording ) {
+		mRecording->addCommand( makeCommand( RenderCommand::Type::PUSH_VIEWPORT, Rectf( vec2( lowerLeft ), vec2( lowerLeft + size ) ) ) );
+		return;
+	}
+
+	flush();
+	mDevice->pushViewport( lowerLeft, size );
+}
+
+void Renderer::popViewport()
+{
+	if( mRecording ) {
+		mRecording->addCommand( makeCommand( RenderCommand::Type::POP_VIEWPORT ) );
+		return;
+	}
+
+	flush();
+	mDevice->popViewport();
+}
+
+void Renderer::clear( const ColorA &color )
+{
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::CLEAR );
+		command.mColor = color;
+		mRecording->addCommand( command );
+		return;
+	}
+
+	flush();
+	mDevice->clear( color );
+}
+
+void Renderer::pushModelMatrix()
+{
+	if( mRecording )
+		mModelMatrixStack.push_back( mModelMatrixStack.back() );
+	else
+		gl::pushModelMatrix();
+}
+
+void Renderer::popModelMatrix()
+{
+	if( mRecording ) {
+		mModelMatrixStack.pop_back();
+		CI_ASSERT_MSG( ! mModelMatrixStack.empty(), "model matrix stack underflow" );
+	}
+	else
+		gl::popModelMatrix();
+}
+
+void Renderer::translate( const vec2 &v )
+{
+	if( mRecording )
+		mModelMatrixStack.back() = glm::translate( mModelMatrixStack.back(), vec3( v, 0 ) );
+	else
+		gl::translate( v );
+}
+
+void Renderer::multModelMatrix( const mat4 &m )
+{
+	if( mRecording )
+		mModelMatrixStack.back() *= m;
+	else
+		gl::multModelMatrix( m );
+}
+
+void Renderer::pushMatrices()
+{
+	if( mRecording ) {
+		mModelMatrixStack.push_back( mModelMatrixStack.back() );
+		mProjectionMatrixStack.push_back( mProjectionMatrixStack.back() );
+	}
+	else
+		gl::pushMatrices();
+}
+
+void Renderer::popMatrices()
+{
+	if( mRecording ) {
+		mModelMatrixStack.pop_back();
+		mProjectionMatrixStack.pop_back();
+		CI_ASSERT_MSG( ! mModelMatrixStack.empty() && ! mProjectionMatrixStack.empty(), "matrix stack underflow" );
+	}
+	else
+		gl::popMatrices();
+}
+
+void Renderer::setMatricesWindow( const ivec2 &size )
+{
+	if( mRecording ) {
+		// same as gl::setMatricesWindow() with the origin in the upper left
+		mModelMatrixStack.back() = mat4();
+		mProjectionMatrixStack.back() = glm::ortho( 0.0f, (float)size.x, (float)size.y, 0.0f, -1.0f, 1.0f );
+	}
+	else
+		gl::setMatricesWindow( size );
+}
+
+mat4 Renderer::getModelViewProjection() const
+{
+	return mRecording ? mProjectionMatrixStack.back() * mModelMatrixStack.back() : gl::getModelViewProjection();
+}
+
+RenderCommandList::DrawState Renderer::getDrawState() const
+{
+	CI_ASSERT( mRecording );
+
+	RenderCommandList::DrawState result;
+	result.mModelMatrix = mModelMatrixStack.back();
+	result.mProjectionMatrix = mProjectionMatrixStack.back();
+	result.mColor = mRecordingColor;
+	return result;
+}
+
+void Renderer::beginRecording( RenderCommandList *list, const mat4 &modelMatrix, const mat4 &projectionMatrix )
+{
+	CI_ASSERT_MSG( ! mRecording, "already recording" );
+	CI_ASSERT( list );
+
+	flush();
+	list->clear();
+	mRecording = list;
+	mRecordingColor = ColorA::white();
+	mModelMatrixStack.assign( 1, modelMatrix );
+	mProjectionMatrixStack.assign( 1, projectionMatrix );
+
+	// so that the list doesn't depend on the blend mode that happens to be current when it is submitted
+	setBlendMode( mBlendModeStack.back() );
+}
+
+void Renderer::endRecording()
+{
+	CI_ASSERT_MSG( mRecording, "not recording" );
+
+	mRecording = nullptr;
+	mModelMatrixStack.clear();
+	mProjectionMatrixStack.clear();
+}
+
+void Renderer::submit( const RenderCommandList &list )
+{
+	CI_ASSERT_MSG( ! mRecording, "can't submit while recording" );
+
+	if( mBackend ) {
+		mBackend->submit( list );
+		return;
+	}
+
+	for( const auto &command : list.mCommands ) {
+		switch( command.mType ) {
+			case RenderCommand::Type::QUADS:
+				batchQuads( &list.mVertices[command.mFirst], command.mCount, command.mIndex != RenderCommand::NO_INDEX ? list.mTextures[command.mIndex] : RenderCommandList::QuadTexture() );
+				if( ! isBatchingEnabled() )
+					flush();
+			break;
+			case RenderCommand::Type::TEXT: {
+				const auto &run = list.mTextRuns[command.mIndex];
+				ScopedDrawState stateScope( list.mDrawStates[command.mState], mDevice.get(), &mStateCache );
+				if( run.mWrapped )
+					drawStringWrapped( run.mText, run.mString, run.mFitRect );
+				else
+					drawString( run.mText, run.mString, run.mFitRect.getUpperLeft() );
+			}
+			break;
+			case RenderCommand::Type::DRAW_FRAMEBUFFER: {
+				const auto &frameBufferDraw = list.mFrameBufferDraws[command.mIndex];
+				ScopedDrawState stateScope( list.mDrawStates[command.mState], mDevice.get(), &mStateCache );
+				draw( frameBufferDraw.mFrameBuffer, frameBufferDraw.mSourceArea, frameBufferDraw.mDestRect );
+			}
+			break;
+			case RenderCommand::Type::CALLBACK: {
+				ScopedDrawState stateScope( list.mDrawStates[command.mState], mDevice.get(), &mStateCache );
+				drawCallback( list.mCallbacks[command.mIndex] );
+			}
+			break;
+			case RenderCommand::Type::CLEAR:
+				clear( command.mColor );
+			break;
+			case RenderCommand::Type::PUSH_CLIP:
+				pushClip( ivec2( command.mRect.getUpperLeft() ), ivec2( command.mRect.getSize() ) );
+			break;
+			case RenderCommand::Type::POP_CLIP:
+				popClip();
+			break;
+			case RenderCommand::Type::PUSH_VIEWPORT:
+				pushViewport( ivec2( command.mRect.getUpperLeft() ), ivec2( command.mRect.getSize() ) );
+			break;
+			case RenderCommand::Type::POP_VIEWPORT:
+				popViewport();
+			break;
+			case RenderCommand::Type::PUSH_FRAMEBUFFER:
+				// FrameBuffers are released once the Layer that recorded them is done with them, so they are no longer in use by now
+				bindFrameBuffer( list.mFrameBuffers[command.mIndex] );
+			break;
+			case RenderCommand::Type::POP_FRAMEBUFFER:
+				popFrameBuffer( list.mFrameBuffers[command.mIndex] );
+			break;
+			case RenderCommand::Type::SET_BLEND_MODE:
+				setBlendMode( command.mBlendMode );
+			break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+
+	flush();
+	setBlendMode( mBlendModeStack.back() );
+}
+
+void Renderer::setBatchingEnabled( bool enable )
+{
+	if( ! enable )
+		flush();
+
+	mBatchingEnabledStack.back() = enable;
+}
+
+void Renderer::pushBatchingEnabled( bool enable )
+{
+	if( ! enable )
+		flush();
+
+	mBatchingEnabledStack.push_back( enable );
+}
+
+void Renderer::popBatchingEnabled()
+{
+	mBatchingEnabledStack.pop_back();
+	CI_ASSERT_MSG( ! mBatchingEnabledStack.empty(), "batching stack underflow" );
+
+	if( ! mBatchingEnabledStack.back() )
+		flush();
+}
+
+void Renderer::addQuad( const Rectf &rect, const Image *image, const Rectf &texCoords )
+{
+	// setColor() has already premultiplied the current color if needed
+	const ColorA color = getCurrentColor();
+	const mat4 modelViewProjection = getModelViewProjection();
+	const QuadVertex vertices[] = {
+		{ modelViewProjection * vec4( rect.x1, rect.y1, 0, 1 ), vec2( texCoords.x1, texCoords.y1 ), color },
+		{ modelViewProjection * vec4( rect.x2, rect.y1, 0, 1 ), vec2( texCoords.x2, texCoords.y1 ), color },
+		{ modelViewProjection * vec4( rect.x2, rect.y2, 0, 1 ), vec2( texCoords.x2, texCoords.y2 ), color },
+		{ modelViewProjection * vec4( rect.x1, rect.y2, 0, 1 ), vec2( texCoords.x1, texCoords.y2 ), color }
+	};
+
+	RenderCommandList::QuadTexture texture;
+	if( image ) {
+		texture.mTexture = image->mTexture;
+		texture.mSurface = image->mSurface;
+	}
+
+	if( mRecording )
+		mRecording->addQuad( vertices, texture.mTexture, texture.mSurface );
+	else {
+		CI_ASSERT_MSG( mDevice->usesGl(), "drawing must be recorded while the GlDevice doesn't use gl" );
+		batchQuads( vertices, 1, texture );
+	}
+}
+
+void Renderer::addSolidQuad( const Rectf &rect )
+{
+	addQuad( rect, nullptr, Rectf( 0, 0, 1, 1 ) );
+}
+
+void Renderer::batchQuads( const QuadVertex *vertices, size_t numQuads, const RenderCommandList::QuadTexture &texture )
+{
+	CI_ASSERT_MSG( ! mBackend, "drawing must be recorded while a RenderBackend is set" );
+
+	if( mQuadVertices.capacity() == 0 )
+		mQuadVertices.reserve( MAX_QUADS_PER_BATCH * 4 );
+
+	while( numQuads ) {
+		if( getTextureResource( texture ) != getTextureResource( mQuadTexture ) || mQuadVertices.size() == MAX_QUADS_PER_BATCH * 4 )
+			flush();
+
+		mQuadTexture = texture;
+
+		const size_t numAdded = min( numQuads, MAX_QUADS_PER_BATCH - mQuadVertices.size() / 4 );
+		mQuadVertices.insert( mQuadVertices.end(), vertices, vertices + numAdded * 4 );
+		vertices += numAdded * 4;
+		numQuads -= numAdded;
+	}
+}
+
+void Renderer::addStrokedQuads( const Rectf &rect, float lineWidth )
+{
+	const float halfWidth = lineWidth / 2;
+	addSolidQuad( Rectf( rect.x1 - halfWidth, rect.y1 - halfWidth, rect.x2 + halfWidth, rect.y1 + halfWidth ) ); // top
+	addSolidQuad( Rectf( rect.x1 - halfWidth, rect.y2 - halfWidth, rect.x2 + halfWidth, rect.y2 + halfWidth ) ); // bottom
+	addSolidQuad( Rectf( rect.x1 - halfWidth, rect.y1 + halfWidth, rect.x1 + halfWidth, rect.y2 - halfWidth ) ); // left
+	addSolidQuad( Rectf( rect.x2 - halfWidth, rect.y1 + halfWidth, rect.x2 + halfWidth, rect.y2 - halfWidth ) ); // right
+}
+
+void Renderer::flush()
+{
+	if( mQuadVertices.empty() )
+		return;
+
+	const size_t numQuads = mQuadVertices.size() / 4;
+
+	bindProgram( GlDevice::Program::QUADS );
+	bindTexture( mQuadTexture );
+	mDevice->drawQuads( mQuadVertices.data(), numQuads );
+
+	mQuadVertices.clear();
+	mQuadTexture = RenderCommandList::QuadTexture();
+	mNumDrawCalls++;
+	mNumBatches++;
+	mNumQuadsBatched += numQuads;
 }
 
 std::string Renderer::printCurrentFrameBuffersToString() const
@@ -351,68 +885,147 @@ std::string Renderer::printCurrentFrameBuffersToString() const
 
 void Renderer::draw( const FrameBufferRef &frameBuffer, const Rectf &destRect )
 {
-	if( ! mGlslFrameBuffer ) {
-		try {
-			// TODO: add support for drawing partial textures
-//			mGlslFrameBuffer = gl::GlslProg::create( FRAMEBUFFER_VERT, FRAMEBUFFER_FRAG );
-			mGlslFrameBuffer = gl::getStockShader( gl::ShaderDef().texture().color() );
-			CI_LOG_I( "loaded mGlslFrameBuffer" );
-		}
-		catch( Exception &exc ) {
-			CI_LOG_EXCEPTION( "failed to load mGlslFrameBuffer", exc );
-		}
-	}
-
-	gl::ScopedGlslProg glslScope( mGlslFrameBuffer );
-	gl::ScopedTextureBind texScope( frameBuffer->mFbo->getColorTexture() );
-
-	gl::drawSolidRect( destRect );
+	draw( frameBuffer, Area::zero(), destRect );
 }
 
 void Renderer::draw( const FrameBufferRef &frameBuffer, const ci::Area &sourceArea, const ci::Rectf &destRect )
 {
-	gl::draw( frameBuffer->mFbo->getColorTexture(), sourceArea, destRect );
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::DRAW_FRAMEBUFFER );
+		command.mIndex = (uint32_t)mRecording->mFrameBufferDraws.size();
+		command.mState = mRecording->addDrawState( getDrawState() );
+		mRecording->mFrameBufferDraws.push_back( { frameBuffer, sourceArea, destRect } );
+		mRecording->addCommand( command );
+		return;
+	}
+
+	flush();
+
+	if( sourceArea.calcArea() != 0 ) {
+		mDevice->drawFrameBufferArea( *frameBuffer, sourceArea, destRect );
+		mNumDrawCalls++;
+		return;
+	}
+
+	bindProgram( GlDevice::Program::FRAMEBUFFER );
+	mDevice->drawFrameBuffer( *frameBuffer, destRect );
+	mNumDrawCalls++;
 }
 
 void Renderer::draw( const ImageRef &image, const ci::Rectf &destRect )
 {
-	if( ! mBatchImage ) {
-		mBatchImage = gl::Batch::create( geom::Rect( Rectf( 0, 0, 1, 1 ) ), gl::getStockShader( gl::ShaderDef().color().texture() ) );
+	// when drawing with gl, Images that only have a Surface are uploaded the first time they're drawn
+	const bool drawingWithGl = isDrawingWithGl();
+	if( ! image->mTexture && drawingWithGl )
+		image->createTexture();
+
+	// only the Image's area is sampled, which is a part of a shared page for Images from an ImageAtlas
+	const Area &area = image->mArea;
+	Rectf texCoords;
+	if( ! drawingWithGl ) {
+		// a RenderBackend samples the surface, which is top-down. Images without one are skipped by the backend.
+		const vec2 surfaceSize = image->mSurface ? vec2( image->mSurface->getSize() ) : vec2( area.getSize() );
+		texCoords = Rectf( area.x1 / surfaceSize.x, area.y1 / surfaceSize.y, area.x2 / surfaceSize.x, area.y2 / surfaceSize.y );
 	}
+	else
+		texCoords = image->mTexture->getAreaTexCoords( area );
 
-	draw( image, destRect, mBatchImage );
+	addQuad( destRect, image.get(), texCoords );
+
+	if( ! isBatchingEnabled() )
+		flush();
 }
 
 void Renderer::draw( const ImageRef &image, const ci::Rectf &destRect, const ci::gl::BatchRef &batch )
 {
+	if( mRecording ) {
+		drawCallback( [this, image, destRect, batch] { draw( image, destRect, batch ); } );
+		return;
+	}
+
+	// the batch may use its own shader, so it is drawn on its own
+	flush();
+
 	gl::ScopedTextureBind texScope( image->mTexture );
 
 	gl::ScopedModelMatrix modelScope;
 	gl::translate( destRect.getUpperLeft() );
 	gl::scale( destRect.getSize() );
 	batch->draw();
+	mNumDrawCalls++;
 }
 
-void Renderer::drawSolidRect( const Rectf &rect )
+void Renderer::drawString( const TextRef &text, const string &str, const vec2 &baseline )
 {
-	if( ! mBatchSolidRect ) {
-		mBatchSolidRect = gl::Batch::create( geom::Rect( Rectf( 0, 0, 1, 1 ) ), gl::getStockShader( gl::ShaderDef().color() ) );
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::TEXT );
+		command.mIndex = (uint32_t)mRecording->mTextRuns.size();
+		command.mState = mRecording->addDrawState( getDrawState() );
+		mRecording->mTextRuns.push_back( { text, str, Rectf( baseline, baseline ), false } );
+		mRecording->addCommand( command );
+		return;
 	}
 
-	gl::ScopedModelMatrix modelScope;
-	gl::translate( rect.getUpperLeft() );
-	gl::scale( rect.getSize() );
-	mBatchSolidRect->draw();
+	flush();
+	mDevice->drawString( text, str, baseline );
+	mNumDrawCalls++;
+}
+
+void Renderer::drawStringWrapped( const TextRef &text, const string &str, const Rectf &fitRect )
+{
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::TEXT );
+		command.mIndex = (uint32_t)mRecording->mTextRuns.size();
+		command.mState = mRecording->addDrawState( getDrawState() );
+		mRecording->mTextRuns.push_back( { text, str, fitRect, true } );
+		mRecording->addCommand( command );
+		return;
+	}
+
+	flush();
+	mDevice->drawStringWrapped( text, str, fitRect );
+	mNumDrawCalls++;
+}
+
+void Renderer::drawCallback( const function<void ()> &fn )
+{
+	if( mRecording ) {
+		auto command = makeCommand( RenderCommand::Type::CALLBACK );
+		command.mIndex = (uint32_t)mRecording->mCallbacks.size();
+		command.mState = mRecording->addDrawState( getDrawState() );
+		mRecording->mCallbacks.push_back( fn );
+		mRecording->addCommand( command );
+		return;
+	}
+
+	flush();
+	mDevice->drawCallback( fn );
+	// fn may have changed any gl state without going through the cache
+	invalidateState();
+}
+
+void Renderer::drawSolidRect( const Rectf &rect )
+{
+	addSolidQuad( rect );
+
+	if( ! isBatchingEnabled() )
+		flush();
 }
 
 void Renderer::drawStrokedRect( const Rectf &rect )
 {
-	gl::drawStrokedRect( rect );
+	addStrokedQuads( rect, 1 );
+
+	if( ! isBatchingEnabled() )
+		flush();
 }
 
 void Renderer::drawStrokedRect( const Rectf &rect, float lineWidth )
 {
-	gl::drawStrokedRect( rect, lineWidth );
+	addStrokedQuads( rect, lineWidth );
+
+	if( ! isBatchingEnabled() )
+		flush();
 }
 
 } // namespace vu
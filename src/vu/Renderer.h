@@ -22,13 +22,20 @@
 #pragma once
 
 #include "vu/Export.h"
+#include "vu/GlDevice.h"
+#include "vu/GlStateCache.h"
 #include "vu/Image.h"
+#include "vu/RenderBackend.h"
+#include "vu/RenderCommandList.h"
 
 #include "cinder/Cinder.h"
 #include "cinder/Color.h"
 #include "cinder/Rect.h"
 
-#define UI_FRAMEBUFFER_CACHING_ENABLED 0
+//! FrameBuffers are pooled by the Renderer unless this is defined to 0, in which case each Layer and Filter Pass owns its own.
+#if ! defined( UI_FRAMEBUFFER_CACHING_ENABLED )
+	#define UI_FRAMEBUFFER_CACHING_ENABLED 1
+#endif
 
 namespace cinder {
 
@@ -38,7 +45,6 @@ namespace gl {
 
 typedef std::shared_ptr<class Batch>		BatchRef;
 typedef std::shared_ptr<class Fbo>          FboRef;
-typedef std::shared_ptr<class GlslProg>     GlslProgRef;
 
 } } // namespace cinder::gl
 
@@ -61,10 +67,18 @@ class CI_UI_API FrameBuffer {
 			return *this;
 		}
 
+		//! Sets whether a gl::Fbo is created, which is false for Renderers that don't draw with gl (see Renderer::isDrawingWithGl()). \default true.
+		Format &fbo( bool create )
+		{
+			mCreateFbo = create;
+			return *this;
+		}
+
 		//! Allow Format to be used as a key in std::unordered_map
 		bool operator==( const Format &other ) const;
 
-		ci::ivec2 mSize;
+		ci::ivec2	mSize;
+		bool		mCreateFbo = true;
 	};
 
 	FrameBuffer( const Format &format );
@@ -73,9 +87,15 @@ class CI_UI_API FrameBuffer {
 	ci::ivec2   getSize() const;
 	int         getWidth() const { return getSize().x; }
 	int         getHeight() const { return getSize().y; }
+	//! Returns the number of bytes of GPU memory used by the color attachment.
+	size_t		getNumBytes() const;
+	//! Returns whether this FrameBuffer has been acquired from the Renderer and not yet released, in which case the Renderer won't hand it out again.
 	bool        isInUse() const { return mInUse; }
 	void		setInUse( bool inUse );
+	//! Returns whether the Renderer's pool evicted this FrameBuffer to stay within its memory budget, after which its contents are gone. See Renderer::retainFrameBufferAsCache().
+	bool		isEvicted() const { return mEvicted; }
 
+	//! Reads back the contents, only possible if this FrameBuffer has a gl::Fbo.
 	ci::ImageSourceRef  createImageSource() const;
 
 	// TODO: don't expose gl, but as Renderer doesn't support passing in shaders for drawing this is the only way to custom draw a FrameBuffer's contents
@@ -87,7 +107,12 @@ private:
 	//! Updates the internal FBO to match \a format.
 	void updateFormat( const Format &format );
 
+	ci::ivec2			mSize;
 	bool                mInUse = false;
+	bool				mEvictable = false;	// in use, but only as a cache that the holder can rebuild, see Renderer::retainFrameBufferAsCache()
+	bool				mEvicted = false;
+	bool				mCached = false;	// owned by the Renderer's pool
+	uint64_t			mLastUsed = 0;		// Renderer's use counter when this was last acquired, for LRU eviction
 
 	friend class Renderer;
 };
@@ -113,6 +138,9 @@ namespace vu {
 
 class CI_UI_API Renderer {
   public:
+	//! The most quads drawn by a single batch, so that their vertices can be indexed with 16 bits.
+	static const size_t MAX_QUADS_PER_BATCH = 4096;
+
 	Renderer();
 
 	//! Sets the current color used for rendering
@@ -134,25 +162,113 @@ class CI_UI_API Renderer {
 	//!
 	void popClip();
 
-	//!
+	//! Enables or disables batching. While enabled, solid rects, stroked rects and images are collected into batches of quads that are drawn
+	//! together when the texture, BlendMode, clip or FrameBuffer changes, or flush() is called. While disabled, each is drawn right away. \default true.
+	void setBatchingEnabled( bool enable = true );
+	//! Returns whether batching is currently enabled.
+	bool isBatchingEnabled() const				{ return mBatchingEnabledStack.back(); }
+	//! Enables or disables batching, first storing whether it was enabled. Disabling draws any quads that are pending.
+	void pushBatchingEnabled( bool enable );
+	//! Restores batching to what it was before the last pushBatchingEnabled().
+	void popBatchingEnabled();
+	//! Draws all pending quads. Needed before drawing with ci::gl directly or changing gl state that the Renderer doesn't know about.
+	void flush();
+	//! Forgets the blend, color, scissor, framebuffer and GlslProg state that the Renderer last set, so that it is set again on next use. Needed after changing any of them
+	//! with ci::gl directly outside of drawCallback(), which does this itself. The Graph calls this at the start of every frame.
+	void invalidateState();
+	//! Returns the shadowed gl state, which counts the state changes that were issued and those that were skipped because the value was already current.
+	const GlStateCache&	getStateCache() const	{ return mStateCache; }
+
+	//! Records everything drawn through this Renderer into \a list, which is cleared first, until endRecording(). Nothing is drawn while recording and gl isn't used,
+	//! except to acquire FrameBuffers. The matrices start out as \a modelMatrix and \a projectionMatrix, which includes the view matrix.
+	void beginRecording( RenderCommandList *list, const ci::mat4 &modelMatrix = ci::mat4(), const ci::mat4 &projectionMatrix = ci::mat4() );
+	//! Stops recording, after which drawing goes to gl again.
+	void endRecording();
+	//! Returns whether drawing is currently being recorded.
+	bool isRecording() const					{ return mRecording != nullptr; }
+	//! Draws the commands recorded in \a list with gl, or passes them to the RenderBackend if one is set. The same list can be submitted more than once,
+	//! as long as the FrameBuffers and callbacks it refers to are still valid.
+	void submit( const RenderCommandList &list );
+	//! Sets a RenderBackend that draws submitted commands in place of gl, or null to draw with gl again. While a backend is set the Renderer doesn't use gl,
+	//! so drawing must be recorded and then submitted (Graphs do this on their own), and new FrameBuffers have no gl::Fbo. Set it before anything is drawn.
+	void setBackend( const RenderBackendRef &backend );
+	//! Returns the RenderBackend that submitted commands are drawn with, or null if they are drawn with gl.
+	const RenderBackendRef&	getBackend() const	{ return mBackend; }
+	//! Sets the GlDevice that issues the gl calls when drawing without a RenderBackend, which is a CinderGlDevice by default. A device that doesn't use gl,
+	//! like NullGlDevice, still goes through the Renderer's batching and GlStateCache, but drawing must then be recorded. Set it before anything is drawn.
+	void setGlDevice( const GlDeviceRef &device );
+	//! Returns the GlDevice that issues the gl calls when drawing without a RenderBackend.
+	const GlDeviceRef&	getGlDevice() const		{ return mDevice; }
+	//! Returns whether drawing uses gl, which is the case without a RenderBackend if the GlDevice uses gl.
+	bool isDrawingWithGl() const				{ return ! mBackend && mDevice->usesGl(); }
+
+	//! Stores the current model matrix. While not recording, this and the other matrix functions are the same as those in ci::gl.
+	void pushModelMatrix();
+	//! Restores the model matrix to what it was before the last pushModelMatrix().
+	void popModelMatrix();
+	//! Translates the current model matrix by \a v.
+	void translate( const ci::vec2 &v );
+	//! Multiplies the current model matrix by \a m.
+	void multModelMatrix( const ci::mat4 &m );
+	//! Stores the current model, view and projection matrices.
+	void pushMatrices();
+	//! Restores the matrices to what they were before the last pushMatrices().
+	void popMatrices();
+	//! Sets the matrices for drawing 2D content in a viewport of \a size, with the origin in the upper left.
+	void setMatricesWindow( const ci::ivec2 &size );
+	//! Makes the viewport the area of \a size starting at \a lowerLeft, first storing the current one.
+	void pushViewport( const ci::ivec2 &lowerLeft, const ci::ivec2 &size );
+	//! Restores the viewport to what it was before the last pushViewport().
+	void popViewport();
+	//! Clears the current FrameBuffer to \a color.
+	void clear( const ci::ColorA &color );
+
+	//! Returns a FrameBuffer at least as large as \a size, marked as in use until it is passed to releaseFrameBuffer(). Pooled FrameBuffers are reused when they
+	//! aren't much larger than \a size, otherwise a new one is created with \a size rounded up to a size class, so that Views animating their size don't reallocate every frame.
 	FrameBufferRef getFrameBuffer( const ci::ivec2 &size );
+	//! Reuses \a frameBuffer if it is pooled, not in use and at least as large as \a size, otherwise replaces it with getFrameBuffer(). Either way it is marked as in use.
+	//! Holders that draw every frame, like Layers, use this so they keep getting the same FrameBuffer while it isn't needed elsewhere.
+	void acquireFrameBuffer( FrameBufferRef *frameBuffer, const ci::ivec2 &size );
+	//! Marks \a frameBuffer as no longer in use, making it available to getFrameBuffer(). Holders may keep the reference to pass to acquireFrameBuffer() next time.
+	void releaseFrameBuffer( const FrameBufferRef &frameBuffer );
+	//! Keeps \a frameBuffer in use as a cache that its holder can rebuild, like a Layer's last render. It isn't handed out again, but once it is idle (see beginFrame())
+	//! the pool may evict it like one that isn't in use, after which FrameBuffer::isEvicted() returns true. Holders call this every frame that they draw with it, so that it is only idle
+	//! while they aren't drawn, ex. because they are culled or asleep. Releasing or acquiring it again makes it an ordinary FrameBuffer in use.
+	void retainFrameBufferAsCache( const FrameBufferRef &frameBuffer );
+	//! Marks the start of a frame that draws or records through this Renderer. FrameBuffers that aren't in use and haven't been acquired since the start of the previous frame are idle,
+	//! and may be resized or evicted by the pool even if a holder still references them. Caches that haven't been retained since then are idle too, but are only ever evicted.
+	//! An evicted FrameBuffer is no longer pooled, so acquireFrameBuffer() replaces it. The Graph calls this.
+	void beginFrame();
 	//!
 	size_t getNumFrameBuffersCached() const     { return mFrameBufferCache.size(); }
 	//!
 	void pushFrameBuffer( const FrameBufferRef &frameBuffer );
 	//!
 	void popFrameBuffer( const FrameBufferRef &frameBuffer );
-	//!
+	//! Removes all FrameBuffers that aren't in use from the pool.
 	void clearUnusedFrameBuffers();
+	//! Sets the amount of GPU memory that pooled FrameBuffers may use. When over budget, the least recently used idle FrameBuffers are evicted, see beginFrame(). \default 256 MB.
+	void	setFrameBufferMemoryBudget( size_t bytes );
+	//! Returns the amount of GPU memory that pooled FrameBuffers may use.
+	size_t	getFrameBufferMemoryBudget() const		{ return mFrameBufferMemoryBudget; }
+	//! Returns the amount of GPU memory currently used by pooled FrameBuffers. This can exceed the budget if all FrameBuffers are in use.
+	size_t	getFrameBufferMemoryUsage() const		{ return mFrameBufferMemoryUsage; }
 	//!
 	void draw( const FrameBufferRef &frameBuffer, const ci::Rectf &destRect );
-	//!
+	//! Draws \a sourceArea of \a frameBuffer into \a destRect, or all of it if \a sourceArea is empty.
 	void draw( const FrameBufferRef &frameBuffer, const ci::Area &sourceArea, const ci::Rectf &destRect );
 	//!
 	void draw( const ImageRef &image, const ci::Rectf &destRect );
 	//!
 	void draw( const ImageRef &image, const ci::Rectf &destRect, const ci::gl::BatchRef &batch );
 
+	//! Draws \a str with \a text, starting at \a baseline.
+	void drawString( const TextRef &text, const std::string &str, const ci::vec2 &baseline );
+	//! Draws \a str with \a text, wrapped to fit within \a fitRect.
+	void drawStringWrapped( const TextRef &text, const std::string &str, const ci::Rectf &fitRect );
+	//! Calls \a fn, which draws with ci::gl directly. While recording, it is called when the commands are submitted instead, with the matrices and color that are current now.
+	void drawCallback( const std::function<void ()> &fn );
+
 	//! Draws a solid rectangle with dimensions \a rect.
 	void drawSolidRect( const ci::Rectf &rect );
 	//! Draws a stroked rectangle with dimensions \a rect.
@@ -162,6 +278,25 @@ class CI_UI_API Renderer {
 
 	std::string printCurrentFrameBuffersToString() const;
 
+	//! Returns the number of FrameBuffers created by getFrameBuffer() since this Renderer was constructed.
+	size_t getNumFrameBuffersCreated() const	{ return mNumFrameBuffersCreated; }
+	//! Returns the number of cached FrameBuffers that getFrameBuffer() had to resize since this Renderer was constructed.
+	size_t getNumFrameBuffersResized() const	{ return mNumFrameBuffersResized; }
+	//! Returns the number of cached FrameBuffers that getFrameBuffer() or acquireFrameBuffer() returned as is since this Renderer was constructed.
+	size_t getNumFrameBuffersReused() const		{ return mNumFrameBuffersReused; }
+	//! Returns the number of pooled FrameBuffers that were evicted to stay within the memory budget since this Renderer was constructed.
+	size_t getNumFrameBuffersEvicted() const	{ return mNumFrameBuffersEvicted; }
+	//! Returns the number of FrameBuffer requests that were satisfied by the pool, same as getNumFrameBuffersReused().
+	size_t getNumFrameBufferHits() const		{ return mNumFrameBuffersReused; }
+	//! Returns the number of FrameBuffer requests that needed a new allocation, either by creating or resizing a FrameBuffer.
+	size_t getNumFrameBufferMisses() const		{ return mNumFrameBuffersCreated + mNumFrameBuffersResized; }
+	//! Returns the number of draws issued through this Renderer since it was constructed, including batches. Drawing with ci::gl directly isn't counted.
+	size_t getNumDrawCalls() const				{ return mNumDrawCalls; }
+	//! Returns the number of batches of quads drawn since this Renderer was constructed.
+	size_t getNumBatches() const				{ return mNumBatches; }
+	//! Returns the number of quads drawn in batches since this Renderer was constructed.
+	size_t getNumQuadsBatched() const			{ return mNumQuadsBatched; }
+
 	// TODO: make private and provide public api
 	std::vector<std::pair<ci::ivec2, ci::ivec2>> mScissorStack;
 
@@ -169,10 +304,58 @@ class CI_UI_API Renderer {
 	std::vector<ci::ColorA>		mColorStack;
 	std::vector<BlendMode>		mBlendModeStack;
 
-	std::vector<FrameBufferRef>	mFrameBufferCache;
+	//! Evicts least recently used idle FrameBuffers until the pool fits within the memory budget.
+	void evictFrameBuffers();
+	//! Returns whether \a frameBuffer isn't in use and hasn't been acquired during this frame or the previous one, see beginFrame().
+	bool isFrameBufferIdle( const FrameBufferRef &frameBuffer ) const;
+
+	//! Adds a quad covering \a rect with the current color and model-view-projection matrix, either to the list being recorded or to the pending batch.
+	//! The texture of \a image is sampled across \a texCoords, solid quads have no image.
+	void addQuad( const ci::Rectf &rect, const Image *image, const ci::Rectf &texCoords );
+	void addSolidQuad( const ci::Rectf &rect );
+	//! Adds the four sides of a stroked rect centered around \a rect as solid quads.
+	void addStrokedQuads( const ci::Rectf &rect, float lineWidth );
+	//! Adds \a numQuads quads to the pending batch, drawing pending quads first if they use a different \a texture. Solid quads have an empty texture.
+	void batchQuads( const QuadVertex *vertices, size_t numQuads, const RenderCommandList::QuadTexture &texture );
+	//! Binds \a frameBuffer, unless it is already bound.
+	void bindFrameBuffer( const FrameBufferRef &frameBuffer );
+	//! Binds \a program, unless it is already bound.
+	void bindProgram( GlDevice::Program program );
+	//! Binds the texture that quads with \a texture sample to the first texture unit, unless it is already bound.
+	void bindTexture( const RenderCommandList::QuadTexture &texture );
+
+	ci::ColorA	getCurrentColor() const;
+	ci::mat4	getModelViewProjection() const;
+	RenderCommandList::DrawState	getDrawState() const;
 
-	ci::gl::GlslProgRef         mGlslFrameBuffer;
-	ci::gl::BatchRef			mBatchSolidRect, mBatchImage;
+	std::vector<FrameBufferRef>	mFrameBufferCache;
+	size_t						mFrameBufferMemoryBudget = 256 * 1024 * 1024;
+	size_t						mFrameBufferMemoryUsage = 0;
+	uint64_t					mFrameBufferUseCounter = 0;
+	uint64_t					mFrameBufferUseAtFrameStart = 0; // mFrameBufferUseCounter when beginFrame() was last called
+	uint64_t					mFrameBufferUseAtPrevFrameStart = 0; // and when it was called before that
+
+	std::vector<bool>			mBatchingEnabledStack;
+	GlStateCache				mStateCache;
+	std::vector<bool>			mFrameBufferPushedStack; // whether each pushFrameBuffer() had to bind its Fbo
+	BlendMode					mCurrentBlendMode = BlendMode::ALPHA;
+	std::vector<QuadVertex>		mQuadVertices; // pending quads, four vertices each
+	RenderCommandList::QuadTexture	mQuadTexture; // texture of the pending quads
+
+	GlDeviceRef					mDevice;
+	RenderBackendRef			mBackend;
+	RenderCommandList*			mRecording = nullptr;
+	ci::ColorA					mRecordingColor; // the current color while recording, premultiplied if needed
+	std::vector<ci::mat4>		mModelMatrixStack; // only used while recording
+	std::vector<ci::mat4>		mProjectionMatrixStack; // includes the view matrix, only used while recording
+
+	size_t	mNumFrameBuffersCreated = 0;
+	size_t	mNumFrameBuffersResized = 0;
+	size_t	mNumFrameBuffersReused = 0;
+	size_t	mNumFrameBuffersEvicted = 0;
+	size_t	mNumDrawCalls = 0;
+	size_t	mNumBatches = 0;
+	size_t	mNumQuadsBatched = 0;
 };
 
 } // namespace vu
@@ -208,6 +208,7 @@ void ScrollView::update()
 {
 	if( ! mContentOffset.isComplete() ) {
 		mContentOffsetAnimating = true;
+		wake(); // stay awake in a sleeping subtree until the offset animation finishes
 	}
 
 	if( isUserInteracting() ) {
@@ -341,10 +342,11 @@ bool ScrollView::touchesBegan( app::TouchEvent &event )
 
 bool ScrollView::touchesMoved( app::TouchEvent &event )
 {
-	vec2 pos = toLocal( event.getTouches().front().getPos() );
+	const auto &touch = event.getTouches().front();
+	vec2 pos = toLocal( touch.getPos() );
 	vec2 lastPos = mSwipeTracker->getLastTouchPos();
 	updateOffset( pos, lastPos );
-	mSwipeTracker->storeTouchPos( pos, getGraph()->getCurrentTime() );
+	storeTouchSamples( touch );
 
 	LOG_SCROLL_TRACKING( "intercepting touches: " << getInterceptingTouches().size() << ",  pos: " << pos );
 
@@ -361,6 +363,24 @@ bool ScrollView::touchesMoved( app::TouchEvent &event )
 	return true;
 }
 
+// When touch coalescing is enabled, every sample merged into the dispatched touch is stored so that the swipe velocity isn't
+// sampled at frame rate. Sample times are relative to the Graph's current time, since touch times may use another clock.
+void ScrollView::storeTouchSamples( const app::TouchEvent::Touch &touch )
+{
+	const double currentTime = getGraph()->getCurrentTime();
+
+	getGraph()->getCoalescedTouches( touch.getId(), &mTouchSamples );
+	if( mTouchSamples.size() < 2 || mTouchSamples.back().getTime() <= mTouchSamples.front().getTime() ) {
+		// not coalesced, or the samples aren't timestamped
+		mSwipeTracker->storeTouchPos( toLocal( touch.getPos() ), currentTime );
+		return;
+	}
+
+	const double lastSampleTime = mTouchSamples.back().getTime();
+	for( const auto &sample : mTouchSamples )
+		mSwipeTracker->storeTouchPos( toLocal( sample.getPos() ), currentTime - ( lastSampleTime - sample.getTime() ) );
+}
+
 bool ScrollView::touchesEnded( app::TouchEvent &event )
 {
 	vec2 pos = toLocal( event.getTouches().front().getPos() );
@@ -54,7 +54,7 @@ class CI_UI_API ScrollView : public View {
 
 	void					setContentOffset( const ci::vec2 &offset, bool animated = false );
 	const ci::vec2&			getContentOffset() const	{ return mContentOffset; }
-	ci::Anim<ci::vec2>&		getContentOffsetAnim()		{ return mContentOffset; }
+	ci::Anim<ci::vec2>&		getContentOffsetAnim()		{ wake(); return mContentOffset; }
 
 	const ci::vec2&			getTargetOffset() const		{ return mTargetOffset; }
 
@@ -147,8 +147,11 @@ class CI_UI_API ScrollView : public View {
 	void calcOffsetBoundaries();
 	void updateOffset( const ci::vec2 &currentPos, const ci::vec2 &previousPos );
 	void updateDeceleratingOffset();
+	//! Stores the position of \a touch with mSwipeTracker, including any samples that were merged into it by touch coalescing.
+	void storeTouchSamples( const ci::app::TouchEvent::Touch &touch );
 
 	std::unique_ptr<SwipeTracker>	mSwipeTracker;
+	std::vector<ci::app::TouchEvent::Touch>	mTouchSamples; // reused by storeTouchSamples()
 	ci::vec2						mSwipeVelocity;
 	ci::vec2						mScrollVelocity;
 
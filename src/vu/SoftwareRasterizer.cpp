@@ -0,0 +1,467 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "vu/SoftwareRasterizer.h"
+#include "vu/Renderer.h"
+#include "vu/TextManager.h"
+
+#include "cinder/CinderAssert.h"
+#include "cinder/Log.h"
+#include "cinder/Text.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// enabled wherever the compiler targets SSE2, see SoftwareRasterizer for opting out
+#if ! defined( VU_RASTERIZER_SSE2 )
+	#if defined( __SSE2__ ) || defined( _M_X64 ) || defined( _M_AMD64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+		#define VU_RASTERIZER_SSE2 1
+	#else
+		#define VU_RASTERIZER_SSE2 0
+	#endif
+#endif
+
+#if VU_RASTERIZER_SSE2
+	#include <emmintrin.h>
+#endif
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+// Rasterized text runs are kept until there are more than this many, then all are dropped
+const size_t MAX_TEXT_SURFACES = 256;
+
+inline uint32_t div255( uint32_t x )
+{
+	x += 128;
+	return ( x + ( x >> 8 ) ) >> 8;
+}
+
+inline uint32_t toByte( float x )
+{
+	return uint32_t( glm::clamp( x, 0.0f, 1.0f ) * 255.0f + 0.5f );
+}
+
+//! Blends the premultiplied color r, g, b, a over \a count RGBA pixels starting at \a dst.
+void blendSpan( uint8_t *dst, size_t count, uint32_t r, uint32_t g, uint32_t b, uint32_t a )
+{
+	if( a == 255 ) {
+		const uint8_t pixel[4] = { uint8_t( r ), uint8_t( g ), uint8_t( b ), uint8_t( a ) };
+		for( size_t i = 0; i < count; i++ )
+			memcpy( dst + i * 4, pixel, 4 );
+
+		return;
+	}
+
+	if( ( r | g | b | a ) == 0 )
+		return;
+
+	const uint32_t invAlpha = 255 - a;
+	size_t i = 0;
+
+#if VU_RASTERIZER_SSE2
+	// four pixels at a time, with each channel widened to 16 bits for the multiply
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i invAlpha16 = _mm_set1_epi16( short( invAlpha ) );
+	const __m128i bias = _mm_set1_epi16( 128 );
+	const __m128i src = _mm_set1_epi32( int( r | ( g << 8 ) | ( b << 16 ) | ( a << 24 ) ) );
+	for( ; i + 4 <= count; i += 4 ) {
+		__m128i *p = (__m128i *)( dst + i * 4 );
+		const __m128i d = _mm_loadu_si128( p );
+		__m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), invAlpha16 ), bias );
+		__m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), invAlpha16 ), bias );
+		lo = _mm_srli_epi16( _mm_add_epi16( lo, _mm_srli_epi16( lo, 8 ) ), 8 );
+		hi = _mm_srli_epi16( _mm_add_epi16( hi, _mm_srli_epi16( hi, 8 ) ), 8 );
+		_mm_storeu_si128( p, _mm_adds_epu8( _mm_packus_epi16( lo, hi ), src ) );
+	}
+#endif
+
+	for( ; i < count; i++ ) {
+		uint8_t *p = dst + i * 4;
+		p[0] = uint8_t( min<uint32_t>( 255, r + div255( p[0] * invAlpha ) ) );
+		p[1] = uint8_t( min<uint32_t>( 255, g + div255( p[1] * invAlpha ) ) );
+		p[2] = uint8_t( min<uint32_t>( 255, b + div255( p[2] * invAlpha ) ) );
+		p[3] = uint8_t( min<uint32_t>( 255, a + div255( p[3] * invAlpha ) ) );
+	}
+}
+
+//! Returns the color of \a surface at \a texCoord (the upper left is 0, 0), interpolated between the four nearest pixels. Edges are clamped.
+ColorA sampleBilinear( const Surface8u &surface, const vec2 &texCoord )
+{
+	const int width = surface.getWidth();
+	const int height = surface.getHeight();
+	const float x = texCoord.x * width - 0.5f;
+	const float y = texCoord.y * height - 0.5f;
+	const float floorX = floor( x );
+	const float floorY = floor( y );
+	const float fractX = x - floorX;
+	const float fractY = y - floorY;
+	const int x0 = glm::clamp( int( floorX ), 0, width - 1 );
+	const int x1 = glm::clamp( int( floorX ) + 1, 0, width - 1 );
+	const int y0 = glm::clamp( int( floorY ), 0, height - 1 );
+	const int y1 = glm::clamp( int( floorY ) + 1, 0, height - 1 );
+
+	const uint8_t pixelInc = surface.getPixelInc();
+	const uint8_t red = surface.getRedOffset(), green = surface.getGreenOffset(), blue = surface.getBlueOffset();
+	const bool hasAlpha = surface.hasAlpha();
+	const uint8_t alpha = hasAlpha ? surface.getAlphaOffset() : 0;
+	const uint8_t *row0 = surface.getData() + y0 * surface.getRowBytes();
+	const uint8_t *row1 = surface.getData() + y1 * surface.getRowBytes();
+
+	auto texel = [&]( const uint8_t *row, int column ) {
+		const uint8_t *p = row + column * pixelInc;
+		return vec4( p[red], p[green], p[blue], hasAlpha ? p[alpha] : 255 );
+	};
+
+	const vec4 top = glm::mix( texel( row0, x0 ), texel( row0, x1 ), fractX );
+	const vec4 bottom = glm::mix( texel( row1, x0 ), texel( row1, x1 ), fractX );
+	const vec4 result = glm::mix( top, bottom, fractY ) * ( 1.0f / 255.0f );
+	return ColorA( result.x, result.y, result.z, result.w );
+}
+
+} // anonymous namespace
+
+SoftwareRasterizer::SoftwareRasterizer( const ivec2 &size )
+	: mBlendMode( BlendMode::ALPHA )
+{
+	setSize( size );
+}
+
+void SoftwareRasterizer::setSize( const ivec2 &size )
+{
+	CI_ASSERT( size.x > 0 && size.y > 0 );
+
+	mOutput = Surface8u( size.x, size.y, true, SurfaceChannelOrder::RGBA );
+	mOutput.setPremultiplied( true );
+	memset( mOutput.getData(), 0, mOutput.getRowBytes() * size.y );
+}
+
+void SoftwareRasterizer::resetCounters()
+{
+	mNumPixelsFilled = 0;
+	mNumCommandsSkipped = 0;
+}
+
+const Surface8u* SoftwareRasterizer::getFrameBufferSurface( const FrameBuffer *frameBuffer ) const
+{
+	auto storageIt = mFrameBuffers.find( frameBuffer );
+	return storageIt != mFrameBuffers.end() ? &storageIt->second.mSurface : nullptr;
+}
+
+Surface8u* SoftwareRasterizer::getFrameBufferStorage( const FrameBufferRef &frameBuffer )
+{
+	auto &storage = mFrameBuffers[frameBuffer.get()];
+	if( storage.mFrameBuffer.lock() != frameBuffer || storage.mSurface.getSize() != frameBuffer->getSize() ) {
+		const ivec2 size = frameBuffer->getSize();
+		storage.mFrameBuffer = frameBuffer;
+		storage.mSurface = Surface8u( size.x, size.y, true, SurfaceChannelOrder::RGBA );
+		storage.mSurface.setPremultiplied( true );
+		memset( storage.mSurface.getData(), 0, storage.mSurface.getRowBytes() * size.y );
+	}
+
+	return &storage.mSurface;
+}
+
+void SoftwareRasterizer::submit( const RenderCommandList &list )
+{
+	// free the storage of FrameBuffers that were destroyed since the last submit
+	for( auto storageIt = mFrameBuffers.begin(); storageIt != mFrameBuffers.end(); ) {
+		if( storageIt->second.mFrameBuffer.expired() )
+			storageIt = mFrameBuffers.erase( storageIt );
+		else
+			++storageIt;
+	}
+
+	mTargetStack.assign( 1, &mOutput );
+	mViewportStack.assign( 1, { ivec2( 0 ), mOutput.getSize() } );
+	mScissorStack.clear();
+	mBlendMode = BlendMode::ALPHA;
+
+	const auto &vertices = list.getVertices();
+	for( const auto &command : list.getCommands() ) {
+		switch( command.mType ) {
+			case RenderCommand::Type::QUADS: {
+				const Surface8u *texture = nullptr;
+				if( command.mIndex != RenderCommand::NO_INDEX ) {
+					texture = list.getTextures()[command.mIndex].mSurface.get();
+					if( ! texture ) {
+						// only has a gl texture
+						mNumCommandsSkipped++;
+						break;
+					}
+				}
+
+				for( uint32_t quad = 0; quad < command.mCount; quad++ ) {
+					const QuadVertex *quadVertices = &vertices[command.mFirst + quad * 4];
+					vec2 positions[4], texCoords[4];
+					for( size_t i = 0; i < 4; i++ ) {
+						positions[i] = toPixel( quadVertices[i].mPosition );
+						texCoords[i] = quadVertices[i].mTexCoord;
+					}
+
+					drawQuad( positions, texCoords, quadVertices[0].mColor, texture );
+				}
+			}
+			break;
+			case RenderCommand::Type::TEXT:
+				drawText( list.getTextRuns()[command.mIndex], list.getDrawStates()[command.mState] );
+			break;
+			case RenderCommand::Type::DRAW_FRAMEBUFFER: {
+				const auto &frameBufferDraw = list.getFrameBufferDraws()[command.mIndex];
+				const auto &state = list.getDrawStates()[command.mState];
+				const Surface8u *source = getFrameBufferSurface( frameBufferDraw.mFrameBuffer.get() );
+				if( ! source )
+					break;
+
+				Area sourceArea = frameBufferDraw.mSourceArea;
+				if( sourceArea.calcArea() == 0 )
+					sourceArea = source->getBounds();
+
+				const mat4 modelViewProjection = state.mProjectionMatrix * state.mModelMatrix;
+				const Rectf &destRect = frameBufferDraw.mDestRect;
+				const vec2 positions[] = {
+					toPixel( modelViewProjection * vec4( destRect.x1, destRect.y1, 0, 1 ) ),
+					toPixel( modelViewProjection * vec4( destRect.x2, destRect.y1, 0, 1 ) ),
+					toPixel( modelViewProjection * vec4( destRect.x2, destRect.y2, 0, 1 ) ),
+					toPixel( modelViewProjection * vec4( destRect.x1, destRect.y2, 0, 1 ) )
+				};
+
+				const vec2 sourceSize = vec2( source->getSize() );
+				const Rectf area( vec2( sourceArea.getUL() ) / sourceSize, vec2( sourceArea.getLR() ) / sourceSize );
+				const vec2 texCoords[] = { area.getUpperLeft(), area.getUpperRight(), area.getLowerRight(), area.getLowerLeft() };
+				drawQuad( positions, texCoords, state.mColor, source );
+			}
+			break;
+			case RenderCommand::Type::CALLBACK:
+				mNumCommandsSkipped++;
+			break;
+			case RenderCommand::Type::CLEAR:
+				clear( command.mColor );
+			break;
+			case RenderCommand::Type::PUSH_CLIP:
+				mScissorStack.push_back( { ivec2( command.mRect.getUpperLeft() ), ivec2( command.mRect.getSize() ) } );
+			break;
+			case RenderCommand::Type::POP_CLIP:
+				mScissorStack.pop_back();
+			break;
+			case RenderCommand::Type::PUSH_VIEWPORT:
+				mViewportStack.push_back( { ivec2( command.mRect.getUpperLeft() ), ivec2( command.mRect.getSize() ) } );
+			break;
+			case RenderCommand::Type::POP_VIEWPORT:
+				mViewportStack.pop_back();
+			break;
+			case RenderCommand::Type::PUSH_FRAMEBUFFER:
+				mTargetStack.push_back( getFrameBufferStorage( list.getFrameBuffers()[command.mIndex] ) );
+			break;
+			case RenderCommand::Type::POP_FRAMEBUFFER:
+				mTargetStack.pop_back();
+			break;
+			case RenderCommand::Type::SET_BLEND_MODE:
+				mBlendMode = command.mBlendMode;
+			break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+
+	CI_ASSERT_MSG( mTargetStack.size() == 1 && mViewportStack.size() == 1 && mScissorStack.empty(), "unbalanced pushes and pops" );
+}
+
+vec2 SoftwareRasterizer::toPixel( const vec4 &clipPosition ) const
+{
+	// same as gl, which has the origin of the viewport in the lower left
+	const auto &viewport = mViewportStack.back();
+	const vec2 ndc = vec2( clipPosition ) / clipPosition.w;
+	const vec2 window = vec2( viewport.mLowerLeft ) + ( ndc * 0.5f + 0.5f ) * vec2( viewport.mSize );
+	return vec2( window.x, float( mTargetStack.back()->getHeight() ) - window.y );
+}
+
+Area SoftwareRasterizer::getClipArea() const
+{
+	const int height = mTargetStack.back()->getHeight();
+	Area result = mTargetStack.back()->getBounds();
+	if( ! mScissorStack.empty() ) {
+		const auto &scissor = mScissorStack.back();
+		result.clipBy( Area( scissor.first.x, height - ( scissor.first.y + scissor.second.y ), scissor.first.x + scissor.second.x, height - scissor.first.y ) );
+	}
+
+	return result;
+}
+
+void SoftwareRasterizer::blendPixel( uint8_t *dst, const ColorA &color, float coverage )
+{
+	// BlendMode::ALPHA multiplies the color by its alpha while blending, PREMULT_ALPHA expects that to be done already
+	const float alpha = color.a * coverage;
+	const float colorScale = mBlendMode == BlendMode::ALPHA ? alpha : coverage;
+	const uint32_t a = toByte( alpha );
+	const uint32_t invAlpha = 255 - a;
+	dst[0] = uint8_t( min<uint32_t>( 255, toByte( color.r * colorScale ) + div255( dst[0] * invAlpha ) ) );
+	dst[1] = uint8_t( min<uint32_t>( 255, toByte( color.g * colorScale ) + div255( dst[1] * invAlpha ) ) );
+	dst[2] = uint8_t( min<uint32_t>( 255, toByte( color.b * colorScale ) + div255( dst[2] * invAlpha ) ) );
+	dst[3] = uint8_t( min<uint32_t>( 255, a + div255( dst[3] * invAlpha ) ) );
+}
+
+void SoftwareRasterizer::drawQuad( const vec2 *positions, const vec2 *texCoords, const ColorA &color, const Surface8u *texture )
+{
+	// quads are rects transformed by an affine matrix, so each pixel center maps to a point (s, t) in [0, 1) x [0, 1) across the two edges from the first corner
+	const vec2 origin = positions[0];
+	const vec2 edgeS = positions[1] - origin;
+	const vec2 edgeT = positions[3] - origin;
+	const float det = edgeS.x * edgeT.y - edgeS.y * edgeT.x;
+	if( abs( det ) < 1e-6f )
+		return;
+
+	Area bounds( ivec2( floor( glm::min( glm::min( positions[0], positions[1] ), glm::min( positions[2], positions[3] ) ) ) ),
+				 ivec2( ceil( glm::max( glm::max( positions[0], positions[1] ), glm::max( positions[2], positions[3] ) ) ) ) );
+	bounds.clipBy( getClipArea() );
+	if( bounds.calcArea() <= 0 )
+		return;
+
+	Surface8u *target = mTargetStack.back();
+	const vec2 texCoordS = texCoords[1] - texCoords[0];
+	const vec2 texCoordT = texCoords[3] - texCoords[0];
+	const bool axisAligned = edgeS.y == 0 && edgeT.x == 0;
+
+	if( axisAligned ) {
+		// the common case, each row is a single span
+		const float minX = min( origin.x, origin.x + edgeS.x ), maxX = max( origin.x, origin.x + edgeS.x );
+		const float minY = min( origin.y, origin.y + edgeT.y ), maxY = max( origin.y, origin.y + edgeT.y );
+		const int x1 = max( bounds.x1, int( ceil( minX - 0.5f ) ) ), x2 = min( bounds.x2, int( ceil( maxX - 0.5f ) ) );
+		const int y1 = max( bounds.y1, int( ceil( minY - 0.5f ) ) ), y2 = min( bounds.y2, int( ceil( maxY - 0.5f ) ) );
+		if( x1 >= x2 || y1 >= y2 )
+			return;
+
+		mNumPixelsFilled += size_t( x2 - x1 ) * size_t( y2 - y1 );
+
+		if( ! texture ) {
+			const float colorScale = mBlendMode == BlendMode::ALPHA ? color.a : 1.0f;
+			const uint32_t r = toByte( color.r * colorScale ), g = toByte( color.g * colorScale ), b = toByte( color.b * colorScale ), a = toByte( color.a );
+			for( int y = y1; y < y2; y++ )
+				blendSpan( target->getData( ivec2( x1, y ) ), size_t( x2 - x1 ), r, g, b, a );
+
+			return;
+		}
+
+		for( int y = y1; y < y2; y++ ) {
+			const float t = ( float( y ) + 0.5f - origin.y ) / edgeT.y;
+			uint8_t *dst = target->getData( ivec2( x1, y ) );
+			for( int x = x1; x < x2; x++, dst += 4 ) {
+				const float s = ( float( x ) + 0.5f - origin.x ) / edgeS.x;
+				const ColorA texel = sampleBilinear( *texture, texCoords[0] + s * texCoordS + t * texCoordT );
+				blendPixel( dst, texel * color );
+			}
+		}
+
+		return;
+	}
+
+	for( int y = bounds.y1; y < bounds.y2; y++ ) {
+		uint8_t *dst = target->getData( ivec2( bounds.x1, y ) );
+		for( int x = bounds.x1; x < bounds.x2; x++, dst += 4 ) {
+			const vec2 p = vec2( float( x ) + 0.5f, float( y ) + 0.5f ) - origin;
+			const float s = ( p.x * edgeT.y - p.y * edgeT.x ) / det;
+			const float t = ( edgeS.x * p.y - edgeS.y * p.x ) / det;
+			if( s < 0 || s >= 1 || t < 0 || t >= 1 )
+				continue;
+
+			mNumPixelsFilled++;
+			if( texture )
+				blendPixel( dst, sampleBilinear( *texture, texCoords[0] + s * texCoordS + t * texCoordT ) * color );
+			else
+				blendPixel( dst, color );
+		}
+	}
+}
+
+void SoftwareRasterizer::drawText( const RenderCommandList::TextRun &run, const RenderCommandList::DrawState &state )
+{
+	if( ! run.mText || run.mString.empty() )
+		return;
+
+	const Font &font = run.mText->getFont();
+	const int wrapWidth = run.mWrapped ? int( run.mFitRect.getWidth() ) : TextBox::GROW;
+	const string key = to_string( uintptr_t( run.mText.get() ) ) + "|" + to_string( wrapWidth ) + "|" + run.mString;
+
+	auto surfaceIt = mTextSurfaces.find( key );
+	if( surfaceIt == mTextSurfaces.end() ) {
+		if( mTextSurfaces.size() >= MAX_TEXT_SURFACES )
+			mTextSurfaces.clear();
+
+		auto textBox = TextBox().font( font ).size( wrapWidth, TextBox::GROW ).text( run.mString );
+		textBox.setColor( ColorA::white() );
+		textBox.setBackgroundColor( ColorA( 0, 0, 0, 0 ) );
+		surfaceIt = mTextSurfaces.insert( { key, textBox.render() } ).first;
+	}
+
+	const Surface8u &coverage = surfaceIt->second;
+	if( ! coverage.hasAlpha() )
+		return;
+
+	// the upper left of the fit rect is the baseline of the first line
+	const vec2 baseline = toPixel( state.mProjectionMatrix * state.mModelMatrix * vec4( run.mFitRect.getUpperLeft(), 0, 1 ) );
+	const ivec2 offset = ivec2( glm::round( baseline - vec2( 0, font.getAscent() ) ) );
+
+	Area bounds = coverage.getBounds() + offset;
+	bounds.clipBy( getClipArea() );
+	if( bounds.calcArea() <= 0 )
+		return;
+
+	Surface8u *target = mTargetStack.back();
+	const uint8_t alphaOffset = coverage.getAlphaOffset();
+	const uint8_t pixelInc = coverage.getPixelInc();
+	for( int y = bounds.y1; y < bounds.y2; y++ ) {
+		const uint8_t *src = coverage.getData( ivec2( bounds.x1, y ) - offset ) + alphaOffset;
+		uint8_t *dst = target->getData( ivec2( bounds.x1, y ) );
+		for( int x = bounds.x1; x < bounds.x2; x++, src += pixelInc, dst += 4 ) {
+			if( *src ) {
+				blendPixel( dst, state.mColor, float( *src ) / 255.0f );
+				mNumPixelsFilled++;
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::clear( const ColorA &color )
+{
+	const Area area = getClipArea();
+	if( area.calcArea() <= 0 )
+		return;
+
+	// like gl::clear(), the color isn't blended or premultiplied
+	const uint8_t pixel[4] = { uint8_t( toByte( color.r ) ), uint8_t( toByte( color.g ) ), uint8_t( toByte( color.b ) ), uint8_t( toByte( color.a ) ) };
+	Surface8u *target = mTargetStack.back();
+	for( int y = area.y1; y < area.y2; y++ ) {
+		uint8_t *dst = target->getData( ivec2( area.x1, y ) );
+		for( int x = area.x1; x < area.x2; x++, dst += 4 )
+			memcpy( dst, pixel, 4 );
+	}
+
+	mNumPixelsFilled += size_t( area.calcArea() );
+}
+
+} // namespace vu
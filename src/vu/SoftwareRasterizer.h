@@ -0,0 +1,109 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "vu/RenderBackend.h"
+#include "vu/RenderCommandList.h"
+
+#include "cinder/Area.h"
+#include "cinder/Surface.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vu {
+
+typedef std::shared_ptr<class SoftwareRasterizer>	SoftwareRasterizerRef;
+
+//! A RenderBackend that rasterizes on the CPU into premultiplied RGBA Surfaces, for rendering a Graph without gl (ex. thumbnails or visual regression tests on headless machines).
+//! Solid and textured quads (sampled bilinearly), FrameBuffers and text are blended the same way that BlendMode blends with gl, and clipped to the current clip.
+//! Callbacks need gl and are skipped, so Views that draw with ci::gl directly and Filters don't show up. Images need a Surface, see Image( const ci::Surface8uRef& ).
+//! Text is rasterized with its Font and is only translated by the model matrix, not scaled or rotated.
+//! Solid spans are blended with SSE2 whenever the compiler targets it (all x86-64 builds), there is nothing to define. Building with VU_RASTERIZER_SSE2=0 opts out
+//! and uses the scalar path everywhere, ex. to compare the two.
+class CI_UI_API SoftwareRasterizer : public RenderBackend {
+  public:
+	//! Creates a rasterizer whose output Surface is \a size, usually the size of the Graph being drawn.
+	SoftwareRasterizer( const ci::ivec2 &size );
+
+	void submit( const RenderCommandList &list ) override;
+
+	//! Resizes the output Surface, which clears it.
+	void		setSize( const ci::ivec2 &size );
+	//! Returns the size of the output Surface.
+	ci::ivec2	getSize() const						{ return mOutput.getSize(); }
+	//! Returns the output Surface, premultiplied RGBA with the origin in the upper left.
+	const ci::Surface8u&	getSurface() const		{ return mOutput; }
+	//! Returns the Surface that holds the contents of \a frameBuffer, or nullptr if nothing has been rendered to it.
+	const ci::Surface8u*	getFrameBufferSurface( const FrameBuffer *frameBuffer ) const;
+
+	//! Returns the number of pixels written since construction or resetCounters(), for measuring the fill rate.
+	size_t	getNumPixelsFilled() const				{ return mNumPixelsFilled; }
+	//! Returns the number of commands that were skipped since construction or resetCounters(), because they need gl.
+	size_t	getNumCommandsSkipped() const			{ return mNumCommandsSkipped; }
+	//! Sets the pixel and skipped command counts to zero.
+	void	resetCounters();
+
+  private:
+	struct Viewport {
+		ci::ivec2	mLowerLeft;
+		ci::ivec2	mSize;
+	};
+
+	struct FrameBufferStorage {
+		std::weak_ptr<FrameBuffer>	mFrameBuffer; // for freeing the storage of FrameBuffers that no longer exist
+		ci::Surface8u				mSurface;
+	};
+
+	//! Returns the storage of \a frameBuffer, creating it or resizing it to match.
+	ci::Surface8u*	getFrameBufferStorage( const FrameBufferRef &frameBuffer );
+	//! Converts \a clipPosition to pixels in the current target, with the origin in the upper left.
+	ci::vec2		toPixel( const ci::vec4 &clipPosition ) const;
+	//! Returns the area of the current target that may be drawn to, in pixels with the origin in the upper left.
+	ci::Area		getClipArea() const;
+
+	//! Draws the parallelogram with \a positions in pixels, which are ordered around the quad. The corners of \a texture are mapped to \a texCoords, solid quads have no texture.
+	void	drawQuad( const ci::vec2 *positions, const ci::vec2 *texCoords, const ci::ColorA &color, const ci::Surface8u *texture );
+	void	drawText( const RenderCommandList::TextRun &run, const RenderCommandList::DrawState &state );
+	//! Sets every pixel within the clip area to \a color, as is.
+	void	clear( const ci::ColorA &color );
+	//! Blends \a color, which is premultiplied if the BlendMode is PREMULT_ALPHA, scaled by \a coverage at \a dst.
+	void	blendPixel( uint8_t *dst, const ci::ColorA &color, float coverage = 1 );
+
+	ci::Surface8u					mOutput;
+	std::vector<ci::Surface8u *>	mTargetStack;
+	std::vector<Viewport>			mViewportStack;
+	std::vector<std::pair<ci::ivec2, ci::ivec2>>	mScissorStack; // lower left and size, like Renderer::mScissorStack
+	BlendMode						mBlendMode;
+
+	std::unordered_map<const FrameBuffer *, FrameBufferStorage>	mFrameBuffers;
+	std::unordered_map<std::string, ci::Surface8u>				mTextSurfaces; // coverage of rasterized text runs in the alpha channel, by Text, wrap width and string
+
+	size_t	mNumPixelsFilled = 0;
+	size_t	mNumCommandsSkipped = 0;
+};
+
+} // namespace vu
@@ -0,0 +1,281 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "vu/SpatialIndex.h"
+
+#include "cinder/CinderAssert.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+namespace {
+
+const size_t MAX_ENTRIES_PER_NODE	= 8;
+const size_t MAX_DEPTH				= 8;
+// Points are tested with a small tolerance so that the index never rejects a View that View::isPointInside() would accept.
+const float POINT_EPSILON			= 0.001f;
+
+bool containsRect( const Rectf &outer, const Rectf &inner )
+{
+	return inner.x1 >= outer.x1 && inner.x2 <= outer.x2 && inner.y1 >= outer.y1 && inner.y2 <= outer.y2;
+}
+
+bool containsPoint( const Rectf &rect, const vec2 &pos )
+{
+	return pos.x >= rect.x1 - POINT_EPSILON && pos.x <= rect.x2 + POINT_EPSILON && pos.y >= rect.y1 - POINT_EPSILON && pos.y <= rect.y2 + POINT_EPSILON;
+}
+
+} // anonymous namespace
+
+SpatialIndex::SpatialIndex()
+{
+}
+
+bool SpatialIndex::contains( View *view ) const
+{
+	return mNodeForView.count( view ) != 0;
+}
+
+void SpatialIndex::insert( View *view, const Rectf &bounds )
+{
+	CI_ASSERT( view );
+	CI_ASSERT( ! contains( view ) );
+
+	if( mNodes.empty() ) {
+		mNodes.emplace_back();
+		mNodes[0].mBounds = bounds;
+	}
+
+	insertEntry( 0, { view, bounds } );
+
+	if( mNumOutsideRoot > max( MAX_ENTRIES_PER_NODE, getSize() / 4 ) )
+		rebuild();
+}
+
+void SpatialIndex::update( View *view, const Rectf &bounds )
+{
+	auto it = mNodeForView.find( view );
+	if( it == mNodeForView.end() )
+		return;
+
+	// fast path: bounds still fit in the same node and wouldn't be pushed down to a child
+	size_t nodeIndex = it->second;
+	auto &node = mNodes[nodeIndex];
+	if( containsRect( node.mBounds, bounds ) ) {
+		bool fitsInChild = false;
+		if( node.mFirstChild != 0 ) {
+			for( size_t i = 0; i < 4; i++ ) {
+				if( containsRect( mNodes[node.mFirstChild + i].mBounds, bounds ) ) {
+					fitsInChild = true;
+					break;
+				}
+			}
+		}
+
+		if( ! fitsInChild ) {
+			for( auto &entry : node.mEntries ) {
+				if( entry.mView == view ) {
+					// an entry that was outside of the root has moved back inside it
+					if( entry.mOutsideRoot ) {
+						CI_ASSERT( mNumOutsideRoot > 0 );
+						entry.mOutsideRoot = false;
+						mNumOutsideRoot--;
+					}
+
+					entry.mBounds = bounds;
+					return;
+				}
+			}
+		}
+	}
+
+	eraseEntry( nodeIndex, view );
+	insertEntry( 0, { view, bounds } );
+
+	// splits are never undone incrementally, so compact the tree once it gets sparse or too much lives outside the root.
+	if( mNumOutsideRoot > max( MAX_ENTRIES_PER_NODE, getSize() / 4 ) || mNodes.size() > getSize() * 2 + 64 )
+		rebuild();
+}
+
+void SpatialIndex::remove( View *view )
+{
+	auto it = mNodeForView.find( view );
+	if( it == mNodeForView.end() )
+		return;
+
+	eraseEntry( it->second, view );
+	mNodeForView.erase( view );
+
+	if( mNodeForView.empty() )
+		clear();
+}
+
+void SpatialIndex::clear()
+{
+	mNodes.clear();
+	mNodeForView.clear();
+	mNumOutsideRoot = 0;
+}
+
+void SpatialIndex::rebuild()
+{
+	vector<Entry> entries;
+	entries.reserve( getSize() );
+	for( const auto &node : mNodes ) {
+		entries.insert( entries.end(), node.mEntries.begin(), node.mEntries.end() );
+	}
+
+	clear();
+	if( entries.empty() )
+		return;
+
+	Rectf rootBounds = entries.front().mBounds;
+	for( const auto &entry : entries )
+		rootBounds.include( entry.mBounds );
+
+	mNodes.emplace_back();
+	mNodes[0].mBounds = rootBounds;
+
+	// the root contains everything now, so nothing is counted as outside of it
+	for( const auto &entry : entries )
+		insertEntry( 0, entry );
+
+	CI_ASSERT( mNumOutsideRoot == 0 );
+}
+
+void SpatialIndex::query( const vec2 &pos, vector<View *> *result ) const
+{
+	if( mNodes.empty() )
+		return;
+
+	// entries at the root are always tested, as that is also where anything outside of the root bounds lives.
+	// depth-first, so at most three pending siblings per level plus the four children of the deepest node are on the stack.
+	size_t stack[MAX_DEPTH * 3 + 4];
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while( stackSize > 0 ) {
+		const auto &node = mNodes[stack[--stackSize]];
+		for( const auto &entry : node.mEntries ) {
+			if( containsPoint( entry.mBounds, pos ) )
+				result->push_back( entry.mView );
+		}
+
+		if( node.mFirstChild != 0 ) {
+			for( size_t i = 0; i < 4; i++ ) {
+				size_t childIndex = node.mFirstChild + i;
+				if( containsPoint( mNodes[childIndex].mBounds, pos ) )
+					stack[stackSize++] = childIndex;
+			}
+		}
+	}
+}
+
+void SpatialIndex::insertEntry( size_t nodeIndex, const Entry &sourceEntry )
+{
+	Entry entry = sourceEntry;
+	entry.mOutsideRoot = false;
+
+	if( nodeIndex == 0 && ! containsRect( mNodes[0].mBounds, entry.mBounds ) ) {
+		entry.mOutsideRoot = true;
+		mNumOutsideRoot++;
+		mNodes[0].mEntries.push_back( entry );
+		mNodeForView[entry.mView] = 0;
+		return;
+	}
+
+	// descend as far as the entry fits entirely within a child
+	while( mNodes[nodeIndex].mFirstChild != 0 ) {
+		size_t firstChild = mNodes[nodeIndex].mFirstChild;
+		size_t childIndex = 0;
+		for( size_t i = 0; i < 4; i++ ) {
+			if( containsRect( mNodes[firstChild + i].mBounds, entry.mBounds ) ) {
+				childIndex = firstChild + i;
+				break;
+			}
+		}
+
+		if( childIndex == 0 )
+			break;
+
+		nodeIndex = childIndex;
+	}
+
+	mNodes[nodeIndex].mEntries.push_back( entry );
+	mNodeForView[entry.mView] = nodeIndex;
+
+	if( mNodes[nodeIndex].mFirstChild == 0 && mNodes[nodeIndex].mEntries.size() > MAX_ENTRIES_PER_NODE && mNodes[nodeIndex].mDepth < MAX_DEPTH )
+		split( nodeIndex );
+}
+
+void SpatialIndex::split( size_t nodeIndex )
+{
+	const Rectf bounds = mNodes[nodeIndex].mBounds;
+	const size_t depth = mNodes[nodeIndex].mDepth + 1;
+	const vec2 center = bounds.getCenter();
+	const size_t firstChild = mNodes.size();
+
+	// note: mNodes may reallocate here, so nodes are always accessed by index below
+	mNodes.resize( firstChild + 4 );
+	mNodes[firstChild + 0].mBounds = Rectf( bounds.x1, bounds.y1, center.x, center.y );
+	mNodes[firstChild + 1].mBounds = Rectf( center.x, bounds.y1, bounds.x2, center.y );
+	mNodes[firstChild + 2].mBounds = Rectf( bounds.x1, center.y, center.x, bounds.y2 );
+	mNodes[firstChild + 3].mBounds = Rectf( center.x, center.y, bounds.x2, bounds.y2 );
+	for( size_t i = 0; i < 4; i++ )
+		mNodes[firstChild + i].mDepth = depth;
+
+	mNodes[nodeIndex].mFirstChild = firstChild;
+
+	vector<Entry> entries;
+	entries.swap( mNodes[nodeIndex].mEntries );
+	for( const auto &entry : entries ) {
+		// entries outside the root stay put, they were counted when inserted
+		if( entry.mOutsideRoot ) {
+			mNodes[0].mEntries.push_back( entry );
+			continue;
+		}
+
+		insertEntry( nodeIndex, entry );
+	}
+}
+
+void SpatialIndex::eraseEntry( size_t nodeIndex, View *view )
+{
+	auto &entries = mNodes[nodeIndex].mEntries;
+	for( size_t i = 0; i < entries.size(); i++ ) {
+		if( entries[i].mView == view ) {
+			if( entries[i].mOutsideRoot ) {
+				CI_ASSERT( mNumOutsideRoot > 0 );
+				mNumOutsideRoot--;
+			}
+
+			entries[i] = entries.back();
+			entries.pop_back();
+			return;
+		}
+	}
+
+	CI_ASSERT_NOT_REACHABLE();
+}
+
+} // namespace vu
@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/Rect.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace vu {
+
+class View;
+
+//! Quadtree over the bounds of a View's subviews, used to find touch candidates without visiting every subview.
+//! Bounds are stored in the parent's local coordinate space, so moving the parent doesn't invalidate anything.
+class CI_UI_API SpatialIndex {
+  public:
+	SpatialIndex();
+
+	//! Adds \a view with \a bounds to the index.
+	void	insert( View *view, const ci::Rectf &bounds );
+	//! Updates the bounds of \a view. Does nothing if it isn't in the index.
+	void	update( View *view, const ci::Rectf &bounds );
+	//! Removes \a view from the index. Does nothing if it isn't in the index.
+	void	remove( View *view );
+	//! Removes all entries.
+	void	clear();
+	//! Rebuilds the tree from scratch, fitting the root node to the bounds of all current entries.
+	void	rebuild();
+
+	//! Appends all Views whose bounds contain \a pos (inclusive) to \a result. The order is unspecified.
+	void	query( const ci::vec2 &pos, std::vector<View *> *result ) const;
+
+	//! Returns the number of Views in the index.
+	size_t	getSize() const		{ return mNodeForView.size(); }
+	//! Returns whether \a view is in the index.
+	bool	contains( View *view ) const;
+
+  private:
+	struct Entry {
+		View*		mView;
+		ci::Rectf	mBounds;
+		bool		mOutsideRoot = false; // counted in mNumOutsideRoot, set by insertEntry()
+	};
+
+	struct Node {
+		ci::Rectf			mBounds;
+		std::vector<Entry>	mEntries;
+		size_t				mFirstChild = 0; // 0 if this is a leaf, since the root is never a child
+		size_t				mDepth = 0;
+	};
+
+	void	insertEntry( size_t nodeIndex, const Entry &entry );
+	void	split( size_t nodeIndex );
+	void	eraseEntry( size_t nodeIndex, View *view );
+
+	std::vector<Node>					mNodes;
+	std::unordered_map<View *, size_t>	mNodeForView;
+	size_t								mNumOutsideRoot = 0; // entries at the root whose bounds aren't contained by it
+};
+
+} // namespace vu
@@ -25,7 +25,9 @@
 #include "vu/Debug.h"
 
 #include "cinder/Cinder.h"
+#include "cinder/gl/Context.h"
 #include "cinder/gl/TextureFont.h"
+#include "cinder/Text.h"
 #include "cinder/CinderAssert.h"
 #include "cinder/Log.h"
 #include "cinder/app/App.h"
@@ -134,10 +136,13 @@ Text::Text()
 }
 
 Text::Text( const ci::Font &font, float size )
-	: mIsReady( false ), mFontSize( size )
+	: mIsReady( false ), mFont( font ), mFontSize( size )
 {
-	auto format = gl::TextureFont::Format().premultiply( true );
-	mTextureFont = gl::TextureFont::create( font, format, TextManager::instance()->getSupportedChars() );
+	// without gl (ex. rendering with a RenderBackend on a headless machine), text is measured with the Font and can't be drawn with gl
+	if( gl::context() ) {
+		auto format = gl::TextureFont::Format().premultiply( true );
+		mTextureFont = gl::TextureFont::create( font, format, TextManager::instance()->getSupportedChars() );
+	}
 	mIsReady = true;
 }
 
@@ -151,7 +156,7 @@ float Text::getAscent() const
 	if( ! mIsReady )
 		return 0;
 
-	return mTextureFont->getAscent();
+	return mTextureFont ? mTextureFont->getAscent() : mFont.getAscent();
 }
 
 float Text::getDescent() const
@@ -159,7 +164,7 @@ float Text::getDescent() const
 	if( ! mIsReady )
 		return 0;
 
-	return mTextureFont->getFont().getDescent();
+	return mFont.getDescent();
 }
 
 vec2 Text::measureString( const std::string &str ) const
@@ -167,6 +172,9 @@ vec2 Text::measureString( const std::string &str ) const
 	if( ! mIsReady )
 		return vec2( 0 );
 
+	if( ! mTextureFont )
+		return TextBox().font( mFont ).text( str ).measure();
+
 	return mTextureFont->measureString( str );
 }
 
@@ -175,12 +183,15 @@ vec2 Text::measureStringWrapped( const std::string &str, const ci::Rectf &fitRec
 	if( ! mIsReady )
 		return vec2( 0 );
 
+	if( ! mTextureFont )
+		return TextBox().font( mFont ).size( (int)fitRect.getWidth(), TextBox::GROW ).text( str ).measure();
+
 	return mTextureFont->measureStringWrapped( str, fitRect );
 }
 
 void Text::drawString( const string &str, const vec2 &baseline )
 {
-	if( ! mIsReady )
+	if( ! mIsReady || ! mTextureFont )
 		return;
 
 	mTextureFont->drawString( str, baseline );
@@ -188,7 +199,7 @@ void Text::drawString( const string &str, const vec2 &baseline )
 
 void Text::drawStringWrapped( const std::string &str, const ci::Rectf &fitRect )
 {
-	if( ! mIsReady )
+	if( ! mIsReady || ! mTextureFont )
 		return;
 
 	mTextureFont->drawStringWrapped( str, fitRect );
@@ -66,6 +66,9 @@ public:
 	bool isFileFont() const						{ return ! mFilePath.empty(); }
 	bool isSystemFont() const					{ return ! mSystemName.empty(); }
 
+	//! Returns the Font, which a RenderBackend that doesn't use gl rasterizes text with.
+	const ci::Font&	getFont() const				{ return mFont; }
+
 	float		getSize() const;
 	float		getAscent() const;
 	float		getDescent() const;
@@ -79,7 +82,8 @@ private:
 	Text();
 	Text( const ci::Font &font, float fontSize );
 
-	ci::gl::TextureFontRef	mTextureFont;
+	ci::gl::TextureFontRef	mTextureFont; // null if there was no gl context when this was created
+	ci::Font				mFont;
 	std::string				mSystemName;
 	ci::fs::path			mFilePath;
 	float					mFontSize; //! note: this might be different to the ci::Font size, due to content scaling
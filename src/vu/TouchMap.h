@@ -0,0 +1,93 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/app/TouchEvent.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace vu {
+
+//! Flat map of touch id to Touch, stored in a vector sorted by id. Used in place of std::map since there are hardly ever more than a handful of touches per View.
+class TouchMap {
+  public:
+	typedef std::pair<uint32_t, ci::app::TouchEvent::Touch>	value_type;
+	typedef std::vector<value_type>::iterator					iterator;
+	typedef std::vector<value_type>::const_iterator				const_iterator;
+
+	iterator		begin()			{ return mEntries.begin(); }
+	iterator		end()			{ return mEntries.end(); }
+	const_iterator	begin() const	{ return mEntries.begin(); }
+	const_iterator	end() const		{ return mEntries.end(); }
+
+	size_t	size() const	{ return mEntries.size(); }
+	bool	empty() const	{ return mEntries.empty(); }
+	void	clear()			{ mEntries.clear(); }
+
+	iterator find( uint32_t id )
+	{
+		auto it = lowerBound( id );
+		return ( it != mEntries.end() && it->first == id ) ? it : mEntries.end();
+	}
+
+	const_iterator find( uint32_t id ) const
+	{
+		return const_cast<TouchMap *>( this )->find( id );
+	}
+
+	size_t count( uint32_t id ) const	{ return find( id ) != end() ? 1 : 0; }
+
+	//! Returns the Touch with \a id, inserting a default constructed Touch if there is none.
+	ci::app::TouchEvent::Touch& operator[]( uint32_t id )
+	{
+		auto it = lowerBound( id );
+		if( it == mEntries.end() || it->first != id )
+			it = mEntries.insert( it, value_type( id, ci::app::TouchEvent::Touch() ) );
+
+		return it->second;
+	}
+
+	//! Returns the number of Touches erased (0 or 1).
+	size_t erase( uint32_t id )
+	{
+		auto it = find( id );
+		if( it == mEntries.end() )
+			return 0;
+
+		mEntries.erase( it );
+		return 1;
+	}
+
+	iterator erase( const_iterator pos )	{ return mEntries.erase( pos ); }
+
+  private:
+	iterator lowerBound( uint32_t id )
+	{
+		return std::lower_bound( mEntries.begin(), mEntries.end(), id, []( const value_type &entry, uint32_t id ) { return entry.first < id; } );
+	}
+
+	std::vector<value_type>	mEntries;
+};
+
+} // namespace vu
@@ -0,0 +1,129 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "vu/TransformHierarchy.h"
+#include "vu/View.h"
+
+using namespace ci;
+using namespace std;
+
+namespace vu {
+
+void TransformHierarchy::rebuild( View *root )
+{
+	mViews.clear();
+	mParentIndices.clear();
+
+	// depth-first with an explicit stack, so that deep hierarchies can't overflow the call stack
+	vector<pair<View *, size_t>> stack;
+	stack.emplace_back( root, INVALID_INDEX );
+	while( ! stack.empty() ) {
+		View *view = stack.back().first;
+		size_t parentIndex = stack.back().second;
+		stack.pop_back();
+
+		view->mTransformIndex = mViews.size();
+		mViews.push_back( view );
+		mParentIndices.push_back( parentIndex );
+
+		for( auto it = view->mSubviews.rbegin(); it != view->mSubviews.rend(); ++it ) {
+			if( ! (*it)->mMarkedForRemoval )
+				stack.emplace_back( it->get(), view->mTransformIndex );
+		}
+	}
+
+	const size_t numViews = mViews.size();
+	mPositions.resize( numViews );
+	mScales.resize( numViews );
+	mRotations.resize( numViews );
+	mSizes.resize( numViews );
+	mLocalTransforms.resize( numViews );
+	mWorldTransforms.resize( numViews );
+	mWorldBounds.resize( numViews );
+	mChanged.resize( numViews );
+
+	mHierarchyVersion = View::sHierarchyVersion;
+}
+
+void TransformHierarchy::update( View *root )
+{
+	bool rebuilt = false;
+	if( mHierarchyVersion != View::sHierarchyVersion || mViews.empty() || mViews.front() != root ) {
+		rebuild( root );
+		rebuilt = true;
+	}
+
+	const size_t numViews = mViews.size();
+
+	// gather the local transforms from the Views, only recalculating those whose inputs changed
+	for( size_t i = 0; i < numViews; i++ ) {
+		const View *view = mViews[i];
+		const vec2 &pos = view->getPos();
+		const vec2 &scale = view->getScale();
+		const float rotation = view->getRotation();
+
+		const bool changed = rebuilt || pos != mPositions[i] || scale != mScales[i] || rotation != mRotations[i];
+		if( changed ) {
+			mPositions[i] = pos;
+			mScales[i] = scale;
+			mRotations[i] = rotation;
+			mLocalTransforms[i] = view->getLocalTransform();
+		}
+
+		mChanged[i] = changed ? TRANSFORM_CHANGED : 0;
+
+		const vec2 &size = view->getSize();
+		if( size != mSizes[i] ) {
+			mSizes[i] = size;
+			mChanged[i] |= SIZE_CHANGED;
+		}
+	}
+
+	// compose world transforms, reading only from the arrays. A parent's index is always lower, so it has already been handled.
+	mNumUpdated = 0;
+	for( size_t i = 0; i < numViews; i++ ) {
+		const size_t parentIndex = mParentIndices[i];
+		if( parentIndex != INVALID_INDEX )
+			mChanged[i] |= mChanged[parentIndex] & TRANSFORM_CHANGED;
+
+		if( mChanged[i] & TRANSFORM_CHANGED ) {
+			if( parentIndex == INVALID_INDEX )
+				mWorldTransforms[i] = mLocalTransforms[i];
+			else
+				mWorldTransforms[i] = mWorldTransforms[parentIndex] * mLocalTransforms[i];
+
+			mNumUpdated++;
+		}
+
+		if( mChanged[i] )
+			mWorldBounds[i] = Rectf( vec2( 0 ), mSizes[i] ).transformed( mWorldTransforms[i] );
+	}
+
+	mEpoch = View::sWorldPosEpoch;
+}
+
+bool TransformHierarchy::isValid( const View *view ) const
+{
+	return mEpoch == View::sWorldPosEpoch && view->mTransformIndex < mViews.size() && mViews[view->mTransformIndex] == view;
+}
+
+} // namespace vu
@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2020, Richard Eakin - All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided
+ that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this list of conditions and
+ the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "vu/Export.h"
+
+#include "cinder/Rect.h"
+#include "cinder/Vector.h"
+#include "cinder/Matrix.h"
+
+#include <limits>
+#include <vector>
+
+namespace vu {
+
+class View;
+
+//! Flattened copy of the transforms of a View hierarchy, stored depth-first as structure of arrays. Parents always come before their subviews,
+//! so update() brings every world transform up to date in one linear pass instead of recursing per View. Enabled with Graph::setFlattenedTransformsEnabled().
+class CI_UI_API TransformHierarchy {
+  public:
+	//! Index of a View that isn't in any TransformHierarchy.
+	static const size_t INVALID_INDEX = std::numeric_limits<size_t>::max();
+
+	//! Brings the world transforms and bounds of \a root and its subviews up to date, rebuilding the arrays first if any View has changed parent.
+	void	update( View *root );
+	//! Returns whether \a view is in the hierarchy and its world transform is current. This stops being true as soon as any View moves or changes parent, until the next update().
+	bool	isValid( const View *view ) const;
+
+	//! Returns the number of Views in the hierarchy.
+	size_t				getSize() const								{ return mViews.size(); }
+	//! Returns the affine transform from the coordinate space of the View at \a index to world space.
+	const ci::mat3&		getWorldTransform( size_t index ) const		{ return mWorldTransforms[index]; }
+	//! Returns the axis aligned world bounds of the View at \a index.
+	const ci::Rectf&	getWorldBounds( size_t index ) const		{ return mWorldBounds[index]; }
+	//! Returns the number of world transforms that the last update() recalculated.
+	size_t				getNumUpdated() const						{ return mNumUpdated; }
+
+  private:
+	enum ChangeFlags : uint8_t {
+		TRANSFORM_CHANGED	= 1 << 0,
+		SIZE_CHANGED		= 1 << 1
+	};
+
+	void	rebuild( View *root );
+
+	std::vector<View *>		mViews;
+	std::vector<size_t>		mParentIndices; // INVALID_INDEX for the root
+	std::vector<ci::vec2>	mPositions;
+	std::vector<ci::vec2>	mScales;
+	std::vector<float>		mRotations;
+	std::vector<ci::vec2>	mSizes;
+	std::vector<ci::mat3>	mLocalTransforms;
+	std::vector<ci::mat3>	mWorldTransforms;
+	std::vector<ci::Rectf>	mWorldBounds;
+	std::vector<uint8_t>	mChanged; // ChangeFlags set during update(), read by subviews to know whether they need to recalculate
+
+	uint64_t	mHierarchyVersion = 0;
+	uint64_t	mEpoch = 0;
+	size_t		mNumUpdated = 0;
+};
+
+} // namespace vu
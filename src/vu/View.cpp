@@ -31,12 +31,46 @@
 #include "cinder/Log.h"
 #include "cinder/System.h"
 
+#include <typeinfo>
+
 using namespace std;
 using namespace ci;
 
 namespace vu {
 
 const float BOUNDS_EPSILON = 0.00001f;
+//! Below this many subviews, touches are tested against every subview rather than building a SpatialIndex.
+const size_t SUBVIEW_INDEX_MIN_SIZE = 32;
+
+namespace {
+
+//! Returns the inverse of \a m, which must be a 2D affine transform. Only the 2x2 linear part needs inverting, the translation is then undone with it.
+mat3 inverseAffine( const mat3 &m )
+{
+	const float det = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+	if( det == 0 ) {
+		// scaled to nothing, so no point maps back inside
+		mat3 result( 0 );
+		result[2] = vec3( numeric_limits<float>::infinity(), numeric_limits<float>::infinity(), 1 );
+		return result;
+	}
+
+	mat3 result( 1 );
+	result[0][0] = m[1][1] / det;
+	result[0][1] = - m[0][1] / det;
+	result[1][0] = - m[1][0] / det;
+	result[1][1] = m[0][0] / det;
+	result[2][0] = - ( result[0][0] * m[2][0] + result[1][0] * m[2][1] );
+	result[2][1] = - ( result[0][1] * m[2][0] + result[1][1] * m[2][1] );
+	return result;
+}
+
+} // anonymous namespace
+
+uint64_t View::sWorldPosEpoch = 1;
+uint64_t View::sWorldPosVersionCounter = 0;
+uint64_t View::sHierarchyVersion = 0;
+uint64_t View::sContentVersionCounter = 0;
 
 // ----------------------------------------------------------------------------------------------------
 // Responder
@@ -83,13 +117,21 @@ View::View( const ci::Rectf &bounds )
 
 View::~View()
 {
-	for( auto &subview : mSubviews )
+	for( auto &subview : mSubviews ) {
 		subview->mParent = nullptr;
+		subview->parentChanged();
+		subview->removedFromParent();
+	}
 
 	if( mLayer ) {
 		if( isLayerRoot() )
 			getGraph()->removeLayer( mLayer );
 	}
+
+	for( auto &filter : mFilters ) {
+		if( filter->mView == this )
+			filter->mView = nullptr;
+	}
 }
 
 void View::setPos( const vec2 &position )
@@ -98,8 +140,13 @@ void View::setPos( const vec2 &position )
 		return;
 
 	mPos = position;
+	wake();
 	if( mBackground )
 		mBackground->setPos( getPos() );
+	if( mParent ) {
+		mParent->subviewBoundsChanged( this );
+		mParent->setSubtreeBoundsDirty();
+	}
 
 	setWorldPosDirty();
 }
@@ -112,7 +159,10 @@ void View::setSize( const vec2 &size )
 	mSize = glm::max( vec2( 0 ), size );
 	if( mBackground )
 		mBackground->setSize( mSize );
+	if( mParent )
+		mParent->subviewBoundsChanged( this );
 
+	setSubtreeBoundsDirty();
 	setNeedsLayout();
 }
 
@@ -139,6 +189,56 @@ Rectf View::getBoundsLocal() const
 	return Rectf( vec2( 0 ), getSize() );
 }
 
+void View::setScale( const vec2 &scale )
+{
+	if( scale == mScale )
+		return;
+
+	mScale = scale;
+	localTransformChanged();
+}
+
+void View::setRotation( float radians )
+{
+	if( radians == mRotation )
+		return;
+
+	mRotation = radians;
+	localTransformChanged();
+}
+
+void View::localTransformChanged()
+{
+	mHasLocalTransform = mScale != vec2( 1 ) || mRotation != 0;
+	wake();
+	placementChanged();
+	if( mParent ) {
+		mParent->subviewBoundsChanged( this );
+		mParent->setSubtreeBoundsDirty();
+	}
+
+	setWorldPosDirty();
+}
+
+mat3 View::getLocalTransform() const
+{
+	const vec2 &pos = getPos();
+	if( ! mHasLocalTransform )
+		return mat3( vec3( 1, 0, 0 ), vec3( 0, 1, 0 ), vec3( pos, 1 ) );
+
+	const float c = cos( mRotation );
+	const float s = sin( mRotation );
+	return mat3( vec3( c * mScale.x, s * mScale.x, 0 ), vec3( - s * mScale.y, c * mScale.y, 0 ), vec3( pos, 1 ) );
+}
+
+Rectf View::getBoundsInParent() const
+{
+	if( ! mHasLocalTransform )
+		return getBounds();
+
+	return getBoundsLocal().transformed( getLocalTransform() );
+}
+
 Rectf View::getBoundsForFrameBuffer() const
 {
 	return Rectf( vec2( 0 ), getSize() );
@@ -149,6 +249,20 @@ bool View::isBoundsAnimating() const
 	return ( ! mPos.isComplete() || ! mSize.isComplete() );
 }
 
+void View::setHidden( bool hidden )
+{
+	if( mHidden == hidden )
+		return;
+
+	mHidden = hidden;
+	wake();
+	placementChanged();
+
+	// hidden subviews are left out of the parent's subtree bounds
+	if( mParent )
+		mParent->setSubtreeBoundsDirty();
+}
+
 bool View::isTransparent() const
 {
 	return mAlpha < 0.9999f;
@@ -163,6 +277,7 @@ bool View::isLayerRoot() const
 void View::setClipEnabled( bool enable )
 {
 	mClipEnabled = enable;
+	setNeedsRedraw();
 }
 
 bool View::isClipEnabled() const
@@ -178,6 +293,7 @@ void View::addSubview( const ViewRef &view )
 	// first set the parent to be us, which will remove it from any existing parent (including this view).
 	view->setParent( this );
 	mSubviews.push_back( view );
+	subviewAdded( view.get() );
 
 	setNeedsLayout();
 	view->setNeedsLayout();
@@ -202,6 +318,7 @@ void View::insertSubview( const ViewRef &view, size_t index )
 	auto it = mSubviews.begin();
 	std::advance( it, index );
 	mSubviews.insert( it, view );
+	subviewAdded( view.get() );
 }
 
 void View::insertSubviewAbove( const ViewRef &view, const ViewRef &viewBelow )
@@ -219,6 +336,7 @@ void View::insertSubviewAbove( const ViewRef &view, const ViewRef &viewBelow )
 
 	view->setParent( this );
 	mSubviews.insert( it, view );
+	subviewAdded( view.get() );
 }
 
 void View::insertSubviewBelow( const ViewRef &view, const ViewRef &viewAbove )
@@ -233,42 +351,71 @@ void View::insertSubviewBelow( const ViewRef &view, const ViewRef &viewAbove )
 
 	view->setParent( this );
 	mSubviews.insert( it, view );
+	subviewAdded( view.get() );
 }
 
 void View::removeSubview( const ViewRef &view )
+{
+	if( detachSubview( view ) )
+		view->removedFromParent();
+}
+
+bool View::detachSubview( const ViewRef &view )
 {
 	for( auto it = mSubviews.begin(); it != mSubviews.end(); ++it ) {
 		if( view == *it ) {
 			view->mParent = nullptr;
+			view->parentChanged();
 			if( view->mAcceptsFirstResponder )
 				view->resignFirstResponder();
 
+			if( mSubviewIndex )
+				mSubviewIndex->remove( view.get() );
+
+			mSubviewOrderDirty = true;
+			setSubtreeBoundsDirty();
+			wake();
+			setNeedsRedraw();
+
 			if( mIsIteratingSubviews )
 				view->mMarkedForRemoval = true;
 			else
 				mSubviews.erase( it );
 
-			return;
+			return true;
 		}
 	}
+
+	return false;
 }
 
 void View::removeAllSubviews()
 {
+	mSubviewIndex.reset();
+	mSubviewOrderDirty = true;
+	setSubtreeBoundsDirty();
+	wake();
+	setNeedsRedraw();
+
 	if( mIsIteratingSubviews ) {
 		for( auto &view : mSubviews ) {
 			view->mParent = nullptr;
+			view->parentChanged();
 			if( view->mAcceptsFirstResponder )
 				view->resignFirstResponder();
 
 			view->mMarkedForRemoval = true;
+			view->removedFromParent();
 		}
 	}
 	else {
 		for( auto &view : mSubviews ) {
 			view->mParent = nullptr;
+			view->parentChanged();
 			if( view->mAcceptsFirstResponder )
 				view->resignFirstResponder();
+
+			view->removedFromParent();
 		}
 		mSubviews.clear();
 	}
@@ -308,9 +455,21 @@ bool View::containsSubview( const ViewRef &view )
 
 void View::setParent( View *parent )
 {
-	removeFromParent();
+	// moving to another parent isn't a removal, so removedFromParent() isn't called
+	if( mParent ) {
+		mParent->detachSubview( shared_from_this() );
+		setNeedsLayout();
+	}
+
 	mParent = parent;
 	mGraph = parent->getGraph();
+	parentChanged();
+}
+
+void View::parentChanged()
+{
+	sHierarchyVersion++;
+	setWorldPosDirty();
 }
 
 void View::setFillParentEnabled( bool enable )
@@ -325,6 +484,7 @@ void View::setFillParentEnabled( bool enable )
 void View::setNeedsLayout()
 {
 	mNeedsLayout = true;
+	wake();
 
 	for( const auto &subview : mSubviews ) {
 		if( subview->mFillParent )
@@ -341,16 +501,96 @@ void View::layoutIfNeeded()
 		subview->layoutIfNeeded();
 }
 
+void View::wake()
+{
+	// Walks all the way up, as any ancestor may be the root of a sleeping subtree
+	for( View *view = this; view; view = view->mParent )
+		view->mWakeRequested = true;
+
+	if( mGraph )
+		mGraph->setNeedsRedraw();
+}
+
+void View::setNeedsRedraw()
+{
+	// Walks all the way up, as every ancestor draws this View. Layers compare their root View's version against the one they last rendered.
+	const uint64_t version = ++sContentVersionCounter;
+	for( View *view = this; view; view = view->mParent )
+		view->mContentVersion = version;
+
+	if( mGraph )
+		mGraph->setNeedsRedraw();
+}
+
+void View::placementChanged()
+{
+	if( mParent )
+		mParent->setNeedsRedraw();
+	else if( mGraph )
+		mGraph->setNeedsRedraw();
+}
+
+void View::animatedPropertyChanged( const void *target )
+{
+	wake();
+
+	// the rest of the position change is diffed in updateImpl(), but world positions can be read before this View is updated
+	if( target == mPos.ptr() )
+		setWorldPosDirty();
+
+	// position, size and alpha are diffed in updateImpl(), anything else is assumed to change what this View draws
+	if( target != mPos.ptr() && target != mSize.ptr() && target != mAlpha.ptr() )
+		setNeedsRedraw();
+}
+
+void View::setNeedsRedraw( double time )
+{
+	if( mGraph )
+		mGraph->setNeedsRedraw( time );
+}
+
+bool View::isAnimating() const
+{
+	return mNumTweens != 0 || isBoundsAnimating() || ! mAlpha.isComplete();
+}
+
+void View::animatePos( const vec2 &pos, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( mGraph, "View must be in a Graph to use its Animator" );
+	mGraph->getAnimator().animate( this, mPos.ptr(), pos, mGraph->getCurrentTime() + delay, duration, ease );
+}
+
+void View::animateSize( const vec2 &size, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( mGraph, "View must be in a Graph to use its Animator" );
+	mGraph->getAnimator().animate( this, mSize.ptr(), size, mGraph->getCurrentTime() + delay, duration, ease );
+}
+
+void View::animateAlpha( float alpha, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( mGraph, "View must be in a Graph to use its Animator" );
+	mGraph->getAnimator().animate( this, mAlpha.ptr(), alpha, mGraph->getCurrentTime() + delay, duration, ease );
+}
+
+void View::cancelAnimations()
+{
+	if( mGraph )
+		mGraph->getAnimator().cancel( this );
+}
+
 void View::setWorldPosDirty()
 {
+	// subviews find out lazily in getWorldPos(), when they see that this View's world position was recalculated
 	mWorldPosDirty = true;
-	for( const auto &subview : mSubviews )
-		subview->setWorldPosDirty();
+	sWorldPosEpoch++;
 }
 
 void View::addFilter( const FilterRef &filter )
 {
 	mFilters.push_back( filter );
+	filter->mView = this;
+	wake();
+	setNeedsRedraw();
 	if( isLayerRoot() ) {
 		mLayer->setFiltersNeedConfiguration();
 	}
@@ -359,17 +599,27 @@ void View::addFilter( const FilterRef &filter )
 void View::removeFilter( const FilterRef &filter )
 {
 	mFilters.erase( remove( mFilters.begin(), mFilters.end(), filter ), mFilters.end() );
+	if( filter->mView == this )
+		filter->mView = nullptr;
+
+	wake();
+	setNeedsRedraw();
 }
 
 void View::removeAllFilters()
 {
+	for( auto &filter : mFilters ) {
+		if( filter->mView == this )
+			filter->mView = nullptr;
+	}
+
 	mFilters.clear();
+	wake();
+	setNeedsRedraw();
 }
 
 void View::layoutImpl()
 {
-	mWorldPosDirty = true;
-
 	if( mBackground )
 		mBackground->layoutImpl();
 
@@ -384,9 +634,15 @@ void View::layoutImpl()
 	if( mLayout )
 		mLayout->layout( this );
 
-	layout();
+	if( mHooks & HOOK_LAYOUT )
+		layout();
+
 	mNeedsLayout = false;
+	setNeedsRedraw();
 	mSignalViewDidLayout.emit();
+
+	if( mGraph && mGraph->mFrameStats )
+		mGraph->mFrameStats->mNumLayouts++;
 }
 
 void View::updateImpl()
@@ -400,8 +656,13 @@ void View::updateImpl()
 	if( glm::any( glm::epsilonNotEqual( getPos(), mPosLastUpdate, BOUNDS_EPSILON ) ) ) {
 		if( hasBackground )
 			mBackground->setPos( getPos() );
+		if( mParent ) {
+			mParent->subviewBoundsChanged( this );
+			mParent->setSubtreeBoundsDirty();
+		}
 
 		setWorldPosDirty();
+		placementChanged();
 		mPosLastUpdate = getPos();
 	}
 
@@ -409,11 +670,20 @@ void View::updateImpl()
 	if( glm::any( glm::epsilonNotEqual( getSize(), mSizeLastUpdate, BOUNDS_EPSILON ) ) ) {
 		if( hasBackground )
 			mBackground->setSize( getSize() );
+		if( mParent )
+			mParent->subviewBoundsChanged( this );
 
+		setSubtreeBoundsDirty();
 		setNeedsLayout();
 		mSizeLastUpdate = getSize();
 	}
 
+	// compared rather than relying on setAlpha(), as Anims write alpha directly. A Layer applies alpha when compositing, so only the parent draws differently.
+	if( getAlpha() != mAlphaLastUpdate ) {
+		placementChanged();
+		mAlphaLastUpdate = getAlpha();
+	}
+
 	// handle transparency that needs a Layer for compositing
 	if( mRenderTransparencyToFrameBuffer && isTransparent() ) {
 		needsLayer = true;
@@ -443,11 +713,16 @@ void View::updateImpl()
 		mBackground->updateImpl();
 	}
 
-	update();
+	if( mHooks & HOOK_UPDATE )
+		update();
 }
 
 void View::drawImpl( Renderer *ren )
 {
+	const bool hasDraw = ( mHooks & HOOK_DRAW ) != 0;
+	if( ! mBackground && ! hasDraw )
+		return;
+
 	ren->pushBlendMode( mBlendMode ); // TEMPORARY: this will be handled by Layer
 
 	if( mBackground ) {
@@ -456,21 +731,133 @@ void View::drawImpl( Renderer *ren )
 		ren->popColor();
 	}
 
-	ren->pushColor();
-	draw( ren );
-	ren->popColor();
+	if( hasDraw ) {
+		if( drawsOnlyThroughRenderer() ) {
+			ren->pushColor();
+			draw( ren );
+			ren->popColor();
+		}
+		else {
+			// Subclasses may draw with ci::gl directly, so their draw() is recorded as a callback and not batched with other Views
+			ren->drawCallback( [this, ren] {
+				ren->pushBatchingEnabled( false );
+				ren->pushColor();
+				draw( ren );
+				ren->popColor();
+				ren->popBatchingEnabled();
+			} );
+		}
+	}
 
 	ren->popBlendMode();
 }
 
 void View::clearViewsMarkedForRemoval()
 {
+	size_t sizeBefore = mSubviews.size();
 	mSubviews.erase(
 			remove_if( mSubviews.begin(), mSubviews.end(),
 			           []( const ViewRef &view ) {
 				           return view->mMarkedForRemoval;
 			           } ),
 			mSubviews.end() );
+
+	if( mSubviews.size() != sizeBefore )
+		mSubviewOrderDirty = true;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// Subview Index
+// ----------------------------------------------------------------------------------------------------
+
+void View::setSubviewIndexEnabled( bool enable )
+{
+	mSubviewIndexEnabled = enable;
+	if( ! enable )
+		mSubviewIndex.reset();
+}
+
+void View::subviewAdded( View *subview )
+{
+	// plain Views added without makeSubview() are common as containers and have no hooks to call
+	if( subview->mHooks == HOOKS_ALL && typeid( *subview ) == typeid( View ) )
+		subview->mHooks = HOOKS_NONE;
+
+	mSubviewOrderDirty = true;
+	setSubtreeBoundsDirty();
+	wake();
+	setNeedsRedraw();
+	if( mSubviewIndex )
+		mSubviewIndex->insert( subview, subview->getBoundsInParent() );
+}
+
+void View::subviewBoundsChanged( View *subview )
+{
+	if( mSubviewIndex )
+		mSubviewIndex->update( subview, subview->getBoundsInParent() );
+}
+
+void View::rebuildSubviewIndex()
+{
+	if( ! mSubviewIndex )
+		mSubviewIndex.reset( new SpatialIndex );
+	else
+		mSubviewIndex->clear();
+
+	for( const auto &subview : mSubviews ) {
+		if( ! subview->mMarkedForRemoval )
+			mSubviewIndex->insert( subview.get(), subview->getBoundsInParent() );
+	}
+
+	mSubviewIndex->rebuild();
+}
+
+void View::updateSubviewOrder()
+{
+	for( size_t i = 0; i < mSubviews.size(); i++ )
+		mSubviews[i]->mIndexInParent = i;
+
+	mSubviewOrderDirty = false;
+}
+
+void View::getSubviewsForTouches( const vector<app::TouchEvent::Touch> &touches, vector<ViewRef> *result )
+{
+	if( ! mSubviewIndexEnabled || mSubviews.size() < SUBVIEW_INDEX_MIN_SIZE ) {
+		mSubviewIndex.reset();
+		*result = mSubviews;
+		return;
+	}
+
+	// The index is kept in sync from add / remove / setPos / setSize, this catches subviews changed directly through getSubviews().
+	if( ! mSubviewIndex || mSubviewIndex->getSize() != mSubviews.size() )
+		rebuildSubviewIndex();
+
+	// Index bounds are in this View's space, same as each subview's getBounds()
+	auto &candidates = mSubviewIndexResults;
+	candidates.clear();
+	for( const auto &touch : touches )
+		mSubviewIndex->query( toLocal( touch.getPos() ), &candidates );
+
+	if( mSubviewOrderDirty )
+		updateSubviewOrder();
+
+	for( View *candidate : candidates ) {
+		if( candidate->mIndexInParent >= mSubviews.size() || mSubviews[candidate->mIndexInParent].get() != candidate ) {
+			// order is stale, most likely from a direct modification to mSubviews. Fall back to testing all subviews this time.
+			updateSubviewOrder();
+			rebuildSubviewIndex();
+			*result = mSubviews;
+			return;
+		}
+	}
+
+	sort( candidates.begin(), candidates.end(), []( const View *a, const View *b ) { return a->mIndexInParent < b->mIndexInParent; } );
+	candidates.erase( unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+	result->clear();
+	result->reserve( candidates.size() );
+	for( View *candidate : candidates )
+		result->push_back( mSubviews[candidate->mIndexInParent] );
 }
 
 const View* View::hitTest( const ci::app::TouchEvent &event ) const
@@ -503,57 +890,136 @@ bool View::isPointInside( const vec2 &localPos ) const
 
 vec2 View::toWorld( const vec2 &localPos ) const
 {
-	return localPos + getWorldPos();
+	return vec2( getWorldTransform() * vec3( localPos, 1 ) );
 }
 
 Rectf View::toWorld( const Rectf &localRect ) const
 {
-	return localRect + getWorldPos();
+	return localRect.transformed( getWorldTransform() );
 }
 
 vec2 View::toLocal( const vec2 &worldPos ) const
 {
-	return worldPos - getWorldPos();
+	return vec2( inverseAffine( getWorldTransform() ) * vec3( worldPos, 1 ) );
 }
 
 Rectf View::toLocal( const Rectf &worldRect ) const
 {
-	return worldRect - getWorldPos();
+	return worldRect.transformed( inverseAffine( getWorldTransform() ) );
 }
 
 const vec2& View::getWorldPos() const
 {
-	if( mWorldPosDirty ) {
-		calcWorldPos();
-		mWorldPosDirty = false;
+	if( mWorldPosEpoch != sWorldPosEpoch ) {
+		// validate the parent first, after which only a change to this View's position or the parent's world position requires recalculating
+		auto parent = getParent();
+		uint64_t parentVersion = 0;
+		if( parent ) {
+			parent->getWorldPos();
+			parentVersion = parent->mWorldPosVersion;
+		}
+
+		if( mWorldPosDirty || mParentWorldPosVersion != parentVersion ) {
+			calcWorldPos();
+			mParentWorldPosVersion = parentVersion;
+			mWorldPosVersion = ++sWorldPosVersionCounter;
+			mWorldPosDirty = false;
+		}
+
+		mWorldPosEpoch = sWorldPosEpoch;
 	}
 
 	return mWorldPos;
 }
 
+const mat3& View::getWorldTransform() const
+{
+	auto transforms = getCurrentTransformHierarchy();
+	if( transforms )
+		return transforms->getWorldTransform( mTransformIndex );
+
+	getWorldPos(); // brings mWorldTransform up to date
+	return mWorldTransform;
+}
+
 Rectf View::getWorldBounds() const
 {
-	auto pos = getWorldPos();
-	return Rectf( pos.x, pos.y, pos.x + getWidth(), pos.y + getHeight() );
+	auto transforms = getCurrentTransformHierarchy();
+	if( transforms )
+		return transforms->getWorldBounds( mTransformIndex );
+
+	return getBoundsLocal().transformed( getWorldTransform() );
 }
 
-void View::calcWorldPos() const
+const TransformHierarchy* View::getCurrentTransformHierarchy() const
 {
-	mWorldPos = getPos();
+	if( mGraph && mGraph->mTransformHierarchy && mGraph->mTransformHierarchy->isValid( this ) )
+		return mGraph->mTransformHierarchy.get();
+
+	return nullptr;
+}
+
+const Rectf& View::getSubtreeBounds() const
+{
+	if( mSubtreeBoundsDirty ) {
+		calcSubtreeBounds();
+		mSubtreeBoundsDirty = false;
+	}
+
+	return mSubtreeBounds;
+}
+
+void View::setSubtreeBoundsDirty()
+{
+	// ancestors of a dirty View are already dirty, so marking can stop at the first one
+	for( View *view = this; view && ! view->mSubtreeBoundsDirty; view = view->mParent )
+		view->mSubtreeBoundsDirty = true;
+}
+
+void View::calcSubtreeBounds() const
+{
+	mSubtreeBounds = getBoundsForFrameBuffer();
+	mSubtreeSize = 1;
+
+	// a Layer's FrameBuffer may be larger than its Views, and is composited as a whole
+	if( mRendersToFrameBuffer && isLayerRoot() )
+		mSubtreeBounds.include( mLayer->getRenderBounds() );
 
+	for( const auto &subview : mSubviews ) {
+		if( subview->isHidden() || subview->mMarkedForRemoval )
+			continue;
+
+		if( subview->mHasLocalTransform )
+			mSubtreeBounds.include( subview->getSubtreeBounds().transformed( subview->getLocalTransform() ) );
+		else
+			mSubtreeBounds.include( subview->getSubtreeBounds() + subview->getPos() );
+		mSubtreeSize += subview->mSubtreeSize;
+	}
+}
+
+void View::calcWorldPos() const
+{
+	// the parent has already been validated by getWorldPos()
 	auto parent = getParent();
 	if( parent )
-		mWorldPos += parent->getWorldPos();
+		mWorldTransform = parent->mWorldTransform * getLocalTransform();
+	else
+		mWorldTransform = getLocalTransform();
+
+	mWorldPos = vec2( mWorldTransform[2] );
 }
 
 void View::setBackgroundEnabled( bool enable )
 {
 	if( enable && ! mBackground ) {
 		mBackground = make_shared<RectView>( getBounds() );
+		mBackground->mHooks = detectHooks<RectView>();
 		mBackground->mParent = this;
 	}
 	else if( ! enable && mBackground )
 		mBackground.reset();
+
+	setNeedsRedraw();
 }
 
 bool View::isBackgroundEnabled() const
@@ -677,8 +1143,18 @@ RectView::RectView( const ci::Rectf &bounds )
 	setBlendMode( BlendMode::PREMULT_ALPHA );
 }
 
+void RectView::animateColor( const ColorA &color, double duration, double delay, Ease ease )
+{
+	CI_ASSERT_MSG( getGraph(), "View must be in a Graph to use its Animator" );
+	getGraph()->getAnimator().animate( this, mColor.ptr(), color, getGraph()->getCurrentTime() + delay, duration, ease );
+}
+
 void RectView::draw( Renderer *ren )
 {
+	// a ci::Anim on the color changes it without going through setColor()
+	if( ! mColor.isComplete() )
+		setNeedsRedraw();
+
 	ren->setColor( getColor() );
 	ren->drawSolidRect( getBoundsLocal() );
 }
@@ -692,6 +1168,31 @@ StrokedRectView::StrokedRectView( const ci::Rectf &bounds )
 {
 }
 
+void StrokedRectView::setLineWidth( float lineWidth )
+{
+	mLineWidth = lineWidth;
+	mLineWidthLastUpdate = lineWidth;
+	setSubtreeBoundsDirty();
+	setNeedsRedraw();
+}
+
+void StrokedRectView::setPlacement( Placement placement )
+{
+	mPlacement = placement;
+	setSubtreeBoundsDirty();
+	setNeedsRedraw();
+}
+
+void StrokedRectView::update()
+{
+	// catch line width animations, which change getBoundsForFrameBuffer()
+	if( mLineWidth() != mLineWidthLastUpdate ) {
+		mLineWidthLastUpdate = mLineWidth();
+		setSubtreeBoundsDirty();
+		setNeedsRedraw();
+	}
+}
+
 Rectf StrokedRectView::getBoundsForFrameBuffer() const
 {
 	switch( mPlacement ) {
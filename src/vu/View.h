@@ -24,9 +24,13 @@
 #pragma once
 
 #include "vu/Export.h"
+#include "vu/Animator.h"
 #include "vu/Layer.h"
 #include "vu/Renderer.h"
 #include "vu/Layout.h"
+#include "vu/SpatialIndex.h"
+#include "vu/TouchMap.h"
+#include "vu/TransformHierarchy.h"
 
 #include "cinder/app/TouchEvent.h"
 #include "cinder/app/KeyEvent.h"
@@ -38,6 +42,7 @@
 
 #include <list>
 #include <memory>
+#include <type_traits>
 
 namespace vu {
 
@@ -47,8 +52,24 @@ typedef std::shared_ptr<class RectView>			RectViewRef;
 typedef std::shared_ptr<class StrokedRectView>	StrokedRectViewRef;
 class Graph;
 
+//! Controls when the Graph updates a View and its subviews, see View::setUpdatePolicy().
+enum class UpdatePolicy {
+	ALWAYS,			//! Updated every frame.
+	WHEN_VISIBLE,	//! Skipped while hidden or entirely outside of the Graph's clipping size, unless touched or animating.
+	WHEN_DIRTY		//! Asleep until something changes: a property setter, layout, a touch or a running animation. See View::wake().
+};
+
 class CI_UI_API View : public std::enable_shared_from_this<View> {
   public:
+	//! Flags for the virtual hooks that the Graph calls on a View, see setHooks().
+	enum Hooks : uint8_t {
+		HOOKS_NONE		= 0,
+		HOOK_LAYOUT		= 1 << 0,
+		HOOK_UPDATE		= 1 << 1,
+		HOOK_DRAW		= 1 << 2,
+		HOOKS_ALL		= HOOK_LAYOUT | HOOK_UPDATE | HOOK_DRAW
+	};
+
 	View( const ci::Rectf &bounds = ci::Rectf::zero() );
 	virtual ~View();
 
@@ -62,13 +83,26 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	virtual void removeFromParent();
 	virtual bool containsSubview( const ViewRef &view );
 
+	//! Creates a \a ViewT and adds it as a subview. The hooks that \a ViewT overrides are detected at compile time, see setHooks().
 	template<typename ViewT, typename... Args>
 	std::shared_ptr<ViewT> makeSubview( Args&&... args );
 
+	//! Returns the Hooks flags for the virtual hooks that \a ViewT overrides. A hook that can't be inspected, ex. one overridden privately, is reported as overridden
+	//! while the other hooks are still detected normally. A final \a ViewT can't be inspected at all, so all of its hooks are reported as overridden.
+	template<typename ViewT>
+	static constexpr uint8_t detectHooks();
+
+	//! Sets which of layout(), update() and draw() the Graph calls on this View, as a mask of Hooks flags. Skipping a hook also skips the render state
+	//! changes made around it. Views created with makeSubview() or setBackgroundEnabled() are set automatically, as are plain Views added with addSubview().
+	//! Other Views can call `setHooks( View::detectHooks<MyView>() )`. \default HOOKS_ALL.
+	void	setHooks( uint8_t hooks )	{ mHooks = hooks; }
+	//! Returns which of layout(), update() and draw() the Graph calls on this View, as a mask of Hooks flags.
+	uint8_t	getHooks() const			{ return mHooks; }
+
 	void			setBounds( const ci::Rectf &bounds );
 	virtual void	setPos( const ci::vec2 &position );
 	virtual void	setSize( const ci::vec2 &size );
-	virtual void	setAlpha( float alpha )							{ mAlpha = alpha; }
+	virtual void	setAlpha( float alpha )							{ mAlpha = alpha; wake(); }
 
 	float					getAlpha()	const		{ return mAlpha; }
 	float					getAlphaCombined() const;
@@ -85,9 +119,31 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	float					getWidth() const		{ return mSize().x; }
 	float					getHeight() const		{ return mSize().y; }
 
-	ci::Anim<float>*		animAlpha()			{ return &mAlpha; }
-	ci::Anim<ci::vec2>*		animPos()			{ return &mPos; }
-	ci::Anim<ci::vec2>*		animSize()			{ return &mSize; }
+	//! Sets the scale of this View and its subviews, about its position. \default [1, 1].
+	void					setScale( const ci::vec2 &scale );
+	const ci::vec2&			getScale() const		{ return mScale; }
+	//! Sets the rotation of this View and its subviews in radians, about its position. \default 0.
+	void					setRotation( float radians );
+	float					getRotation() const		{ return mRotation; }
+	//! Returns whether this View is scaled or rotated relative to its parent.
+	bool					hasLocalTransform() const	{ return mHasLocalTransform; }
+	//! Returns the affine transform from this View's coordinate space to its parent's: translated by position, then rotated, then scaled.
+	ci::mat3				getLocalTransform() const;
+
+	ci::Anim<float>*		animAlpha()			{ wake(); return &mAlpha; }
+	ci::Anim<ci::vec2>*		animPos()			{ wake(); return &mPos; }
+	ci::Anim<ci::vec2>*		animSize()			{ wake(); return &mSize; }
+
+	//! Animates the position to \a pos over \a duration seconds, starting after \a delay, with the Graph's Animator. Replaces any Animator tween of the position. The View must be in a Graph.
+	void	animatePos( const ci::vec2 &pos, double duration, double delay = 0, Ease ease = Ease::LINEAR );
+	//! Animates the size to \a size over \a duration seconds, starting after \a delay, with the Graph's Animator. Replaces any Animator tween of the size. The View must be in a Graph.
+	void	animateSize( const ci::vec2 &size, double duration, double delay = 0, Ease ease = Ease::LINEAR );
+	//! Animates alpha to \a alpha over \a duration seconds, starting after \a delay, with the Graph's Animator. Replaces any Animator tween of alpha. The View must be in a Graph.
+	void	animateAlpha( float alpha, double duration, double delay = 0, Ease ease = Ease::LINEAR );
+	//! Stops all tweens of this View's properties on the Graph's Animator, leaving them at their current values.
+	void	cancelAnimations();
+	//! Returns whether position, size or alpha is being animated by a ci::Anim, or any property by the Graph's Animator.
+	bool	isAnimating() const;
 
 	const std::vector<ViewRef>&	getSubviews() const		{ return mSubviews; }
 	std::vector<ViewRef>&	getSubviews()		{ return mSubviews; }
@@ -137,17 +193,33 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	bool isBackgroundEnabled() const;
 	const RectViewRef& getBackground();
 
+	//! Returns the position of this View's origin in world space.
 	const ci::vec2&		getWorldPos() const;
+	//! Returns the affine transform from this View's coordinate space to world space. Read from the Graph's TransformHierarchy when it is enabled and current.
+	const ci::mat3&		getWorldTransform() const;
+	//! Returns the axis aligned bounds of this View in world space. Clipping uses these, so a scaled or rotated View clips to the box around it.
 	ci::Rectf			getWorldBounds() const;
+	//! Returns the axis aligned bounds of this View in its parent's coordinate space, including scale and rotation.
+	ci::Rectf			getBoundsInParent() const;
+	//! Returns the bounds of everything this View and its visible subviews draw, in this View's coordinate space. Used to cull subtrees outside of the current clip when drawing.
+	const ci::Rectf&	getSubtreeBounds() const;
 	ci::vec2			toWorld( const ci::vec2 &localPos ) const;
 	ci::vec2			toLocal( const ci::vec2 &worldPos ) const;
 	ci::Rectf			toWorld( const ci::Rectf &localRect ) const;
 	ci::Rectf			toLocal( const ci::Rectf &worldRect ) const;
 
 	virtual const View*	hitTest( const ci::app::TouchEvent &event ) const;
+	//! Returns whether \a localPos is within this View's bounds. Note: if overridden to accept points outside of the bounds, disable the subview index on the parent View (see setSubviewIndexEnabled()),
+	//! which also stops the Graph from rejecting touches outside of the bounds before this is called (see Graph::setBatchedHitTestingEnabled()).
 	virtual bool		isPointInside( const ci::vec2 &localPos ) const;
 
-	void	setHidden( bool hidden = true )			{ mHidden = hidden; }
+	//! Enables or disables the SpatialIndex used to find which subviews are under touches. Only used once this View has a large number of subviews.
+	//! Disabling it also disables the Graph's batched hit testing of this View's subviews, so each subview's hitTest() sees every touch. \default true.
+	void	setSubviewIndexEnabled( bool enable = true );
+	//! Returns whether the SpatialIndex used to find which subviews are under touches is enabled.
+	bool	isSubviewIndexEnabled() const				{ return mSubviewIndexEnabled; }
+
+	void	setHidden( bool hidden = true );
 	bool	isHidden() const						{ return mHidden; }
 	void	setInteractive( bool enable = true )	{ mInteractive = enable; }
 	bool	isInteractive() const					{ return mInteractive; }
@@ -155,16 +227,16 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	bool	isBoundsAnimating() const;
 	bool    isTransparent() const;
 
-	const  std::map<uint32_t, ci::app::TouchEvent::Touch>&	getActiveTouches() const	{ return mActiveTouches; }
+	const TouchMap&	getActiveTouches() const	{ return mActiveTouches; }
 
 	// TODO: this needs to mark layer tree dirty, at least if there is compositing going on (should skip reconfigure otherwise)
-	void setRenderTransparencyToFrameBufferEnabled( bool enable )	{ mRenderTransparencyToFrameBuffer = enable; }
+	void setRenderTransparencyToFrameBufferEnabled( bool enable )	{ mRenderTransparencyToFrameBuffer = enable; setNeedsRedraw(); }
 	bool isRenderTransparencyToFrameBufferEnabled() const			{ return mRenderTransparencyToFrameBuffer; }
 
 	void	setClipEnabled( bool enable = true );
 	bool	isClipEnabled() const;
 
-	void	    setBlendMode( BlendMode mode )			{ mBlendMode = mode; }
+	void	    setBlendMode( BlendMode mode )			{ mBlendMode = mode; setNeedsRedraw(); }
 	BlendMode	getBlendMode() const					{ return mBlendMode; }
 
 	void    addFilter( const FilterRef &filter );
@@ -176,6 +248,19 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	void	setFillParentEnabled( bool enable = true );
 	bool	isFillParentEnabled() const					{ return mFillParent; }
 
+	//! Sets when the Graph updates this View and its subviews. Sleeping or off-screen subtrees are skipped as a whole, regardless of the policies of their subviews. \default UpdatePolicy::ALWAYS.
+	void			setUpdatePolicy( UpdatePolicy policy )	{ mUpdatePolicy = policy; wake(); }
+	//! Returns when the Graph updates this View and its subviews.
+	UpdatePolicy	getUpdatePolicy() const					{ return mUpdatePolicy; }
+	//! Makes sure this View and its ancestors are updated next frame, waking any sleeping subtree they are in. Property setters, layout, touches and Anims of
+	//! position, size and alpha do this automatically. Subclasses should call it when other state changes or their own Anims run, ex. from update().
+	void			wake();
+	//! Marks what this View draws as changed, so that the Graph draws the next frame (see Graph::needsRedraw()) and any Layer that holds this View re-renders instead of
+	//! compositing its cached FrameBuffer. Built-in setters, layout and hierarchy changes do this; subclasses must call it whenever the output of draw() changes in another way.
+	void			setNeedsRedraw();
+	//! Requests that the Graph draws a frame once its current time reaches \a time, ex. for a cursor blink. See Graph::setNeedsRedraw( double ).
+	void			setNeedsRedraw( double time );
+
 	//! Informs layout propagation that this View and its subviews need layout() to be called.
 	void	setNeedsLayout();
 	//! Returns whether this View needs to have its layout() method called before the next update(). TODO: rename to getNeedsLayout()
@@ -193,19 +278,25 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	//! Returns the touches currently being intercepted
 	const std::vector<ci::app::TouchEvent::Touch>&	getInterceptingTouches() const	{ return mInterceptedTouchEvent.getTouches(); }
 
-	//! This is done when the world position should be recalculated but calling layout isn't necessary (ex. when ScrollView offset moves)
+	//! Marks this View's world position, and so those of its subviews, as needing to be recalculated. This is constant time, subviews are revalidated lazily
+	//! from getWorldPos(). Called automatically by setPos() and when reparenting; needed when the position changes another way, ex. from an Anim.
 	void	setWorldPosDirty();
 
   protected:
 	virtual void layout()		        {}
 	virtual void update()		        {}
 	virtual void draw( Renderer *ren )  {}
+	//! Return true if draw() only draws through \a ren, so that the Renderer can batch it with other Views. Otherwise it is recorded as a callback, which may draw with ci::gl
+	//! directly. Inherited by subclasses, so a subclass that overrides draw() to draw with ci::gl must return false. \default false.
+	virtual bool drawsOnlyThroughRenderer() const	{ return false; }
 
 	//! Returns the bounds required for rendering this View to a FrameBuffer. \default is this View's local bounds. Override if this View needs a larger sized or FrameBuffer.
 	virtual ci::Rectf   getBoundsForFrameBuffer() const;
 
 	//! TODO: try to combine this with getBoundsForFrameBuffer. this is a temp solution to get modified clip bounds.
 	virtual ci::Rectf   getClipWorldBounds() const	{ return getWorldBounds(); }
+	//! Marks getSubtreeBounds() of this View and its ancestors as needing to be recalculated. Call this if the result of getBoundsForFrameBuffer() changes without the size changing.
+	void	setSubtreeBoundsDirty();
 
 	// Responder ------------------
 	// TODO: rename these with 'can' or 'should' suffix? To indicate they are asking whether this is possible or not
@@ -226,33 +317,70 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	virtual bool keyDown( ci::app::KeyEvent &event )	{ return false; }
 	virtual bool keyUp( ci::app::KeyEvent &event )		{ return false; }
 
+	//! Called after this View is removed from its parent with removeSubview(), removeAllSubviews() or removeFromParent(), or its parent is destroyed.
+	//! Not called when it is added to another parent, which moves it. Override to release resources that are only needed while it is shown, ex. pending loads.
+	virtual void removedFromParent()	{}
+
   private:
 	View( const View& )				= delete;
 	View& operator=( const View& )	= delete;
 
 	void setParent( View *parent );
+	//! Removes \a view from mSubviews without calling removedFromParent() on it, returns false if it isn't a subview.
+	bool detachSubview( const ViewRef &view );
+	//! Called whenever mParent changes, so that cached world transforms and the Graph's TransformHierarchy know to recalculate.
+	void parentChanged();
+	void localTransformChanged();
+	//! Returns the Graph's TransformHierarchy if it is enabled and current for this View, otherwise nullptr.
+	const TransformHierarchy* getCurrentTransformHierarchy() const;
+	//! Called when this View's position, alpha, visibility or transform changes, which changes what its parent draws but not its own content.
+	void placementChanged();
+	//! Called by the Animator after writing to \a target, a property of this View.
+	void animatedPropertyChanged( const void *target );
 	void calcWorldPos() const;
+	void calcSubtreeBounds() const;
 	void layoutImpl();
 	void updateImpl();
 	void drawImpl( Renderer *ren );
 	void clearViewsMarkedForRemoval();
 
+	void subviewAdded( View *subview );
+	void subviewBoundsChanged( View *subview );
+	void rebuildSubviewIndex();
+	void updateSubviewOrder();
+	//! Fills \a result with the subviews that may contain any of \a touches, in the same order as mSubviews.
+	void getSubviewsForTouches( const std::vector<ci::app::TouchEvent::Touch> &touches, std::vector<ViewRef> *result );
 
-	typedef std::map<uint32_t, ci::app::TouchEvent::Touch> TouchMapT; // TODO just store this as vector and use std::find (you hardly have more than 10 touches)
-
-	TouchMapT				mActiveTouches;
+	TouchMap				mActiveTouches;
 
 	bool					mInteractive = true;
 	bool					mHidden = false;
 	bool					mNeedsLayout = false;
 	
-	mutable bool			mWorldPosDirty = true;
+	mutable bool			mWorldPosDirty = true; // position or parent changed since mWorldPos was calculated
 	mutable ci::vec2		mWorldPos;
+	mutable ci::mat3		mWorldTransform = ci::mat3( 1 );
+	mutable uint64_t		mWorldPosEpoch = 0; // epoch in which mWorldPos was last validated
+	mutable uint64_t		mWorldPosVersion = 0; // changes every time mWorldPos is recalculated
+	mutable uint64_t		mParentWorldPosVersion = 0; // the parent's mWorldPosVersion that mWorldPos was calculated from
+	size_t					mTransformIndex = TransformHierarchy::INVALID_INDEX; // index in the Graph's TransformHierarchy
+	mutable bool			mSubtreeBoundsDirty = true;
+	mutable ci::Rectf		mSubtreeBounds = ci::Rectf::zero();
+	mutable size_t			mSubtreeSize = 1; // number of visible Views in the subtree, including this one
+	UpdatePolicy			mUpdatePolicy = UpdatePolicy::ALWAYS;
+	uint8_t					mHooks = HOOKS_ALL;
+	bool					mWakeRequested = true; // something changed in this View's subtree since it was last updated
 
 	ci::Anim<float>			mAlpha = 1.0f;
 	ci::Anim<ci::vec2>		mPos;
 	ci::Anim<ci::vec2>		mSize;
+	ci::vec2				mScale = ci::vec2( 1 );
+	float					mRotation = 0;
+	bool					mHasLocalTransform = false;
+	size_t					mNumTweens = 0; // tweens of this View's properties running on the Graph's Animator
 	ci::vec2				mPosLastUpdate, mSizeLastUpdate;
+	float					mAlphaLastUpdate = 1.0f;
+	uint64_t				mContentVersion = 0; // last time anything drawn within this View's subtree changed, compared by Layers with a cached FrameBuffer
 	std::string				mLabel;
 	bool					mFillParent = false; // TODO: replace this with proper layout system
 	BlendMode				mBlendMode = BlendMode::ALPHA;
@@ -265,6 +393,11 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 	View*					mParent = nullptr;
 	Graph*                  mGraph = nullptr;
 	std::vector<ViewRef>	mSubviews;
+	std::unique_ptr<SpatialIndex>	mSubviewIndex;
+	std::vector<View *>		mSubviewIndexResults; // reused by getSubviewsForTouches()
+	bool					mSubviewIndexEnabled = true;
+	bool					mSubviewOrderDirty = true;
+	size_t					mIndexInParent = 0;
 	RectViewRef				mBackground;
 	LayerRef				mLayer;
 	std::vector<FilterRef>  mFilters;
@@ -278,8 +411,15 @@ class CI_UI_API View : public std::enable_shared_from_this<View> {
 
 	ci::signals::Signal<void ()>	mSignalViewDidLayout;
 
+	static uint64_t			sWorldPosEpoch; // advanced whenever any View's position or parent changes
+	static uint64_t			sWorldPosVersionCounter; // source of mWorldPosVersion values, unique across all Views so that subviews notice any recalculation
+	static uint64_t			sHierarchyVersion; // advanced whenever any View's parent changes
+	static uint64_t			sContentVersionCounter; // source of mContentVersion values
+
 	friend class Layer;
 	friend class Graph;
+	friend class TransformHierarchy;
+	friend class Animator;
 };
 
 CI_UI_API std::ostream& operator<<( std::ostream &os, const View &rhs );
@@ -292,12 +432,56 @@ CI_UI_API std::string printHierarchyToString( const ViewRef &view );
 //! Traverses the View hierarchy of \a view, top to bottom.
 CI_UI_API void traverse( const ViewRef &view, const std::function<bool( const ViewRef & )> &applyFn );
 
+namespace detail {
+
+//! Derives from \a ViewT so that its protected hooks can be named. A hook that resolves to View's own declaration hasn't been overridden.
+template<typename ViewT, bool IsFinal = std::is_final<ViewT>::value>
+struct ViewHookTraits : public ViewT {
+	template<typename C>
+	static constexpr bool overridesLayout( decltype( &C::layout ) )		{ return ! std::is_same<decltype( &C::layout ), void (View::*)()>::value; }
+	template<typename C>
+	static constexpr bool overridesLayout( ... )						{ return true; }
+	template<typename C>
+	static constexpr bool overridesUpdate( decltype( &C::update ) )		{ return ! std::is_same<decltype( &C::update ), void (View::*)()>::value; }
+	template<typename C>
+	static constexpr bool overridesUpdate( ... )						{ return true; }
+	template<typename C>
+	static constexpr bool overridesDraw( decltype( &C::draw ) )			{ return ! std::is_same<decltype( &C::draw ), void (View::*)( Renderer * )>::value; }
+	template<typename C>
+	static constexpr bool overridesDraw( ... )							{ return true; }
+
+	static constexpr uint8_t hooks()
+	{
+		return uint8_t( ( overridesLayout<ViewHookTraits>( nullptr ) ? View::HOOK_LAYOUT : 0 )
+		              | ( overridesUpdate<ViewHookTraits>( nullptr ) ? View::HOOK_UPDATE : 0 )
+		              | ( overridesDraw<ViewHookTraits>( nullptr ) ? View::HOOK_DRAW : 0 ) );
+	}
+};
+
+//! Final classes can't be derived from to inspect their hooks, so they keep all of them.
+template<typename ViewT>
+struct ViewHookTraits<ViewT, true> {
+	static constexpr uint8_t hooks()	{ return View::HOOKS_ALL; }
+};
+
+} // namespace detail
+
+template<typename ViewT>
+constexpr uint8_t View::detectHooks()
+{
+	static_assert( std::is_base_of<View, ViewT>::value, "ViewT must inherit from vu::View" );
+
+	return detail::ViewHookTraits<ViewT>::hooks();
+}
+
 template<typename ViewT, typename... Args>
 std::shared_ptr<ViewT> View::makeSubview( Args&&... args )
 {
 	static_assert( std::is_base_of<View, ViewT>::value, "ViewT must inherit from vu::View" );
 
 	std::shared_ptr<ViewT> result( new ViewT( std::forward<Args>( args )... ) );
+	// keep any hooks the constructor has already disabled
+	result->mHooks &= detectHooks<ViewT>();
 	addSubview( result );
 	return result;
 }
@@ -306,14 +490,17 @@ class CI_UI_API RectView : public View {
   public:
 	RectView( const ci::Rectf &bounds = ci::Rectf::zero() );
 
-	void					setColor( const ci::ColorA &color )	{ mColor = color; }
+	void					setColor( const ci::ColorA &color )	{ mColor = color; setNeedsRedraw(); }
 	const ci::ColorA&		getColor() const					{ return mColor; }
-	ci::Anim<ci::ColorA>*	animColor()							{ return &mColor; }
+	ci::Anim<ci::ColorA>*	animColor()							{ setNeedsRedraw(); return &mColor; }
 	//! note: deprecated, use animColor() instead
-	ci::Anim<ci::ColorA>*	getColorAnim()						{ return &mColor; }
+	ci::Anim<ci::ColorA>*	getColorAnim()						{ setNeedsRedraw(); return &mColor; }
+	//! Animates the color to \a color with the Graph's Animator, see View::animatePos().
+	void					animateColor( const ci::ColorA &color, double duration, double delay = 0, Ease ease = Ease::LINEAR );
 
   protected:
 	void draw( Renderer *ren ) override;
+	bool drawsOnlyThroughRenderer() const override	{ return true; }
 
 	ci::Anim<ci::ColorA>	mColor = { ci::ColorA::black() };
   private:
@@ -326,20 +513,22 @@ class CI_UI_API StrokedRectView : public RectView {
 
 	StrokedRectView( const ci::Rectf &bounds = ci::Rectf::zero() );
 
-	void				setLineWidth( float lineWidth )		{ mLineWidth = lineWidth; }
+	void				setLineWidth( float lineWidth );
 	float				getLineWidth() const				{ return mLineWidth; }
 	ci::Anim<float>*	getLineWidthAnim()					{ return &mLineWidth; }
 
-	void                setPlacement( Placement placement )	{ mPlacement = placement; };
+	void                setPlacement( Placement placement );
 	Placement           getPlacement() const                { return mPlacement; }
 
   protected:
+	void update() override;
 	void draw( Renderer *ren ) override;
 	ci::Rectf getBoundsForFrameBuffer() const   override;
 
   private:
 
 	ci::Anim<float>		mLineWidth = { 1 };
+	float				mLineWidthLastUpdate = 1;
 	Placement mPlacement = Placement::CENTERED;
 };
 
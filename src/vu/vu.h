@@ -21,16 +21,30 @@
 
 #pragma once
 
+#include "vu/Animator.h"
 #include "vu/Control.h"
 #include "vu/Filter.h"
+#include "vu/GlDevice.h"
+#include "vu/GlStateCache.h"
 #include "vu/Graph.h"
 #include "vu/Image.h"
+#include "vu/ImageAtlas.h"
+#include "vu/ImageLoader.h"
 #include "vu/ImageView.h"
+#include "vu/InputQueue.h"
+#include "vu/InputRecording.h"
 #include "vu/Interface3d.h"
 #include "vu/Label.h"
 #include "vu/Layer.h"
+#include "vu/NullGlDevice.h"
+#include "vu/RenderBackend.h"
+#include "vu/RenderCommandList.h"
 #include "vu/Renderer.h"
 #include "vu/ScrollView.h"
+#include "vu/SoftwareRasterizer.h"
+#include "vu/SpatialIndex.h"
 #include "vu/Suite.h"
 #include "vu/TextManager.h"
+#include "vu/TouchMap.h"
+#include "vu/TransformHierarchy.h"
 #include "vu/View.h"